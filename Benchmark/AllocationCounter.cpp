@@ -0,0 +1,67 @@
+#include "BenchmarkUtil.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// ベンチマークの実行ファイル全体の operator new を置き換え、確保の回数を数える
+// (配置 new と align_val_t 付きのものは置き換えないので数えない)
+
+namespace {
+
+std::atomic<uint64_t> gAllocationCount{ 0 };
+
+void* CountedAllocate(std::size_t size) {
+	gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+} // namespace
+
+uint64_t GetAllocationCount() {
+	return gAllocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+	return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size) {
+	return CountedAllocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+	std::free(pointer);
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "../ChunkedTileMap.h"
+#include "../MapFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// ベンチマーク共通の小道具
+
+// 経過時間の計測
+class Stopwatch {
+public:
+	Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+	void Restart() { start_ = std::chrono::steady_clock::now(); }
+
+	double GetSeconds() const {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+	}
+
+private:
+	std::chrono::steady_clock::time_point start_;
+};
+
+// 計測値の集計 (秒)
+struct TimingSummary {
+	double best = 0.0;
+	double median = 0.0;
+	double mean = 0.0;
+};
+
+inline TimingSummary Summarize(std::vector<double> samples) {
+	TimingSummary summary;
+	if (samples.empty()) {
+		return summary;
+	}
+	std::sort(samples.begin(), samples.end());
+	summary.best = samples.front();
+	summary.median = samples[samples.size() / 2];
+	double total = 0.0;
+	for (double sample : samples) {
+		total += sample;
+	}
+	summary.mean = total / static_cast<double>(samples.size());
+	return summary;
+}
+
+// "--name value" 形式の引数を探す (なければ既定値)
+inline std::string FindOption(int argc, char* argv[], const std::string& name, const std::string& defaultValue) {
+	for (int i = 0; i + 1 < argc; ++i) {
+		if (name == argv[i]) {
+			return argv[i + 1];
+		}
+	}
+	return defaultValue;
+}
+
+inline int FindIntOption(int argc, char* argv[], const std::string& name, int defaultValue) {
+	std::string value = FindOption(argc, argv, name, "");
+	return value.empty() ? defaultValue : std::atoi(value.c_str());
+}
+
+// マップ全体を読み込んでおく
+inline void LoadWholeMap(ChunkedTileMap& map, const MapData& data) {
+	map.Reset(std::make_unique<MapDataChunkSource>(data));
+	map.Stream(data.width / 2, data.height / 2, data.width, data.height);
+}
+
+// 壁がまばらに散ったマップ (壁の割合は wallsPerThousand / 1000)
+inline MapData GenerateScatteredMap(int32_t width, int32_t height, int wallsPerThousand, uint32_t seed) {
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int> distribution(0, 999);
+	MapData map;
+	map.width = width;
+	map.height = height;
+	map.tiles.resize(static_cast<size_t>(width) * height);
+	for (uint8_t& tile : map.tiles) {
+		tile = distribution(random) < wallsPerThousand ? kTileWall : kTileEmpty;
+	}
+	return map;
+}
+
+// これまでに operator new で確保した回数 (AllocationCounter.cpp で数える)
+uint64_t GetAllocationCount();
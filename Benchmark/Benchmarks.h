@@ -0,0 +1,72 @@
+#pragma once
+
+// 各ベンチマークの入口 (argv はサブコマンド名より後ろの引数)
+
+// OBJ読み込み: 旧ローダー (stringstream) と ObjLoader の MB/s を比較する
+int RunObjBenchmark(int argc, char* argv[]);
+
+// メッシュの焼き込み: OBJ を .meshbin にして、解析と読み込みの時間を比べる
+int RunMeshBakeCommand(int argc, char* argv[]);
+
+// 頂点キャッシュ最適化: ACMR / ATVR の前後比較 (skydome, multiMesh など)
+int RunVertexCacheBenchmark(int argc, char* argv[]);
+
+// 頂点の圧縮: CompactVertexData に詰めて戻したときの誤差 (許容値を超えたら 1 を返す)
+int RunVertexPackingBenchmark(int argc, char* argv[]);
+
+// タイルの当たり判定: 旧 MapChip (vector<vector<int>>) と TileGrid の比較
+int RunTileGridBenchmark(int argc, char* argv[]);
+
+// マップの変換: CSV / TSV / .mapbin を相互に変換する (引数なしならゲームのマップを .mapbin に)
+int RunMapConvertCommand(int argc, char* argv[]);
+
+// マップの読み込み: 旧 getline/stoi と ParseMapText / ParseMapBin の比較
+int RunMapLoadBenchmark(int argc, char* argv[]);
+
+// 壁のメッシュ化: 見えない面の間引きと面の結合で三角形がどれだけ減るか (ゲームのマップで検証する)
+int RunTileMeshBenchmark(int argc, char* argv[]);
+
+// チャンクの読み込み: 10万列のマップを流して、常駐量が予算内で一定か・当たり判定が正しいかを確かめる
+int RunChunkStreamBenchmark(int argc, char* argv[]);
+
+// 書き換えの反映: 壁の書き換えを毎フレーム行い、書き換えたチャンクだけ作り直す費用を測る (kTileBlock だけの書き換えでは作り直さないことも確かめる)
+int RunRemeshBenchmark(int argc, char* argv[]);
+
+// 描画の間引き: Camera の行列から求めたタイルの範囲が、画面にかかるタイルを取りこぼさないかを総当たりで確かめる
+int RunViewCullBenchmark(int argc, char* argv[]);
+
+// 箱の掃引: 1ステップで何マスも進む動きで壁を飛び越さないかを、細かく刻んだ総当たりと比べる
+int RunSweepBenchmark(int argc, char* argv[]);
+
+// 光線の問い合わせ: タイルの DDA を総当たりと比べ、大きなマップで1秒に何本撃てるかを測る
+int RunRaycastBenchmark(int argc, char* argv[]);
+
+// 壁の有無の階層: 書き換えのたびの更新が正しいかを確かめ、まばらなマップで光線・床探しがどれだけ速くなるかを測る
+int RunOccupancyBenchmark(int argc, char* argv[]);
+
+// 動的ブロックの索引: 動かしながら問い合わせを総当たりと比べ、数を増やしても近くを探す費用が一定かを測る
+int RunObjectGridBenchmark(int argc, char* argv[]);
+
+// ゲームの進行: ウィンドウなしで決まった操作のボットに遊ばせ、1秒に何ティック回るか・繰り返して同じ結果になるか・画面の更新間隔によらず同じ速さで進むかを見る
+int RunSimulationBenchmark(int argc, char* argv[]);
+
+// 操作の記録と再生: 記録をファイルに書いて読み戻し、同じ状態をたどるかと、ずれたティックを正しく見つけるかを見る
+int RunReplayBenchmark(int argc, char* argv[]);
+
+// 通しプレイ: map.csv / map2.csv / map3.csv をボットか記録した操作で遊び、ティックの時間の分布・処理ごとの内訳・確保の回数を出す (JSON にも書ける)
+int RunPlaythroughBenchmark(int argc, char* argv[]);
+
+// ずれの検出: 同じ操作で2つ並べて回し、毎ティックの項目ごとのハッシュでずれた最初のティックと項目 (要素) を見つける
+int RunDesyncBenchmark(int argc, char* argv[]);
+
+// インスタンス描画のまとめ: 記録用のバックエンドに送り、メッシュごとに1回の描画・範囲・行列・入りきらないときの扱いを確かめる
+int RunInstanceBatchBenchmark(int argc, char* argv[]);
+
+// 描画ごとの定数のリング: 256バイト境界・折り返し・GPU が読んでいるフレームを上書きしないこと・フェンスでの解放・容量不足を確かめる
+int RunRingAllocatorBenchmark(int argc, char* argv[]);
+
+// サイズクラスの確保: 大きさ・配置の混ざった確保と解放を流し、丸め・空きリストの再利用・ページ・統計を確かめる
+int RunSizeClassBenchmark(int argc, char* argv[]);
+
+// 静的バッファの転送: コピーが1本の命令列にまとまるか・ステージング領域をフェンスを待って使い直すかを確かめる
+int RunUploadBenchmark(int argc, char* argv[]);
@@ -0,0 +1,289 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../ChunkedTileMap.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// 列ごとに地面の高さと足場を決める横長のマップ (ファイルを作らずにいくらでも大きくできる)
+class GeneratedChunkSource : public TileChunkSource {
+public:
+	GeneratedChunkSource(int32_t width, int32_t height) : width_(width), height_(height) {}
+
+	int32_t GetWidth() const override { return width_; }
+	int32_t GetHeight() const override { return height_; }
+	const std::vector<MapObject>& GetObjects() const override { return objects_; }
+
+	bool LoadChunk(int32_t chunkX, int32_t chunkY, uint8_t* tiles) override {
+		for (int32_t y = 0; y < kChunkSize; ++y) {
+			for (int32_t x = 0; x < kChunkSize; ++x) {
+				tiles[y * kChunkSize + x] = TileAt((chunkX << kChunkShift) + x, (chunkY << kChunkShift) + y);
+			}
+		}
+		return true;
+	}
+
+	// 答え合わせ用 (マップの外は kTileEmpty)
+	uint8_t TileAt(int32_t x, int32_t mapY) const {
+		if (x < 0 || x >= width_ || mapY < 0 || mapY >= height_) {
+			return kTileEmpty;
+		}
+		uint32_t column = Hash(static_cast<uint32_t>(x) / 8);
+		int32_t ground = height_ - 3 - static_cast<int32_t>(column % 6);
+		if (mapY >= ground) {
+			return kTileWall;
+		}
+		// ところどころに浮いた足場
+		uint32_t cell = Hash(static_cast<uint32_t>(x) * 7919u + static_cast<uint32_t>(mapY) * 104729u);
+		return (cell % 23 == 0) ? kTileWall : kTileEmpty;
+	}
+
+private:
+	static uint32_t Hash(uint32_t value) {
+		value ^= value >> 16;
+		value *= 0x7feb352du;
+		value ^= value >> 15;
+		value *= 0x846ca68bu;
+		value ^= value >> 16;
+		return value;
+	}
+
+	int32_t width_;
+	int32_t height_;
+	std::vector<MapObject> objects_;
+};
+
+// MapChip と同じくチャンクごとに壁の位置を作り、破棄で捨てる (描画データの常駐量を測る)
+class WallListener : public TileChunkListener {
+public:
+	explicit WallListener(int32_t chunkCountX) : chunkCountX_(chunkCountX) {}
+
+	void OnChunkLoaded(int32_t chunkX, int32_t chunkY, const uint8_t* tiles) override {
+		CollectWalls(walls_[chunkY * chunkCountX_ + chunkX], tiles);
+	}
+
+	void OnChunkEvicted(int32_t chunkX, int32_t chunkY) override {
+		auto it = walls_.find(chunkY * chunkCountX_ + chunkX);
+		wallCount_ -= it->second.size();
+		walls_.erase(it);
+	}
+
+	void OnChunkChanged(int32_t chunkX, int32_t chunkY, const TileRect&, bool wallsChanged, const uint8_t* tiles) override {
+		if (!wallsChanged) {
+			return;
+		}
+		std::vector<int32_t>& walls = walls_[chunkY * chunkCountX_ + chunkX];
+		wallCount_ -= walls.size();
+		CollectWalls(walls, tiles);
+	}
+
+	size_t GetWallCount() const { return wallCount_; }
+	size_t GetPeakWallCount() const { return peakWallCount_; }
+
+private:
+	void CollectWalls(std::vector<int32_t>& walls, const uint8_t* tiles) {
+		walls.clear();
+		for (int32_t i = 0; i < kChunkTileCount; ++i) {
+			if (tiles[i] == kTileWall) {
+				walls.push_back(i);
+			}
+		}
+		wallCount_ += walls.size();
+		peakWallCount_ = std::max(peakWallCount_, wallCount_);
+	}
+
+	int32_t chunkCountX_;
+	std::unordered_map<int32_t, std::vector<int32_t>> walls_;
+	size_t wallCount_ = 0;
+	size_t peakWallCount_ = 0;
+};
+
+// 左端から右端まで流して戻る。当たり判定は毎フレーム答え合わせする (食い違いがあれば false)
+bool Scroll(const char* name, std::unique_ptr<TileChunkSource> source, const GeneratedChunkSource& reference,
+	size_t budget, int32_t step, int32_t queriesPerFrame) {
+	ChunkedTileMap map;
+	map.Reset(std::move(source), budget);
+	WallListener listener(map.GetChunkCountX());
+	map.AddListener(&listener);
+
+	const int32_t kRadiusX = 48;
+	const int32_t kRadiusY = 32;
+	int32_t centerMapY = map.GetHeight() / 2;
+	std::mt19937 random(13579);
+	// 書き換えたマス (x + mapY * width -> 種類)
+	std::unordered_map<int64_t, uint8_t> edits;
+	auto expectedTile = [&](int32_t x, int32_t mapY) -> int32_t {
+		if (!map.Contains(x, mapY)) {
+			return -1;
+		}
+		auto it = edits.find(x + static_cast<int64_t>(mapY) * map.GetWidth());
+		return it != edits.end() ? it->second : reference.TileAt(x, mapY);
+	};
+	uint64_t queryCount = 0;
+	uint64_t mismatchCount = 0;
+	std::vector<double> streamSamples;
+	double querySeconds = 0.0;
+
+	// 予算いっぱいまで読み込んだあとは常駐量が変わらないことを、10区間ごとの最大値で確かめる
+	const int kSectionCount = 10;
+	size_t sectionPeakBytes[kSectionCount] = {};
+	size_t sectionPeakWalls[kSectionCount] = {};
+
+	// 範囲の外を調べるとその場で読み込むので、問い合わせは範囲内に収める
+	const int32_t kMaxLength = 32;
+	auto checkQueries = [&](int32_t centerX) {
+		std::uniform_int_distribution<int32_t> offsetX(-(kRadiusX - kMaxLength), kRadiusX - kMaxLength);
+		std::uniform_int_distribution<int32_t> offsetY(-kRadiusY, kRadiusY);
+		std::uniform_int_distribution<int32_t> length(0, kMaxLength);
+		Stopwatch stopwatch;
+		for (int32_t i = 0; i < queriesPerFrame; ++i) {
+			int32_t x = centerX + offsetX(random);
+			int32_t mapY = centerMapY + offsetY(random);
+			int32_t extent = length(random);
+
+			// 1マス・横・縦 (チャンクの境目とマップの外をまたぐ長さまで)
+			bool solid = map.IsSolid(x, mapY);
+			bool span = map.IsSpanSolid(mapY, x, x + extent);
+			bool column = map.IsColumnSolid(x, mapY - extent, mapY);
+			queryCount += 3;
+
+			bool expectedSpan = false;
+			for (int32_t sx = x; sx <= x + extent; ++sx) {
+				expectedSpan |= expectedTile(sx, mapY) == kTileWall;
+			}
+			bool expectedColumn = false;
+			for (int32_t sy = mapY - extent; sy <= mapY; ++sy) {
+				expectedColumn |= expectedTile(x, sy) == kTileWall;
+			}
+			bool expectedSolid = expectedTile(x, mapY) == kTileWall;
+			if (solid != expectedSolid || span != expectedSpan || column != expectedColumn || map.Get(x, mapY) != expectedTile(x, mapY)) {
+				++mismatchCount;
+			}
+		}
+		querySeconds += stopwatch.GetSeconds();
+	};
+
+	int32_t width = map.GetWidth();
+	int64_t frameCount = 0;
+	int64_t totalFrames = (width + step - 1) / step;
+	for (int32_t centerX = 0; centerX < width; centerX += step, ++frameCount) {
+		Stopwatch stopwatch;
+		map.Stream(centerX, centerMapY, kRadiusX, kRadiusY);
+		streamSamples.push_back(stopwatch.GetSeconds());
+		checkQueries(centerX);
+
+		// ときどきタイルを書き換え、戻りで残っているか確かめる
+		if (frameCount % 997 == 0) {
+			uint8_t type = map.Get(centerX, centerMapY) == kTileWall ? kTileEmpty : kTileWall;
+			map.Set(centerX, centerMapY, type);
+			edits[centerX + static_cast<int64_t>(centerMapY) * width] = type;
+		}
+		map.FlushChanges();
+
+		int section = static_cast<int>(frameCount * kSectionCount / totalFrames);
+		sectionPeakBytes[section] = std::max(sectionPeakBytes[section], map.GetStats().residentBytes);
+		sectionPeakWalls[section] = std::max(sectionPeakWalls[section], listener.GetWallCount());
+	}
+	ChunkStreamStats outbound = map.GetStats();
+	size_t peakWallCount = listener.GetPeakWallCount();
+
+	// 戻り: 書き換えたマスが残っているか、それ以外は読み込み元と同じか
+	uint64_t editMismatchCount = 0;
+	for (int32_t centerX = width - 1; centerX >= 0; centerX -= step * 8) {
+		map.Stream(centerX, centerMapY, kRadiusX, kRadiusY);
+	}
+	for (const auto& edit : edits) {
+		int32_t x = static_cast<int32_t>(edit.first % width);
+		int32_t mapY = static_cast<int32_t>(edit.first / width);
+		if (map.Get(x, mapY) != edit.second) {
+			++editMismatchCount;
+		}
+	}
+	// 書き換えていないマスも読み込み元と一致する (チャンクの境目の前後を見る)
+	std::uniform_int_distribution<int32_t> anyX(0, width - 1);
+	std::uniform_int_distribution<int32_t> anyY(0, map.GetHeight() - 1);
+	for (int i = 0; i < 4096; ++i) {
+		int32_t x = anyX(random) | (kChunkSize - 1);
+		int32_t mapY = anyY(random);
+		for (int32_t sx = x; sx <= x + 1; ++sx) {
+			if (map.Get(sx, mapY) != expectedTile(sx, mapY)) {
+				++editMismatchCount;
+			}
+		}
+	}
+
+	TimingSummary streamTiming = Summarize(streamSamples);
+	std::sort(streamSamples.begin(), streamSamples.end());
+	double streamP99 = streamSamples[streamSamples.size() * 99 / 100];
+	std::printf("%s (%dx%d tiles, %dx%d chunks, budget %zu KB, %lld frames of %d tiles)\n", name,
+		map.GetWidth(), map.GetHeight(), map.GetChunkCountX(), map.GetChunkCountY(), budget / 1024,
+		static_cast<long long>(frameCount), step);
+	std::printf("  stream      median %7.3f us  p99 %7.3f us  max %7.3f us\n",
+		streamTiming.median * 1e6, streamP99 * 1e6, streamSamples.back() * 1e6);
+	std::printf("  queries     %llu (%.2f M/s incl. reference checks), mismatches %llu\n",
+		static_cast<unsigned long long>(queryCount), static_cast<double>(queryCount) / querySeconds / 1e6,
+		static_cast<unsigned long long>(mismatchCount));
+	std::printf("  chunks      loaded %llu  evicted %llu  demand-loaded %llu  edited kept %zu\n",
+		static_cast<unsigned long long>(outbound.loadCount), static_cast<unsigned long long>(outbound.evictionCount),
+		static_cast<unsigned long long>(outbound.demandLoadCount), outbound.editedChunks);
+	std::printf("  resident    peak %zu bytes, %zu walls (whole map would be %lld bytes)\n",
+		outbound.peakResidentBytes, peakWallCount,
+		static_cast<long long>(map.GetWidth()) * map.GetHeight());
+	std::printf("  per tenth   ");
+	for (int i = 0; i < kSectionCount; ++i) {
+		std::printf(" %zu", sectionPeakBytes[i]);
+	}
+	std::printf(" bytes\n  walls       ");
+	for (int i = 0; i < kSectionCount; ++i) {
+		std::printf(" %zu", sectionPeakWalls[i]);
+	}
+	std::printf("\n  edits       %zu written, mismatches after revisit %llu\n", edits.size(),
+		static_cast<unsigned long long>(editMismatchCount));
+
+	// 範囲が予算に収まるなら、常駐量は予算を超えない
+	bool withinBudget = budget == 0 || outbound.peakResidentBytes <= budget;
+	if (!withinBudget) {
+		std::printf("  FAILED: resident bytes exceeded the budget\n");
+	}
+	return mismatchCount == 0 && editMismatchCount == 0 && withinBudget;
+}
+
+} // namespace
+
+int RunChunkStreamBenchmark(int argc, char* argv[]) {
+	int width = FindIntOption(argc, argv, "--width", 100000);
+	int height = FindIntOption(argc, argv, "--height", 48);
+	int step = FindIntOption(argc, argv, "--step", 2);
+	int queries = FindIntOption(argc, argv, "--queries", 16);
+	size_t budget = static_cast<size_t>(FindIntOption(argc, argv, "--budget-kb", 64)) * 1024;
+	std::string mapBinPath = FindOption(argc, argv, "--mapbin", "");
+
+	GeneratedChunkSource reference(width, height);
+	bool ok = Scroll("generated", std::make_unique<GeneratedChunkSource>(width, height), reference, budget, step, queries);
+
+	// 同じマップを .mapbin に書き出して、ファイルから少しずつ読む場合も流す
+	if (!mapBinPath.empty()) {
+		MapData map;
+		map.width = width;
+		map.height = height;
+		map.tiles.resize(static_cast<size_t>(width) * height);
+		for (int32_t y = 0; y < height; ++y) {
+			for (int32_t x = 0; x < width; ++x) {
+				map.tiles[static_cast<size_t>(y) * width + x] = reference.TileAt(x, y);
+			}
+		}
+		std::unique_ptr<MapBinChunkSource> source = std::make_unique<MapBinChunkSource>();
+		if (!WriteMapBin(mapBinPath, map) || !source->Open(mapBinPath)) {
+			std::printf("%s: cannot write or open\n", mapBinPath.c_str());
+			return 1;
+		}
+		ok = Scroll(mapBinPath.c_str(), std::move(source), reference, budget, step, queries) && ok;
+	}
+	return ok ? 0 : 1;
+}
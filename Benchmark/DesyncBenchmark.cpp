@@ -0,0 +1,171 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "ScriptedInput.h"
+#include "../GameSimulation.h"
+#include "../StateHash.h"
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 2つのシミュレーションを並べて回したときの最初のずれ
+struct Desync {
+	int64_t tick = -1; // ずれた最初のティック (ずれなければ -1)
+	StateDifference difference;
+};
+
+std::string DescribeDifference(const StateDifference& difference) {
+	if (difference.field == kStateFieldCount) {
+		return "none";
+	}
+	std::string text = GetStateFieldName(difference.field);
+	if (difference.index >= 0) {
+		text += "[" + std::to_string(difference.index) + "]";
+	}
+	return text;
+}
+
+// 同じボタン列で2つ回し、毎ティックの項目ごとのハッシュを比べる
+// tamperTick のティックだけ、右のほうのボタンを tamperMask で反転する (-1 なら同じ操作)
+Desync RunLockstep(const std::vector<uint8_t>& buttons, int64_t tamperTick, uint8_t tamperMask) {
+	Desync desync;
+	GameSimulation left;
+	GameSimulation right;
+	for (size_t tick = 0; tick < buttons.size(); ++tick) {
+		left.Step(buttons[tick]);
+		right.Step(static_cast<int64_t>(tick) == tamperTick ? static_cast<uint8_t>(buttons[tick] ^ tamperMask) : buttons[tick]);
+		if (left.ComputeStateHash() != right.ComputeStateHash()) {
+			desync.tick = static_cast<int64_t>(tick);
+			desync.difference = GameSimulation::FindStateDifference(left, right);
+			return desync;
+		}
+	}
+	return desync;
+}
+
+// 書き換えのハッシュを、読み込み直したマップとの差を全マス調べて作り直す (GameMap の更新と同じ値になるはず)
+uint64_t RecomputeGridEditHash(const GameMap& map, const std::string& path) {
+	GameMap original;
+	original.Load(path);
+	uint64_t hash = 0;
+	for (int mapY = 0; mapY < static_cast<int>(map.GetRowCount()); ++mapY) {
+		for (int x = 0; x < static_cast<int>(map.GetColCount()); ++x) {
+			int before = original.GetGridValue(x, mapY);
+			int after = map.GetGridValue(x, mapY);
+			if (before != after) {
+				hash ^= GameMap::HashGridCell(x, mapY, static_cast<uint8_t>(before)) ^ GameMap::HashGridCell(x, mapY, static_cast<uint8_t>(after));
+			}
+		}
+	}
+	return hash;
+}
+
+} // namespace
+
+int RunDesyncBenchmark(int argc, char* argv[]) {
+	const int ticks = FindIntOption(argc, argv, "--ticks", 36000);
+	const uint32_t seed = static_cast<uint32_t>(FindIntOption(argc, argv, "--seed", 1));
+	const int trials = FindIntOption(argc, argv, "--trials", 30);
+	const int gridCheckTicks = 500;
+
+	int failures = 0;
+
+	// ボットのボタン列を先に作っておく (同じ列を何度も流す)
+	std::vector<uint8_t> buttons(static_cast<size_t>(ticks));
+	{
+		ScriptedInput input(seed);
+		for (uint8_t& button : buttons) {
+			button = input.PollButtons();
+		}
+	}
+
+	// 1. 同じ操作で2回回してずれないか。あわせて項目ごとのハッシュの費用と、マスの書き換えのハッシュが全マスを調べた値と合うかを見る
+	{
+		GameSimulation simulation;
+		std::vector<double> digestSeconds;
+		digestSeconds.reserve(buttons.size());
+		int gridChecks = 0;
+		int gridMismatches = 0;
+		int64_t gridEdits = 0;
+		for (size_t tick = 0; tick < buttons.size(); ++tick) {
+			simulation.Step(buttons[tick]);
+			if (!simulation.GetLastError().empty()) {
+				std::printf("FAIL: %s (run from the game's directory)\n", simulation.GetLastError().c_str());
+				return 1;
+			}
+			Stopwatch stopwatch;
+			StateDigest digest = simulation.ComputeStateDigest();
+			digestSeconds.push_back(stopwatch.GetSeconds());
+			gridEdits += digest.fields[kStateFieldGridEdits] != 0 ? 1 : 0;
+			if (simulation.IsPlaying() && tick % gridCheckTicks == 0) {
+				++gridChecks;
+				if (RecomputeGridEditHash(simulation.GetMap(), simulation.GetMapFilePath()) != simulation.GetMap().GetGridEditHash()) {
+					++gridMismatches;
+				}
+			}
+		}
+		TimingSummary digestTiming = Summarize(digestSeconds);
+		Stopwatch fullGrid;
+		const int fullGridRepeats = 20;
+		for (int i = 0; i < fullGridRepeats; ++i) {
+			RecomputeGridEditHash(simulation.GetMap(), simulation.GetMapFilePath());
+		}
+		const double fullGridSeconds = fullGrid.GetSeconds() / fullGridRepeats;
+
+		Desync same = RunLockstep(buttons, -1, 0);
+		failures += same.tick < 0 ? 0 : 1;
+		failures += gridMismatches == 0 ? 0 : 1;
+		std::printf("lockstep %d ticks (seed %u): %s\n", ticks, seed,
+			same.tick < 0 ? "no desync" : ("FAIL desync at tick " + std::to_string(same.tick) + " in " + DescribeDifference(same.difference)).c_str());
+		std::printf("  state digest %.0f ns/tick median (%.0f ns mean), %d fields\n", digestTiming.median * 1e9, digestTiming.mean * 1e9,
+			static_cast<int>(kStateFieldCount));
+		std::printf("  grid edit hash: %lld ticks with edits, matches a full-grid recompute at %d / %d checks (full recompute %.1f us, incremental is O(1) per edit)\n",
+			static_cast<long long>(gridEdits), gridChecks - gridMismatches, gridChecks, fullGridSeconds * 1e6);
+	}
+
+	// 2. 右のほうだけ1ティックの操作を変え、ずれを見つけたティックと項目を出す
+	{
+		std::mt19937 random(seed + 1);
+		std::uniform_int_distribution<int> tickDistribution(0, ticks - 1);
+		std::uniform_int_distribution<int> buttonDistribution(1, 31);
+		int detected = 0;
+		int sameTick = 0;
+		int fieldCounts[kStateFieldCount] = {};
+		for (int trial = 0; trial < trials; ++trial) {
+			const int tick = tickDistribution(random);
+			const uint8_t mask = static_cast<uint8_t>(buttonDistribution(random));
+			Desync desync = RunLockstep(buttons, tick, mask);
+			if (desync.tick < 0) {
+				continue;
+			}
+			++detected;
+			++fieldCounts[desync.difference.field == kStateFieldCount ? 0 : desync.difference.field];
+			// ずれるのは操作を変えたティックより前ではありえない
+			if (desync.tick < tick || desync.difference.field == kStateFieldCount) {
+				++failures;
+				std::printf("  FAIL tampered tick %d: reported tick %lld field %s\n", tick, static_cast<long long>(desync.tick),
+					DescribeDifference(desync.difference).c_str());
+				continue;
+			}
+			sameTick += desync.tick == tick ? 1 : 0;
+			if (trial < 8) {
+				std::printf("  tampered tick %6d buttons ^%02x: desync at tick %6lld in %s\n", tick, mask, static_cast<long long>(desync.tick),
+					DescribeDifference(desync.difference).c_str());
+			}
+		}
+		std::printf("tamper %d random ticks: %d changed the state (%d at the tampered tick), %d had no effect\n", trials, detected, sameTick,
+			trials - detected);
+		std::printf("  first differing field:");
+		for (int field = 0; field < kStateFieldCount; ++field) {
+			if (fieldCounts[field] > 0) {
+				std::printf(" %s %d", GetStateFieldName(static_cast<StateField>(field)), fieldCounts[field]);
+			}
+		}
+		std::printf("\n");
+	}
+
+	std::printf("%s\n", failures == 0 ? "all checks passed" : "FAILED");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../InstanceBatch.h"
+#include "../MathUtil.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// InstanceBatch はメッシュを比べるだけなので、中身のないアドレスで足りる
+struct FakeMeshes {
+	char storage[3] = {};
+	const Mesh* Get(int index) const { return reinterpret_cast<const Mesh*>(&storage[index]); }
+};
+
+// 追加する1インスタンス
+struct Placement {
+	int mesh;
+	uint64_t textureHandle;
+	Transform transform;
+};
+
+// ゲームのフレームに近い並び: 壁・罠・弾・落下ブロックが混ざって追加される
+std::vector<Placement> MakeFrame(int32_t walls) {
+	std::vector<Placement> placements;
+	for (int32_t i = 0; i < walls; ++i) {
+		float x = static_cast<float>(i % 40) * 0.7f;
+		float y = static_cast<float>(i / 40) * 0.7f;
+		placements.push_back({ 0, 100, { { 0.7f, 0.7f, 0.7f }, { 0.0f, 0.0f, 0.0f }, { x, y, 0.0f } } });
+		if (i % 25 == 0) {
+			// 罠と弾は同じメッシュでもテクスチャが違うので別の描画になる
+			placements.push_back({ 1, 200, { { 0.7f, 0.7f, 0.7f }, { 0.0f, 0.0f, 0.0f }, { x, y + 3.0f, 0.0f } } });
+			placements.push_back({ 1, 300, { { 0.2f, 0.2f, 0.2f }, { 0.0f, 0.5f, 0.0f }, { x, y + 1.0f, 0.0f } } });
+		}
+		if (i % 10 == 0) {
+			placements.push_back({ 2, 400, { { 0.7f, 0.7f, 0.7f }, { 0.1f, 0.0f, 0.3f }, { x, y - 2.0f, 0.5f } } });
+		}
+	}
+	return placements;
+}
+
+bool SameMatrix(const Matrix4x4& a, const Matrix4x4& b) {
+	return std::memcmp(&a, &b, sizeof(Matrix4x4)) == 0;
+}
+
+// 1フレーム分を送り、描画命令と書き込んだ行列を確かめる (違っていたら失敗の数)
+int CheckFrame(InstanceBatch& batch, RecordingInstanceBackend& backend, const FakeMeshes& meshes,
+	const std::vector<Placement>& placements, const Matrix4x4& viewProjection) {
+	backend.Clear();
+	batch.Begin(viewProjection);
+	for (const Placement& placement : placements) {
+		batch.Add(meshes.Get(placement.mesh), placement.textureHandle, placement.transform);
+	}
+	uint32_t drawCount = batch.Submit(backend);
+
+	// 期待する結果: (メッシュ, テクスチャ) ごとに最初に出てきた順で1回ずつ、範囲は連続し、中は追加した順
+	struct ExpectedGroup {
+		int mesh;
+		uint64_t textureHandle;
+		std::vector<const Placement*> members;
+	};
+	std::vector<ExpectedGroup> groups;
+	for (const Placement& placement : placements) {
+		ExpectedGroup* group = nullptr;
+		for (ExpectedGroup& candidate : groups) {
+			if (candidate.mesh == placement.mesh && candidate.textureHandle == placement.textureHandle) {
+				group = &candidate;
+			}
+		}
+		if (!group) {
+			groups.push_back({ placement.mesh, placement.textureHandle, {} });
+			group = &groups.back();
+		}
+		group->members.push_back(&placement);
+	}
+
+	int failures = 0;
+	if (drawCount != groups.size() || backend.drawCommands.size() != groups.size()) {
+		std::printf("  FAIL: %u draws for %zu mesh/texture groups\n", drawCount, groups.size());
+		return 1;
+	}
+	if (backend.uploadedInstances.size() != placements.size()) {
+		std::printf("  FAIL: %zu instances uploaded, %zu added\n", backend.uploadedInstances.size(), placements.size());
+		return 1;
+	}
+	uint32_t firstInstance = 0;
+	for (size_t i = 0; i < groups.size(); ++i) {
+		const InstanceDrawCommand& command = backend.drawCommands[i];
+		const ExpectedGroup& group = groups[i];
+		if (command.mesh != meshes.Get(group.mesh) || command.textureHandle != group.textureHandle ||
+			command.firstInstance != firstInstance || command.instanceCount != group.members.size()) {
+			std::printf("  FAIL: draw %zu is instances %u+%u, expected %u+%zu\n", i, command.firstInstance, command.instanceCount,
+				firstInstance, group.members.size());
+			++failures;
+		}
+		for (size_t member = 0; member < group.members.size(); ++member) {
+			const Transform& transform = group.members[member]->transform;
+			Matrix4x4 world = MakeAffineMatrix(transform.scale, transform.rotate, transform.translate);
+			const InstancingData& packed = backend.uploadedInstances[firstInstance + member];
+			if (!SameMatrix(packed.World, world) || !SameMatrix(packed.WVP, Multiply(world, viewProjection))) {
+				++failures;
+			}
+		}
+		firstInstance += static_cast<uint32_t>(group.members.size());
+	}
+	return failures;
+}
+
+} // namespace
+
+int RunInstanceBatchBenchmark(int argc, char* argv[]) {
+	const int walls = FindIntOption(argc, argv, "--walls", 400);
+	const int frames = FindIntOption(argc, argv, "--frames", 2000);
+
+	FakeMeshes meshes;
+	InstanceBatch batch;
+	RecordingInstanceBackend backend;
+	Matrix4x4 viewProjection = Multiply(MakeAffineMatrix({ 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { -7.0f, -5.0f, 20.0f }),
+		MakePerspectiveFovMatrix(0.45f, 1280.0f / 720.0f, 0.1f, 100.0f));
+	int failures = 0;
+
+	// 1. 混ざった追加がメッシュ・テクスチャごとに1回の描画にまとまり、範囲と行列が合うか
+	std::vector<Placement> frame = MakeFrame(walls);
+	int frameFailures = CheckFrame(batch, backend, meshes, frame, viewProjection);
+	failures += frameFailures;
+	std::printf("frame of %zu instances: %zu draws, %s\n", frame.size(), backend.drawCommands.size(), frameFailures == 0 ? "ok" : "FAILED");
+
+	// 2. 次のフレームは前のフレームの内容を持ち越さない (グループの順も新しいフレームの順になる)
+	std::vector<Placement> smaller = MakeFrame(walls / 4);
+	std::swap(smaller.front(), smaller.back());
+	frameFailures = CheckFrame(batch, backend, meshes, smaller, viewProjection);
+	failures += frameFailures;
+	std::printf("next frame of %zu instances: %zu draws, %s\n", smaller.size(), backend.drawCommands.size(), frameFailures == 0 ? "ok" : "FAILED");
+
+	// 3. 空のフレームは何も送らない
+	backend.Clear();
+	batch.Begin(viewProjection);
+	uint32_t emptyDraws = batch.Submit(backend);
+	bool emptyOk = emptyDraws == 0 && backend.drawCommands.empty() && backend.uploadedInstances.empty();
+	failures += emptyOk ? 0 : 1;
+	std::printf("empty frame: %s\n", emptyOk ? "no upload, no draws" : "FAILED");
+
+	// 4. 書き込み先に入りきらなければ、そのフレームは描かない (一部だけ描いて範囲がずれることがない)
+	backend.Clear();
+	backend.maxInstances = static_cast<uint32_t>(frame.size() - 1);
+	batch.Begin(viewProjection);
+	for (const Placement& placement : frame) {
+		batch.Add(meshes.Get(placement.mesh), placement.textureHandle, placement.transform);
+	}
+	uint32_t overflowDraws = batch.Submit(backend);
+	bool overflowOk = overflowDraws == 0 && backend.drawCommands.empty();
+	backend.maxInstances = static_cast<uint32_t>(frame.size());
+	backend.Clear();
+	overflowOk = overflowOk && batch.Submit(backend) == backend.drawCommands.size() && !backend.drawCommands.empty();
+	backend.maxInstances = 0;
+	failures += overflowOk ? 0 : 1;
+	std::printf("overflow (capacity %zu): %s\n", frame.size() - 1, overflowOk ? "frame skipped, fits at full capacity" : "FAILED");
+
+	// 5. 1フレームをまとめる費用
+	Stopwatch stopwatch;
+	for (int i = 0; i < frames; ++i) {
+		backend.Clear();
+		batch.Begin(viewProjection);
+		for (const Placement& placement : frame) {
+			batch.Add(meshes.Get(placement.mesh), placement.textureHandle, placement.transform);
+		}
+		batch.Submit(backend);
+	}
+	double seconds = stopwatch.GetSeconds();
+	std::printf("batching: %.2f us/frame, %.1f ns/instance over %d frames\n", seconds * 1e6 / frames,
+		seconds * 1e9 / (static_cast<double>(frames) * frame.size()), frames);
+
+	std::printf("%s\n", failures == 0 ? "all checks passed" : "FAILED");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../MapFile.h"
+#include "../ObjLoader.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+
+// ゲームのマップ (作業ディレクトリはゲームと同じ場所を想定)
+const char* const kGameMaps[] = {
+	"Resources/map.csv",
+	"Resources/map2.csv",
+	"Resources/map3.csv",
+	"Resources/blocks.csv",
+};
+
+bool EndsWith(const std::string& text, const std::string& suffix) {
+	return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool SameMap(const MapData& a, const MapData& b) {
+	if (a.width != b.width || a.height != b.height || a.tiles != b.tiles || a.objects.size() != b.objects.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < a.objects.size(); ++i) {
+		if (a.objects[i].x != b.objects[i].x || a.objects[i].mapY != b.objects[i].mapY || a.objects[i].type != b.objects[i].type) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// 出力の拡張子で形式を選ぶ (.mapbin / .tsv / それ以外は CSV)
+bool Convert(const std::string& inputPath, const std::string& outputPath) {
+	MapData map;
+	std::string errorMessage;
+	if (!LoadMapFile(inputPath, map, &errorMessage)) {
+		std::printf("%-28s %s\n", inputPath.c_str(), errorMessage.c_str());
+		return false;
+	}
+
+	bool written = false;
+	if (EndsWith(outputPath, ".mapbin")) {
+		written = WriteMapBin(outputPath, map);
+	} else {
+		std::string text = WriteMapText(map, EndsWith(outputPath, ".tsv") ? '\t' : ',');
+		std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+		file.write(text.data(), static_cast<std::streamsize>(text.size()));
+		written = static_cast<bool>(file);
+	}
+	if (!written) {
+		std::printf("%-28s cannot write %s\n", inputPath.c_str(), outputPath.c_str());
+		return false;
+	}
+
+	// 書いたものを読み戻して同じか確かめる
+	MapData readBack;
+	bool same = LoadMapFile(outputPath, readBack) && SameMap(map, readBack);
+	std::printf("%-28s %4dx%-4d %3zu objects -> %s  %s\n", inputPath.c_str(), map.width, map.height, map.objects.size(),
+		outputPath.c_str(), same ? "ok" : "MISMATCH");
+	return same;
+}
+
+} // namespace
+
+int RunMapConvertCommand(int argc, char* argv[]) {
+	if (argc == 0) {
+		// ゲームのマップを全部 .mapbin にする
+		bool succeeded = true;
+		for (const char* path : kGameMaps) {
+			std::string inputPath = path;
+			succeeded &= Convert(inputPath, inputPath.substr(0, inputPath.find_last_of('.')) + ".mapbin");
+		}
+		return succeeded ? 0 : 1;
+	}
+	if (argc != 2) {
+		std::printf("usage: Benchmark convertmap [<input> <output>]\n");
+		return 1;
+	}
+	return Convert(argv[0], argv[1]) ? 0 : 1;
+}
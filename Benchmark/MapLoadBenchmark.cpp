@@ -0,0 +1,116 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../MapFile.h"
+#include "../ObjLoader.h"
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 置き換え前の MapChip::Load と同じ読み方 (比較用。ファイルの代わりに文字列から読む)
+std::vector<std::vector<int>> LegacyParseCsv(const std::string& text) {
+	std::vector<std::vector<int>> data;
+	std::istringstream file(text);
+	std::string line;
+	while (std::getline(file, line)) {
+		std::vector<int> row;
+		std::string cell;
+		std::stringstream ss(line);
+		while (std::getline(ss, cell, ',')) {
+			row.push_back(std::stoi(cell));
+		}
+		data.push_back(row);
+	}
+	return data;
+}
+
+// 外周が壁で、中に壁と罠を散らした CSV
+std::string GenerateCsv(int32_t width, int32_t height) {
+	std::mt19937 random(24680);
+	std::uniform_int_distribution<int32_t> distribution(0, 99);
+	MapData map;
+	map.width = width;
+	map.height = height;
+	map.tiles.resize(static_cast<size_t>(width) * height);
+	for (int32_t y = 0; y < height; ++y) {
+		for (int32_t x = 0; x < width; ++x) {
+			int32_t roll = distribution(random);
+			bool border = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+			if (!border && roll == 0) {
+				map.objects.push_back({ x, y, 3 });
+			}
+			map.tiles[static_cast<size_t>(y) * width + x] = (border || roll < 20) ? kTileWall : kTileEmpty;
+		}
+	}
+	return WriteMapText(map);
+}
+
+void Run(const std::string& name, const std::string& text, int iterations) {
+	MapData map;
+	std::string errorMessage;
+	if (!ParseMapText(text, map, &errorMessage)) {
+		std::printf("%s: %s\n", name.c_str(), errorMessage.c_str());
+		return;
+	}
+	// .mapbin はファイルを介さずにメモリ上で読む (解析の時間だけを比べる)
+	std::string binary = SerializeMapBin(map);
+
+	std::vector<double> legacySamples;
+	std::vector<double> textSamples;
+	std::vector<double> binarySamples;
+	bool comma = text.find(',') != std::string::npos;
+	for (int i = 0; i < iterations; ++i) {
+		Stopwatch stopwatch;
+		if (comma) {
+			std::vector<std::vector<int>> legacy = LegacyParseCsv(text);
+			legacySamples.push_back(stopwatch.GetSeconds());
+		}
+
+		stopwatch.Restart();
+		MapData parsed;
+		ParseMapText(text, parsed);
+		textSamples.push_back(stopwatch.GetSeconds());
+
+		stopwatch.Restart();
+		MapData loaded;
+		ParseMapBin(binary, loaded);
+		binarySamples.push_back(stopwatch.GetSeconds());
+	}
+
+	double megabytes = static_cast<double>(text.size()) / (1024.0 * 1024.0);
+	TimingSummary textTiming = Summarize(textSamples);
+	TimingSummary binaryTiming = Summarize(binarySamples);
+	std::printf("%s (%dx%d, %.2f MB text, %.2f MB mapbin)\n", name.c_str(), map.width, map.height, megabytes,
+		static_cast<double>(binary.size()) / (1024.0 * 1024.0));
+	if (comma) {
+		TimingSummary legacy = Summarize(legacySamples);
+		std::printf("  legacy getline/stoi %9.3f ms  %8.2f MB/s\n", legacy.median * 1000.0, megabytes / legacy.median);
+	} else {
+		std::printf("  legacy getline/stoi  (cannot read tab-separated files)\n");
+	}
+	std::printf("  ParseMapText        %9.3f ms  %8.2f MB/s\n", textTiming.median * 1000.0, megabytes / textTiming.median);
+	std::printf("  ParseMapBin         %9.3f ms\n", binaryTiming.median * 1000.0);
+}
+
+} // namespace
+
+int RunMapLoadBenchmark(int argc, char* argv[]) {
+	int iterations = FindIntOption(argc, argv, "--iterations", 10);
+	int width = FindIntOption(argc, argv, "--width", 4096);
+	int height = FindIntOption(argc, argv, "--height", 1024);
+
+	const char* const kMaps[] = { "Resources/map.csv", "Resources/blocks.csv" };
+	for (const char* path : kMaps) {
+		std::string text;
+		if (ReadFileToString(path, text)) {
+			Run(path, text, iterations);
+		} else {
+			std::printf("%s: missing\n", path);
+		}
+	}
+	Run("generated", GenerateCsv(width, height), iterations);
+	return 0;
+}
@@ -0,0 +1,101 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../MeshCache.h"
+#include "../ObjLoader.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+// ゲームが読み込むモデル (作業ディレクトリはゲームと同じ場所を想定)
+const char* const kGameMeshes[][2] = {
+	{ "Resources", "flag.obj" },
+	{ "Resources/Clear", "Clear.obj" },
+	{ "Resources/GameOver", "GameOver.obj" },
+	{ "Resources/Title", "Title.obj" },
+	{ "Resources/Trap", "Trap.obj" },
+	{ "Resources/block", "block.obj" },
+	{ "Resources/cube", "cube.obj" },
+	{ "Resources/player", "player.obj" },
+	{ "Resources/skydome", "skydome.obj" },
+};
+
+// 1つ焼いて、OBJ解析と .meshbin 読み込みの時間を比べる
+bool BakeOne(const std::string& directoryPath, const std::string& filename) {
+	std::string objText;
+	if (!ReadFileToString(directoryPath + "/" + filename, objText)) {
+		std::printf("%-40s missing\n", (directoryPath + "/" + filename).c_str());
+		return false;
+	}
+	std::string mtlText;
+	MeshSource source;
+	source.materialLibrary = FindMaterialLibrary(objText);
+	std::string mtlPath = source.materialLibrary.empty() ? std::string() : directoryPath + "/" + source.materialLibrary;
+	if (!mtlPath.empty()) {
+		ReadFileToString(mtlPath, mtlText);
+	}
+	source.hash = HashMeshSource(objText, mtlText);
+	GetMeshSourceStamp(directoryPath + "/" + filename, mtlPath, source.stamp);
+
+	Stopwatch stopwatch;
+	ModelData modelData;
+	if (!ParseObj(objText, modelData)) {
+		std::printf("%-40s parse error\n", filename.c_str());
+		return false;
+	}
+	if (!mtlText.empty()) {
+		modelData.material = ParseMaterialTemplate(mtlText, directoryPath);
+	}
+	IndexedModelData meshData;
+	WeldStats weldStats;
+	VertexCacheStats before;
+	VertexCacheStats after;
+	BakeMesh(modelData, MeshBakeOptions(), meshData, &weldStats, &before, &after);
+	double parseSeconds = stopwatch.GetSeconds();
+
+	std::string cachePath = GetMeshBinPath(directoryPath, filename);
+	if (!WriteMeshBin(cachePath, meshData, source, modelData.vertices.size(), kMeshBinFlagVertexCacheOptimized)) {
+		std::printf("%-40s cannot write %s\n", filename.c_str(), cachePath.c_str());
+		return false;
+	}
+
+	stopwatch.Restart();
+	IndexedModelData cached;
+	MeshBinHeader header;
+	bool readBack = ReadMeshBin(cachePath, cached, header) && header.sourceHash == source.hash;
+	double readSeconds = stopwatch.GetSeconds();
+
+	// 焼いた直後は元ファイルが変わっていないので、ゲームの読み込みは元ファイルを読まずにキャッシュを使うはず
+	stopwatch.Restart();
+	MeshLoadResult loadResult = LoadMeshWithCache(directoryPath, filename, cached);
+	double loadSeconds = stopwatch.GetSeconds();
+	bool stampHit = loadResult.fromCache && !loadResult.sourceRead;
+
+	std::printf("%-40s %7zu -> %6zu verts  ACMR %.3f -> %.3f  bake %8.3f ms  meshbin %8.3f ms  cached load %8.3f ms  %s\n",
+		(directoryPath + "/" + filename).c_str(), weldStats.sourceVertexCount, weldStats.weldedVertexCount,
+		before.acmr, after.acmr, parseSeconds * 1000.0, readSeconds * 1000.0, loadSeconds * 1000.0,
+		!readBack ? "READ FAILED" : (stampHit ? "ok" : "SOURCE REREAD"));
+	return readBack && stampHit;
+}
+
+} // namespace
+
+int RunMeshBakeCommand(int argc, char* argv[]) {
+	bool succeeded = true;
+	if (argc == 0) {
+		for (const auto& mesh : kGameMeshes) {
+			succeeded &= BakeOne(mesh[0], mesh[1]);
+		}
+	} else {
+		// 引数は "ディレクトリ/ファイル.obj"
+		for (int i = 0; i < argc; ++i) {
+			std::string path = argv[i];
+			size_t slash = path.find_last_of("/\\");
+			std::string directoryPath = (slash == std::string::npos) ? "." : path.substr(0, slash);
+			std::string filename = (slash == std::string::npos) ? path : path.substr(slash + 1);
+			succeeded &= BakeOne(directoryPath, filename);
+		}
+	}
+	return succeeded ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../ObjLoader.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// 置き換え前の LoadOjFile と同じ解析 (比較用。ファイルの代わりに文字列から読む)
+ModelData LegacyParseObj(const std::string& text) {
+	ModelData modelData;
+	std::vector<Vector4> positions;
+	std::vector<Vector3> normals;
+	std::vector<Vector2> texcoords;
+	std::string line;
+	std::istringstream file(text);
+
+	while (std::getline(file, line)) {
+		std::string identifiler;
+		std::istringstream s(line);
+		s >> identifiler;
+		if (identifiler == "v") {
+			Vector4 position;
+			s >> position.x >> position.y >> position.z;
+			position.x *= -1.0f;
+			position.w = 1.0f;
+			positions.push_back(position);
+		} else if (identifiler == "vt") {
+			Vector2 texcoord;
+			s >> texcoord.x >> texcoord.y;
+			texcoord.y = 1.0f - texcoord.y;
+			texcoords.push_back(texcoord);
+		} else if (identifiler == "vn") {
+			Vector3 normal;
+			s >> normal.x >> normal.y >> normal.z;
+			normal.x *= -1.0f;
+			normals.push_back(normal);
+		} else if (identifiler == "f") {
+			VertexData triangle[3];
+			for (int32_t faceVertex = 0; faceVertex < 3; ++faceVertex) {
+				std::string vertexDefinition;
+				s >> vertexDefinition;
+				std::istringstream v(vertexDefinition);
+				uint32_t elementIndices[3];
+				for (int32_t element = 0; element < 3; ++element) {
+					std::string index;
+					std::getline(v, index, '/');
+					elementIndices[element] = std::stoi(index);
+				}
+				Vector4 position = positions[elementIndices[0] - 1];
+				Vector2 texcoord = texcoords[elementIndices[1] - 1];
+				Vector3 normal = normals[elementIndices[2] - 1];
+				triangle[faceVertex] = { position, texcoord, normal };
+			}
+			modelData.vertices.push_back(triangle[2]);
+			modelData.vertices.push_back(triangle[1]);
+			modelData.vertices.push_back(triangle[0]);
+		}
+	}
+	return modelData;
+}
+
+// 旧ローダーでも読める三角形だけの球を作る (v/vt/vn 形式)
+std::string GenerateSphereObj(int32_t segments) {
+	const float kPi = 3.14159265f;
+	std::string text;
+	char line[128];
+	text += "# generated sphere\n";
+	for (int32_t lat = 0; lat <= segments; ++lat) {
+		float theta = kPi * static_cast<float>(lat) / static_cast<float>(segments);
+		for (int32_t lon = 0; lon <= segments; ++lon) {
+			float phi = 2.0f * kPi * static_cast<float>(lon) / static_cast<float>(segments);
+			float x = std::sin(theta) * std::cos(phi);
+			float y = std::cos(theta);
+			float z = std::sin(theta) * std::sin(phi);
+			std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", x, y, z);
+			text += line;
+			std::snprintf(line, sizeof(line), "vt %.6f %.6f\n",
+				static_cast<float>(lon) / static_cast<float>(segments), static_cast<float>(lat) / static_cast<float>(segments));
+			text += line;
+			std::snprintf(line, sizeof(line), "vn %.6f %.6f %.6f\n", x, y, z);
+			text += line;
+		}
+	}
+	int32_t stride = segments + 1;
+	for (int32_t lat = 0; lat < segments; ++lat) {
+		for (int32_t lon = 0; lon < segments; ++lon) {
+			int32_t a = lat * stride + lon + 1;
+			int32_t b = a + stride;
+			std::snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, a + 1, a + 1, a + 1);
+			text += line;
+			std::snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d\n", a + 1, a + 1, a + 1, b, b, b, b + 1, b + 1, b + 1);
+			text += line;
+		}
+	}
+	return text;
+}
+
+bool SameVertices(const ModelData& a, const ModelData& b) {
+	return a.vertices.size() == b.vertices.size() &&
+		std::memcmp(a.vertices.data(), b.vertices.data(), sizeof(VertexData) * a.vertices.size()) == 0;
+}
+
+} // namespace
+
+int RunObjBenchmark(int argc, char* argv[]) {
+	std::string path = FindOption(argc, argv, "--file", "");
+	int iterations = FindIntOption(argc, argv, "--iterations", 10);
+	int segments = FindIntOption(argc, argv, "--segments", 256);
+
+	std::string text;
+	if (path.empty()) {
+		text = GenerateSphereObj(segments);
+		path = "(generated sphere, " + std::to_string(segments) + " segments)";
+	} else if (!ReadFileToString(path, text)) {
+		std::printf("cannot open %s\n", path.c_str());
+		return 1;
+	}
+	double megabytes = static_cast<double>(text.size()) / (1024.0 * 1024.0);
+
+	std::vector<double> legacySamples;
+	std::vector<double> fastSamples;
+	ModelData legacyResult;
+	ModelData fastResult;
+	ObjParseStats stats;
+	for (int i = 0; i < iterations; ++i) {
+		Stopwatch stopwatch;
+		legacyResult = LegacyParseObj(text);
+		legacySamples.push_back(stopwatch.GetSeconds());
+
+		fastResult = ModelData();
+		stopwatch.Restart();
+		if (!ParseObj(text, fastResult, nullptr, &stats)) {
+			std::printf("ParseObj failed\n");
+			return 1;
+		}
+		fastSamples.push_back(stopwatch.GetSeconds());
+	}
+
+	TimingSummary legacy = Summarize(legacySamples);
+	TimingSummary fast = Summarize(fastSamples);
+	std::printf("input      : %s\n", path.c_str());
+	std::printf("size       : %.2f MB, %zu positions, %zu faces, %zu triangles\n",
+		megabytes, stats.positionCount, stats.faceCount, stats.triangleCount);
+	std::printf("legacy     : %8.2f MB/s (median %.3f ms)\n", megabytes / legacy.median, legacy.median * 1000.0);
+	std::printf("ObjLoader  : %8.2f MB/s (median %.3f ms)\n", megabytes / fast.median, fast.median * 1000.0);
+	std::printf("speedup    : %.2fx\n", legacy.median / fast.median);
+	// 旧パーサと頂点が一致しなければ失敗として終える
+	bool identical = SameVertices(legacyResult, fastResult);
+	std::printf("identical  : %s\n", identical ? "yes" : "NO");
+	return identical ? 0 : 1;
+}
@@ -0,0 +1,264 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../GameMap.h"
+#include "../ObjectGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int32_t kCellTiles = 4;
+// 動的ブロックの種類 (3..10) と罠 (11)
+const int32_t kFirstType = 3;
+const int32_t kLastType = 11;
+
+// 旧 MapChip と同じく、全部を並べた配列を毎回なめる
+struct LinearObject {
+	Vector2 position;
+	int32_t type;
+};
+
+void ResetGrid(ObjectGrid& grid, int32_t widthTiles, int32_t heightTiles) {
+	grid.Reset(kCellTiles * GameMap::kBlockSize, (widthTiles + kCellTiles - 1) / kCellTiles, (heightTiles + kCellTiles - 1) / kCellTiles);
+}
+
+// 総当たりの答え (番号順)
+std::vector<int32_t> ReferenceRadius(const ObjectGrid& grid, const Vector2& center, float radius, uint32_t typeMask, int32_t idCount) {
+	std::vector<int32_t> ids;
+	for (int32_t id = 0; id < idCount; ++id) {
+		if (!grid.IsAlive(id)) {
+			continue;
+		}
+		const Vector2& p = grid.GetPosition(id);
+		float dx = p.x - center.x;
+		float dy = p.y - center.y;
+		if ((typeMask & ObjectGrid::GetTypeBit(grid.GetType(id))) != 0 && dx * dx + dy * dy <= radius * radius) {
+			ids.push_back(id);
+		}
+	}
+	return ids;
+}
+
+std::vector<int32_t> ReferenceRect(const ObjectGrid& grid, const WorldRect& rect, uint32_t typeMask, int32_t idCount) {
+	std::vector<int32_t> ids;
+	for (int32_t id = 0; id < idCount; ++id) {
+		if (!grid.IsAlive(id)) {
+			continue;
+		}
+		const Vector2& p = grid.GetPosition(id);
+		if ((typeMask & ObjectGrid::GetTypeBit(grid.GetType(id))) != 0 && p.x >= rect.left && p.x <= rect.right && p.y >= rect.bottom &&
+			p.y <= rect.top) {
+			ids.push_back(id);
+		}
+	}
+	return ids;
+}
+
+// 動かし・足し・消しを繰り返しながら、問い合わせを総当たりと比べる
+int CheckIncremental(int32_t widthTiles, int32_t heightTiles, int32_t count, int frames) {
+	std::mt19937 random(5);
+	const float worldWidth = widthTiles * GameMap::kBlockSize;
+	const float worldHeight = heightTiles * GameMap::kBlockSize;
+	// マップの外 (左右・上下に数マス) にも出す
+	std::uniform_real_distribution<float> px(-4.0f * GameMap::kBlockSize, worldWidth + 4.0f * GameMap::kBlockSize);
+	std::uniform_real_distribution<float> py(-4.0f * GameMap::kBlockSize, worldHeight + 4.0f * GameMap::kBlockSize);
+	std::uniform_real_distribution<float> step(-0.3f, 0.3f);
+	std::uniform_int_distribution<int32_t> type(kFirstType, kLastType);
+	std::uniform_int_distribution<int> percent(0, 99);
+	std::uniform_real_distribution<float> radius(0.0f, 12.0f * GameMap::kBlockSize);
+
+	ObjectGrid grid;
+	ResetGrid(grid, widthTiles, heightTiles);
+	int32_t idCount = 0;
+	for (int32_t i = 0; i < count; ++i) {
+		grid.Add(type(random), { px(random), py(random) });
+		++idCount;
+	}
+
+	int failures = 0;
+	std::vector<int32_t> found;
+	for (int frame = 0; frame < frames; ++frame) {
+		for (int32_t id = 0; id < idCount; ++id) {
+			if (!grid.IsAlive(id)) {
+				continue;
+			}
+			int roll = percent(random);
+			if (roll < 1) {
+				grid.Remove(id);
+			} else if (roll < 3) {
+				grid.Move(id, { px(random), py(random) }); // 遠くへ飛ぶ
+			} else if (roll < 50) {
+				const Vector2& p = grid.GetPosition(id);
+				grid.Move(id, { p.x + step(random), p.y + step(random) });
+			}
+		}
+		// 消えた分を足す
+		while (grid.GetCount() < static_cast<size_t>(count)) {
+			grid.Add(type(random), { px(random), py(random) });
+			++idCount;
+		}
+
+		for (int q = 0; q < 50; ++q) {
+			Vector2 center = { px(random), py(random) };
+			// 格子の境目ちょうどの点も混ぜる
+			if (q % 5 == 0) {
+				center = { std::floor(center.x / GameMap::kBlockSize) * GameMap::kBlockSize, std::floor(center.y / GameMap::kBlockSize) * GameMap::kBlockSize };
+			}
+			float r = radius(random);
+			uint32_t mask = q % 3 == 0 ? ObjectGrid::kAllTypes : static_cast<uint32_t>(random());
+			found.clear();
+			grid.FindInRadius(center, r, mask, found);
+			std::sort(found.begin(), found.end());
+			bool ok = found == ReferenceRadius(grid, center, r, mask, idCount);
+
+			WorldRect rect = { center.x - r, center.y - r * 0.5f, center.x + r * 2.0f, center.y + r };
+			found.clear();
+			grid.FindInRect(rect, mask, found);
+			std::sort(found.begin(), found.end());
+			ok = ok && found == ReferenceRect(grid, rect, mask, idCount);
+			if (!ok) {
+				if (failures < 5) {
+					std::printf("  mismatch: frame %d center (%.5f %.5f) radius %.5f mask %08x\n", frame, center.x, center.y, r, mask);
+				}
+				++failures;
+			}
+		}
+		// 種類ごとの最初 = まだいる中で一番小さい番号
+		for (int32_t t = 0; t < ObjectGrid::kMaxTypes; ++t) {
+			int32_t expected = -1;
+			for (int32_t id = 0; id < idCount && expected < 0; ++id) {
+				if (grid.IsAlive(id) && grid.GetType(id) == t) {
+					expected = id;
+				}
+			}
+			if (grid.FindFirst(t) != expected) {
+				if (failures < 5) {
+					std::printf("  mismatch: frame %d FindFirst(%d) %d expected %d\n", frame, t, grid.FindFirst(t), expected);
+				}
+				++failures;
+			}
+		}
+	}
+	return failures;
+}
+
+// 罠やブロックの密度を変えずにマップを伸ばしたとき (長いステージほど数が多い)、近くを探す費用が一定かを見る
+void MeasureScaling(int32_t count, int32_t heightTiles, float radiusTiles, int queries) {
+	// 64 タイルあたり1つ
+	int32_t widthTiles = std::max(64, static_cast<int32_t>(static_cast<int64_t>(count) * 64 / heightTiles));
+	std::mt19937 random(17);
+	std::uniform_real_distribution<float> px(0.0f, widthTiles * GameMap::kBlockSize);
+	std::uniform_real_distribution<float> py(0.0f, heightTiles * GameMap::kBlockSize);
+	std::uniform_int_distribution<int32_t> type(kFirstType, kLastType);
+
+	ObjectGrid grid;
+	ResetGrid(grid, widthTiles, heightTiles);
+	std::vector<LinearObject> linear;
+	for (int32_t i = 0; i < count; ++i) {
+		LinearObject object = { { px(random), py(random) }, type(random) };
+		grid.Add(object.type, object.position);
+		linear.push_back(object);
+	}
+	std::vector<Vector2> centers;
+	for (int q = 0; q < queries; ++q) {
+		centers.push_back({ px(random), py(random) });
+	}
+	const float radius = radiusTiles * GameMap::kBlockSize;
+	const uint32_t mask = ObjectGrid::kAllTypes;
+
+	// 近くのもの (索引)
+	std::vector<int32_t> found;
+	size_t foundCount = 0;
+	Stopwatch stopwatch;
+	for (const Vector2& center : centers) {
+		found.clear();
+		foundCount += grid.FindInRadius(center, radius, mask, found);
+	}
+	double indexed = stopwatch.GetSeconds();
+
+	// 近くのもの (全部なめる)
+	size_t linearCount = 0;
+	stopwatch.Restart();
+	for (const Vector2& center : centers) {
+		found.clear();
+		for (int32_t id = 0; id < count; ++id) {
+			float dx = linear[id].position.x - center.x;
+			float dy = linear[id].position.y - center.y;
+			if ((mask & ObjectGrid::GetTypeBit(linear[id].type)) != 0 && dx * dx + dy * dy <= radius * radius) {
+				found.push_back(id);
+				++linearCount;
+			}
+		}
+	}
+	double scanned = stopwatch.GetSeconds();
+
+	// 種類の最初 (旧 FindBlock と同じく先頭からなめる。最後に足した種類を探すので一番遠い)
+	const int32_t lastType = kLastType + 1 < ObjectGrid::kMaxTypes ? kLastType + 1 : kLastType;
+	grid.Add(lastType, { 0.0f, 0.0f });
+	linear.push_back({ { 0.0f, 0.0f }, lastType });
+	const int kFindRepeat = 1000;
+	int32_t first = 0;
+	stopwatch.Restart();
+	for (int i = 0; i < kFindRepeat; ++i) {
+		first += grid.FindFirst(lastType);
+	}
+	double findIndexed = stopwatch.GetSeconds();
+	int32_t linearFirst = 0;
+	stopwatch.Restart();
+	for (int i = 0; i < kFindRepeat; ++i) {
+		for (size_t k = 0; k < linear.size(); ++k) {
+			if (linear[k].type == lastType) {
+				linearFirst += static_cast<int32_t>(k);
+				break;
+			}
+		}
+	}
+	double findScanned = stopwatch.GetSeconds();
+
+	// 全部を少しずつ動かす (1フレーム分)
+	std::uniform_real_distribution<float> step(-0.2f, 0.2f);
+	std::vector<Vector2> steps;
+	for (int32_t id = 0; id < count; ++id) {
+		steps.push_back({ step(random), step(random) });
+	}
+	const int kMoveFrames = 20;
+	stopwatch.Restart();
+	for (int frame = 0; frame < kMoveFrames; ++frame) {
+		for (int32_t id = 0; id < count; ++id) {
+			const Vector2& p = grid.GetPosition(id);
+			grid.Move(id, { p.x + steps[id].x, p.y + steps[id].y });
+		}
+	}
+	double move = stopwatch.GetSeconds();
+
+	auto perQuery = [&](double seconds, size_t n) { return seconds / static_cast<double>(n) * 1e9; };
+	std::printf("%7d objects %7dx%d tiles  radius query %7.1f ns (scan %9.1f ns)  found %.2f/query%s  first of type %6.1f ns (scan %9.1f ns)%s"
+		"  move %5.1f ns\n",
+		count, widthTiles, heightTiles, perQuery(indexed, centers.size()), perQuery(scanned, centers.size()),
+		static_cast<double>(foundCount) / static_cast<double>(centers.size()), foundCount == linearCount ? "" : " (MISMATCH)",
+		perQuery(findIndexed, kFindRepeat), perQuery(findScanned, kFindRepeat), first == linearFirst ? "" : " (MISMATCH)",
+		perQuery(move, static_cast<size_t>(count) * kMoveFrames));
+}
+
+} // namespace
+
+int RunObjectGridBenchmark(int argc, char* argv[]) {
+	int count = FindIntOption(argc, argv, "--objects", 5000);
+	int frames = FindIntOption(argc, argv, "--frames", 100);
+	int queries = FindIntOption(argc, argv, "--queries", 100000);
+	int radius = FindIntOption(argc, argv, "--radius", 6);
+
+	// 1. 動かしながらの答え合わせ
+	int failures = CheckIncremental(1024, 64, count, frames);
+	std::printf("%d objects, %d frames of moves/adds/removes vs brute force: failures %d\n", count, frames, failures);
+
+	// 2. 数を増やしても、近くを探す費用が変わらないか
+	for (int32_t n : { 100, 1000, 10000, 100000 }) {
+		MeasureScaling(n, 64, static_cast<float>(radius), queries);
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,306 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../ChunkedTileMap.h"
+#include "../GameMap.h"
+#include "../MapFile.h"
+#include "../TileRaycast.h"
+#include "../TileSweep.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 広い空間に足場が点々とあるマップ (横に並んだ壁の列を、マップの 0.5% ほど置く)
+MapData GeneratePlatformMap(int32_t width, int32_t height, uint32_t seed) {
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int32_t> px(0, width - 1);
+	std::uniform_int_distribution<int32_t> py(0, height - 1);
+	std::uniform_int_distribution<int32_t> length(6, 24);
+	MapData map;
+	map.width = width;
+	map.height = height;
+	map.tiles.assign(static_cast<size_t>(width) * height, kTileEmpty);
+	size_t platformCount = static_cast<size_t>(width) * height / 3000;
+	for (size_t i = 0; i < platformCount; ++i) {
+		int32_t x0 = px(random);
+		int32_t mapY = py(random);
+		int32_t x1 = std::min(x0 + length(random), width - 1);
+		for (int32_t x = x0; x <= x1; ++x) {
+			map.tiles[static_cast<size_t>(mapY) * width + x] = kTileWall;
+		}
+	}
+	return map;
+}
+
+// 階層を使わない光線 (TileRaycast に階層を入れる前と同じ、1マスずつ進む DDA)
+TileRayHit FlatRaycast(const ChunkedTileMap& tiles, const Vector2& origin, const Vector2& direction, float maxDistance) {
+	TileRayHit result;
+	result.distance = maxDistance;
+	const float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	const float dirX = direction.x / length;
+	const float dirY = direction.y / length;
+	const float kInfinity = std::numeric_limits<float>::infinity();
+	const double u = static_cast<double>(origin.x) / GameMap::kBlockSize;
+	const double v = static_cast<double>(origin.y) / GameMap::kBlockSize;
+	const float maxTiles = maxDistance / GameMap::kBlockSize;
+	const int32_t width = tiles.GetWidth();
+	const int32_t lastMapY = tiles.GetHeight() - 1;
+	int32_t column = static_cast<int32_t>(std::floor(u));
+	int32_t row = static_cast<int32_t>(std::floor(v));
+	const int32_t stepX = dirX > 0.0f ? 1 : (dirX < 0.0f ? -1 : 0);
+	const int32_t stepY = dirY > 0.0f ? 1 : (dirY < 0.0f ? -1 : 0);
+	float nextX = stepX != 0 ? static_cast<float>((column + (stepX > 0 ? 1 : 0) - u) / dirX) : kInfinity;
+	float nextY = stepY != 0 ? static_cast<float>((row + (stepY > 0 ? 1 : 0) - v) / dirY) : kInfinity;
+	const float deltaX = stepX != 0 ? 1.0f / std::abs(dirX) : kInfinity;
+	const float deltaY = stepY != 0 ? 1.0f / std::abs(dirY) : kInfinity;
+	while (true) {
+		float distance;
+		if (nextX < nextY) {
+			distance = nextX;
+			column += stepX;
+			nextX += deltaX;
+		} else {
+			distance = nextY;
+			row += stepY;
+			nextY += deltaY;
+		}
+		if (distance > maxTiles) {
+			break;
+		}
+		if ((column < 0 && stepX <= 0) || (column >= width && stepX >= 0) || (row < 0 && stepY <= 0) || (row > lastMapY && stepY >= 0)) {
+			break;
+		}
+		if (tiles.IsSolid(column, lastMapY - row)) {
+			result.hit = true;
+			result.distance = distance * GameMap::kBlockSize;
+			result.tileX = column;
+			result.tileMapY = lastMapY - row;
+			return result;
+		}
+	}
+	return result;
+}
+
+// 光線がタイルの中を通る長さ (ワールド単位。かすめるだけなら 0 に近い)
+float GetPassLength(const ChunkedTileMap& tiles, const Vector2& origin, const Vector2& direction, int32_t tileX, int32_t tileMapY) {
+	double length = std::sqrt(static_cast<double>(direction.x) * direction.x + static_cast<double>(direction.y) * direction.y);
+	const double low[2] = { tileX * static_cast<double>(GameMap::kBlockSize), (tiles.GetHeight() - 1 - tileMapY) * static_cast<double>(GameMap::kBlockSize) };
+	const double start[2] = { origin.x, origin.y };
+	const double dir[2] = { direction.x / length, direction.y / length };
+	double enter = -1e30;
+	double exit = 1e30;
+	for (int axis = 0; axis < 2; ++axis) {
+		if (dir[axis] == 0.0) {
+			continue;
+		}
+		double t0 = (low[axis] - start[axis]) / dir[axis];
+		double t1 = (low[axis] + GameMap::kBlockSize - start[axis]) / dir[axis];
+		enter = std::max(enter, std::min(t0, t1));
+		exit = std::min(exit, std::max(t0, t1));
+	}
+	return static_cast<float>(std::max(exit - enter, 0.0));
+}
+
+// 1マスずつ下を見る床までの距離
+float FlatGroundDistance(const ChunkedTileMap& tiles, const Vector2& point, float maxDistance) {
+	int32_t column = static_cast<int32_t>(std::floor(point.x / GameMap::kBlockSize));
+	for (int32_t row = static_cast<int32_t>(std::floor(point.y / GameMap::kBlockSize)) - 1; row >= 0; --row) {
+		float distance = point.y / GameMap::kBlockSize - static_cast<float>(row + 1);
+		if (distance > maxDistance / GameMap::kBlockSize) {
+			break;
+		}
+		if (tiles.IsSolid(column, tiles.GetHeight() - 1 - row)) {
+			return distance * GameMap::kBlockSize;
+		}
+	}
+	return maxDistance;
+}
+
+// 階層の全セルを、タイルから数え直した答えと比べる (食い違ったセルの数)
+int CountWrongCells(const ChunkedTileMap& map) {
+	const TileOccupancy& occupancy = map.GetOccupancy();
+	int wrong = 0;
+	for (int32_t level = 0; level < occupancy.GetLevelCount(); ++level) {
+		int32_t shift = TileOccupancy::kLevelShift * level;
+		int32_t size = 1 << shift;
+		for (int32_t cellY = 0; (cellY << shift) < map.GetHeight(); ++cellY) {
+			for (int32_t cellX = 0; (cellX << shift) < map.GetWidth(); ++cellX) {
+				bool solid = map.IsRectSolid(cellX << shift, cellY << shift, (cellX << shift) + size - 1, (cellY << shift) + size - 1);
+				wrong += (occupancy.IsCellEmpty(level, cellX, cellY) == solid) ? 1 : 0;
+			}
+		}
+	}
+	return wrong;
+}
+
+struct Rays {
+	std::vector<Vector2> origins;
+	std::vector<Vector2> directions;
+	std::vector<float> lengths;
+};
+
+Rays MakeRays(const MapData& data, size_t count, float maxTiles, uint32_t seed) {
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> px(0.0f, static_cast<float>(data.width) * GameMap::kBlockSize);
+	std::uniform_real_distribution<float> py(0.0f, static_cast<float>(data.height) * GameMap::kBlockSize);
+	std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+	std::uniform_real_distribution<float> reach(maxTiles * 0.5f * GameMap::kBlockSize, maxTiles * GameMap::kBlockSize);
+	Rays rays;
+	for (size_t i = 0; i < count; ++i) {
+		float a = angle(random);
+		rays.origins.push_back({ px(random), py(random) });
+		rays.directions.push_back({ std::cos(a), std::sin(a) });
+		rays.lengths.push_back(reach(random));
+	}
+	return rays;
+}
+
+// 1秒あたりの問い合わせ数 (百万)
+template <typename Query>
+double MeasureRate(size_t count, int iterations, Query query) {
+	Stopwatch stopwatch;
+	for (int i = 0; i < iterations; ++i) {
+		for (size_t k = 0; k < count; ++k) {
+			query(k);
+		}
+	}
+	return static_cast<double>(count) * iterations / stopwatch.GetSeconds() / 1e6;
+}
+
+} // namespace
+
+int RunOccupancyBenchmark(int argc, char* argv[]) {
+	int width = FindIntOption(argc, argv, "--width", 4096);
+	int height = FindIntOption(argc, argv, "--height", 1024);
+	int count = FindIntOption(argc, argv, "--rays", 50000);
+	int iterations = FindIntOption(argc, argv, "--iterations", 4);
+	bool ok = true;
+
+	// 1. 書き換えのたびに更新した階層が、数え直した答えと同じか
+	{
+		MapData data = GenerateScatteredMap(700, 300, 20, 5);
+		ChunkedTileMap map;
+		LoadWholeMap(map, data);
+		int wrong = CountWrongCells(map);
+		std::mt19937 random(17);
+		std::uniform_int_distribution<int32_t> px(0, data.width - 1);
+		std::uniform_int_distribution<int32_t> py(0, data.height - 1);
+		const uint8_t kTypes[] = { kTileEmpty, kTileWall, kTileBlock, kTileEmpty, kTileStart };
+		int edits = 0;
+		for (int round = 0; round < 20; ++round) {
+			for (int i = 0; i < 2000; ++i, ++edits) {
+				map.Set(px(random), py(random), kTypes[i % 5]);
+			}
+			// 一度空にしたところへ1つだけ置く (上のレベルまで伝わるか)
+			for (int32_t mapY = 100; mapY < 164; ++mapY) {
+				for (int32_t x = 256; x < 320; ++x) {
+					map.Set(x, mapY, kTileEmpty);
+				}
+			}
+			map.Set(300, 130, kTileWall);
+			wrong += CountWrongCells(map);
+		}
+		// 読み込んでいない場所は壁があるものとして扱う
+		ChunkedTileMap streamed;
+		streamed.Reset(std::make_unique<MapDataChunkSource>(GenerateScatteredMap(4096, 64, 0, 1)));
+		streamed.Stream(100, 32, 40, 32);
+		bool unknownIsSolid = !streamed.GetOccupancy().IsRectEmpty(3000, 0, 3100, 63) && streamed.GetOccupancy().IsRectEmpty(64, 0, 127, 63);
+		std::printf("incremental  %d edits on %dx%d, %d levels, wrong cells %d, unloaded chunks treated as solid: %s\n", edits,
+			data.width, data.height, map.GetOccupancy().GetLevelCount(), wrong, unknownIsSolid ? "yes" : "NO");
+		ok = ok && wrong == 0 && unknownIsSolid;
+
+		// 書き換えの費用 (壁を置いて消す)
+		const int kEdits = 1000000;
+		Stopwatch stopwatch;
+		for (int i = 0; i < kEdits; ++i) {
+			map.Set(px(random), py(random), (i & 1) ? kTileEmpty : kTileWall);
+		}
+		std::printf("set          %.1f ns per edit including the pyramid update\n", stopwatch.GetSeconds() / kEdits * 1e9);
+	}
+
+	// 2. まばらなマップで、階層を使う光線と1マスずつの光線を比べる
+	struct Case {
+		std::string name;
+		MapData data;
+	};
+	std::vector<Case> cases;
+	for (int density : { 1, 10, 50, 200 }) {
+		char name[32];
+		std::snprintf(name, sizeof(name), "scattered %.1f%%", density / 10.0);
+		cases.push_back({ name, GenerateScatteredMap(width, height, density, 100 + density) });
+	}
+	cases.push_back({ "platforms", GeneratePlatformMap(width, height, 21) });
+	for (const Case& c : cases) {
+		const MapData& data = c.data;
+		ChunkedTileMap map;
+		LoadWholeMap(map, data);
+		for (float maxTiles : { 16.0f, 64.0f, 256.0f }) {
+			Rays rays = MakeRays(data, static_cast<size_t>(count), maxTiles, 3);
+			int mismatches = 0;
+			for (size_t k = 0; k < rays.origins.size(); ++k) {
+				TileRayHit fast = RaycastTiles(map, GameMap::kBlockSize, rays.origins[k], rays.directions[k], rays.lengths[k]);
+				TileRayHit flat = FlatRaycast(map, rays.origins[k], rays.directions[k], rays.lengths[k]);
+				bool same = fast.hit == flat.hit && (!fast.hit || (fast.tileX == flat.tileX && fast.tileMapY == flat.tileMapY &&
+					std::abs(fast.distance - flat.distance) < 1.0e-3f));
+				// 角をかすめるだけのタイルは、1マスずつ足していく方の誤差で見落とすことがある (どちらも正しいとみなす)
+				if (!same) {
+					const TileRayHit& first = (fast.hit && (!flat.hit || fast.distance < flat.distance)) ? fast : flat;
+					same = first.hit && GetPassLength(map, rays.origins[k], rays.directions[k], first.tileX, first.tileMapY) < 1.0e-3f;
+				}
+				if (!same && mismatches < 3) {
+					std::printf("  mismatch: origin (%.9g %.9g) direction (%.9g %.9g) max %.5f  pyramid %d %.5f (%d,%d)  flat %d %.5f (%d,%d)\n",
+						rays.origins[k].x, rays.origins[k].y, rays.directions[k].x, rays.directions[k].y, rays.lengths[k],
+						fast.hit ? 1 : 0, fast.distance, fast.tileX, fast.tileMapY, flat.hit ? 1 : 0, flat.distance, flat.tileX, flat.tileMapY);
+				}
+				mismatches += same ? 0 : 1;
+			}
+			float sink = 0.0f;
+			double flatRate = MeasureRate(rays.origins.size(), iterations, [&](size_t k) {
+				sink += FlatRaycast(map, rays.origins[k], rays.directions[k], rays.lengths[k]).distance;
+			});
+			double fastRate = MeasureRate(rays.origins.size(), iterations, [&](size_t k) {
+				sink += RaycastTiles(map, GameMap::kBlockSize, rays.origins[k], rays.directions[k], rays.lengths[k]).distance;
+			});
+			std::printf("%-16s rays up to %3.0f tiles  flat %6.2f M/s  pyramid %6.2f M/s  (%.1fx)  mismatches %d%s\n",
+				c.name.c_str(), maxTiles, flatRate, fastRate, fastRate / flatRate, mismatches, sink < 0.0f ? " " : "");
+			ok = ok && mismatches == 0;
+		}
+
+		// 床までの距離 (マップの高さいっぱいまで探す)
+		Rays points = MakeRays(data, static_cast<size_t>(count), 1.0f, 4);
+		float reach = static_cast<float>(data.height) * GameMap::kBlockSize;
+		int groundMismatches = 0;
+		for (const Vector2& point : points.origins) {
+			float fast = GetTileGroundDistance(map, GameMap::kBlockSize, point, reach);
+			groundMismatches += std::abs(fast - FlatGroundDistance(map, point, reach)) < 1.0e-3f ? 0 : 1;
+		}
+		float sink = 0.0f;
+		double flatRate = MeasureRate(points.origins.size(), iterations, [&](size_t k) { sink += FlatGroundDistance(map, points.origins[k], reach); });
+		double fastRate = MeasureRate(points.origins.size(), iterations, [&](size_t k) {
+			sink += GetTileGroundDistance(map, GameMap::kBlockSize, points.origins[k], reach);
+		});
+		std::printf("%-16s ground distance        flat %6.2f M/s  pyramid %6.2f M/s  (%.1fx)  mismatches %d%s\n",
+			c.name.c_str(), flatRate, fastRate, fastRate / flatRate, groundMismatches, sink < 0.0f ? " " : "");
+		ok = ok && groundMismatches == 0;
+
+		// 長い掃引 (通り道が空なら階層だけで答えが出る)
+		std::mt19937 random(9);
+		std::uniform_real_distribution<float> offset(-16.0f * GameMap::kBlockSize, 16.0f * GameMap::kBlockSize);
+		int hits = 0;
+		Stopwatch stopwatch;
+		for (size_t k = 0; k < points.origins.size(); ++k) {
+			const Vector2& p = points.origins[k];
+			WorldRect box = { p.x - 0.2f, p.y - 0.2f, p.x + 0.2f, p.y + 0.2f };
+			hits += SweepTileBox(map, GameMap::kBlockSize, box, { offset(random), offset(random) }).hit ? 1 : 0;
+		}
+		std::printf("%-16s sweep up to 16 tiles   %.1f ns per sweep (%d%% hit)  pyramid %zu bytes\n", c.name.c_str(),
+			stopwatch.GetSeconds() / static_cast<double>(points.origins.size()) * 1e9,
+			static_cast<int>(100 * hits / std::max<size_t>(points.origins.size(), 1)), map.GetOccupancy().GetMemoryBytes());
+	}
+	return ok ? 0 : 1;
+}
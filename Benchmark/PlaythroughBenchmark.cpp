@@ -0,0 +1,326 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "ScriptedInput.h"
+#include "../GameSimulation.h"
+#include "../InputReplay.h"
+#include "../SimulationProfile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const kMapPaths[] = { "Resources/map.csv", "Resources/map2.csv", "Resources/map3.csv" };
+
+// 1回の通しプレイの結果
+struct PlaythroughResult {
+	std::string input;    // "scripted" / "replay"
+	std::string startMap; // 最初に遊んだマップ
+	int64_t ticks = 0;
+	int64_t playTicks = 0;
+	uint32_t mapLoads = 0;
+	std::vector<std::string> visitedMaps;
+
+	// 測らずに回したときの Step 1回ずつの時間 (ナノ秒。並べ替え済み)
+	std::vector<double> tickNanoseconds;
+	double totalNanoseconds = 0.0;
+	uint64_t allocations = 0;
+	int64_t allocatingTicks = 0;
+
+	// 処理ごとに測りながら回したとき
+	SimulationProfile profile;
+	double profiledNanoseconds = 0.0;
+	// 1回の計測で測った時間に入ってしまう時計そのものの費用 (ナノ秒。処理ごとの時間から引く)
+	double timerNanoseconds = 0.0;
+
+	int64_t divergedTick = -1;
+	std::string lastError;
+
+	double GetPercentile(double fraction) const {
+		if (tickNanoseconds.empty()) {
+			return 0.0;
+		}
+		size_t index = static_cast<size_t>(fraction * static_cast<double>(tickNanoseconds.size() - 1) + 0.5);
+		return tickNanoseconds[index];
+	}
+	double GetTicksPerSecond() const { return totalNanoseconds > 0.0 ? ticks * 1e9 / totalNanoseconds : 0.0; }
+	// 1ティックあたり (0 ティックなら 0。--ticks 0 や空の記録でも JSON に nan を書かない)
+	double PerTick(double value) const { return ticks > 0 ? value / static_cast<double>(ticks) : 0.0; }
+	// 時計の費用を引いた、処理ごとの時間
+	double GetSectionNanoseconds(SimulationSection section) const {
+		double nanoseconds = static_cast<double>(profile.nanoseconds[section]) - timerNanoseconds * static_cast<double>(profile.calls[section]);
+		return std::max(nanoseconds, 0.0);
+	}
+};
+
+// 操作の出どころを通しプレイのたびに作り直す (2回とも同じ操作にするため)
+class PlaythroughInput {
+public:
+	virtual ~PlaythroughInput() = default;
+	virtual InputSource* Begin() = 0;
+	// Step の後に呼ぶ。記録とずれていたら false
+	virtual bool Verify(const GameSimulation&) { return true; }
+	virtual int64_t GetDivergedTick() const { return -1; }
+};
+
+class ScriptedPlaythroughInput : public PlaythroughInput {
+public:
+	explicit ScriptedPlaythroughInput(uint32_t seed) : seed_(seed) {}
+
+	InputSource* Begin() override {
+		input_ = std::make_unique<ScriptedInput>(seed_);
+		return input_.get();
+	}
+
+private:
+	uint32_t seed_;
+	std::unique_ptr<ScriptedInput> input_;
+};
+
+class ReplayPlaythroughInput : public PlaythroughInput {
+public:
+	explicit ReplayPlaythroughInput(const InputRecording* recording) : recording_(recording) {}
+
+	InputSource* Begin() override {
+		replayer_ = std::make_unique<InputReplayer>(recording_);
+		return replayer_.get();
+	}
+	bool Verify(const GameSimulation& simulation) override { return replayer_->VerifyState(simulation.ComputeStateHash()); }
+	int64_t GetDivergedTick() const override { return replayer_->GetDivergedTick(); }
+
+private:
+	const InputRecording* recording_;
+	std::unique_ptr<InputReplayer> replayer_;
+};
+
+double ElapsedNanoseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+// 何もしないスコープを測り、1回あたりに計上される時間を求める
+double CalibrateSectionTimer() {
+	SimulationProfile profile;
+	const int repeats = 200000;
+	for (int i = 0; i < repeats; ++i) {
+		ScopedSectionTimer timer(&profile, kSectionStreaming);
+	}
+	return static_cast<double>(profile.nanoseconds[kSectionStreaming]) / repeats;
+}
+
+// 同じ操作で2回回す。1回目は Step ごとの時間と確保の回数、2回目は処理ごとの内訳を測る
+// (内訳の計測は時計を何度も読むので、1回目の時間には混ぜない)
+PlaythroughResult Play(PlaythroughInput& input, const std::string& startMap, int64_t ticks) {
+	PlaythroughResult result;
+	result.startMap = startMap.empty() ? "Resources/map.csv" : startMap;
+	result.tickNanoseconds.reserve(static_cast<size_t>(ticks));
+
+	{
+		GameSimulation simulation;
+		if (!startMap.empty()) {
+			simulation.SetStartMap(startMap);
+		}
+		simulation.SetInputSource(input.Begin());
+		uint32_t seenLoads = 0;
+		for (int64_t tick = 0; tick < ticks; ++tick) {
+			const uint64_t allocationsBefore = GetAllocationCount();
+			auto start = std::chrono::steady_clock::now();
+			simulation.Step();
+			auto end = std::chrono::steady_clock::now();
+			const uint64_t allocations = GetAllocationCount() - allocationsBefore;
+			result.allocations += allocations;
+			result.allocatingTicks += allocations > 0 ? 1 : 0;
+			result.tickNanoseconds.push_back(ElapsedNanoseconds(start, end));
+
+			if (!simulation.GetLastError().empty()) {
+				result.lastError = simulation.GetLastError();
+				return result;
+			}
+			if (simulation.IsPlaying()) {
+				++result.playTicks;
+				if (simulation.GetMapLoadCount() != seenLoads) {
+					seenLoads = simulation.GetMapLoadCount();
+					const std::string& path = simulation.GetMapFilePath();
+					if (std::find(result.visitedMaps.begin(), result.visitedMaps.end(), path) == result.visitedMaps.end()) {
+						result.visitedMaps.push_back(path);
+					}
+				}
+			}
+			input.Verify(simulation);
+		}
+		result.ticks = ticks;
+		result.mapLoads = simulation.GetMapLoadCount();
+		result.divergedTick = input.GetDivergedTick();
+	}
+	for (double nanoseconds : result.tickNanoseconds) {
+		result.totalNanoseconds += nanoseconds;
+	}
+	std::sort(result.tickNanoseconds.begin(), result.tickNanoseconds.end());
+
+	{
+		GameSimulation simulation;
+		if (!startMap.empty()) {
+			simulation.SetStartMap(startMap);
+		}
+		simulation.SetInputSource(input.Begin());
+		result.timerNanoseconds = CalibrateSectionTimer();
+		simulation.SetProfile(&result.profile);
+		auto start = std::chrono::steady_clock::now();
+		for (int64_t tick = 0; tick < ticks; ++tick) {
+			simulation.Step();
+		}
+		result.profiledNanoseconds = ElapsedNanoseconds(start, std::chrono::steady_clock::now());
+	}
+	return result;
+}
+
+std::string GetFileName(const std::string& path) {
+	size_t slash = path.find_last_of("/\\");
+	return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+void PrintResult(const PlaythroughResult& result) {
+	std::string visited;
+	for (const std::string& path : result.visitedMaps) {
+		visited += " " + GetFileName(path);
+	}
+	std::printf("%s from %s: %lld ticks (%lld in play), %u map loads, visited%s\n", result.input.c_str(),
+		GetFileName(result.startMap).c_str(), static_cast<long long>(result.ticks), static_cast<long long>(result.playTicks),
+		result.mapLoads, visited.empty() ? " none" : visited.c_str());
+	std::printf("  %.0f ticks/s, tick p50 %.2f us p99 %.2f us max %.2f us\n", result.GetTicksPerSecond(),
+		result.GetPercentile(0.50) / 1000.0, result.GetPercentile(0.99) / 1000.0, result.GetPercentile(1.0) / 1000.0);
+	std::printf("  allocations %llu (%.3f/tick, %lld ticks allocated)\n", static_cast<unsigned long long>(result.allocations),
+		result.PerTick(static_cast<double>(result.allocations)), static_cast<long long>(result.allocatingTicks));
+
+	std::printf("  %-16s %10s %11s %7s\n", "section", "ns/tick", "calls/tick", "share");
+	for (int section = 0; section < kSectionCount; ++section) {
+		const double nanoseconds = result.GetSectionNanoseconds(static_cast<SimulationSection>(section));
+		const double calls = result.PerTick(static_cast<double>(result.profile.calls[section]));
+		if (!IsSimulationSectionTimed(static_cast<SimulationSection>(section))) {
+			std::printf("  %-16s %10s %11.2f %7s\n", GetSimulationSectionName(static_cast<SimulationSection>(section)), "-", calls, "-");
+			continue;
+		}
+		std::printf("  %-16s %10.1f %11.2f %6.1f%%\n", GetSimulationSectionName(static_cast<SimulationSection>(section)),
+			result.PerTick(nanoseconds), calls, result.totalNanoseconds > 0.0 ? nanoseconds * 100.0 / result.totalNanoseconds : 0.0);
+	}
+	std::printf("  (section times exclude %.1f ns of timer cost per call and share is of the plain run; map_queries and map_edits are call counts\n"
+		"   only, inside the sections that call them; profiled run took %.2fx the plain run)\n", result.timerNanoseconds,
+		result.totalNanoseconds > 0.0 ? result.profiledNanoseconds / result.totalNanoseconds : 0.0);
+}
+
+std::string JsonString(const std::string& text) {
+	std::string quoted = "\"";
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			quoted += '\\';
+		}
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+// コミットどうしで比べられるように、数値だけを JSON に書く (時間はナノ秒)
+bool WriteJson(const std::string& path, const std::vector<PlaythroughResult>& results, uint32_t seed) {
+	FILE* file = std::fopen(path.c_str(), "w");
+	if (!file) {
+		return false;
+	}
+	int64_t totalTicks = 0;
+	double totalNanoseconds = 0.0;
+	for (const PlaythroughResult& result : results) {
+		totalTicks += result.ticks;
+		totalNanoseconds += result.totalNanoseconds;
+	}
+	std::fprintf(file, "{\n  \"benchmark\": \"playthrough\",\n  \"seed\": %u,\n", seed);
+	std::fprintf(file, "  \"total\": { \"ticks\": %lld, \"ticks_per_second\": %.1f },\n", static_cast<long long>(totalTicks),
+		totalNanoseconds > 0.0 ? totalTicks * 1e9 / totalNanoseconds : 0.0);
+	std::fprintf(file, "  \"runs\": [\n");
+	for (size_t i = 0; i < results.size(); ++i) {
+		const PlaythroughResult& result = results[i];
+		std::fprintf(file, "    {\n      \"input\": %s,\n      \"start_map\": %s,\n", JsonString(result.input).c_str(),
+			JsonString(result.startMap).c_str());
+		std::fprintf(file, "      \"ticks\": %lld,\n      \"play_ticks\": %lld,\n      \"map_loads\": %u,\n      \"visited_maps\": [",
+			static_cast<long long>(result.ticks), static_cast<long long>(result.playTicks), result.mapLoads);
+		for (size_t map = 0; map < result.visitedMaps.size(); ++map) {
+			std::fprintf(file, "%s%s", map == 0 ? "" : ", ", JsonString(result.visitedMaps[map]).c_str());
+		}
+		std::fprintf(file, "],\n      \"ticks_per_second\": %.1f,\n", result.GetTicksPerSecond());
+		std::fprintf(file, "      \"tick_ns\": { \"mean\": %.1f, \"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f },\n",
+			result.PerTick(result.totalNanoseconds), result.GetPercentile(0.50), result.GetPercentile(0.99),
+			result.GetPercentile(1.0));
+		std::fprintf(file, "      \"allocations\": %llu,\n      \"allocations_per_tick\": %.4f,\n      \"allocating_ticks\": %lld,\n",
+			static_cast<unsigned long long>(result.allocations),
+			result.PerTick(static_cast<double>(result.allocations)), static_cast<long long>(result.allocatingTicks));
+		std::fprintf(file, "      \"diverged_tick\": %lld,\n", static_cast<long long>(result.divergedTick));
+		std::fprintf(file, "      \"profiled_ns\": %.0f,\n      \"timer_ns\": %.1f,\n      \"sections\": {\n", result.profiledNanoseconds,
+			result.timerNanoseconds);
+		for (int section = 0; section < kSectionCount; ++section) {
+			// 回数だけの処理は時間を書かない
+			std::string nanoseconds;
+			if (IsSimulationSectionTimed(static_cast<SimulationSection>(section))) {
+				char text[64];
+				std::snprintf(text, sizeof(text), "\"ns_per_tick\": %.1f, ", result.PerTick(result.GetSectionNanoseconds(static_cast<SimulationSection>(section))));
+				nanoseconds = text;
+			}
+			std::fprintf(file, "        %s: { %s\"calls_per_tick\": %.3f }%s\n",
+				JsonString(GetSimulationSectionName(static_cast<SimulationSection>(section))).c_str(), nanoseconds.c_str(),
+				result.PerTick(static_cast<double>(result.profile.calls[section])), section + 1 < kSectionCount ? "," : "");
+		}
+		std::fprintf(file, "      }\n    }%s\n", i + 1 < results.size() ? "," : "");
+	}
+	std::fprintf(file, "  ]\n}\n");
+	return std::fclose(file) == 0;
+}
+
+} // namespace
+
+int RunPlaythroughBenchmark(int argc, char* argv[]) {
+	const int ticks = FindIntOption(argc, argv, "--ticks", 36000);
+	const uint32_t seed = static_cast<uint32_t>(FindIntOption(argc, argv, "--seed", 1));
+	const std::string replayPath = FindOption(argc, argv, "--replay", "");
+	const std::string jsonPath = FindOption(argc, argv, "--json", "");
+
+	std::vector<PlaythroughResult> results;
+	if (!replayPath.empty()) {
+		// 記録した操作で、記録と同じくタイトルから遊ぶ
+		InputRecording recording;
+		std::string errorMessage;
+		if (!ReadInputRecording(replayPath, recording, &errorMessage)) {
+			std::printf("FAIL: %s: %s\n", replayPath.c_str(), errorMessage.c_str());
+			return 1;
+		}
+		ReplayPlaythroughInput input(&recording);
+		results.push_back(Play(input, "", static_cast<int64_t>(recording.GetTickCount())));
+		results.back().input = "replay";
+	} else {
+		// ボットでそれぞれのマップから遊ぶ (ボットはなかなか先のマップへ進めないので)
+		for (const char* path : kMapPaths) {
+			ScriptedPlaythroughInput input(seed);
+			results.push_back(Play(input, path, ticks));
+			results.back().input = "scripted";
+		}
+	}
+
+	int failures = 0;
+	for (const PlaythroughResult& result : results) {
+		if (!result.lastError.empty()) {
+			std::printf("FAIL: %s (run from the game's directory)\n", result.lastError.c_str());
+			return 1;
+		}
+		PrintResult(result);
+		if (result.divergedTick >= 0) {
+			std::printf("  FAIL: replay diverged from the recording at tick %lld\n", static_cast<long long>(result.divergedTick));
+			++failures;
+		}
+	}
+	if (!jsonPath.empty()) {
+		if (!WriteJson(jsonPath, results, seed)) {
+			std::printf("FAIL: cannot write %s\n", jsonPath.c_str());
+			return 1;
+		}
+		std::printf("wrote %s\n", jsonPath.c_str());
+	}
+	return failures == 0 ? 0 : 1;
+}
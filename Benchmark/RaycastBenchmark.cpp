@@ -0,0 +1,229 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../ChunkedTileMap.h"
+#include "../GameMap.h"
+#include "../MapFile.h"
+#include "../TileRaycast.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 総当たりの答え: 光線の通る範囲のタイルを全部、箱と光線の交差 (スラブ法) で調べる
+// 始点のタイルは除く。当たらなければ負の値を返す
+float ReferenceRaycast(const ChunkedTileMap& map, const Vector2& origin, const Vector2& direction, float maxDistance) {
+	float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	double dirX = direction.x / length;
+	double dirY = direction.y / length;
+	double endX = origin.x + dirX * maxDistance;
+	double endY = origin.y + dirY * maxDistance;
+	int32_t startColumn = static_cast<int32_t>(std::floor(static_cast<double>(origin.x) / GameMap::kBlockSize));
+	int32_t startRow = static_cast<int32_t>(std::floor(static_cast<double>(origin.y) / GameMap::kBlockSize));
+	int32_t column0 = static_cast<int32_t>(std::floor(std::min<double>(origin.x, endX) / GameMap::kBlockSize)) - 1;
+	int32_t column1 = static_cast<int32_t>(std::floor(std::max<double>(origin.x, endX) / GameMap::kBlockSize)) + 1;
+	int32_t row0 = static_cast<int32_t>(std::floor(std::min<double>(origin.y, endY) / GameMap::kBlockSize)) - 1;
+	int32_t row1 = static_cast<int32_t>(std::floor(std::max<double>(origin.y, endY) / GameMap::kBlockSize)) + 1;
+	double best = -1.0;
+	for (int32_t row = row0; row <= row1; ++row) {
+		for (int32_t column = column0; column <= column1; ++column) {
+			if ((column == startColumn && row == startRow) || !map.IsSolid(column, map.GetHeight() - 1 - row)) {
+				continue;
+			}
+			double enter = 0.0;
+			double exit = maxDistance;
+			const double low[2] = { column * static_cast<double>(GameMap::kBlockSize), row * static_cast<double>(GameMap::kBlockSize) };
+			const double start[2] = { origin.x, origin.y };
+			const double dir[2] = { dirX, dirY };
+			bool missed = false;
+			for (int axis = 0; axis < 2 && !missed; ++axis) {
+				if (dir[axis] == 0.0) {
+					missed = start[axis] < low[axis] || start[axis] > low[axis] + GameMap::kBlockSize;
+					continue;
+				}
+				double t0 = (low[axis] - start[axis]) / dir[axis];
+				double t1 = (low[axis] + GameMap::kBlockSize - start[axis]) / dir[axis];
+				enter = std::max(enter, std::min(t0, t1));
+				exit = std::min(exit, std::max(t0, t1));
+				missed = enter > exit;
+			}
+			if (!missed && (best < 0.0 || enter < best)) {
+				best = enter;
+			}
+		}
+	}
+	return static_cast<float>(best);
+}
+
+// 総当たりの答え: 真下の列を1マスずつ見る
+float ReferenceGroundDistance(const ChunkedTileMap& map, const Vector2& point, float maxDistance) {
+	int32_t column = static_cast<int32_t>(std::floor(point.x / GameMap::kBlockSize));
+	for (int32_t row = static_cast<int32_t>(std::floor(point.y / GameMap::kBlockSize)) - 1; row >= 0; --row) {
+		float distance = point.y - static_cast<float>(row + 1) * GameMap::kBlockSize;
+		if (distance > maxDistance) {
+			break;
+		}
+		if (map.IsSolid(column, map.GetHeight() - 1 - row)) {
+			return distance;
+		}
+	}
+	return maxDistance;
+}
+
+struct QuerySet {
+	std::vector<TileRay> rays;
+	std::vector<Vector2> from;
+	std::vector<Vector2> to;
+};
+
+// マップの中の点から、長さ maxTiles タイルまでのランダムな向きの光線を作る
+QuerySet MakeQueries(const MapData& data, size_t count, float maxTiles, uint32_t seed) {
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> px(0.0f, static_cast<float>(data.width) * GameMap::kBlockSize);
+	std::uniform_real_distribution<float> py(0.0f, static_cast<float>(data.height) * GameMap::kBlockSize);
+	std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+	std::uniform_real_distribution<float> reach(0.1f, maxTiles * GameMap::kBlockSize);
+	QuerySet set;
+	for (size_t i = 0; i < count; ++i) {
+		TileRay ray;
+		ray.origin = { px(random), py(random) };
+		float a = angle(random);
+		// 1/8 は軸に沿った光線 (床・壁の検索でよく使う向き)
+		if ((i & 7) == 0) {
+			a = static_cast<float>(i / 8 % 4) * 1.5707963f;
+		}
+		ray.direction = { std::cos(a), std::sin(a) };
+		if ((i & 7) == 0) {
+			ray.direction = { std::round(ray.direction.x), std::round(ray.direction.y) };
+		}
+		ray.maxDistance = reach(random);
+		set.rays.push_back(ray);
+		set.from.push_back(ray.origin);
+		set.to.push_back({ ray.origin.x + ray.direction.x * ray.maxDistance, ray.origin.y + ray.direction.y * ray.maxDistance });
+	}
+	return set;
+}
+
+// 総当たりと比べる (距離の差が許容値を超えたら失敗)
+int CheckQueries(const ChunkedTileMap& map, const QuerySet& set) {
+	const float kTolerance = 1.0e-3f;
+	int failures = 0;
+	for (size_t i = 0; i < set.rays.size(); ++i) {
+		const TileRay& ray = set.rays[i];
+		TileRayHit hit = RaycastTiles(map, GameMap::kBlockSize, ray.origin, ray.direction, ray.maxDistance);
+		float reference = ReferenceRaycast(map, ray.origin, ray.direction, ray.maxDistance);
+		bool ok = (reference < 0.0f) ? !hit.hit : (hit.hit && std::abs(hit.distance - reference) < kTolerance);
+		// 境目すれすれの光線は、どちらの答えも誤差の範囲
+		if (!ok && hit.hit && reference < 0.0f && ray.maxDistance - hit.distance < kTolerance) {
+			ok = true;
+		}
+		if (!ok && !hit.hit && reference >= 0.0f && ray.maxDistance - reference < kTolerance) {
+			ok = true;
+		}
+		if (ok && hit.hit && !map.IsSolid(hit.tileX, hit.tileMapY)) {
+			ok = false;
+		}
+		float ground = GetTileGroundDistance(map, GameMap::kBlockSize, ray.origin, ray.maxDistance);
+		if (std::abs(ground - ReferenceGroundDistance(map, ray.origin, ray.maxDistance)) > kTolerance) {
+			ok = false;
+		}
+		if (!ok) {
+			if (failures < 5) {
+				std::printf("  mismatch: origin (%.9g %.9g) direction (%.9g %.9g) max %.5f  ray %d %.5f  reference %.5f\n",
+					ray.origin.x, ray.origin.y, ray.direction.x, ray.direction.y, ray.maxDistance, hit.hit ? 1 : 0, hit.distance,
+					reference);
+			}
+			++failures;
+		}
+	}
+	return failures;
+}
+
+// 1本ずつの版とまとめた版の速さ (百万本 / 秒)
+bool Measure(const std::string& name, const ChunkedTileMap& map, const QuerySet& set, int iterations) {
+	const size_t count = set.rays.size();
+	std::vector<TileRayHit> hits(count);
+	std::unique_ptr<bool[]> visible(new bool[count]);
+	std::vector<float> distances(count);
+
+	auto rate = [&](double seconds) { return static_cast<double>(count) * iterations / seconds / 1e6; };
+	size_t hitCount = 0;
+	Stopwatch stopwatch;
+	for (int i = 0; i < iterations; ++i) {
+		for (size_t k = 0; k < count; ++k) {
+			hitCount += RaycastTiles(map, GameMap::kBlockSize, set.rays[k].origin, set.rays[k].direction, set.rays[k].maxDistance).hit ? 1 : 0;
+		}
+	}
+	double single = stopwatch.GetSeconds();
+	stopwatch.Restart();
+	for (int i = 0; i < iterations; ++i) {
+		RaycastTilesBatch(map, GameMap::kBlockSize, set.rays.data(), count, hits.data());
+	}
+	double batch = stopwatch.GetSeconds();
+	stopwatch.Restart();
+	for (int i = 0; i < iterations; ++i) {
+		HasTileLineOfSightBatch(map, GameMap::kBlockSize, set.from.data(), set.to.data(), count, visible.get());
+	}
+	double sight = stopwatch.GetSeconds();
+	stopwatch.Restart();
+	for (int i = 0; i < iterations; ++i) {
+		GetTileGroundDistanceBatch(map, GameMap::kBlockSize, set.from.data(), count, 16.0f * GameMap::kBlockSize, distances.data());
+	}
+	double ground = stopwatch.GetSeconds();
+
+	// 1本ずつの版とまとめた版は同じ答え
+	bool same = true;
+	for (size_t k = 0; k < count; ++k) {
+		TileRayHit one = RaycastTiles(map, GameMap::kBlockSize, set.rays[k].origin, set.rays[k].direction, set.rays[k].maxDistance);
+		same = same && one.hit == hits[k].hit && one.distance == hits[k].distance &&
+			visible[k] == HasTileLineOfSight(map, GameMap::kBlockSize, set.from[k], set.to[k]);
+	}
+	size_t visibleCount = static_cast<size_t>(std::count(visible.get(), visible.get() + count, true));
+	std::printf("%-24s raycast %6.1f M/s  batch %6.1f M/s  line of sight %6.1f M/s (%4.1f%% clear)  ground %6.1f M/s  hits %.1f%%%s\n",
+		name.c_str(), rate(single), rate(batch), rate(sight), 100.0 * static_cast<double>(visibleCount) / static_cast<double>(count),
+		rate(ground), 100.0 * static_cast<double>(hitCount) / (static_cast<double>(count) * iterations), same ? "" : "  FAILED (batch differs)");
+	return same;
+}
+
+} // namespace
+
+int RunRaycastBenchmark(int argc, char* argv[]) {
+	int width = FindIntOption(argc, argv, "--width", 4096);
+	int height = FindIntOption(argc, argv, "--height", 512);
+	int count = FindIntOption(argc, argv, "--rays", 100000);
+	int iterations = FindIntOption(argc, argv, "--iterations", 10);
+	bool ok = true;
+
+	// 1. 総当たりとの比較
+	struct Case {
+		std::string name;
+		MapData data;
+	};
+	std::vector<Case> cases;
+	MapData data;
+	if (LoadMapFile("Resources/map.csv", data, nullptr)) {
+		cases.push_back({ "map.csv", data });
+	}
+	if (LoadMapFile("Resources/blocks.csv", data, nullptr)) {
+		cases.push_back({ "blocks.csv", data });
+	}
+	cases.push_back({ "scattered 5% (large)", GenerateScatteredMap(width, height, 50, 11) });
+	cases.push_back({ "scattered 30% (large)", GenerateScatteredMap(width, height, 300, 12) });
+
+	for (const Case& c : cases) {
+		ChunkedTileMap map;
+		LoadWholeMap(map, c.data);
+		QuerySet checks = MakeQueries(c.data, 20000, 24.0f, 99);
+		int failures = CheckQueries(map, checks);
+		std::printf("%-24s %dx%d  20000 rays vs brute force, failures %d\n", c.name.c_str(), c.data.width, c.data.height, failures);
+		ok = ok && failures == 0;
+
+		// 2. 16 タイルまでの光線の速さ
+		QuerySet set = MakeQueries(c.data, static_cast<size_t>(count), 16.0f, 7);
+		ok = Measure(c.name, map, set, iterations) && ok;
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,314 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../ChunkedTileMap.h"
+#include "../GameMap.h"
+#include "../MapFile.h"
+#include "../TileMesher.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+TileMeshOptions GetChunkMeshOptions(int32_t chunkX, int32_t chunkY, int32_t mapHeight) {
+	TileMeshOptions options;
+	options.blockSize = GameMap::kBlockSize;
+	options.originX = static_cast<float>(chunkX << kChunkShift) * GameMap::kBlockSize;
+	options.originY = static_cast<float>(mapHeight - (chunkY << kChunkShift)) * GameMap::kBlockSize;
+	return options;
+}
+
+bool IsSameMesh(const IndexedModelData& a, const IndexedModelData& b) {
+	return a.vertices.size() == b.vertices.size() && a.indices == b.indices &&
+		(a.vertices.empty() || std::memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(VertexData)) == 0);
+}
+
+// MapChip と同じくチャンクごとに壁のメッシュを持ち、書き換えの通知で作り直す
+class MeshListener : public TileChunkListener {
+public:
+	MeshListener(int32_t chunkCountX, int32_t mapHeight) : chunkCountX_(chunkCountX), mapHeight_(mapHeight) {}
+
+	void OnChunkLoaded(int32_t chunkX, int32_t chunkY, const uint8_t* tiles) override {
+		Build(chunkX, chunkY, tiles);
+	}
+
+	void OnChunkEvicted(int32_t chunkX, int32_t chunkY) override {
+		meshes_.erase(chunkY * chunkCountX_ + chunkX);
+	}
+
+	void OnChunkChanged(int32_t chunkX, int32_t chunkY, const TileRect&, bool wallsChanged, const uint8_t* tiles) override {
+		if (!wallsChanged) {
+			return;
+		}
+		Stopwatch stopwatch;
+		Build(chunkX, chunkY, tiles);
+		rebuildSeconds_ += stopwatch.GetSeconds();
+		++rebuildCount_;
+		// 1回の FlushChanges で同じチャンクを2回作り直したら失敗
+		int32_t index = chunkY * chunkCountX_ + chunkX;
+		if (std::find(rebuiltThisFlush_.begin(), rebuiltThisFlush_.end(), index) != rebuiltThisFlush_.end()) {
+			++duplicateCount_;
+		}
+		rebuiltThisFlush_.push_back(index);
+	}
+
+	void BeginFlush() { rebuiltThisFlush_.clear(); }
+
+	// 常駐しているチャンクのメッシュが、今のタイルから作り直したものと同じか
+	size_t CountStaleMeshes(const ChunkedTileMap& map) const {
+		std::vector<uint8_t> tiles(kChunkTileCount);
+		IndexedModelData expected;
+		size_t staleCount = 0;
+		for (const auto& entry : meshes_) {
+			int32_t chunkX = entry.first % chunkCountX_;
+			int32_t chunkY = entry.first / chunkCountX_;
+			for (int32_t y = 0; y < kChunkSize; ++y) {
+				for (int32_t x = 0; x < kChunkSize; ++x) {
+					int32_t type = map.Get((chunkX << kChunkShift) + x, (chunkY << kChunkShift) + y);
+					tiles[y * kChunkSize + x] = static_cast<uint8_t>(type < 0 ? kTileEmpty : type);
+				}
+			}
+			BuildTileMesh(tiles.data(), kChunkSize, kChunkSize, GetChunkMeshOptions(chunkX, chunkY, mapHeight_), expected);
+			staleCount += IsSameMesh(entry.second, expected) ? 0 : 1;
+		}
+		return staleCount;
+	}
+
+	size_t GetMeshCount() const { return meshes_.size(); }
+	uint64_t GetRebuildCount() const { return rebuildCount_; }
+	uint64_t GetDuplicateCount() const { return duplicateCount_; }
+	double GetRebuildSeconds() const { return rebuildSeconds_; }
+
+private:
+	void Build(int32_t chunkX, int32_t chunkY, const uint8_t* tiles) {
+		BuildTileMesh(tiles, kChunkSize, kChunkSize, GetChunkMeshOptions(chunkX, chunkY, mapHeight_),
+			meshes_[chunkY * chunkCountX_ + chunkX]);
+	}
+
+	int32_t chunkCountX_;
+	int32_t mapHeight_;
+	std::unordered_map<int32_t, IndexedModelData> meshes_;
+	std::vector<int32_t> rebuiltThisFlush_;
+	uint64_t rebuildCount_ = 0;
+	uint64_t duplicateCount_ = 0;
+	double rebuildSeconds_ = 0.0;
+};
+
+// ミニマップ (マップ全体の1マス1バイトの画像)。書き換えは dirtyRect の範囲だけ写す
+class MinimapListener : public TileChunkListener {
+public:
+	MinimapListener(int32_t width, int32_t height) : width_(width), height_(height), pixels_(static_cast<size_t>(width) * height, 0) {}
+
+	void OnChunkLoaded(int32_t chunkX, int32_t chunkY, const uint8_t* tiles) override {
+		int32_t x0 = chunkX << kChunkShift;
+		int32_t y0 = chunkY << kChunkShift;
+		Copy({ x0, y0, x0 + kChunkSize - 1, y0 + kChunkSize - 1 }, x0, y0, tiles);
+	}
+
+	void OnChunkEvicted(int32_t, int32_t) override {}
+
+	void OnChunkChanged(int32_t chunkX, int32_t chunkY, const TileRect& dirtyRect, bool, const uint8_t* tiles) override {
+		Copy(dirtyRect, chunkX << kChunkShift, chunkY << kChunkShift, tiles);
+		copiedTiles_ += static_cast<uint64_t>(dirtyRect.x1 - dirtyRect.x0 + 1) * (dirtyRect.mapY1 - dirtyRect.mapY0 + 1);
+	}
+
+	size_t CountMismatches(const ChunkedTileMap& map) const {
+		size_t mismatchCount = 0;
+		for (int32_t y = 0; y < height_; ++y) {
+			for (int32_t x = 0; x < width_; ++x) {
+				uint8_t expected = map.Get(x, y) == kTileWall ? 255 : 0;
+				mismatchCount += pixels_[static_cast<size_t>(y) * width_ + x] != expected ? 1 : 0;
+			}
+		}
+		return mismatchCount;
+	}
+
+	uint64_t GetCopiedTiles() const { return copiedTiles_; }
+
+private:
+	void Copy(const TileRect& rect, int32_t chunkLeft, int32_t chunkTop, const uint8_t* tiles) {
+		for (int32_t y = std::max(rect.mapY0, 0); y <= std::min(rect.mapY1, height_ - 1); ++y) {
+			for (int32_t x = std::max(rect.x0, 0); x <= std::min(rect.x1, width_ - 1); ++x) {
+				uint8_t type = tiles[(y - chunkTop) * kChunkSize + (x - chunkLeft)];
+				pixels_[static_cast<size_t>(y) * width_ + x] = type == kTileWall ? 255 : 0;
+			}
+		}
+	}
+
+	int32_t width_;
+	int32_t height_;
+	std::vector<uint8_t> pixels_;
+	uint64_t copiedTiles_ = 0;
+};
+
+MapData GenerateMap(int32_t width, int32_t height) {
+	std::mt19937 random(24680);
+	std::uniform_int_distribution<int32_t> distribution(0, 99);
+	MapData map;
+	map.width = width;
+	map.height = height;
+	map.tiles.resize(static_cast<size_t>(width) * height);
+	for (int32_t y = 0; y < height; ++y) {
+		for (int32_t x = 0; x < width; ++x) {
+			bool ground = y >= height - 3;
+			map.tiles[static_cast<size_t>(y) * width + x] = (ground || distribution(random) < 15) ? kTileWall : kTileEmpty;
+		}
+	}
+	return map;
+}
+
+} // namespace
+
+int RunRemeshBenchmark(int argc, char* argv[]) {
+	int width = FindIntOption(argc, argv, "--width", 512);
+	int height = FindIntOption(argc, argv, "--height", 96);
+	int frames = FindIntOption(argc, argv, "--frames", 2000);
+	int editsPerFrame = FindIntOption(argc, argv, "--edits", 4);
+
+	MapData source = GenerateMap(width, height);
+	ChunkedTileMap map;
+	map.Reset(std::make_unique<MapDataChunkSource>(source));
+	MeshListener meshes(map.GetChunkCountX(), height);
+	MinimapListener minimap(width, height);
+	map.AddListener(&meshes);
+	map.AddListener(&minimap);
+	map.Stream(width / 2, height / 2, width, height);
+
+	// 比べる相手: 書き換えのたびにマップ全体のチャンクを作り直す
+	std::vector<double> fullSamples;
+	{
+		MapDataChunkSource fullSource(source);
+		std::vector<uint8_t> tiles(kChunkTileCount);
+		IndexedModelData mesh;
+		for (int i = 0; i < 10; ++i) {
+			Stopwatch stopwatch;
+			for (int32_t chunkY = 0; chunkY < map.GetChunkCountY(); ++chunkY) {
+				for (int32_t chunkX = 0; chunkX < map.GetChunkCountX(); ++chunkX) {
+					fullSource.LoadChunk(chunkX, chunkY, tiles.data());
+					BuildTileMesh(tiles.data(), kChunkSize, kChunkSize, GetChunkMeshOptions(chunkX, chunkY, height), mesh);
+				}
+			}
+			fullSamples.push_back(stopwatch.GetSeconds());
+		}
+	}
+
+	// 落下ブロックのように数マスずつ置いたり消したりし、ときどき1列まるごと埋める (map3 のイベント)
+	std::mt19937 random(11);
+	std::uniform_int_distribution<int32_t> anyX(0, width - 1);
+	std::uniform_int_distribution<int32_t> anyY(0, height - 1);
+	std::vector<double> flushSamples;
+	double setSeconds = 0.0;
+	uint64_t setCount = 0;
+	uint64_t staleCount = 0;
+	uint64_t minimapMismatchCount = 0;
+	for (int frame = 0; frame < frames; ++frame) {
+		Stopwatch setWatch;
+		if (frame % 500 == 499) {
+			int32_t x = anyX(random);
+			for (int32_t mapY = 0; mapY < height; ++mapY) {
+				map.Set(x, mapY, kTileWall);
+			}
+			setCount += height;
+		} else {
+			for (int i = 0; i < editsPerFrame; ++i) {
+				int32_t x = anyX(random);
+				int32_t mapY = anyY(random);
+				map.Set(x, mapY, map.Get(x, mapY) == kTileWall ? kTileEmpty : kTileWall);
+				map.Set(x, mapY - 1, kTileEmpty); // 同じチャンクなら1つの矩形にまとまる
+			}
+			setCount += editsPerFrame * 2;
+		}
+		setSeconds += setWatch.GetSeconds();
+
+		meshes.BeginFlush();
+		Stopwatch flushWatch;
+		map.FlushChanges();
+		flushSamples.push_back(flushWatch.GetSeconds());
+
+		if (frame % 100 == 0 || frame == frames - 1) {
+			staleCount += meshes.CountStaleMeshes(map);
+			minimapMismatchCount += minimap.CountMismatches(map);
+		}
+	}
+	ChunkStreamStats stats = map.GetStats();
+	// 壁の有無が変わったと通知したチャンクだけを作り直している
+	bool rebuildsMatchWalls = meshes.GetRebuildCount() == stats.wallChangedChunkCount;
+
+	// ゲーム中の書き換え (SetGridCell) と同じく壁でないマスに kTileBlock を置いて消すだけなら、
+	// 書き換えの通知は届くがメッシュは作り直さない
+	uint64_t blockEdits = 0;
+	uint64_t blockStaleCount = 0;
+	const uint64_t rebuildsBeforeBlocks = meshes.GetRebuildCount();
+	const uint64_t changedBeforeBlocks = map.GetStats().changedChunkCount;
+	for (int frame = 0; frame < 200; ++frame) {
+		uint8_t type = frame % 2 == 0 ? kTileBlock : kTileEmpty;
+		for (int i = 0; i < editsPerFrame; ++i) {
+			int32_t x = anyX(random);
+			int32_t mapY = anyY(random);
+			if (map.Get(x, mapY) != kTileWall) {
+				map.Set(x, mapY, type);
+				++blockEdits;
+			}
+		}
+		meshes.BeginFlush();
+		map.FlushChanges();
+	}
+	blockStaleCount += meshes.CountStaleMeshes(map);
+	minimapMismatchCount += minimap.CountMismatches(map);
+	const uint64_t blockRebuilds = meshes.GetRebuildCount() - rebuildsBeforeBlocks;
+	const uint64_t blockNotified = map.GetStats().changedChunkCount - changedBeforeBlocks;
+	bool blockOk = rebuildsMatchWalls && blockEdits > 0 && blockNotified > 0 && blockRebuilds == 0 && blockStaleCount == 0;
+
+	// 通知の前に捨てたチャンクは、読み込み直したときに書き換え後のタイルで作られる
+	ChunkedTileMap streamed;
+	streamed.Reset(std::make_unique<MapDataChunkSource>(GenerateMap(4096, 64)), 64 * 1024);
+	MeshListener streamedMeshes(streamed.GetChunkCountX(), streamed.GetHeight());
+	streamed.AddListener(&streamedMeshes);
+	streamed.Stream(2000, 32, 48, 32);
+	streamed.Set(5, 40, streamed.Get(5, 40) == kTileWall ? kTileEmpty : kTileWall);
+	for (int32_t centerX = 2000; centerX <= 4000; centerX += 16) {
+		streamed.Stream(centerX, 32, 48, 32); // 予算いっぱいになり、書き換えたチャンクも捨てる
+	}
+	bool evictedBeforeFlush = !streamed.IsResident(0, 1);
+	streamed.FlushChanges();
+	streamed.Stream(40, 32, 48, 32);
+	size_t streamedStaleCount = streamedMeshes.CountStaleMeshes(streamed);
+	bool streamedOk = evictedBeforeFlush && streamedMeshes.GetRebuildCount() == 0 && streamedStaleCount == 0;
+
+	TimingSummary full = Summarize(fullSamples);
+	TimingSummary flush = Summarize(flushSamples);
+	std::sort(flushSamples.begin(), flushSamples.end());
+	double flushP99 = flushSamples[flushSamples.size() * 99 / 100];
+	double editedFrames = static_cast<double>(frames);
+	std::printf("remesh (%dx%d tiles, %dx%d chunks, %d frames, %d cells per frame + a full column every 500)\n",
+		width, height, map.GetChunkCountX(), map.GetChunkCountY(), frames, editsPerFrame * 2);
+	std::printf("  Set           %7.1f ns per edit (%llu edits, %llu changed a tile)\n",
+		setSeconds / static_cast<double>(setCount) * 1e9, static_cast<unsigned long long>(setCount),
+		static_cast<unsigned long long>(stats.editCount));
+	std::printf("  flush         median %7.3f us  p99 %7.3f us  max %7.3f us per frame\n",
+		flush.median * 1e6, flushP99 * 1e6, flushSamples.back() * 1e6);
+	std::printf("  rebuilds      %llu chunks (%.2f per frame, %.3f us each), %llu twice in one flush\n",
+		static_cast<unsigned long long>(meshes.GetRebuildCount()),
+		static_cast<double>(meshes.GetRebuildCount()) / editedFrames,
+		meshes.GetRebuildSeconds() / static_cast<double>(std::max<uint64_t>(meshes.GetRebuildCount(), 1)) * 1e6,
+		static_cast<unsigned long long>(meshes.GetDuplicateCount()));
+	std::printf("  cost per edit %7.3f us (Set + share of the rebuild)\n",
+		(setSeconds + flush.mean * editedFrames) / static_cast<double>(std::max<uint64_t>(stats.editCount, 1)) * 1e6);
+	std::printf("  full rebuild  %7.3f us per frame (%d chunks) -> incremental is %.1fx faster\n",
+		full.median * 1e6, map.GetChunkCountX() * map.GetChunkCountY(), full.median / std::max(flush.mean, 1e-12));
+	std::printf("  minimap       %llu tiles copied for %llu edits\n",
+		static_cast<unsigned long long>(minimap.GetCopiedTiles()), static_cast<unsigned long long>(stats.editCount));
+	std::printf("  block only    %llu kTileBlock edits notified %llu chunks, %llu rebuilds, stale meshes %llu -> %s\n",
+		static_cast<unsigned long long>(blockEdits), static_cast<unsigned long long>(blockNotified),
+		static_cast<unsigned long long>(blockRebuilds), static_cast<unsigned long long>(blockStaleCount), blockOk ? "ok" : "FAILED");
+	std::printf("  verify        stale meshes %llu, minimap mismatches %llu, evicted-before-flush %s\n",
+		static_cast<unsigned long long>(staleCount), static_cast<unsigned long long>(minimapMismatchCount),
+		streamedOk ? "ok" : "FAILED");
+
+	bool ok = staleCount == 0 && minimapMismatchCount == 0 && meshes.GetDuplicateCount() == 0 && streamedOk && blockOk;
+	return ok ? 0 : 1;
+}
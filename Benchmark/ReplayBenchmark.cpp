@@ -0,0 +1,194 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "ScriptedInput.h"
+#include "../GameSimulation.h"
+#include "../InputReplay.h"
+#include <cstdio>
+#include <random>
+#include <string>
+
+namespace {
+
+// source の操作で ticks ティック遊んだ記録
+InputRecording Record(InputSource* source, int ticks) {
+	GameSimulation simulation;
+	InputRecorder recorder(source);
+	simulation.SetInputSource(&recorder);
+	for (int tick = 0; tick < ticks; ++tick) {
+		simulation.Step();
+		recorder.RecordState(simulation.ComputeStateHash());
+	}
+	return recorder.GetRecording();
+}
+
+struct ReplayResult {
+	int64_t divergedTick = -1;
+	size_t ticks = 0;
+	double seconds = 0.0;
+	std::string lastError;
+};
+
+ReplayResult Replay(const InputRecording& recording) {
+	ReplayResult result;
+	GameSimulation simulation;
+	InputReplayer replayer(&recording);
+	simulation.SetInputSource(&replayer);
+	Stopwatch stopwatch;
+	while (!replayer.IsFinished()) {
+		simulation.Step();
+		if (!replayer.VerifyState(simulation.ComputeStateHash())) {
+			break;
+		}
+	}
+	result.seconds = stopwatch.GetSeconds();
+	result.divergedTick = replayer.GetDivergedTick();
+	result.ticks = replayer.GetTick();
+	result.lastError = simulation.GetLastError();
+	return result;
+}
+
+// 2つのボタン列で並べて回し、状態のハッシュが最初に違ったティック (同じなら -1)
+int64_t FindFirstDifference(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+	GameSimulation left;
+	GameSimulation right;
+	for (size_t tick = 0; tick < a.size(); ++tick) {
+		left.Step(a[tick]);
+		right.Step(b[tick]);
+		if (left.ComputeStateHash() != right.ComputeStateHash()) {
+			return static_cast<int64_t>(tick);
+		}
+	}
+	return -1;
+}
+
+void PrintSize(const InputRecording& recording, size_t bytes) {
+	size_t runs = 0;
+	for (size_t i = 0; i < recording.buttons.size(); ++i) {
+		runs += (i == 0 || recording.buttons[i] != recording.buttons[i - 1]) ? 1 : 0;
+	}
+	const double minutes = recording.GetTickCount() / 60.0 / 60.0;
+	const size_t hashBytes = recording.hashBytes.size() + sizeof(uint64_t) * recording.checkpoints.size();
+	std::printf("  %zu ticks, %zu button runs: %zu bytes (%.0f bytes/min; buttons %zu, hashes %zu, raw buttons would be %zu)\n",
+		recording.GetTickCount(), runs, bytes, bytes / minutes, bytes - hashBytes - sizeof(ReplayHeader), hashBytes,
+		recording.GetTickCount());
+}
+
+int RecordToFile(const std::string& path, int ticks, uint32_t seed) {
+	ScriptedInput input(seed);
+	InputRecording recording = Record(&input, ticks);
+	if (!WriteInputRecording(path, recording)) {
+		std::printf("FAIL: cannot write %s\n", path.c_str());
+		return 1;
+	}
+	std::printf("recorded %s (seed %u)\n", path.c_str(), seed);
+	PrintSize(recording, SerializeInputRecording(recording).size());
+	return 0;
+}
+
+int VerifyFile(const std::string& path) {
+	InputRecording recording;
+	std::string errorMessage;
+	if (!ReadInputRecording(path, recording, &errorMessage)) {
+		std::printf("FAIL: %s: %s\n", path.c_str(), errorMessage.c_str());
+		return 1;
+	}
+	ReplayResult result = Replay(recording);
+	if (!result.lastError.empty()) {
+		std::printf("FAIL: %s (run from the game's directory)\n", result.lastError.c_str());
+		return 1;
+	}
+	if (result.divergedTick >= 0) {
+		std::printf("FAIL: %s diverged at tick %lld of %zu\n", path.c_str(), static_cast<long long>(result.divergedTick),
+			recording.GetTickCount());
+		return 1;
+	}
+	std::printf("%s: %zu ticks replayed bit-exactly in %.3f s\n", path.c_str(), result.ticks, result.seconds);
+	return 0;
+}
+
+} // namespace
+
+int RunReplayBenchmark(int argc, char* argv[]) {
+	const int ticks = FindIntOption(argc, argv, "--ticks", 36000);
+	const uint32_t seed = static_cast<uint32_t>(FindIntOption(argc, argv, "--seed", 1));
+	const int trials = FindIntOption(argc, argv, "--trials", 50);
+	const std::string recordPath = FindOption(argc, argv, "--record", "");
+	const std::string verifyPath = FindOption(argc, argv, "--verify", "");
+	if (!recordPath.empty()) {
+		return RecordToFile(recordPath, ticks, seed);
+	}
+	if (!verifyPath.empty()) {
+		return VerifyFile(verifyPath);
+	}
+
+	int failures = 0;
+
+	// 1. ボットの操作を記録し、ファイルの形に書いて読み戻す
+	ScriptedInput input(seed);
+	Stopwatch stopwatch;
+	InputRecording recording = Record(&input, ticks);
+	const double recordSeconds = stopwatch.GetSeconds();
+	std::string bytes = SerializeInputRecording(recording);
+	InputRecording loaded;
+	std::string errorMessage;
+	bool roundTrip = ParseInputRecording(bytes, loaded, &errorMessage) && loaded.buttons == recording.buttons &&
+		loaded.hashBytes == recording.hashBytes && loaded.checkpoints == recording.checkpoints && loaded.finalHash == recording.finalHash;
+	failures += roundTrip ? 0 : 1;
+	std::printf("record %d ticks (seed %u) in %.3f s, file round trip %s\n", ticks, seed, recordSeconds, roundTrip ? "ok" : "FAIL");
+	PrintSize(recording, bytes.size());
+
+	// 壊れたファイルは読まない
+	int rejected = 0;
+	const size_t cuts[] = { 0, sizeof(ReplayHeader) - 1, sizeof(ReplayHeader) + 3, bytes.size() - 1 };
+	for (size_t cut : cuts) {
+		rejected += ParseInputRecording(std::string_view(bytes).substr(0, cut), loaded) ? 0 : 1;
+	}
+	failures += rejected == 4 ? 0 : 1;
+	std::printf("  truncated files rejected: %d / 4\n", rejected);
+
+	// 2. 読み戻した記録を再生し、最後まで同じ状態をたどるか
+	ReplayResult replay = Replay(loaded);
+	if (!replay.lastError.empty()) {
+		std::printf("FAIL: %s (run from the game's directory)\n", replay.lastError.c_str());
+		return 1;
+	}
+	bool exact = replay.divergedTick < 0 && replay.ticks == recording.GetTickCount();
+	failures += exact ? 0 : 1;
+	std::printf("replay: %zu ticks in %.3f s (%.0f ticks/s with hashing), %s\n", replay.ticks, replay.seconds,
+		replay.ticks / replay.seconds, exact ? "bit-exact" : "DIVERGED");
+
+	// 3. 1ティックだけボタンを変えた記録を再生し、ずれを見つけたティックが本当にずれ始めたティックか
+	std::mt19937 random(seed + 1);
+	std::uniform_int_distribution<int> tickDistribution(0, ticks - 1);
+	std::uniform_int_distribution<int> buttonDistribution(1, 31);
+	int exactTicks = 0;
+	int noEffect = 0;
+	int late = 0;
+	for (int trial = 0; trial < trials; ++trial) {
+		InputRecording tampered = recording;
+		int tick = tickDistribution(random);
+		tampered.buttons[tick] ^= static_cast<uint8_t>(buttonDistribution(random));
+		int64_t truth = FindFirstDifference(recording.buttons, tampered.buttons);
+		int64_t found = Replay(tampered).divergedTick;
+		if (truth < 0) {
+			// 状態が変わらない操作 (タイトルで射撃など) は見つからなくてよい
+			++noEffect;
+			failures += found < 0 ? 0 : 1;
+		} else if (found == truth) {
+			++exactTicks;
+		} else if (found > truth) {
+			// 下位8ビットが偶然一致したときだけ遅れる (1/256)
+			++late;
+			std::printf("  tampered tick %d: state diverged at %lld, detected at %lld\n", tick, static_cast<long long>(truth),
+				static_cast<long long>(found));
+		} else {
+			++failures;
+			std::printf("  FAIL tampered tick %d: state diverged at %lld, detected at %lld\n", tick, static_cast<long long>(truth),
+				static_cast<long long>(found));
+		}
+	}
+	std::printf("tamper %d random ticks: detected at the exact tick %d, later %d, no state change %d\n", trials, exactTicks, late, noEffect);
+
+	std::printf("%s\n", failures == 0 ? "all checks passed" : "FAILED");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../RingAllocator.h"
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace {
+
+const uint64_t kAlignment = RingAllocator::kConstantBufferAlignment;
+
+struct Range {
+	uint64_t offset;
+	uint64_t size;
+};
+
+bool Overlaps(const Range& a, const Range& b) {
+	return a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+}
+
+// ConstantBufferAllocator と同じ使い方で回す: フレームの始めに完了したフェンスまでを返し、描画ごとに切り出し、終わりにフェンスを打つ
+// GPU は framesInFlight フレーム遅れて終わる。まだ GPU が読んでいるフレームの領域に重ねて切り出したら失敗
+struct FrameSimulation {
+	int64_t allocations = 0;
+	int64_t misaligned = 0;
+	int64_t outOfBounds = 0;
+	int64_t overlaps = 0;
+	int64_t wraps = 0;
+	int64_t failedAllocations = 0;
+	uint64_t peakUsed = 0;
+};
+
+FrameSimulation RunFrames(RingAllocator& ring, int frames, int framesInFlight, int drawsPerFrame, uint32_t seed) {
+	FrameSimulation result;
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int> drawDistribution(drawsPerFrame / 2, drawsPerFrame);
+	std::uniform_int_distribution<int> sizeDistribution(16, 700);
+	std::deque<std::vector<Range>> inFlight; // GPU がまだ終えていないフレームの確保 (古い順)
+	uint64_t fenceValue = 0;
+	uint64_t previousOffset = 0;
+	for (int frame = 0; frame < frames; ++frame) {
+		// GPU は framesInFlight フレーム前までを終えている
+		uint64_t completed = fenceValue > static_cast<uint64_t>(framesInFlight) ? fenceValue - framesInFlight : 0;
+		ring.ReleaseCompletedFrames(completed);
+		while (inFlight.size() > static_cast<size_t>(framesInFlight)) {
+			inFlight.pop_front();
+		}
+
+		std::vector<Range> current;
+		int draws = drawDistribution(random);
+		for (int draw = 0; draw < draws; ++draw) {
+			uint64_t size = static_cast<uint64_t>(sizeDistribution(random));
+			uint64_t offset = ring.Allocate(size, kAlignment);
+			if (offset == RingAllocator::kInvalidOffset) {
+				++result.failedAllocations;
+				continue;
+			}
+			++result.allocations;
+			Range range{ offset, size };
+			result.misaligned += offset % kAlignment != 0 ? 1 : 0;
+			result.outOfBounds += offset + size > ring.GetCapacity() ? 1 : 0;
+			result.wraps += (result.allocations > 1 && offset < previousOffset) ? 1 : 0;
+			previousOffset = offset;
+			for (const std::vector<Range>& ranges : inFlight) {
+				for (const Range& other : ranges) {
+					result.overlaps += Overlaps(range, other) ? 1 : 0;
+				}
+			}
+			for (const Range& other : current) {
+				result.overlaps += Overlaps(range, other) ? 1 : 0;
+			}
+			current.push_back(range);
+		}
+		ring.FinishFrame(++fenceValue);
+		inFlight.push_back(std::move(current));
+	}
+	result.peakUsed = ring.GetPeakUsedSize();
+	return result;
+}
+
+} // namespace
+
+int RunRingAllocatorBenchmark(int argc, char* argv[]) {
+	const int frames = FindIntOption(argc, argv, "--frames", 20000);
+	const int draws = FindIntOption(argc, argv, "--draws", 120);
+	const uint64_t capacity = static_cast<uint64_t>(FindIntOption(argc, argv, "--capacity-kb", 256)) * 1024;
+	int failures = 0;
+
+	// 1. 描画が多いフレームを GPU が2フレーム遅れて終える流れで、境界・範囲・重なりを確かめる
+	{
+		RingAllocator ring;
+		ring.Initialize(capacity);
+		FrameSimulation result = RunFrames(ring, frames, 2, draws, 1);
+		bool ok = result.misaligned == 0 && result.outOfBounds == 0 && result.overlaps == 0 && result.failedAllocations == 0 &&
+			result.wraps > 0;
+		failures += ok ? 0 : 1;
+		std::printf("%d frames, up to %d draws, 2 frames in flight, %llu KiB ring: %lld allocations, %lld wrap-arounds, peak %llu B\n",
+			frames, draws, static_cast<unsigned long long>(capacity / 1024), static_cast<long long>(result.allocations),
+			static_cast<long long>(result.wraps), static_cast<unsigned long long>(result.peakUsed));
+		std::printf("  misaligned %lld, out of bounds %lld, overlapping a frame in flight %lld, failed %lld -> %s\n",
+			static_cast<long long>(result.misaligned), static_cast<long long>(result.outOfBounds), static_cast<long long>(result.overlaps),
+			static_cast<long long>(result.failedAllocations), ok ? "ok" : "FAILED");
+	}
+
+	// 2. GPU が止まっていれば、いっぱいになったところで断り、まだ読まれている領域には書かない
+	{
+		RingAllocator ring;
+		ring.Initialize(16 * kAlignment);
+		int granted = 0;
+		for (int frame = 1; frame <= 4; ++frame) {
+			for (int draw = 0; draw < 8; ++draw) {
+				granted += ring.Allocate(100, kAlignment) != RingAllocator::kInvalidOffset ? 1 : 0;
+			}
+			ring.FinishFrame(frame);
+		}
+		// 16 枠のうち 16 個まで。残りは GPU を待つしかない
+		bool refused = granted == 16 && ring.GetUsedSize() <= ring.GetCapacity() && ring.GetPendingFrameCount() == 4;
+
+		// フェンス 1 が終わったら、フレーム 1 の分 (8 枠) だけ返る
+		ring.ReleaseCompletedFrames(1);
+		bool releasedOne = ring.GetPendingFrameCount() == 3 && ring.GetUsedSize() == 8 * kAlignment;
+		int regranted = 0;
+		while (ring.Allocate(100, kAlignment) != RingAllocator::kInvalidOffset) {
+			++regranted;
+		}
+		ring.FinishFrame(5);
+		// 全部終われば空に戻る
+		ring.ReleaseCompletedFrames(5);
+		bool drained = ring.GetPendingFrameCount() == 0 && ring.GetUsedSize() == 0;
+		bool ok = refused && releasedOne && regranted == 8 && drained;
+		failures += ok ? 0 : 1;
+		std::printf("stalled GPU: granted %d of 32 into 16 slots, after fence 1 released %s, regranted %d, drained %s -> %s\n", granted,
+			releasedOne ? "one frame" : "WRONG", regranted, drained ? "yes" : "no", ok ? "ok" : "FAILED");
+	}
+
+	// 3. 容量を超える・大きさ 0 の確保は断る
+	{
+		RingAllocator ring;
+		ring.Initialize(4 * kAlignment);
+		bool ok = ring.Allocate(4 * kAlignment + 1, kAlignment) == RingAllocator::kInvalidOffset &&
+			ring.Allocate(0, kAlignment) == RingAllocator::kInvalidOffset && ring.Allocate(4 * kAlignment, kAlignment) == 0 &&
+			ring.Allocate(1, kAlignment) == RingAllocator::kInvalidOffset;
+		failures += ok ? 0 : 1;
+		std::printf("out of memory (kInvalidOffset) for oversized, empty and full requests: %s\n", ok ? "ok" : "FAILED");
+	}
+
+	// 4. 切り出しの費用 (1フレームに draws 個、GPU は2フレーム遅れ)
+	{
+		RingAllocator ring;
+		ring.Initialize(capacity);
+		int64_t allocations = 0;
+		Stopwatch stopwatch;
+		for (int frame = 1; frame <= frames; ++frame) {
+			ring.ReleaseCompletedFrames(frame > 2 ? static_cast<uint64_t>(frame - 2) : 0);
+			for (int draw = 0; draw < draws; ++draw) {
+				allocations += ring.Allocate(static_cast<uint64_t>(64 + (draw & 7) * 64), kAlignment) != RingAllocator::kInvalidOffset ? 1 : 0;
+			}
+			ring.FinishFrame(frame);
+		}
+		double seconds = stopwatch.GetSeconds();
+		std::printf("%.1f ns per allocation (%lld allocations)\n", seconds * 1e9 / static_cast<double>(allocations),
+			static_cast<long long>(allocations));
+	}
+
+	std::printf("%s\n", failures == 0 ? "all checks passed" : "FAILED");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "../GameInput.h"
+#include <cstdint>
+#include <random>
+
+// 決まった手順で動かすボット (種が同じなら毎回同じボタンを押す)
+// 大体は右へ進み、ときどき向きを変え、ジャンプ・射撃・ローリングを混ぜる。
+// ジャンプはタイトル・ゲームオーバー・死亡後のリトライも兼ねる
+class ScriptedInput : public InputSource {
+public:
+	explicit ScriptedInput(uint32_t seed) : random_(seed) {}
+
+	uint8_t PollButtons() override {
+		if (holdTicks_ <= 0) {
+			std::uniform_int_distribution<int> percent(0, 99);
+			std::uniform_int_distribution<int> hold(4, 40);
+			int roll = percent(random_);
+			buttons_ = roll < 70 ? kButtonRight : (roll < 85 ? kButtonLeft : 0);
+			if (percent(random_) < 50) buttons_ |= kButtonJump;
+			if (percent(random_) < 20) buttons_ |= kButtonShoot;
+			if (percent(random_) < 10) buttons_ |= kButtonRoll;
+			holdTicks_ = hold(random_);
+		}
+		--holdTicks_;
+		// 押しっぱなしだとジャンプ・射撃が1回しか出ないので、ときどき離す
+		if (holdTicks_ % 8 == 0) {
+			return static_cast<uint8_t>(buttons_ & (kButtonLeft | kButtonRight));
+		}
+		return buttons_;
+	}
+
+private:
+	std::mt19937 random_;
+	uint8_t buttons_ = 0;
+	int holdTicks_ = 0;
+};
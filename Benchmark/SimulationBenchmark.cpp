@@ -0,0 +1,209 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../FixedTimestep.h"
+#include "../GameSimulation.h"
+#include "ScriptedInput.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace {
+
+struct RunResult {
+	double seconds = 0.0;
+	// プレイヤーの位置とシーンを毎ティック畳み込んだ値 (2回の実行の比較用)
+	uint64_t trajectory = 14695981039346656037ull;
+	uint32_t mapLoads = 0;
+	uint32_t deaths = 0;
+	uint32_t clears = 0;
+	int64_t playTicks = 0;
+	std::string lastError;
+};
+
+void Fold(uint64_t& hash, uint32_t value) {
+	for (int i = 0; i < 4; ++i) {
+		hash ^= (value >> (i * 8)) & 0xFF;
+		hash *= 1099511628211ull;
+	}
+}
+
+uint32_t FloatBits(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+RunResult Run(int ticks, uint32_t seed) {
+	RunResult result;
+	GameSimulation simulation;
+	ScriptedInput input(seed);
+	simulation.SetInputSource(&input);
+
+	bool wasAlive = false;
+	Stopwatch stopwatch;
+	for (int tick = 0; tick < ticks; ++tick) {
+		GameScene previousScene = simulation.GetScene();
+		simulation.Step();
+		if (!simulation.GetLastError().empty()) {
+			result.lastError = simulation.GetLastError();
+			break;
+		}
+
+		GameScene scene = simulation.GetScene();
+		Fold(result.trajectory, static_cast<uint32_t>(scene));
+		if (previousScene == GameScene::GamePlay && scene == GameScene::GameClear) {
+			++result.clears;
+		}
+		const Player* player = simulation.IsPlaying() ? simulation.GetPlayer() : nullptr;
+		if (player) {
+			++result.playTicks;
+			Fold(result.trajectory, FloatBits(player->GetPosition().x));
+			Fold(result.trajectory, FloatBits(player->GetPosition().y));
+			if (wasAlive && !player->IsAlive()) {
+				++result.deaths;
+			}
+			wasAlive = player->IsAlive();
+		} else {
+			wasAlive = false;
+		}
+	}
+	result.seconds = stopwatch.GetSeconds();
+	result.mapLoads = simulation.GetMapLoadCount();
+	return result;
+}
+
+// 画面の更新間隔の決め方 (1フレームの秒数を返す)
+struct FramePattern {
+	const char* name;
+	double baseSeconds;
+	double jitterSeconds; // 0..jitter を足す
+	double hitchSeconds;  // 2秒ごとに1回、このフレームだけ長くなる (0 ならなし)
+	bool expectExact;     // 経過時間とティック数が合うはずか
+};
+
+const FramePattern kFramePatterns[] = {
+	{ "30 Hz", 1.0 / 30.0, 0.0, 0.0, true },
+	{ "60 Hz", 1.0 / 60.0, 0.0, 0.0, true },
+	{ "144 Hz", 1.0 / 144.0, 0.0, 0.0, true },
+	{ "240 Hz", 1.0 / 240.0, 0.0, 0.0, true },
+	{ "jitter 4-40 ms", 0.004, 0.036, 0.0, true },
+	{ "60 Hz + 0.5 s hitch", 1.0 / 60.0, 0.0, 0.5, false },
+};
+
+// 一定の速さ (1ティックに 0.1) で動くものを描いたときの、フレームごとの移動量のばらつき (変動係数)
+// 補間しなければ 144Hz では「動かないフレーム」が混ざってがたつく
+double StepVariation(const std::vector<double>& positions, double frameSeconds) {
+	std::vector<double> speeds;
+	for (size_t i = 1; i < positions.size(); ++i) {
+		speeds.push_back((positions[i] - positions[i - 1]) / frameSeconds);
+	}
+	double mean = 0.0;
+	for (double speed : speeds) mean += speed;
+	mean /= static_cast<double>(speeds.size());
+	double variance = 0.0;
+	for (double speed : speeds) variance += (speed - mean) * (speed - mean);
+	variance /= static_cast<double>(speeds.size());
+	return mean > 0.0 ? std::sqrt(variance) / mean : 0.0;
+}
+
+// 画面の更新間隔を変えて FixedTimestep に時間を渡し、ティック数・補間の割合・動きの滑らかさを見る
+int CheckFramePacing(uint32_t seed) {
+	const double kWallSeconds = 20.0;
+	const double kSpeedPerTick = 0.1;
+	int failures = 0;
+	std::printf("frame pacing (%.0f s of wall time each):\n", kWallSeconds);
+	for (const FramePattern& pattern : kFramePatterns) {
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<double> jitter(0.0, pattern.jitterSeconds);
+		FixedTimestep timestep;
+		double wallTime = 0.0;
+		double nextHitch = 2.0;
+		int64_t frames = 0;
+		int32_t maxTicks = 0;
+		int64_t idleFrames = 0;
+		float minAlpha = 1.0f;
+		float maxAlpha = 0.0f;
+		// 定速で動くものの今のティックと前のティックの位置
+		double current = 0.0;
+		double previous = 0.0;
+		std::vector<double> snapped;
+		std::vector<double> interpolated;
+		while (wallTime < kWallSeconds) {
+			double frameSeconds = pattern.baseSeconds + (pattern.jitterSeconds > 0.0 ? jitter(random) : 0.0);
+			if (pattern.hitchSeconds > 0.0 && wallTime >= nextHitch) {
+				frameSeconds += pattern.hitchSeconds;
+				nextHitch += 2.0;
+			}
+			wallTime += frameSeconds;
+			int32_t ticks = timestep.Advance(frameSeconds);
+			for (int32_t i = 0; i < ticks; ++i) {
+				previous = current;
+				current += kSpeedPerTick;
+			}
+			float alpha = timestep.GetAlpha();
+			maxTicks = std::max(maxTicks, ticks);
+			idleFrames += ticks == 0 ? 1 : 0;
+			minAlpha = std::min(minAlpha, alpha);
+			maxAlpha = std::max(maxAlpha, alpha);
+			snapped.push_back(current);
+			// ゲームのものと同じく、最後の2ティックの間を補間する
+			interpolated.push_back(previous + (current - previous) * alpha);
+			++frames;
+		}
+
+		const int64_t expectedTicks = static_cast<int64_t>(wallTime / kTickSeconds);
+		const int64_t ticks = static_cast<int64_t>(timestep.GetTickCount());
+		bool ok = minAlpha >= 0.0f && maxAlpha < 1.0f && maxTicks <= 5;
+		if (pattern.expectExact) {
+			ok = ok && std::llabs(ticks - expectedTicks) <= 1 && timestep.GetDroppedTickCount() == 0;
+		} else {
+			ok = ok && ticks + static_cast<int64_t>(timestep.GetDroppedTickCount()) >= expectedTicks - 1;
+		}
+		failures += ok ? 0 : 1;
+		// 一定間隔のパターンだけ滑らかさを比べる (揺らぎやひっかかりのあるものはフレームの長さ自体が違う)
+		std::string smoothness = "";
+		if (pattern.jitterSeconds == 0.0 && pattern.hitchSeconds == 0.0) {
+			char text[96];
+			std::snprintf(text, sizeof(text), "  step variation snapped %.2f interpolated %.2f",
+				StepVariation(snapped, pattern.baseSeconds), StepVariation(interpolated, pattern.baseSeconds));
+			smoothness = text;
+		}
+		std::printf("  %-20s frames %6lld ticks %5lld (expected %5lld) dropped %4llu max/frame %d idle frames %5lld alpha %.2f..%.2f%s%s\n",
+			pattern.name, static_cast<long long>(frames), static_cast<long long>(ticks), static_cast<long long>(expectedTicks),
+			static_cast<unsigned long long>(timestep.GetDroppedTickCount()), maxTicks, static_cast<long long>(idleFrames),
+			minAlpha, maxAlpha, smoothness.c_str(), ok ? "" : "  FAIL");
+	}
+	return failures;
+}
+
+} // namespace
+
+int RunSimulationBenchmark(int argc, char* argv[]) {
+	const int ticks = FindIntOption(argc, argv, "--ticks", 200000);
+	const uint32_t seed = static_cast<uint32_t>(FindIntOption(argc, argv, "--seed", 1));
+
+	std::printf("headless simulation: %d ticks (%.0f s of play at 60 Hz), seed %u\n", ticks, ticks / 60.0, seed);
+
+	// 同じボットで2回回し、毎ティックの状態が一致するかを見る
+	RunResult first = Run(ticks, seed);
+	if (!first.lastError.empty()) {
+		std::printf("FAIL: %s (run from the game's directory)\n", first.lastError.c_str());
+		return 1;
+	}
+	RunResult second = Run(ticks, seed);
+
+	std::printf("  play ticks %lld, map loads %u, deaths %u, clears %u\n",
+		static_cast<long long>(first.playTicks), first.mapLoads, first.deaths, first.clears);
+	const double seconds = std::min(first.seconds, second.seconds);
+	std::printf("  %.3f s, %.0f ticks/s, %.2f us/tick (%.0fx real time)\n",
+		seconds, ticks / seconds, seconds * 1e6 / ticks, ticks / 60.0 / seconds);
+
+	const bool deterministic = first.trajectory == second.trajectory && first.mapLoads == second.mapLoads;
+	std::printf("  repeat run: trajectory %016llx vs %016llx -> %s\n",
+		static_cast<unsigned long long>(first.trajectory), static_cast<unsigned long long>(second.trajectory),
+		deterministic ? "identical" : "DIFFERENT");
+
+	int pacingFailures = CheckFramePacing(seed);
+	return deterministic && pacingFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../SizeClassAllocator.h"
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Allocation = SizeClassAllocator::Allocation;
+
+// size と alignment に合うはずのブロックの大きさ (256 から 2 倍ずつ)
+uint64_t ExpectedBlockSize(uint64_t size, uint64_t alignment) {
+	uint64_t block = SizeClassAllocator::kMinBlockSize;
+	while (block < size || block < alignment) {
+		block *= 2;
+	}
+	return block;
+}
+
+// 生きている確保の中身を呼び出し側で数え直し、アロケータの統計・配置と比べる
+struct LiveSet {
+	std::vector<Allocation> allocations;
+	uint64_t requestedBytes = 0;
+	uint64_t reservedBytes = 0;
+	uint64_t dedicatedBytes = 0;
+
+	void Add(const Allocation& allocation) {
+		allocations.push_back(allocation);
+		requestedBytes += allocation.requestedSize;
+		reservedBytes += allocation.reservedSize;
+		dedicatedBytes += allocation.IsDedicated() ? allocation.reservedSize : 0;
+	}
+	Allocation Remove(size_t index) {
+		Allocation allocation = allocations[index];
+		allocations[index] = allocations.back();
+		allocations.pop_back();
+		requestedBytes -= allocation.requestedSize;
+		reservedBytes -= allocation.reservedSize;
+		dedicatedBytes -= allocation.IsDedicated() ? allocation.reservedSize : 0;
+		return allocation;
+	}
+	bool MatchesStats(const SizeClassAllocator& allocator) const {
+		return allocator.GetRequestedBytes() == requestedBytes && allocator.GetReservedBytes() == reservedBytes &&
+			allocator.GetLiveAllocationCount() == allocations.size() &&
+			allocator.GetCommittedBytes() == allocator.GetPageCount() * SizeClassAllocator::kPageSize + dedicatedBytes;
+	}
+	// 同じページで重なっている組の数 (ページごとに並べて隣どうしを比べる)
+	int64_t CountOverlaps() const {
+		std::map<std::pair<uint32_t, uint64_t>, uint64_t> blocks;
+		for (const Allocation& allocation : allocations) {
+			if (!allocation.IsDedicated()) {
+				blocks[{ allocation.page, allocation.offset }] = allocation.reservedSize;
+			}
+		}
+		int64_t overlaps = 0;
+		size_t pageBlocks = 0;
+		for (const Allocation& allocation : allocations) {
+			pageBlocks += allocation.IsDedicated() ? 0 : 1;
+		}
+		overlaps += static_cast<int64_t>(pageBlocks - blocks.size()); // 同じ先頭を2回渡した
+		for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+			auto next = std::next(it);
+			if (next != blocks.end() && next->first.first == it->first.first && it->first.second + it->second > next->first.second) {
+				++overlaps;
+			}
+		}
+		return overlaps;
+	}
+};
+
+} // namespace
+
+int RunSizeClassBenchmark(int argc, char* argv[]) {
+	const int operations = FindIntOption(argc, argv, "--operations", 200000);
+	const uint32_t seed = static_cast<uint32_t>(FindIntOption(argc, argv, "--seed", 1));
+	const int liveTarget = FindIntOption(argc, argv, "--live", 2000);
+	int failures = 0;
+
+	// 1. 大きさ・配置の混ざった確保と解放を繰り返し、丸め・配置・重なり・統計を毎回確かめる
+	{
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<int> percent(0, 99);
+		std::uniform_int_distribution<int> alignmentShift(0, 16); // 1 .. 64KiB
+		SizeClassAllocator allocator;
+		LiveSet live;
+		int64_t wrongSize = 0;
+		int64_t misplaced = 0;
+		int64_t statMismatches = 0;
+		int64_t overlaps = 0;
+		for (int operation = 0; operation < operations; ++operation) {
+			// 生きている確保が liveTarget 前後で増えたり減ったりする
+			bool allocate = percent(random) < (live.allocations.size() < static_cast<size_t>(liveTarget) ? 60 : 40);
+			if (allocate) {
+				// 定数バッファ程度の小さいものが多く、ときどきページより大きいもの
+				int kind = percent(random);
+				uint64_t size = kind < 70 ? 1 + random() % 512 : (kind < 97 ? 1 + random() % SizeClassAllocator::kPageSize :
+					SizeClassAllocator::kPageSize + 1 + random() % (3 * SizeClassAllocator::kPageSize));
+				uint64_t alignment = uint64_t(1) << alignmentShift(random);
+				Allocation allocation = allocator.Allocate(size, alignment);
+				if (size > SizeClassAllocator::kPageSize) {
+					uint64_t expected = (size + SizeClassAllocator::kPageSize - 1) / SizeClassAllocator::kPageSize * SizeClassAllocator::kPageSize;
+					wrongSize += (!allocation.IsDedicated() || allocation.reservedSize != expected) ? 1 : 0;
+				} else {
+					wrongSize += (allocation.IsDedicated() || allocation.reservedSize != ExpectedBlockSize(size, alignment) ||
+						SizeClassAllocator::GetBlockSize(allocation.sizeClass) != allocation.reservedSize) ? 1 : 0;
+					misplaced += (allocation.offset % alignment != 0 || allocation.offset % allocation.reservedSize != 0 ||
+						allocation.offset + allocation.reservedSize > SizeClassAllocator::kPageSize ||
+						allocation.page >= allocator.GetPageCount()) ? 1 : 0;
+				}
+				wrongSize += allocation.requestedSize != size ? 1 : 0;
+				live.Add(allocation);
+			} else {
+				size_t index = static_cast<size_t>(random() % live.allocations.size());
+				allocator.Free(live.Remove(index));
+			}
+			statMismatches += live.MatchesStats(allocator) ? 0 : 1;
+			if (operation % 1000 == 0) {
+				overlaps += live.CountOverlaps();
+			}
+		}
+		overlaps += live.CountOverlaps();
+		const uint32_t peakPages = allocator.GetPageCount();
+		const double efficiency = live.reservedBytes > 0 ? static_cast<double>(live.requestedBytes) / live.reservedBytes : 1.0;
+		while (!live.allocations.empty()) {
+			allocator.Free(live.Remove(live.allocations.size() - 1));
+		}
+		bool drained = allocator.GetLiveAllocationCount() == 0 && allocator.GetRequestedBytes() == 0 && allocator.GetReservedBytes() == 0 &&
+			allocator.GetCommittedBytes() == allocator.GetPageCount() * SizeClassAllocator::kPageSize;
+		bool ok = wrongSize == 0 && misplaced == 0 && statMismatches == 0 && overlaps == 0 && drained;
+		failures += ok ? 0 : 1;
+		std::printf("%d mixed operations (seed %u, about %d live): %u pages, requested/reserved %.2f at the end\n", operations, seed, liveTarget,
+			peakPages, efficiency);
+		std::printf("  wrong size class %lld, misplaced %lld, overlapping %lld, stats mismatched %lld, drained %s -> %s\n",
+			static_cast<long long>(wrongSize), static_cast<long long>(misplaced), static_cast<long long>(overlaps),
+			static_cast<long long>(statMismatches), drained ? "yes" : "no", ok ? "ok" : "FAILED");
+	}
+
+	// 2. 解放したブロックは同じサイズクラスで使い回し、ページは空きリストが尽きたときだけ増える
+	{
+		SizeClassAllocator allocator;
+		const uint64_t blockSize = 1024;
+		const uint64_t blocksPerPage = SizeClassAllocator::kPageSize / blockSize;
+		std::vector<Allocation> allocations;
+		for (uint64_t i = 0; i < blocksPerPage; ++i) {
+			allocations.push_back(allocator.Allocate(700, 256));
+		}
+		bool onePage = allocator.GetPageCount() == 1;
+		allocations.push_back(allocator.Allocate(700, 256));
+		bool secondPage = allocator.GetPageCount() == 2;
+
+		Allocation freed = allocations[5];
+		allocator.Free(freed);
+		Allocation reused = allocator.Allocate(1000, 16);
+		bool sameBlock = reused.page == freed.page && reused.offset == freed.offset && allocator.GetPageCount() == 2;
+
+		// 別のサイズクラスは空いたブロックを使わず、自分のページを取る
+		allocator.Free(allocations[6]);
+		Allocation other = allocator.Allocate(300, 256);
+		bool separateClass = other.reservedSize == 512 && allocator.GetPageCount() == 3;
+
+		bool ok = onePage && secondPage && sameBlock && separateClass;
+		failures += ok ? 0 : 1;
+		std::printf("free-list reuse: %llu x 1 KiB fills one page %s, next one reserves a page %s, freed block reused %s, other class takes its own page %s -> %s\n",
+			static_cast<unsigned long long>(blocksPerPage), onePage ? "yes" : "no", secondPage ? "yes" : "no", sameBlock ? "yes" : "no",
+			separateClass ? "yes" : "no", ok ? "ok" : "FAILED");
+	}
+
+	// 3. 大きさ 0 は確保しない
+	{
+		SizeClassAllocator allocator;
+		Allocation empty = allocator.Allocate(0, 256);
+		bool ok = !empty.IsValid() && allocator.GetLiveAllocationCount() == 0 && allocator.GetPageCount() == 0;
+		allocator.Free(empty);
+		ok = ok && allocator.GetLiveAllocationCount() == 0;
+		failures += ok ? 0 : 1;
+		std::printf("zero-sized request: %s\n", ok ? "not allocated" : "FAILED");
+	}
+
+	// 4. 確保と解放の費用 (ゲームの定数バッファ程度の大きさ)
+	{
+		SizeClassAllocator allocator;
+		std::vector<Allocation> allocations(1024);
+		Stopwatch stopwatch;
+		const int rounds = 200;
+		for (int round = 0; round < rounds; ++round) {
+			for (size_t i = 0; i < allocations.size(); ++i) {
+				allocations[i] = allocator.Allocate(64 + (i & 7) * 96, 256);
+			}
+			for (const Allocation& allocation : allocations) {
+				allocator.Free(allocation);
+			}
+		}
+		double seconds = stopwatch.GetSeconds();
+		std::printf("%.1f ns per allocate+free pair, %u pages\n", seconds * 1e9 / (static_cast<double>(rounds) * allocations.size()),
+			allocator.GetPageCount());
+	}
+
+	std::printf("%s\n", failures == 0 ? "all checks passed" : "FAILED");
+	return failures == 0 ? 0 : 1;
+}
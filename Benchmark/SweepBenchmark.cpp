@@ -0,0 +1,283 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../ChunkedTileMap.h"
+#include "../GameMap.h"
+#include "../MapFile.h"
+#include "../TileSweep.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+MapData CreateEmptyMap(int32_t width, int32_t height) {
+	MapData map;
+	map.width = width;
+	map.height = height;
+	map.tiles.assign(static_cast<size_t>(width) * height, kTileEmpty);
+	return map;
+}
+
+void SetTile(MapData& map, int32_t x, int32_t mapY) {
+	map.tiles[static_cast<size_t>(mapY) * map.width + x] = kTileWall;
+}
+
+// 箱がかかるタイルの範囲 (TileSweep と同じく、接しているだけの辺は含めない)
+void GetCoveredTiles(const WorldRect& box, int32_t mapHeight, int32_t& x0, int32_t& x1, int32_t& mapY0, int32_t& mapY1) {
+	const float kEpsilon = 1.0e-4f;
+	x0 = static_cast<int32_t>(std::floor(box.left / GameMap::kBlockSize + kEpsilon));
+	x1 = static_cast<int32_t>(std::ceil(box.right / GameMap::kBlockSize - kEpsilon)) - 1;
+	int32_t row0 = static_cast<int32_t>(std::floor(box.bottom / GameMap::kBlockSize + kEpsilon));
+	int32_t row1 = static_cast<int32_t>(std::ceil(box.top / GameMap::kBlockSize - kEpsilon)) - 1;
+	mapY0 = (mapHeight - 1) - row1;
+	mapY1 = (mapHeight - 1) - row0;
+}
+
+WorldRect Offset(const WorldRect& box, float t, const Vector2& delta) {
+	return { box.left + delta.x * t, box.bottom + delta.y * t, box.right + delta.x * t, box.top + delta.y * t };
+}
+
+// 総当たりの答え: 細かく刻んで動かし、動く前にかかっていなかった壁に最初にかかる時刻
+float ReferenceSweep(const ChunkedTileMap& map, const WorldRect& box, const Vector2& delta, int substeps) {
+	int32_t sx0, sx1, sy0, sy1;
+	GetCoveredTiles(box, map.GetHeight(), sx0, sx1, sy0, sy1);
+	for (int i = 1; i <= substeps; ++i) {
+		float t = static_cast<float>(i) / static_cast<float>(substeps);
+		int32_t x0, x1, y0, y1;
+		GetCoveredTiles(Offset(box, t, delta), map.GetHeight(), x0, x1, y0, y1);
+		for (int32_t mapY = y0; mapY <= y1; ++mapY) {
+			for (int32_t x = x0; x <= x1; ++x) {
+				bool atStart = x >= sx0 && x <= sx1 && mapY >= sy0 && mapY <= sy1;
+				if (!atStart && map.IsSolid(x, mapY)) {
+					return t;
+				}
+			}
+		}
+	}
+	return -1.0f;
+}
+
+// 掃引の結果の箱が、当たったタイルの面に接していて、そのまま進めば重なるか
+bool IsTouching(const ChunkedTileMap& map, const WorldRect& box, const Vector2& delta, const TileSweepResult& hit) {
+	if (!map.IsSolid(hit.tileX, hit.tileMapY)) {
+		return false;
+	}
+	const float kSlack = 1.0e-3f;
+	float tileLeft = static_cast<float>(hit.tileX) * GameMap::kBlockSize;
+	float tileBottom = static_cast<float>(map.GetHeight() - 1 - hit.tileMapY) * GameMap::kBlockSize;
+	float tileRight = tileLeft + GameMap::kBlockSize;
+	float tileTop = tileBottom + GameMap::kBlockSize;
+	// 面に沿う向きにはタイルと重なっている (SweepTileBox と同じく、触れるだけの幅は誤差として許す)
+	const float kGraze = 2.0e-4f * GameMap::kBlockSize;
+	bool overlaps = hit.normal.x != 0.0f ? box.bottom < tileTop + kGraze && box.top > tileBottom - kGraze :
+		box.left < tileRight + kGraze && box.right > tileLeft - kGraze;
+	// 法線に逆らって動いている
+	overlaps = overlaps && (hit.normal.x * delta.x + hit.normal.y * delta.y) < 0.0f;
+	// 法線の向きの辺がタイルの面の上にある
+	bool onFace = hit.normal.x < 0.0f ? std::abs(box.right - tileLeft) < kSlack :
+		hit.normal.x > 0.0f ? std::abs(box.left - tileRight) < kSlack :
+		hit.normal.y > 0.0f ? std::abs(box.bottom - tileTop) < kSlack : std::abs(box.top - tileBottom) < kSlack;
+	return overlaps && onFace;
+}
+
+// 旧 Player の方法: 1ステップ動かしてから、動いた先の辺だけを調べる
+bool LegacyProbe(const ChunkedTileMap& map, const WorldRect& box, const Vector2& delta) {
+	WorldRect moved = Offset(box, 1.0f, delta);
+	int32_t x0, x1, y0, y1;
+	GetCoveredTiles(moved, map.GetHeight(), x0, x1, y0, y1);
+	if (delta.x > 0.0f) {
+		return map.IsColumnSolid(x1, y0, y1);
+	}
+	if (delta.x < 0.0f) {
+		return map.IsColumnSolid(x0, y0, y1);
+	}
+	return map.IsSpanSolid(delta.y < 0.0f ? y1 : y0, x0, x1);
+}
+
+struct CaseResult {
+	int cases = 0;
+	int failures = 0;
+	int legacyTunneled = 0;
+};
+
+// 1. 厚さ1マスの壁・床を、1ステップで何十マスも進む速さで通り抜けようとする
+CaseResult RunThinWallCases() {
+	CaseResult result;
+	const int32_t kWidth = 128;
+	const int32_t kHeight = 96;
+	const int32_t kWallX = 60;
+	const int32_t kFloorMapY = 70;
+	MapData data = CreateEmptyMap(kWidth, kHeight);
+	for (int32_t mapY = 0; mapY < kHeight; ++mapY) {
+		SetTile(data, kWallX, mapY);
+	}
+	for (int32_t x = 0; x < kWidth; ++x) {
+		SetTile(data, x, kFloorMapY);
+	}
+	// 角だけが当たる1マスの壁 (斜めにちょうど角を通る)
+	SetTile(data, 20, 20);
+	ChunkedTileMap map;
+	LoadWholeMap(map, data);
+
+	const float kHalfSize = 0.2f; // Player と同じ
+	const float floorTop = static_cast<float>(kHeight - kFloorMapY) * GameMap::kBlockSize;
+	const float wallLeft = static_cast<float>(kWallX) * GameMap::kBlockSize;
+	for (float tilesPerTick = 0.25f; tilesPerTick <= 48.0f; tilesPerTick *= 1.5f) {
+		float speed = tilesPerTick * GameMap::kBlockSize;
+		for (int offset = 0; offset < 16; ++offset) {
+			float phase = static_cast<float>(offset) / 16.0f * GameMap::kBlockSize;
+
+			// 右へ: 壁の手前 0..1 マスから、壁を越える速さで
+			float startX = wallLeft - kHalfSize - 0.01f - phase;
+			float centerY = floorTop + 10.0f;
+			WorldRect box = { startX - kHalfSize, centerY - kHalfSize, startX + kHalfSize, centerY + kHalfSize };
+			TileSweepResult hit = SweepTileBox(map, GameMap::kBlockSize, box, { speed, 0.0f });
+			float expectedTime = (wallLeft - box.right) / speed;
+			bool reachable = expectedTime <= 1.0f;
+			++result.cases;
+			if (hit.hit != reachable || (reachable && (std::abs(hit.time - expectedTime) * speed > 1e-4f ||
+				hit.normal.x != -1.0f || hit.tileX != kWallX))) {
+				++result.failures;
+			}
+			if (reachable && !LegacyProbe(map, box, { speed, 0.0f })) {
+				++result.legacyTunneled;
+			}
+
+			// 下へ: 床の上から
+			float startY = floorTop + kHalfSize + 0.01f + phase;
+			box = { 10.0f - kHalfSize, startY - kHalfSize, 10.0f + kHalfSize, startY + kHalfSize };
+			hit = SweepTileBox(map, GameMap::kBlockSize, box, { 0.0f, -speed });
+			expectedTime = (box.bottom - floorTop) / speed;
+			reachable = expectedTime <= 1.0f;
+			++result.cases;
+			if (hit.hit != reachable || (reachable && (std::abs(hit.time - expectedTime) * speed > 1e-4f ||
+				hit.normal.y != 1.0f || hit.tileMapY != kFloorMapY))) {
+				++result.failures;
+			}
+			if (reachable && !LegacyProbe(map, box, { 0.0f, -speed })) {
+				++result.legacyTunneled;
+			}
+		}
+
+		// 斜め 45 度でちょうど1マスの壁の角へ (角を素通りしない)
+		float cornerX = 20.0f * GameMap::kBlockSize;
+		float cornerY = static_cast<float>(kHeight - 20) * GameMap::kBlockSize; // タイル (20, 20) の上端
+		WorldRect box = { cornerX - 1.0f, cornerY + 0.6f, cornerX - 0.6f, cornerY + 1.0f };
+		Vector2 delta = { speed / std::sqrt(2.0f), -speed / std::sqrt(2.0f) };
+		TileSweepResult hit = SweepTileBox(map, GameMap::kBlockSize, box, delta);
+		float expectedTime = 0.6f / delta.x;
+		++result.cases;
+		if (hit.hit != (expectedTime <= 1.0f) || (hit.hit && (std::abs(hit.time - expectedTime) * speed > 1e-4f ||
+			hit.tileX != 20 || hit.tileMapY != 20))) {
+			++result.failures;
+		}
+	}
+	return result;
+}
+
+// 2. ランダムな地形・箱・移動量を、細かく刻んだ総当たりと比べる
+CaseResult RunRandomCases(int count, uint32_t seed) {
+	CaseResult result;
+	std::mt19937 random(seed);
+	const int32_t kWidth = 96;
+	const int32_t kHeight = 64;
+	MapData data = CreateEmptyMap(kWidth, kHeight);
+	std::uniform_int_distribution<int32_t> percent(0, 99);
+	for (uint8_t& tile : data.tiles) {
+		tile = percent(random) < 12 ? kTileWall : kTileEmpty;
+	}
+	ChunkedTileMap map;
+	LoadWholeMap(map, data);
+
+	std::uniform_real_distribution<float> position(8.0f * GameMap::kBlockSize, 56.0f * GameMap::kBlockSize);
+	std::uniform_real_distribution<float> halfSize(0.03f * GameMap::kBlockSize, 0.9f * GameMap::kBlockSize);
+	std::uniform_real_distribution<float> move(-24.0f * GameMap::kBlockSize, 24.0f * GameMap::kBlockSize);
+	std::uniform_int_distribution<int> axis(0, 3);
+	for (int i = 0; i < count; ++i) {
+		float cx = position(random);
+		float cy = position(random);
+		float hx = halfSize(random);
+		float hy = halfSize(random);
+		WorldRect box = { cx - hx, cy - hy, cx + hx, cy + hy };
+		Vector2 delta = { move(random), move(random) };
+		// 軸に沿った動きも混ぜる (Player はこちら)
+		int kind = axis(random);
+		if (kind == 0) {
+			delta.y = 0.0f;
+		} else if (kind == 1) {
+			delta.x = 0.0f;
+		}
+		float lengthInTiles = std::max(std::abs(delta.x), std::abs(delta.y)) / GameMap::kBlockSize;
+		int substeps = static_cast<int>(lengthInTiles * 64.0f) + 1;
+
+		TileSweepResult hit = SweepTileBox(map, GameMap::kBlockSize, box, delta);
+		float reference = ReferenceSweep(map, box, delta, substeps);
+		bool referenceHit = reference >= 0.0f;
+		++result.cases;
+		// 総当たりより遅く当たる (= 飛び越す) のは失敗。早く当たるのは、刻みの間をかすめる壁を
+		// 総当たりが見落としたときだけなので、その時刻に本当に壁へ接しているかを確かめる
+		bool ok = true;
+		if (referenceHit && (!hit.hit || hit.time > reference + 1e-4f)) {
+			ok = false;
+		} else if (hit.hit) {
+			ok = IsTouching(map, Offset(box, hit.time, delta), delta, hit);
+		}
+		if (!ok) {
+			if (result.failures < 5) {
+				std::printf("  mismatch: box (%.9g %.9g %.9g %.9g) delta (%.9g %.9g) sweep %d %.5f reference %.5f\n",
+					box.left, box.bottom, box.right, box.top, delta.x, delta.y, hit.hit ? 1 : 0, hit.time, reference);
+			}
+			++result.failures;
+		}
+		if (referenceHit && (delta.x == 0.0f || delta.y == 0.0f) && !LegacyProbe(map, box, delta)) {
+			++result.legacyTunneled;
+		}
+	}
+	return result;
+}
+
+} // namespace
+
+int RunSweepBenchmark(int argc, char* argv[]) {
+	int count = FindIntOption(argc, argv, "--cases", 20000);
+	int iterations = FindIntOption(argc, argv, "--iterations", 1000000);
+
+	CaseResult thin = RunThinWallCases();
+	std::printf("thin walls   %5d cases (0.25..48 tiles per tick), failures %d, legacy probe tunneled %d\n",
+		thin.cases, thin.failures, thin.legacyTunneled);
+	CaseResult randomCases = RunRandomCases(count, 4242);
+	std::printf("random       %5d cases vs 1/64-tile reference, failures %d, legacy probe tunneled %d\n",
+		randomCases.cases, randomCases.failures, randomCases.legacyTunneled);
+
+	// Player と同じ大きさ・速さの掃引の費用
+	MapData data;
+	if (!LoadMapFile("Resources/map.csv", data, nullptr)) {
+		data = CreateEmptyMap(26, 15);
+	}
+	ChunkedTileMap map;
+	LoadWholeMap(map, data);
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> px(0.5f, static_cast<float>(data.width) * GameMap::kBlockSize - 0.5f);
+	std::uniform_real_distribution<float> py(0.5f, static_cast<float>(data.height) * GameMap::kBlockSize - 0.5f);
+	std::uniform_real_distribution<float> speed(-0.42f, 0.42f);
+	std::vector<WorldRect> boxes(1024);
+	std::vector<Vector2> deltas(1024);
+	for (size_t i = 0; i < boxes.size(); ++i) {
+		float x = px(random);
+		float y = py(random);
+		boxes[i] = { x - 0.2f, y - 0.2f, x + 0.2f, y + 0.2f };
+		deltas[i] = (i & 1) ? Vector2{ speed(random), 0.0f } : Vector2{ 0.0f, speed(random) };
+	}
+	Stopwatch stopwatch;
+	int hits = 0;
+	for (int i = 0; i < iterations; ++i) {
+		size_t k = static_cast<size_t>(i) & (boxes.size() - 1);
+		hits += SweepTileBox(map, GameMap::kBlockSize, boxes[k], deltas[k]).hit ? 1 : 0;
+	}
+	double seconds = stopwatch.GetSeconds();
+	std::printf("cost         %.1f ns per Player-sized sweep on map.csv (%d hits)\n", seconds / iterations * 1e9, hits);
+
+	return thin.failures == 0 && randomCases.failures == 0 ? 0 : 1;
+}
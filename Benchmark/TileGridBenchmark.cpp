@@ -0,0 +1,188 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../GameMap.h"
+#include "../ObjLoader.h"
+#include "../TileGrid.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Player の当たり判定の半分の大きさ
+const float kPlayerHalfSize = 0.2f;
+
+// 置き換え前の MapChip と同じ持ち方・判定 (比較用)
+class LegacyGrid {
+public:
+	std::vector<std::vector<int>> data;
+
+	bool CheckCollision(float worldX, float worldY) const {
+		int x = static_cast<int>(std::floor(worldX / GameMap::kBlockSize));
+		int y = static_cast<int>(std::floor(worldY / GameMap::kBlockSize));
+		int mapY = (static_cast<int>(data.size()) - 1) - y;
+		if (mapY < 0 || mapY >= static_cast<int>(data.size())) return false;
+		if (x < 0 || x >= static_cast<int>(data[mapY].size())) return false;
+		return data[mapY][x] == 1;
+	}
+};
+
+// 置き換え前の MapChip::Load と同じ CSV の読み方
+LegacyGrid LoadLegacyCsv(const std::string& text) {
+	LegacyGrid grid;
+	std::istringstream file(text);
+	std::string line;
+	while (std::getline(file, line)) {
+		std::vector<int> row;
+		std::string cell;
+		std::stringstream ss(line);
+		while (std::getline(ss, cell, ',')) {
+			row.push_back(std::stoi(cell));
+		}
+		grid.data.push_back(row);
+	}
+	return grid;
+}
+
+// 外周が壁で、中は density の割合で壁を置いた地図
+LegacyGrid GenerateLegacyGrid(int32_t width, int32_t height, float density) {
+	LegacyGrid grid;
+	std::mt19937 random(12345);
+	std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+	grid.data.assign(height, std::vector<int>(width, 0));
+	for (int32_t y = 0; y < height; ++y) {
+		for (int32_t x = 0; x < width; ++x) {
+			bool border = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+			grid.data[y][x] = (border || distribution(random) < density) ? 1 : 0;
+		}
+	}
+	return grid;
+}
+
+TileGrid ToTileGrid(const LegacyGrid& legacy) {
+	int32_t width = 0;
+	for (const std::vector<int>& row : legacy.data) {
+		width = std::max(width, static_cast<int32_t>(row.size()));
+	}
+	TileGrid grid;
+	grid.Resize(width, static_cast<int32_t>(legacy.data.size()));
+	for (size_t y = 0; y < legacy.data.size(); ++y) {
+		for (size_t x = 0; x < legacy.data[y].size(); ++x) {
+			grid.Set(static_cast<int32_t>(x), static_cast<int32_t>(y), static_cast<uint8_t>(legacy.data[y][x]));
+		}
+	}
+	return grid;
+}
+
+// GameMap と同じワールド座標 -> グリッド座標
+int WorldToGridX(float worldX) { return static_cast<int>(std::floor(worldX / GameMap::kBlockSize)); }
+int WorldToMapY(const TileGrid& grid, float worldY) { return (grid.GetHeight() - 1) - static_cast<int>(std::floor(worldY / GameMap::kBlockSize)); }
+
+// 地図の少し外側まで含めた乱数の位置
+std::vector<Vector2> GeneratePositions(const TileGrid& grid, size_t count) {
+	std::mt19937 random(67890);
+	std::uniform_real_distribution<float> x(-GameMap::kBlockSize, (grid.GetWidth() + 1) * GameMap::kBlockSize);
+	std::uniform_real_distribution<float> y(-GameMap::kBlockSize, (grid.GetHeight() + 1) * GameMap::kBlockSize);
+	std::vector<Vector2> positions(count);
+	for (Vector2& position : positions) {
+		position = { x(random), y(random) };
+	}
+	return positions;
+}
+
+void Run(const std::string& name, const LegacyGrid& legacy, size_t queryCount, int iterations) {
+	TileGrid grid = ToTileGrid(legacy);
+	std::vector<Vector2> positions = GeneratePositions(grid, queryCount);
+
+	// 点の判定
+	std::vector<double> legacyPointSamples;
+	std::vector<double> gridPointSamples;
+	size_t legacyHits = 0;
+	size_t gridHits = 0;
+	for (int i = 0; i < iterations; ++i) {
+		Stopwatch stopwatch;
+		legacyHits = 0;
+		for (const Vector2& position : positions) {
+			legacyHits += legacy.CheckCollision(position.x, position.y);
+		}
+		legacyPointSamples.push_back(stopwatch.GetSeconds());
+
+		stopwatch.Restart();
+		gridHits = 0;
+		for (const Vector2& position : positions) {
+			gridHits += grid.IsSolid(WorldToGridX(position.x), WorldToMapY(grid, position.y));
+		}
+		gridPointSamples.push_back(stopwatch.GetSeconds());
+	}
+
+	// Player::Update の床・天井・左右の判定 (旧: 角の点を8回 / 新: 辺の区間を4回)
+	std::vector<double> legacyPlayerSamples;
+	std::vector<double> gridPlayerSamples;
+	size_t legacyContacts = 0;
+	size_t gridContacts = 0;
+	for (int i = 0; i < iterations; ++i) {
+		Stopwatch stopwatch;
+		legacyContacts = 0;
+		for (const Vector2& p : positions) {
+			float left = p.x - kPlayerHalfSize;
+			float right = p.x + kPlayerHalfSize;
+			float top = p.y + kPlayerHalfSize;
+			float bottom = p.y - kPlayerHalfSize;
+			legacyContacts += legacy.CheckCollision(left, bottom) || legacy.CheckCollision(right, bottom);
+			legacyContacts += legacy.CheckCollision(left, top) || legacy.CheckCollision(right, top);
+			legacyContacts += legacy.CheckCollision(left, top - 0.05f) || legacy.CheckCollision(left, bottom + 0.05f);
+			legacyContacts += legacy.CheckCollision(right, top - 0.05f) || legacy.CheckCollision(right, bottom + 0.05f);
+		}
+		legacyPlayerSamples.push_back(stopwatch.GetSeconds());
+
+		stopwatch.Restart();
+		gridContacts = 0;
+		for (const Vector2& p : positions) {
+			int left = WorldToGridX(p.x - kPlayerHalfSize);
+			int right = WorldToGridX(p.x + kPlayerHalfSize);
+			int top = WorldToMapY(grid, p.y + kPlayerHalfSize);
+			int bottom = WorldToMapY(grid, p.y - kPlayerHalfSize);
+			int innerTop = WorldToMapY(grid, p.y + kPlayerHalfSize - 0.05f);
+			int innerBottom = WorldToMapY(grid, p.y - kPlayerHalfSize + 0.05f);
+			gridContacts += grid.IsSpanSolid(bottom, left, right);
+			gridContacts += grid.IsSpanSolid(top, left, right);
+			gridContacts += grid.IsColumnSolid(left, innerTop, innerBottom);
+			gridContacts += grid.IsColumnSolid(right, innerTop, innerBottom);
+		}
+		gridPlayerSamples.push_back(stopwatch.GetSeconds());
+	}
+
+	double count = static_cast<double>(queryCount);
+	TimingSummary legacyPoint = Summarize(legacyPointSamples);
+	TimingSummary gridPoint = Summarize(gridPointSamples);
+	TimingSummary legacyPlayer = Summarize(legacyPlayerSamples);
+	TimingSummary gridPlayer = Summarize(gridPlayerSamples);
+	std::printf("%s (%dx%d, %zu queries)\n", name.c_str(), grid.GetWidth(), grid.GetHeight(), queryCount);
+	std::printf("  point   legacy %6.2f ns  TileGrid %6.2f ns  %.2fx  %s\n",
+		legacyPoint.median * 1.0e9 / count, gridPoint.median * 1.0e9 / count, legacyPoint.median / gridPoint.median,
+		legacyHits == gridHits ? "same" : "MISMATCH");
+	std::printf("  player  legacy %6.2f ns  TileGrid %6.2f ns  %.2fx  %s\n",
+		legacyPlayer.median * 1.0e9 / count, gridPlayer.median * 1.0e9 / count, legacyPlayer.median / gridPlayer.median,
+		legacyContacts == gridContacts ? "same" : "MISMATCH");
+}
+
+} // namespace
+
+int RunTileGridBenchmark(int argc, char* argv[]) {
+	std::string path = FindOption(argc, argv, "--file", "Resources/map.csv");
+	int size = FindIntOption(argc, argv, "--size", 4096);
+	int queries = FindIntOption(argc, argv, "--queries", 4000000);
+	int iterations = FindIntOption(argc, argv, "--iterations", 5);
+
+	std::string text;
+	if (ReadFileToString(path, text)) {
+		Run(path, LoadLegacyCsv(text), static_cast<size_t>(queries), iterations);
+	} else {
+		std::printf("%s: missing\n", path.c_str());
+	}
+	Run("generated", GenerateLegacyGrid(size, size, 0.2f), static_cast<size_t>(queries), iterations);
+	return 0;
+}
@@ -0,0 +1,268 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../ChunkedTileMap.h"
+#include "../MapFile.h"
+#include "../TileMesher.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 作ったメッシュを面ごとにタイルへ戻し、どの面もちょうど1回ずつ覆っているかを確かめる
+// (手前の面は壁のマス全部、側面は隣が空いている辺だけ。UV の長さと巻き順も見る)
+bool VerifyTileMesh(const uint8_t* tiles, int32_t width, int32_t height, const TileMeshOptions& options,
+	const IndexedModelData& mesh, std::string& error) {
+	auto isSolid = [&](int32_t x, int32_t mapY) {
+		return x >= 0 && x < width && mapY >= 0 && mapY < height && tiles[static_cast<size_t>(mapY) * width + x] == kTileWall;
+	};
+	// 面の向き (手前, 上, 下, 左, 右) ごとにマスを覆った回数
+	const int kDirectionCount = 5;
+	std::vector<int> covered(static_cast<size_t>(width) * height * kDirectionCount, 0);
+	auto cover = [&](int direction, int32_t x, int32_t mapY) -> bool {
+		if (x < 0 || x >= width || mapY < 0 || mapY >= height) {
+			return false;
+		}
+		++covered[(static_cast<size_t>(mapY) * width + x) * kDirectionCount + direction];
+		return true;
+	};
+
+	const float s = options.blockSize;
+	auto toTileX = [&](float x) { return static_cast<int32_t>(std::lround((x - options.originX) / s)); };
+	auto toTileY = [&](float y) { return static_cast<int32_t>(std::lround((options.originY - y) / s)); };
+
+	if (mesh.vertices.size() % 4 != 0 || mesh.indices.size() != mesh.vertices.size() / 4 * 6) {
+		error = "not made of quads";
+		return false;
+	}
+	for (size_t quad = 0; quad < mesh.vertices.size() / 4; ++quad) {
+		const VertexData* v = &mesh.vertices[quad * 4];
+		const Vector3& normal = v[0].normal;
+
+		// 巻き順: 法線の側から見て時計回り
+		for (size_t t = 0; t < 2; ++t) {
+			const uint32_t* index = &mesh.indices[quad * 6 + t * 3];
+			const Vector4& a = mesh.vertices[index[0]].position;
+			const Vector4& b = mesh.vertices[index[1]].position;
+			const Vector4& c = mesh.vertices[index[2]].position;
+			float ex = b.x - a.x, ey = b.y - a.y, ez = b.z - a.z;
+			float fx = c.x - a.x, fy = c.y - a.y, fz = c.z - a.z;
+			float cx = ey * fz - ez * fy, cy = ez * fx - ex * fz, cz = ex * fy - ey * fx;
+			if (cx * normal.x + cy * normal.y + cz * normal.z <= 0.0f) {
+				error = "triangle " + std::to_string(quad * 2 + t) + " faces away from its normal";
+				return false;
+			}
+		}
+
+		float minX = v[0].position.x, maxX = minX, minY = v[0].position.y, maxY = minY;
+		float maxU = 0.0f, maxV = 0.0f;
+		for (int i = 0; i < 4; ++i) {
+			minX = std::min(minX, v[i].position.x);
+			maxX = std::max(maxX, v[i].position.x);
+			minY = std::min(minY, v[i].position.y);
+			maxY = std::max(maxY, v[i].position.y);
+			maxU = std::max(maxU, v[i].texcoord.x);
+			maxV = std::max(maxV, v[i].texcoord.y);
+		}
+		int32_t x0 = toTileX(minX), x1 = toTileX(maxX);
+		int32_t y0 = toTileY(maxY), y1 = toTileY(minY);
+
+		int direction = -1;
+		int32_t spanU = 0;
+		int32_t spanV = 0;
+		if (normal.z < -0.5f) {
+			direction = 0;
+			spanU = x1 - x0;
+			spanV = y1 - y0;
+			for (int32_t mapY = y0; mapY < y1; ++mapY) {
+				for (int32_t x = x0; x < x1; ++x) {
+					if (!cover(direction, x, mapY)) {
+						error = "front face outside the map";
+						return false;
+					}
+				}
+			}
+		} else if (normal.y > 0.5f || normal.y < -0.5f) {
+			direction = normal.y > 0.0f ? 1 : 2;
+			int32_t mapY = normal.y > 0.0f ? y0 : y0 - 1; // 上の面は行の上端、下の面は次の行の上端にある
+			spanU = x1 - x0;
+			spanV = 1;
+			for (int32_t x = x0; x < x1; ++x) {
+				if (!cover(direction, x, mapY)) {
+					error = "top/bottom face outside the map";
+					return false;
+				}
+			}
+		} else if (normal.x < -0.5f || normal.x > 0.5f) {
+			direction = normal.x < 0.0f ? 3 : 4;
+			int32_t x = normal.x < 0.0f ? x0 : x0 - 1;
+			spanU = 1;
+			spanV = y1 - y0;
+			for (int32_t mapY = y0; mapY < y1; ++mapY) {
+				if (!cover(direction, x, mapY)) {
+					error = "side face outside the map";
+					return false;
+				}
+			}
+		} else {
+			continue; // 奥の面は数えない
+		}
+		// UV はタイル1枚で 0..1 (まとめた面では繰り返す)
+		if (std::lround(maxU) != spanU || std::lround(maxV) != spanV) {
+			error = "UV does not tile once per block";
+			return false;
+		}
+	}
+
+	for (int32_t mapY = 0; mapY < height; ++mapY) {
+		for (int32_t x = 0; x < width; ++x) {
+			bool solid = isSolid(x, mapY);
+			const bool expected[kDirectionCount] = {
+				solid,
+				solid && !isSolid(x, mapY - 1),
+				solid && !isSolid(x, mapY + 1),
+				solid && !isSolid(x - 1, mapY),
+				solid && !isSolid(x + 1, mapY),
+			};
+			for (int direction = 0; direction < kDirectionCount; ++direction) {
+				int count = covered[(static_cast<size_t>(mapY) * width + x) * kDirectionCount + direction];
+				if (count != (expected[direction] ? 1 : 0)) {
+					error = "face " + std::to_string(direction) + " of tile (" + std::to_string(x) + ", " + std::to_string(mapY) +
+						") covered " + std::to_string(count) + " times";
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// マップ全体を1つのメッシュにした場合と、チャンクごとに分けた場合を数える
+bool Run(const std::string& name, const MapData& map, int iterations) {
+	TileMeshOptions options;
+	options.blockSize = 0.7f;
+	options.originY = static_cast<float>(map.height) * options.blockSize;
+
+	IndexedModelData mesh;
+	TileMeshOptions cullOnly = options;
+	cullOnly.mergeFaces = false;
+	TileMeshStats culled = BuildTileMesh(map.tiles.data(), map.width, map.height, cullOnly, mesh);
+	std::string error;
+	if (!VerifyTileMesh(map.tiles.data(), map.width, map.height, cullOnly, mesh, error)) {
+		std::printf("%s: FAILED (cull only) %s\n", name.c_str(), error.c_str());
+		return false;
+	}
+
+	std::vector<double> samples;
+	TileMeshStats merged;
+	for (int i = 0; i < iterations; ++i) {
+		Stopwatch stopwatch;
+		merged = BuildTileMesh(map.tiles.data(), map.width, map.height, options, mesh);
+		samples.push_back(stopwatch.GetSeconds());
+	}
+	if (!VerifyTileMesh(map.tiles.data(), map.width, map.height, options, mesh, error)) {
+		std::printf("%s: FAILED (merged) %s\n", name.c_str(), error.c_str());
+		return false;
+	}
+
+	// MapChip と同じくチャンクごとに作る (チャンクの端の側面は残る)
+	MapDataChunkSource source(map);
+	std::vector<uint8_t> chunkTiles(kChunkTileCount);
+	TileMeshStats chunked;
+	size_t chunkMeshCount = 0;
+	for (int32_t chunkY = 0; chunkY * kChunkSize < map.height; ++chunkY) {
+		for (int32_t chunkX = 0; chunkX * kChunkSize < map.width; ++chunkX) {
+			source.LoadChunk(chunkX, chunkY, chunkTiles.data());
+			TileMeshOptions chunkOptions = options;
+			chunkOptions.originX = static_cast<float>(chunkX * kChunkSize) * options.blockSize;
+			chunkOptions.originY = static_cast<float>(map.height - chunkY * kChunkSize) * options.blockSize;
+			TileMeshStats stats = BuildTileMesh(chunkTiles.data(), kChunkSize, kChunkSize, chunkOptions, mesh);
+			if (!VerifyTileMesh(chunkTiles.data(), kChunkSize, kChunkSize, chunkOptions, mesh, error)) {
+				std::printf("%s: FAILED (chunk %d,%d) %s\n", name.c_str(), chunkX, chunkY, error.c_str());
+				return false;
+			}
+			chunked.Accumulate(stats);
+			chunkMeshCount += stats.triangleCount > 0 ? 1 : 0;
+		}
+	}
+
+	auto percent = [&](size_t triangles) {
+		return merged.cubeTriangleCount ? 100.0 * static_cast<double>(triangles) / static_cast<double>(merged.cubeTriangleCount) : 0.0;
+	};
+	TimingSummary timing = Summarize(samples);
+	std::printf("%s (%dx%d, %zu walls)\n", name.c_str(), map.width, map.height, merged.wallCount);
+	std::printf("  cubes          %8zu triangles  (%zu instances)\n", merged.cubeTriangleCount, merged.wallCount);
+	std::printf("  hidden culled  %8zu triangles  %6.1f%%\n", culled.triangleCount, percent(culled.triangleCount));
+	std::printf("  greedy merged  %8zu triangles  %6.1f%%  %zu vertices  %.3f ms\n", merged.triangleCount,
+		percent(merged.triangleCount), merged.vertexCount, timing.median * 1000.0);
+	std::printf("  per chunk      %8zu triangles  %6.1f%%  %zu meshes (draw calls)\n", chunked.triangleCount,
+		percent(chunked.triangleCount), chunkMeshCount);
+	return true;
+}
+
+// 洞窟のように壁が固まったマップ (ランダムな壁を数回ならす)
+MapData GenerateCaveMap(int32_t width, int32_t height) {
+	std::mt19937 random(97531);
+	std::uniform_int_distribution<int32_t> distribution(0, 99);
+	MapData map;
+	map.width = width;
+	map.height = height;
+	map.tiles.resize(static_cast<size_t>(width) * height);
+	for (uint8_t& tile : map.tiles) {
+		tile = distribution(random) < 45 ? kTileWall : kTileEmpty;
+	}
+	for (int pass = 0; pass < 4; ++pass) {
+		std::vector<uint8_t> next(map.tiles.size());
+		for (int32_t y = 0; y < height; ++y) {
+			for (int32_t x = 0; x < width; ++x) {
+				int walls = 0;
+				for (int32_t dy = -1; dy <= 1; ++dy) {
+					for (int32_t dx = -1; dx <= 1; ++dx) {
+						int32_t nx = x + dx, ny = y + dy;
+						bool outside = nx < 0 || ny < 0 || nx >= width || ny >= height;
+						walls += (outside || map.tiles[static_cast<size_t>(ny) * width + nx] == kTileWall) ? 1 : 0;
+					}
+				}
+				next[static_cast<size_t>(y) * width + x] = walls >= 5 ? kTileWall : kTileEmpty;
+			}
+		}
+		map.tiles.swap(next);
+	}
+	return map;
+}
+
+} // namespace
+
+int RunTileMeshBenchmark(int argc, char* argv[]) {
+	int iterations = FindIntOption(argc, argv, "--iterations", 10);
+	int width = FindIntOption(argc, argv, "--width", 1024);
+	int height = FindIntOption(argc, argv, "--height", 256);
+
+	bool ok = true;
+	std::vector<std::string> paths;
+	for (int i = 0; i < argc; ++i) {
+		if (argv[i][0] == '-') {
+			++i; // オプションの値を飛ばす
+		} else {
+			paths.push_back(argv[i]);
+		}
+	}
+	if (paths.empty()) {
+		paths = { "Resources/map.csv", "Resources/map2.csv", "Resources/map3.csv", "Resources/blocks.csv" };
+	}
+	for (const std::string& path : paths) {
+		MapData map;
+		std::string errorMessage;
+		if (!LoadMapFile(path, map, &errorMessage)) {
+			std::printf("%s: %s\n", path.c_str(), errorMessage.c_str());
+			ok = false;
+			continue;
+		}
+		ok = Run(path, map, iterations) && ok;
+	}
+	ok = Run("generated cave", GenerateCaveMap(width, height), iterations) && ok;
+	return ok ? 0 : 1;
+}
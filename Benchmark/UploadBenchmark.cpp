@@ -0,0 +1,245 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../UploadScheduler.h"
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+namespace {
+
+// 転送先バッファの代わり (ID ごとのバイト列)
+struct FakeBuffers {
+	std::vector<std::vector<uint8_t>> contents;
+
+	uint32_t Create(uint64_t size) {
+		contents.emplace_back(static_cast<size_t>(size), uint8_t(0));
+		return static_cast<uint32_t>(contents.size() - 1);
+	}
+	// GPU の代わりにコピー命令を実行する
+	void Execute(const CopyCommandStream& stream, const std::vector<uint8_t>& staging) {
+		for (const BufferCopyCommand& copy : stream.copies) {
+			std::memcpy(contents[copy.destination].data() + copy.destinationOffset, staging.data() + copy.stagingOffset,
+				static_cast<size_t>(copy.size));
+		}
+	}
+};
+
+std::vector<uint8_t> MakeData(std::mt19937& random, uint64_t size) {
+	std::vector<uint8_t> data(static_cast<size_t>(size));
+	for (uint8_t& byte : data) {
+		byte = static_cast<uint8_t>(random());
+	}
+	return data;
+}
+
+struct EnqueuedCopy {
+	uint32_t destination;
+	uint64_t destinationOffset;
+	std::vector<uint8_t> data;
+};
+
+// 1回の Flush の中身が予約した順・内容どおりか (違っていたら失敗の数)
+int CheckStream(const CopyCommandStream& stream, const std::vector<EnqueuedCopy>& enqueued, const std::vector<uint8_t>& staging) {
+	int failures = 0;
+	if (stream.copies.size() != enqueued.size()) {
+		std::printf("  FAIL: %zu copies for %zu uploads\n", stream.copies.size(), enqueued.size());
+		return 1;
+	}
+	std::vector<uint32_t> expectedDestinations;
+	for (size_t i = 0; i < enqueued.size(); ++i) {
+		const BufferCopyCommand& copy = stream.copies[i];
+		const EnqueuedCopy& expected = enqueued[i];
+		bool placed = copy.destination == expected.destination && copy.destinationOffset == expected.destinationOffset &&
+			copy.size == expected.data.size() && copy.stagingOffset % 16 == 0 && copy.stagingOffset + copy.size <= staging.size();
+		if (!placed || std::memcmp(staging.data() + copy.stagingOffset, expected.data.data(), expected.data.size()) != 0) {
+			std::printf("  FAIL: copy %zu -> buffer %u +%llu (%llu B from staging +%llu)\n", i, copy.destination,
+				static_cast<unsigned long long>(copy.destinationOffset), static_cast<unsigned long long>(copy.size),
+				static_cast<unsigned long long>(copy.stagingOffset));
+			++failures;
+		}
+		for (size_t j = 0; j < i; ++j) {
+			const BufferCopyCommand& other = stream.copies[j];
+			if (copy.stagingOffset < other.stagingOffset + other.size && other.stagingOffset < copy.stagingOffset + copy.size) {
+				++failures;
+			}
+		}
+		bool seen = false;
+		for (uint32_t destination : expectedDestinations) {
+			seen = seen || destination == expected.destination;
+		}
+		if (!seen) {
+			expectedDestinations.push_back(expected.destination);
+		}
+	}
+	if (stream.destinations != expectedDestinations) {
+		std::printf("  FAIL: %zu destinations to transition, expected %zu\n", stream.destinations.size(), expectedDestinations.size());
+		++failures;
+	}
+	return failures;
+}
+
+} // namespace
+
+int RunUploadBenchmark(int argc, char* argv[]) {
+	const int frames = FindIntOption(argc, argv, "--frames", 20000);
+	const uint64_t capacity = static_cast<uint64_t>(FindIntOption(argc, argv, "--capacity-kb", 32)) * 1024;
+	int failures = 0;
+
+	// 1. メッシュ数個分の転送が、予約した順の1本の命令列にまとまり、転送先が重複なく並ぶか
+	{
+		std::mt19937 random(1);
+		std::vector<uint8_t> staging(256 * 1024);
+		UploadScheduler scheduler;
+		scheduler.Initialize(staging.data(), staging.size());
+		FakeBuffers buffers;
+		std::vector<EnqueuedCopy> enqueued;
+		uint64_t enqueuedBytes = 0;
+		for (int mesh = 0; mesh < 6; ++mesh) {
+			// 頂点とインデックスを同じバッファの別の位置へ (大きさは 16 の倍数とは限らない)
+			uint64_t vertexBytes = 36 * (1 + random() % 300);
+			uint64_t indexBytes = 2 * (1 + random() % 700);
+			uint32_t buffer = buffers.Create(vertexBytes + indexBytes);
+			enqueued.push_back({ buffer, 0, MakeData(random, vertexBytes) });
+			enqueued.push_back({ buffer, vertexBytes, MakeData(random, indexBytes) });
+		}
+		scheduler.BeginFrame(0);
+		for (const EnqueuedCopy& copy : enqueued) {
+			failures += scheduler.Enqueue(copy.destination, copy.destinationOffset, copy.data.data(), copy.data.size()) ? 0 : 1;
+			enqueuedBytes += copy.data.size();
+		}
+		bool pending = scheduler.HasPendingCopies();
+		CopyCommandStream stream;
+		scheduler.Flush(stream);
+		int streamFailures = CheckStream(stream, enqueued, staging);
+		bool stats = !scheduler.HasPendingCopies() && scheduler.GetFlushCount() == 1 &&
+			scheduler.GetTotalCopyCount() == enqueued.size() && scheduler.GetTotalUploadedBytes() == enqueuedBytes;
+		// 空の Flush は何も書かず、回数にも数えない
+		CopyCommandStream empty;
+		scheduler.Flush(empty);
+		bool emptyOk = empty.copies.empty() && empty.destinations.empty() && scheduler.GetFlushCount() == 1;
+		bool ok = pending && streamFailures == 0 && stats && emptyOk;
+		failures += ok ? 0 : 1;
+		std::printf("batched copies: %zu uploads -> %zu copies into %zu buffers, %llu B, stats %s, empty flush %s -> %s\n", enqueued.size(),
+			stream.copies.size(), stream.destinations.size(), static_cast<unsigned long long>(enqueuedBytes), stats ? "ok" : "WRONG",
+			emptyOk ? "ignored" : "WRONG", ok ? "ok" : "FAILED");
+	}
+
+	// 2. ステージング領域はそのフレームのフェンスを GPU が通過するまで使わず、通過したら先頭から使い直す
+	{
+		const uint64_t slot = 256;
+		std::vector<uint8_t> staging(static_cast<size_t>(4 * slot));
+		UploadScheduler scheduler;
+		scheduler.Initialize(staging.data(), staging.size());
+		uint8_t data[slot] = {};
+		CopyCommandStream stream;
+
+		// フレーム 1: 4 枠で満杯、5 個目は断る (予約にも残らない)
+		scheduler.BeginFrame(0);
+		int granted = 0;
+		for (int i = 0; i < 5; ++i) {
+			granted += scheduler.Enqueue(0, i * slot, data, slot) ? 1 : 0;
+		}
+		scheduler.Flush(stream);
+		bool filled = granted == 4 && stream.copies.size() == 4;
+		scheduler.EndFrame(1);
+
+		// フレーム 2: GPU はまだフェンス 1 を通過していない
+		scheduler.BeginFrame(0);
+		bool held = !scheduler.Enqueue(0, 0, data, 16) && scheduler.GetStagingRing().GetUsedSize() == 4 * slot;
+		scheduler.EndFrame(2);
+
+		// フレーム 3: フェンス 1 を通過したので先頭から使える。ただし命令列に書き出す前にフレームが終わる
+		scheduler.BeginFrame(1);
+		stream.Clear();
+		bool reused = scheduler.Enqueue(1, 0, data, slot) && scheduler.Enqueue(1, slot, data, slot);
+		scheduler.Flush(stream);
+		reused = reused && stream.copies.size() == 2 && stream.copies[0].stagingOffset == 0 && stream.copies[1].stagingOffset == slot;
+		bool unflushedOk = scheduler.Enqueue(2, 0, data, slot);
+		scheduler.EndFrame(3);
+
+		// フレーム 4: フェンス 3 を通過しても、フレーム 3 は締めていないので、その3枠はまだ使っている
+		// (書き出していなかったコピーは、次に締めるフレームのフェンスで返る)
+		scheduler.BeginFrame(3);
+		unflushedOk = unflushedOk && scheduler.GetStagingRing().GetUsedSize() == 3 * slot && scheduler.HasPendingCopies();
+		stream.Clear();
+		scheduler.Flush(stream);
+		scheduler.EndFrame(4);
+		scheduler.BeginFrame(4);
+		bool drained = stream.copies.size() == 1 && scheduler.GetStagingRing().GetUsedSize() == 0;
+
+		bool ok = filled && held && reused && unflushedOk && drained;
+		failures += ok ? 0 : 1;
+		std::printf("fence reuse: filled %s, held until fence 1 %s, reused from the start %s, unflushed copy kept past its frame %s, drained %s -> %s\n",
+			filled ? "yes" : "no", held ? "yes" : "no", reused ? "yes" : "no", unflushedOk ? "yes" : "no", drained ? "yes" : "no",
+			ok ? "ok" : "FAILED");
+	}
+
+	// 3. ゲームと同じ順 (BeginFrame → Flush → 読み込み → EndFrame) で回し、GPU はフェンスを通過する直前にコピーを実行する
+	//    ステージングを早く使い直していれば、転送先に届く内容が壊れる (小さいステージングで折り返しを多くする)
+	{
+		std::mt19937 random(2);
+		std::uniform_int_distribution<int> percent(0, 99);
+		const uint64_t framesInFlight = 2;
+		std::vector<uint8_t> staging(static_cast<size_t>(capacity));
+		UploadScheduler scheduler;
+		scheduler.Initialize(staging.data(), capacity);
+		FakeBuffers buffers;
+		std::vector<std::vector<uint8_t>> expected;
+		std::deque<std::pair<uint64_t, CopyCommandStream>> submitted; // GPU にまだ実行されていない命令列 (フェンス値つき)
+		int64_t uploads = 0;
+		int64_t refused = 0;
+		double flushSeconds = 0.0;
+		uint64_t fenceValue = 0;
+		for (int frame = 0; frame < frames + static_cast<int>(framesInFlight) + 2; ++frame) {
+			uint64_t completed = fenceValue > framesInFlight ? fenceValue - framesInFlight : 0;
+			if (frame >= frames) {
+				completed = fenceValue; // 最後は GPU を待ち切る
+			}
+			while (!submitted.empty() && submitted.front().first <= completed) {
+				buffers.Execute(submitted.front().second, staging);
+				submitted.pop_front();
+			}
+			scheduler.BeginFrame(completed);
+			CopyCommandStream stream;
+			Stopwatch stopwatch;
+			scheduler.Flush(stream);
+			flushSeconds += stopwatch.GetSeconds();
+
+			// ときどきメッシュを作る (1フレームに数個、大きさはまちまち)
+			if (frame < frames && percent(random) < 30) {
+				int meshes = 1 + percent(random) % 4;
+				for (int mesh = 0; mesh < meshes; ++mesh) {
+					uint64_t size = 16 + random() % 8192;
+					std::vector<uint8_t> data = MakeData(random, size);
+					uint32_t buffer = buffers.Create(size);
+					expected.push_back(std::vector<uint8_t>(static_cast<size_t>(size), uint8_t(0)));
+					if (scheduler.Enqueue(buffer, 0, data.data(), size)) {
+						expected.back() = std::move(data);
+						++uploads;
+					} else {
+						++refused; // ゲームではアップロードヒープに作り直す
+					}
+				}
+			}
+			scheduler.EndFrame(++fenceValue);
+			submitted.push_back({ fenceValue, std::move(stream) });
+		}
+		int64_t corrupted = 0;
+		for (size_t buffer = 0; buffer < expected.size(); ++buffer) {
+			corrupted += buffers.contents[buffer] != expected[buffer] ? 1 : 0;
+		}
+		bool ok = corrupted == 0 && uploads > 0 && !scheduler.HasPendingCopies() && scheduler.GetStagingRing().GetUsedSize() == 0;
+		failures += ok ? 0 : 1;
+		std::printf("%d frames, %llu KiB staging, GPU %llu frames behind: %lld uploads (%lld refused while full), staging peak %llu B\n",
+			frames, static_cast<unsigned long long>(capacity / 1024), static_cast<unsigned long long>(framesInFlight),
+			static_cast<long long>(uploads), static_cast<long long>(refused),
+			static_cast<unsigned long long>(scheduler.GetStagingRing().GetPeakUsedSize()));
+		std::printf("  buffers with wrong contents %lld, flush %.1f ns/frame -> %s\n", static_cast<long long>(corrupted),
+			flushSeconds * 1e9 / frames, ok ? "ok" : "FAILED");
+	}
+
+	std::printf("%s\n", failures == 0 ? "all checks passed" : "FAILED");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../ObjLoader.h"
+#include "../VertexPacking.h"
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 既定で誤差を測るモデル (見つからないものは飛ばす)
+const char* const kDefaultMeshes[] = {
+	"Resources/skydome/skydome.obj",
+	"Resources/player/player.obj",
+	"Resources/block/block.obj",
+};
+
+// 許容する誤差 (超えたら終了コード 1)
+const float kMaxNormalErrorDegrees = 0.01f;
+const float kMaxTexcoordRelativeError = 1.0f / 2048.0f; // half の仮数 11bit の半分
+
+// 球面上にほぼ均等に並べた法線 (黄金角の螺旋)
+std::vector<VertexData> GenerateNormalSweep(int32_t count) {
+	std::vector<VertexData> vertices(count);
+	const float kGoldenAngle = 2.39996323f;
+	for (int32_t i = 0; i < count; ++i) {
+		float z = 1.0f - 2.0f * (static_cast<float>(i) + 0.5f) / static_cast<float>(count);
+		float radius = std::sqrt(1.0f - z * z);
+		float angle = kGoldenAngle * static_cast<float>(i);
+		vertices[i].position = { 0.0f, 0.0f, 0.0f, 1.0f };
+		vertices[i].normal = { radius * std::cos(angle), radius * std::sin(angle), z };
+	}
+	return vertices;
+}
+
+// UV を [-range, range] で等間隔に並べる
+std::vector<VertexData> GenerateTexcoordSweep(int32_t count, float range) {
+	std::vector<VertexData> vertices(count);
+	for (int32_t i = 0; i < count; ++i) {
+		float t = -range + 2.0f * range * static_cast<float>(i) / static_cast<float>(count - 1);
+		vertices[i].position = { 0.0f, 0.0f, 0.0f, 1.0f };
+		vertices[i].texcoord = { t, -t };
+		vertices[i].normal = { 0.0f, 1.0f, 0.0f };
+	}
+	return vertices;
+}
+
+bool Report(const std::string& name, const std::vector<VertexData>& vertices) {
+	VertexPackingError error = MeasureVertexPackingError(vertices);
+	bool passed = error.nonUnitWCount == 0 && error.maxPositionError == 0.0f &&
+		error.maxNormalErrorDegrees <= kMaxNormalErrorDegrees && error.maxTexcoordRelativeError <= kMaxTexcoordRelativeError;
+	std::printf("%-36s %8zu verts  pos %g  uv %.3g (rel %.3g)  normal max %.5f mean %.5f deg  w!=1 %zu  %s\n",
+		name.c_str(), error.vertexCount, error.maxPositionError, error.maxTexcoordError, error.maxTexcoordRelativeError,
+		error.maxNormalErrorDegrees, error.meanNormalErrorDegrees, error.nonUnitWCount, passed ? "ok" : "FAILED");
+	return passed;
+}
+
+} // namespace
+
+int RunVertexPackingBenchmark(int argc, char* argv[]) {
+	std::vector<std::string> paths;
+	for (int i = 0; i < argc; ++i) {
+		if (argv[i][0] == '-') {
+			++i; // オプションの値を飛ばす
+			continue;
+		}
+		paths.push_back(argv[i]);
+	}
+	if (paths.empty()) {
+		paths.assign(std::begin(kDefaultMeshes), std::end(kDefaultMeshes));
+	}
+	int32_t sweepCount = FindIntOption(argc, argv, "--count", 1000000);
+
+	std::printf("vertex %zu -> %zu bytes\n", sizeof(VertexData), sizeof(CompactVertexData));
+	bool passed = true;
+	std::vector<VertexData> normalSweep = GenerateNormalSweep(sweepCount);
+	passed &= Report("normal sweep", normalSweep);
+	passed &= Report("uv sweep [0, 1]", GenerateTexcoordSweep(sweepCount, 1.0f));
+	passed &= Report("uv sweep [-16, 16]", GenerateTexcoordSweep(sweepCount, 16.0f));
+
+	for (const std::string& path : paths) {
+		std::string text;
+		ModelData modelData;
+		if (!ReadFileToString(path, text) || !ParseObj(text, modelData)) {
+			std::printf("%-36s missing\n", path.c_str());
+			continue;
+		}
+		passed &= Report(path, modelData.vertices);
+	}
+
+	// 圧縮の速さ (読み込み時に1回だけ行う)
+	std::vector<CompactVertexData> packed;
+	Stopwatch stopwatch;
+	PackVertices(normalSweep, packed);
+	double seconds = stopwatch.GetSeconds();
+	std::printf("pack %zu vertices: %.3f ms (%.1f Mvert/s)\n", packed.size(), seconds * 1000.0,
+		static_cast<double>(packed.size()) / seconds / 1.0e6);
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+#include "Benchmarks.h"
+#include "BenchmarkUtil.h"
+#include "../Camera.h"
+#include "../GameMap.h"
+#include "../MapFile.h"
+#include "../ViewCulling.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+// タイルの立方体の8つの角を画面に写し、その外接矩形が画面にかかるか (かかるなら描かなければならない)
+bool IsTileOnScreen(const Matrix4x4& viewProjection, int32_t x, int32_t mapY, int32_t mapHeight) {
+	float left = static_cast<float>(x) * GameMap::kBlockSize;
+	float bottom = static_cast<float>(mapHeight - 1 - mapY) * GameMap::kBlockSize;
+	float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f;
+	for (int corner = 0; corner < 8; ++corner) {
+		float px = left + ((corner & 1) ? GameMap::kBlockSize : 0.0f);
+		float py = bottom + ((corner & 2) ? GameMap::kBlockSize : 0.0f);
+		float pz = (corner & 4) ? GameMap::kBlockSize * 0.5f : -GameMap::kBlockSize * 0.5f;
+		const Matrix4x4& m = viewProjection;
+		float cx = px * m.m[0][0] + py * m.m[1][0] + pz * m.m[2][0] + m.m[3][0];
+		float cy = px * m.m[0][1] + py * m.m[1][1] + pz * m.m[2][1] + m.m[3][1];
+		float w = px * m.m[0][3] + py * m.m[1][3] + pz * m.m[2][3] + m.m[3][3];
+		if (w <= 0.0f) {
+			return true; // カメラの後ろにかかる (ここで使う配置では起きない) ものは見えるとみなす
+		}
+		minX = std::min(minX, cx / w);
+		maxX = std::max(maxX, cx / w);
+		minY = std::min(minY, cy / w);
+		maxY = std::max(maxY, cy / w);
+	}
+	return maxX >= -1.0f && minX <= 1.0f && maxY >= -1.0f && minY <= 1.0f;
+}
+
+struct CullCheck {
+	uint64_t cameraCount = 0;
+	uint64_t onScreenTiles = 0;
+	uint64_t rangeTiles = 0;
+	uint64_t missedTiles = 0; // 画面にかかるのに範囲の外 (0 でなければ失敗)
+	uint64_t failedRects = 0;
+};
+
+// カメラを動かしながら、範囲の外に画面にかかるタイルがないかを総当たりで確かめる
+void CheckCamera(Camera& camera, int32_t mapHeight, CullCheck& check) {
+	camera.UpdateMatrix();
+	const Matrix4x4& viewProjection = camera.GetViewProjectionMatrix();
+	WorldRect rect;
+	if (!ComputeVisibleWorldRect(viewProjection, 0.0f, rect)) {
+		++check.failedRects;
+		return;
+	}
+	TileRect range = ComputeVisibleTileRange(rect, GameMap::kBlockSize, mapHeight, kTileCullMargin);
+	++check.cameraCount;
+
+	// 範囲よりずっと広い窓を調べる
+	int32_t centerX = static_cast<int32_t>(camera.GetTransform().translate.x / GameMap::kBlockSize);
+	int32_t centerMapY = (mapHeight - 1) - static_cast<int32_t>(camera.GetTransform().translate.y / GameMap::kBlockSize);
+	for (int32_t mapY = centerMapY - 60; mapY <= centerMapY + 60; ++mapY) {
+		for (int32_t x = centerX - 80; x <= centerX + 80; ++x) {
+			bool inRange = x >= range.x0 && x <= range.x1 && mapY >= range.mapY0 && mapY <= range.mapY1;
+			bool onScreen = IsTileOnScreen(viewProjection, x, mapY, mapHeight);
+			check.onScreenTiles += onScreen ? 1 : 0;
+			check.rangeTiles += inRange ? 1 : 0;
+			check.missedTiles += (onScreen && !inRange) ? 1 : 0;
+		}
+	}
+}
+
+} // namespace
+
+int RunViewCullBenchmark(int argc, char* argv[]) {
+	std::string path = FindOption(argc, argv, "--file", "Resources/blocks.csv");
+	int width = FindIntOption(argc, argv, "--width", 4096);
+
+	Camera camera;
+	camera.Initialize();
+	bool ok = true;
+
+	// 1. ゲームと同じ固定カメラ、横スクロール、傾けたカメラ
+	struct Pose {
+		const char* name;
+		Vector3 rotate;
+	};
+	const Pose poses[] = {
+		{ "straight", { 0.0f, 0.0f, 0.0f } },
+		{ "pitched", { 0.25f, 0.0f, 0.0f } },
+		{ "yawed", { 0.0f, -0.2f, 0.0f } },
+		{ "rolled", { 0.1f, 0.15f, 0.3f } },
+	};
+	const int32_t kMapHeight = 64;
+	for (const Pose& pose : poses) {
+		CullCheck check;
+		for (float cameraX = -5.0f; cameraX < static_cast<float>(width) * GameMap::kBlockSize; cameraX += 3.7f) {
+			for (float cameraY = 2.0f; cameraY < kMapHeight * GameMap::kBlockSize; cameraY += 9.1f) {
+				camera.GetTransform().translate = { cameraX, cameraY, -21.9f };
+				camera.GetTransform().rotate = pose.rotate;
+				CheckCamera(camera, kMapHeight, check);
+			}
+		}
+		bool passed = check.missedTiles == 0 && check.failedRects == 0;
+		std::printf("%-9s %6llu cameras  on screen %7.1f tiles  in range %7.1f tiles (%.2fx)  missed %llu%s\n", pose.name,
+			static_cast<unsigned long long>(check.cameraCount),
+			static_cast<double>(check.onScreenTiles) / static_cast<double>(check.cameraCount),
+			static_cast<double>(check.rangeTiles) / static_cast<double>(check.cameraCount),
+			static_cast<double>(check.rangeTiles) / static_cast<double>(std::max<uint64_t>(check.onScreenTiles, 1)),
+			static_cast<unsigned long long>(check.missedTiles), passed ? "" : "  FAILED");
+		ok = ok && passed;
+	}
+
+	// 2. 範囲を求める費用 (毎フレーム1回)
+	camera.Initialize();
+	const int kIterations = 1000000;
+	Stopwatch stopwatch;
+	int64_t checksum = 0;
+	for (int i = 0; i < kIterations; ++i) {
+		Matrix4x4 viewProjection = camera.GetViewProjectionMatrix();
+		viewProjection.m[3][0] += static_cast<float>(i & 255) * 0.01f; // 最適化で消えないように少し動かす
+		WorldRect rect;
+		if (ComputeVisibleWorldRect(viewProjection, 0.0f, rect)) {
+			checksum += ComputeVisibleTileRange(rect, GameMap::kBlockSize, kMapHeight, kTileCullMargin).x1;
+		}
+	}
+	std::printf("range     %.1f ns per frame (checksum %lld)\n", stopwatch.GetSeconds() / kIterations * 1e9,
+		static_cast<long long>(checksum));
+
+	// 3. ゲームのカメラで、マップの壁のうち描くものの割合
+	MapData map;
+	std::string errorMessage;
+	if (!LoadMapFile(path, map, &errorMessage)) {
+		std::printf("%s: %s\n", path.c_str(), errorMessage.c_str());
+		return 1;
+	}
+	size_t totalWalls = 0;
+	for (uint8_t tile : map.tiles) {
+		totalWalls += tile == kTileWall ? 1 : 0;
+	}
+	camera.Initialize();
+	std::printf("%s (%dx%d, %zu walls), camera at the start, visible walls per chunk-aligned scroll position:\n",
+		path.c_str(), map.width, map.height, totalWalls);
+	for (float cameraX = camera.GetTransform().translate.x; cameraX < map.width * GameMap::kBlockSize; cameraX += kChunkSize * GameMap::kBlockSize) {
+		camera.GetTransform().translate.x = cameraX;
+		camera.UpdateMatrix();
+		WorldRect rect;
+		ComputeVisibleWorldRect(camera.GetViewProjectionMatrix(), 0.0f, rect);
+		TileRect range = ComputeVisibleTileRange(rect, GameMap::kBlockSize, map.height, kTileCullMargin);
+		// MapChip と同じくチャンク単位で描くかを決める
+		size_t tileWalls = 0;
+		size_t chunkWalls = 0;
+		for (int32_t mapY = 0; mapY < map.height; ++mapY) {
+			for (int32_t x = 0; x < map.width; ++x) {
+				if (map.tiles[static_cast<size_t>(mapY) * map.width + x] != kTileWall) {
+					continue;
+				}
+				int32_t x0 = x & ~(kChunkSize - 1);
+				int32_t y0 = mapY & ~(kChunkSize - 1);
+				TileRect chunkRect = { x0, y0, x0 + kChunkSize - 1, y0 + kChunkSize - 1 };
+				tileWalls += (x >= range.x0 && x <= range.x1 && mapY >= range.mapY0 && mapY <= range.mapY1) ? 1 : 0;
+				chunkWalls += IsTileRectOverlapping(chunkRect, range) ? 1 : 0;
+			}
+		}
+		std::printf("  x %6.1f  tiles [%d..%d]x[%d..%d]  walls in range %zu / %zu  drawn (whole chunks) %zu / %zu\n",
+			cameraX, range.x0, range.x1, range.mapY0, range.mapY1, tileWalls, totalWalls, chunkWalls, totalWalls);
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include "Benchmarks.h"
+#include <cstdio>
+#include <cstring>
+
+// ゲーム本体とは別のコンソールアプリ。ゲームのコードを GPU なしで計測する
+//   Benchmark.exe <サブコマンド> [オプション]
+
+namespace {
+
+struct Command {
+	const char* name;
+	int (*run)(int argc, char* argv[]);
+	const char* description;
+};
+
+const Command kCommands[] = {
+	{ "obj", RunObjBenchmark, "OBJ parser throughput (--file path --iterations N)" },
+	{ "bakemesh", RunMeshBakeCommand, "bake OBJ files into .meshbin (paths, or the game's models)" },
+	{ "vcache", RunVertexCacheBenchmark, "vertex cache optimization ACMR/ATVR (paths --segments N)" },
+	{ "vpack", RunVertexPackingBenchmark, "compact vertex round-trip error (paths --count N)" },
+	{ "tilegrid", RunTileGridBenchmark, "tile collision queries, legacy vs TileGrid (--file csv --size N --queries N)" },
+	{ "convertmap", RunMapConvertCommand, "convert maps between CSV/TSV/.mapbin (input output, or the game's maps)" },
+	{ "mapload", RunMapLoadBenchmark, "map parse time, legacy vs ParseMapText vs .mapbin (--width N --height N)" },
+	{ "tilemesh", RunTileMeshBenchmark, "greedy wall meshing, verified triangle counts (map paths --width N --height N)" },
+	{ "chunkstream", RunChunkStreamBenchmark, "scroll a huge chunked map at a memory budget (--width N --budget-kb N --mapbin path)" },
+	{ "remesh", RunRemeshBenchmark, "per-edit cost of rebuilding only dirty chunks, block-only edits skip the rebuild (--width N --height N --frames N --edits N)" },
+	{ "viewcull", RunViewCullBenchmark, "camera tile range vs brute-force on-screen test (--file csv --width N)" },
+	{ "sweep", RunSweepBenchmark, "swept-AABB tile collision, tunneling and TOI checks (--cases N --iterations N)" },
+	{ "raycast", RunRaycastBenchmark, "tile DDA raycast / line of sight / ground distance (--width N --height N --rays N)" },
+	{ "occupancy", RunOccupancyBenchmark, "occupancy pyramid updates and empty-space skipping on sparse maps (--width N --height N --rays N)" },
+	{ "objects", RunObjectGridBenchmark, "dynamic block index queries vs linear scans as object counts grow (--objects N --queries N --radius N)" },
+	{ "sim", RunSimulationBenchmark, "headless game simulation driven by a scripted bot, ticks/s, repeatability and frame pacing (--ticks N --seed N)" },
+	{ "replay", RunReplayBenchmark, "input recording round trip, bit-exact replay and divergence detection (--ticks N --record path --verify path)" },
+	{ "playthrough", RunPlaythroughBenchmark, "play map.csv/map2.csv/map3.csv headless, tick time p50/p99, per-system breakdown, allocations (--ticks N --seed N --replay path --json path)" },
+	{ "desync", RunDesyncBenchmark, "lockstep two simulations, per-field state hashes, first differing tick and field (--ticks N --seed N --trials N)" },
+	{ "batch", RunInstanceBatchBenchmark, "instance batching through the recording backend: one draw per mesh, offsets, packed matrices, overflow (--walls N --frames N)" },
+	{ "ring", RunRingAllocatorBenchmark, "per-frame constant ring: 256-byte alignment, wrap-around, frames in flight, fence release, out of memory (--frames N --draws N --capacity-kb N)" },
+	{ "sizeclass", RunSizeClassBenchmark, "size-class allocator: mixed sizes/alignments, free-list reuse, pages, stats (--operations N --seed N --live N)" },
+	{ "upload", RunUploadBenchmark, "batched static-buffer copies and fenced staging reuse (--frames N --capacity-kb N)" },
+};
+
+void PrintUsage() {
+	std::printf("usage: Benchmark <command> [options]\n");
+	for (const Command& command : kCommands) {
+		std::printf("  %-12s %s\n", command.name, command.description);
+	}
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		PrintUsage();
+		return 1;
+	}
+	for (const Command& command : kCommands) {
+		if (std::strcmp(argv[1], command.name) == 0) {
+			return command.run(argc - 2, argv + 2);
+		}
+	}
+	PrintUsage();
+	return 1;
+}
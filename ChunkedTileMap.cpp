@@ -0,0 +1,448 @@
+#include "ChunkedTileMap.h"
+#include <algorithm>
+#include <cstring>
+
+bool MapDataChunkSource::LoadChunk(int32_t chunkX, int32_t chunkY, uint8_t* tiles) {
+	std::memset(tiles, kTileEmpty, kChunkTileCount);
+	int32_t x0 = chunkX << kChunkShift;
+	int32_t y0 = chunkY << kChunkShift;
+	int32_t columns = std::min(kChunkSize, map_.width - x0);
+	int32_t rows = std::min(kChunkSize, map_.height - y0);
+	if (columns <= 0) {
+		return true;
+	}
+	for (int32_t row = 0; row < rows; ++row) {
+		const uint8_t* source = &map_.tiles[static_cast<size_t>(y0 + row) * map_.width + x0];
+		std::memcpy(tiles + row * kChunkSize, source, static_cast<size_t>(columns));
+	}
+	return true;
+}
+
+bool MapBinChunkSource::Open(const std::string& path) {
+	file_.open(path, std::ios::binary);
+	if (!file_.is_open()) {
+		return false;
+	}
+	file_.seekg(0, std::ios::end);
+	uint64_t totalBytes = static_cast<uint64_t>(file_.tellg());
+	file_.seekg(0, std::ios::beg);
+	if (totalBytes < sizeof(MapBinHeader) ||
+		!file_.read(reinterpret_cast<char*>(&header_), sizeof(header_)) ||
+		!IsValidMapBinHeader(header_, totalBytes)) {
+		header_ = {};
+		return false;
+	}
+
+	// 表はタイルの後ろ
+	uint64_t tileBytes = static_cast<uint64_t>(header_.width) * static_cast<uint64_t>(header_.height);
+	objects_.resize(header_.objectCount);
+	file_.seekg(static_cast<std::streamoff>(sizeof(MapBinHeader) + tileBytes));
+	if (!file_.read(reinterpret_cast<char*>(objects_.data()), static_cast<std::streamsize>(sizeof(MapObject) * objects_.size()))) {
+		header_ = {};
+		return false;
+	}
+	for (const MapObject& object : objects_) {
+		if (object.x < 0 || object.x >= header_.width || object.mapY < 0 || object.mapY >= header_.height) {
+			header_ = {};
+			return false;
+		}
+	}
+	return true;
+}
+
+bool MapBinChunkSource::LoadChunk(int32_t chunkX, int32_t chunkY, uint8_t* tiles) {
+	std::memset(tiles, kTileEmpty, kChunkTileCount);
+	int32_t x0 = chunkX << kChunkShift;
+	int32_t y0 = chunkY << kChunkShift;
+	int32_t columns = std::min(kChunkSize, header_.width - x0);
+	int32_t rows = std::min(kChunkSize, header_.height - y0);
+	if (columns <= 0) {
+		return true;
+	}
+	// 1行ずつ、チャンクにかかる分だけ読む
+	for (int32_t row = 0; row < rows; ++row) {
+		uint64_t offset = sizeof(MapBinHeader) + static_cast<uint64_t>(y0 + row) * header_.width + x0;
+		file_.seekg(static_cast<std::streamoff>(offset));
+		if (!file_.read(reinterpret_cast<char*>(tiles + row * kChunkSize), columns)) {
+			file_.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+std::unique_ptr<TileChunkSource> OpenTileChunkSource(const std::string& path, std::string* errorMessage) {
+	if (HasMapBinExtension(path)) {
+		std::unique_ptr<MapBinChunkSource> source = std::make_unique<MapBinChunkSource>();
+		if (!source->Open(path)) {
+			if (errorMessage) {
+				*errorMessage = "broken mapbin " + path;
+			}
+			return nullptr;
+		}
+		return source;
+	}
+
+	MapData map;
+	if (!LoadMapFile(path, map, errorMessage)) {
+		return nullptr;
+	}
+	return std::make_unique<MapDataChunkSource>(std::move(map));
+}
+
+ChunkedTileMap::~ChunkedTileMap() {
+	// 通知先が先に破棄されていることがあるので通知はしない
+	ReleaseChunks(false);
+}
+
+void ChunkedTileMap::Reset(std::unique_ptr<TileChunkSource> source, size_t memoryBudget) {
+	ReleaseChunks(true);
+	editedTiles_.clear();
+	changes_.clear();
+	stats_ = {};
+	frame_ = 0;
+
+	source_ = std::move(source);
+	memoryBudget_ = memoryBudget;
+	width_ = source_ ? std::max(source_->GetWidth(), 0) : 0;
+	height_ = source_ ? std::max(source_->GetHeight(), 0) : 0;
+	chunkCountX_ = (width_ + kChunkSize - 1) >> kChunkShift;
+	chunkCountY_ = (height_ + kChunkSize - 1) >> kChunkShift;
+	chunks_.assign(static_cast<size_t>(chunkCountX_) * chunkCountY_, nullptr);
+	loadBuffer_.resize(kChunkTileCount);
+	occupancy_.Reset(width_, height_);
+
+	// チャンク1つ分のバイト数 (どのチャンクも同じ大きさ)
+	TileGrid grid;
+	grid.Resize(kChunkSize, kChunkSize);
+	chunkBytes_ = sizeof(Chunk) + grid.GetMemoryBytes();
+}
+
+void ChunkedTileMap::AddListener(TileChunkListener* listener) {
+	if (std::find(listeners_.begin(), listeners_.end(), listener) == listeners_.end()) {
+		listeners_.push_back(listener);
+	}
+}
+
+void ChunkedTileMap::RemoveListener(TileChunkListener* listener) {
+	listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), listener), listeners_.end());
+}
+
+const std::vector<MapObject>& ChunkedTileMap::GetObjects() const {
+	static const std::vector<MapObject> kNoObjects;
+	return source_ ? source_->GetObjects() : kNoObjects;
+}
+
+void ChunkedTileMap::Stream(int32_t centerX, int32_t centerMapY, int32_t radiusX, int32_t radiusY) {
+	++frame_;
+	if (chunks_.empty()) {
+		return;
+	}
+
+	int32_t firstChunkX = Clamp(centerX - radiusX, 0, width_ - 1) >> kChunkShift;
+	int32_t lastChunkX = Clamp(centerX + radiusX, 0, width_ - 1) >> kChunkShift;
+	int32_t firstChunkY = Clamp(centerMapY - radiusY, 0, height_ - 1) >> kChunkShift;
+	int32_t lastChunkY = Clamp(centerMapY + radiusY, 0, height_ - 1) >> kChunkShift;
+
+	// 範囲内の常駐チャンクに使った印を付け、足りないチャンクの数を数える
+	size_t missingCount = 0;
+	for (int32_t chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+		for (int32_t chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+			Chunk* chunk = chunks_[GetChunkIndex(chunkX, chunkY)];
+			if (chunk) {
+				chunk->lastUsedFrame = frame_;
+			} else {
+				++missingCount;
+			}
+		}
+	}
+
+	// 読み込む前に場所を空けておく (常駐量が一瞬でも予算を超えないように)
+	EvictUnused(missingCount * chunkBytes_);
+
+	for (int32_t chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+		for (int32_t chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+			if (!chunks_[GetChunkIndex(chunkX, chunkY)]) {
+				LoadChunk(chunkX, chunkY)->lastUsedFrame = frame_;
+			}
+		}
+	}
+}
+
+void ChunkedTileMap::EvictUnused(size_t incomingBytes) {
+	if (memoryBudget_ == 0) {
+		return;
+	}
+	// 予算に収まるまで、このフレームに使っていないチャンクを古い順に捨てる
+	while (stats_.residentBytes + incomingBytes > memoryBudget_) {
+		size_t oldest = residentIndices_.size();
+		uint64_t oldestFrame = frame_;
+		for (size_t i = 0; i < residentIndices_.size(); ++i) {
+			uint64_t lastUsedFrame = chunks_[residentIndices_[i]]->lastUsedFrame;
+			if (lastUsedFrame < oldestFrame) {
+				oldestFrame = lastUsedFrame;
+				oldest = i;
+			}
+		}
+		if (oldest == residentIndices_.size()) {
+			break; // 残りは全部範囲内
+		}
+		EvictChunk(residentIndices_[oldest]);
+	}
+}
+
+bool ChunkedTileMap::IsResident(int32_t chunkX, int32_t chunkY) const {
+	if (static_cast<uint32_t>(chunkX) >= static_cast<uint32_t>(chunkCountX_) ||
+		static_cast<uint32_t>(chunkY) >= static_cast<uint32_t>(chunkCountY_)) {
+		return false;
+	}
+	return chunks_[GetChunkIndex(chunkX, chunkY)] != nullptr;
+}
+
+int32_t ChunkedTileMap::Get(int32_t x, int32_t mapY) const {
+	if (!Contains(x, mapY)) {
+		return -1;
+	}
+	const Chunk* chunk = AcquireChunk(x >> kChunkShift, mapY >> kChunkShift);
+	return chunk->grid.Get(x & (kChunkSize - 1), mapY & (kChunkSize - 1));
+}
+
+void ChunkedTileMap::Set(int32_t x, int32_t mapY, uint8_t type) {
+	if (!Contains(x, mapY)) {
+		return;
+	}
+	Chunk* chunk = AcquireChunk(x >> kChunkShift, mapY >> kChunkShift);
+	int32_t localX = x & (kChunkSize - 1);
+	int32_t localY = mapY & (kChunkSize - 1);
+	uint8_t before = static_cast<uint8_t>(chunk->grid.Get(localX, localY));
+	if (before == type) {
+		return;
+	}
+	chunk->grid.Set(localX, localY, type);
+	chunk->modified = true;
+	++stats_.editCount;
+	if (TileGrid::IsSolidType(before) != TileGrid::IsSolidType(type)) {
+		occupancy_.UpdateRect(chunk->grid, x - localX, mapY - localY, x, mapY, x, mapY);
+	}
+	// ゲーム中の書き換え (SetGridCell) は kTileBlock の出し入れだけで、壁のメッシュは変わらない
+	bool wallsChanged = (before == kTileWall) != (type == kTileWall);
+
+	// 直前の書き換えと同じチャンクなら矩形を広げる
+	if (!changes_.empty()) {
+		TileChange& last = changes_.back();
+		if ((last.rect.x0 >> kChunkShift) == (x >> kChunkShift) && (last.rect.mapY0 >> kChunkShift) == (mapY >> kChunkShift)) {
+			last.rect.x0 = std::min(last.rect.x0, x);
+			last.rect.x1 = std::max(last.rect.x1, x);
+			last.rect.mapY0 = std::min(last.rect.mapY0, mapY);
+			last.rect.mapY1 = std::max(last.rect.mapY1, mapY);
+			last.wallsChanged = last.wallsChanged || wallsChanged;
+			return;
+		}
+	}
+	changes_.push_back({ { x, mapY, x, mapY }, wallsChanged });
+}
+
+void ChunkedTileMap::FlushChanges() {
+	if (changes_.empty()) {
+		return;
+	}
+
+	// チャンクごとに範囲をまとめる (1フレームの書き換えは少ないので線形探索)
+	changedChunks_.clear();
+	for (const TileChange& change : changes_) {
+		const TileRect& rect = change.rect;
+		int32_t index = GetChunkIndex(rect.x0 >> kChunkShift, rect.mapY0 >> kChunkShift);
+		auto it = std::find_if(changedChunks_.begin(), changedChunks_.end(),
+			[index](const std::pair<int32_t, TileChange>& changed) { return changed.first == index; });
+		if (it == changedChunks_.end()) {
+			changedChunks_.push_back({ index, change });
+			continue;
+		}
+		TileRect& merged = it->second.rect;
+		merged.x0 = std::min(merged.x0, rect.x0);
+		merged.x1 = std::max(merged.x1, rect.x1);
+		merged.mapY0 = std::min(merged.mapY0, rect.mapY0);
+		merged.mapY1 = std::max(merged.mapY1, rect.mapY1);
+		it->second.wallsChanged = it->second.wallsChanged || change.wallsChanged;
+	}
+	changes_.clear();
+
+	for (const auto& changed : changedChunks_) {
+		const Chunk* chunk = chunks_[changed.first];
+		if (!chunk) {
+			continue;
+		}
+		const TileChange& change = changed.second;
+		++stats_.changedChunkCount;
+		stats_.wallChangedChunkCount += change.wallsChanged ? 1 : 0;
+		for (TileChunkListener* listener : listeners_) {
+			listener->OnChunkChanged(chunk->chunkX, chunk->chunkY, change.rect, change.wallsChanged, chunk->grid.GetTiles().data());
+		}
+	}
+}
+
+bool ChunkedTileMap::IsSolid(int32_t x, int32_t mapY) const {
+	if (!Contains(x, mapY)) {
+		return false;
+	}
+	const Chunk* chunk = AcquireChunk(x >> kChunkShift, mapY >> kChunkShift);
+	return chunk->grid.IsSolid(x & (kChunkSize - 1), mapY & (kChunkSize - 1));
+}
+
+bool ChunkedTileMap::IsSpanSolid(int32_t mapY, int32_t x0, int32_t x1) const {
+	if (x0 > x1) {
+		std::swap(x0, x1);
+	}
+	// マップの外は壁でないので、はみ出した分は切り落とす
+	x0 = std::max(x0, 0);
+	x1 = std::min(x1, width_ - 1);
+	if (static_cast<uint32_t>(mapY) >= static_cast<uint32_t>(height_) || x0 > x1) {
+		return false;
+	}
+	int32_t chunkY = mapY >> kChunkShift;
+	int32_t localY = mapY & (kChunkSize - 1);
+	for (int32_t chunkX = x0 >> kChunkShift; chunkX <= (x1 >> kChunkShift); ++chunkX) {
+		int32_t base = chunkX << kChunkShift;
+		const Chunk* chunk = AcquireChunk(chunkX, chunkY);
+		if (chunk->grid.IsSpanSolid(localY, std::max(x0, base) - base, std::min(x1, base + kChunkSize - 1) - base)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ChunkedTileMap::IsColumnSolid(int32_t x, int32_t mapY0, int32_t mapY1) const {
+	if (mapY0 > mapY1) {
+		std::swap(mapY0, mapY1);
+	}
+	mapY0 = std::max(mapY0, 0);
+	mapY1 = std::min(mapY1, height_ - 1);
+	if (static_cast<uint32_t>(x) >= static_cast<uint32_t>(width_) || mapY0 > mapY1) {
+		return false;
+	}
+	int32_t chunkX = x >> kChunkShift;
+	int32_t localX = x & (kChunkSize - 1);
+	for (int32_t chunkY = mapY0 >> kChunkShift; chunkY <= (mapY1 >> kChunkShift); ++chunkY) {
+		int32_t base = chunkY << kChunkShift;
+		const Chunk* chunk = AcquireChunk(chunkX, chunkY);
+		if (chunk->grid.IsColumnSolid(localX, std::max(mapY0, base) - base, std::min(mapY1, base + kChunkSize - 1) - base)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ChunkedTileMap::IsRectSolid(int32_t x0, int32_t mapY0, int32_t x1, int32_t mapY1) const {
+	if (x0 > x1) {
+		std::swap(x0, x1);
+	}
+	if (mapY0 > mapY1) {
+		std::swap(mapY0, mapY1);
+	}
+	x0 = std::max(x0, 0);
+	x1 = std::min(x1, width_ - 1);
+	mapY0 = std::max(mapY0, 0);
+	mapY1 = std::min(mapY1, height_ - 1);
+	if (x0 > x1 || mapY0 > mapY1) {
+		return false;
+	}
+	for (int32_t chunkY = mapY0 >> kChunkShift; chunkY <= (mapY1 >> kChunkShift); ++chunkY) {
+		int32_t baseY = chunkY << kChunkShift;
+		int32_t localY0 = std::max(mapY0, baseY) - baseY;
+		int32_t localY1 = std::min(mapY1, baseY + kChunkSize - 1) - baseY;
+		for (int32_t chunkX = x0 >> kChunkShift; chunkX <= (x1 >> kChunkShift); ++chunkX) {
+			int32_t baseX = chunkX << kChunkShift;
+			const Chunk* chunk = AcquireChunk(chunkX, chunkY);
+			if (chunk->grid.IsRectSolid(std::max(x0, baseX) - baseX, localY0, std::min(x1, baseX + kChunkSize - 1) - baseX, localY1)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+ChunkedTileMap::Chunk* ChunkedTileMap::AcquireChunk(int32_t chunkX, int32_t chunkY) const {
+	Chunk* chunk = chunks_[GetChunkIndex(chunkX, chunkY)];
+	if (!chunk) {
+		// Stream の範囲外を調べた (次の Stream で予算を超えていれば捨てられる)
+		chunk = LoadChunk(chunkX, chunkY);
+		++stats_.demandLoadCount;
+	}
+	chunk->lastUsedFrame = frame_;
+	return chunk;
+}
+
+ChunkedTileMap::Chunk* ChunkedTileMap::LoadChunk(int32_t chunkX, int32_t chunkY) const {
+	int32_t index = GetChunkIndex(chunkX, chunkY);
+	Chunk* chunk = new Chunk();
+	chunk->chunkX = chunkX;
+	chunk->chunkY = chunkY;
+
+	// 読めなかったときは空のチャンクとして扱う
+	if (!source_->LoadChunk(chunkX, chunkY, loadBuffer_.data())) {
+		std::fill(loadBuffer_.begin(), loadBuffer_.end(), static_cast<uint8_t>(kTileEmpty));
+	}
+	// 前に書き換えたチャンクなら書き換え後のタイルに戻す
+	auto edited = editedTiles_.find(index);
+	if (edited != editedTiles_.end()) {
+		chunk->grid.Assign(kChunkSize, kChunkSize, edited->second.data());
+		chunk->modified = true;
+		editedTiles_.erase(edited);
+		stats_.editedChunks = editedTiles_.size();
+	} else {
+		chunk->grid.Assign(kChunkSize, kChunkSize, loadBuffer_.data());
+	}
+
+	int32_t x0 = chunkX << kChunkShift;
+	int32_t y0 = chunkY << kChunkShift;
+	occupancy_.UpdateRect(chunk->grid, x0, y0, x0, y0, x0 + kChunkSize - 1, y0 + kChunkSize - 1);
+
+	for (TileChunkListener* listener : listeners_) {
+		listener->OnChunkLoaded(chunkX, chunkY, chunk->grid.GetTiles().data());
+	}
+
+	chunks_[index] = chunk;
+	residentIndices_.push_back(index);
+	++stats_.loadCount;
+	stats_.residentChunks = residentIndices_.size();
+	stats_.residentBytes += chunkBytes_;
+	stats_.peakResidentBytes = std::max(stats_.peakResidentBytes, stats_.residentBytes);
+	return chunk;
+}
+
+void ChunkedTileMap::EvictChunk(int32_t index) {
+	Chunk* chunk = chunks_[index];
+	if (chunk->modified) {
+		editedTiles_[index] = chunk->grid.GetTiles();
+		stats_.editedChunks = editedTiles_.size();
+	}
+	for (TileChunkListener* listener : listeners_) {
+		listener->OnChunkEvicted(chunk->chunkX, chunk->chunkY);
+	}
+
+	auto it = std::find(residentIndices_.begin(), residentIndices_.end(), index);
+	*it = residentIndices_.back();
+	residentIndices_.pop_back();
+	++stats_.evictionCount;
+	stats_.residentChunks = residentIndices_.size();
+	stats_.residentBytes -= chunkBytes_;
+
+	chunks_[index] = nullptr;
+	delete chunk;
+}
+
+void ChunkedTileMap::ReleaseChunks(bool notify) {
+	for (int32_t index : residentIndices_) {
+		Chunk* chunk = chunks_[index];
+		if (notify) {
+			for (TileChunkListener* listener : listeners_) {
+				listener->OnChunkEvicted(chunk->chunkX, chunk->chunkY);
+			}
+		}
+		chunks_[index] = nullptr;
+		delete chunk;
+	}
+	residentIndices_.clear();
+	stats_.residentChunks = 0;
+	stats_.residentBytes = 0;
+}
@@ -0,0 +1,226 @@
+#pragma once
+#include "MapFile.h"
+#include "TileGrid.h"
+#include "TileOccupancy.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// チャンクに分けたタイルマップ (Windows / D3D12 に依存しない)
+//
+// マップを kChunkSize 四方のチャンクに分け、カメラの周りのチャンクだけを読み込んでおく。
+// 読み込み元 (TileChunkSource) はメモリ上のマップでも .mapbin のファイルでもよく、
+// 画面より大きなマップでも常駐するのは予算分のチャンクだけになる。
+// 当たり判定は TileGrid と同じ関数をマップ全体の座標で受け付け、チャンクの境目をまたいでも同じ結果を返す。
+//
+// Set で書き換えたマスは変更履歴 (チャンクごとの矩形) に積んでおき、FlushChanges で
+// 書き換えのあったチャンクごとに1回だけ通知する (メッシュなどの作り直しは1フレームに1回で済む)。
+// 通知には壁 (kTileWall) の有無が変わったかを添え、kTileBlock の出し入れだけなら壁のメッシュは作り直さない。
+// 壁の有無の粗い階層 (TileOccupancy) はチャンクを読み込んだときと Set のたびにその場で更新する
+// (光線などが空の場所を飛び越すのに使う。捨てたチャンクの分は、中身が変わらないのでそのまま残す)。
+
+// チャンクの一辺 (タイル数)
+static const int32_t kChunkShift = 5;
+static const int32_t kChunkSize = 1 << kChunkShift;
+static const int32_t kChunkTileCount = kChunkSize * kChunkSize;
+
+// チャンクの読み込み元
+class TileChunkSource {
+public:
+	virtual ~TileChunkSource() = default;
+
+	virtual int32_t GetWidth() const = 0;
+	virtual int32_t GetHeight() const = 0;
+
+	// チャンク (chunkX, chunkY) の kChunkSize * kChunkSize タイルを行優先で tiles に書く
+	// (マップの外にはみ出した部分は kTileEmpty)
+	virtual bool LoadChunk(int32_t chunkX, int32_t chunkY, uint8_t* tiles) = 0;
+
+	// スタート・ゴール・動的ブロック (数が少ないので最初に全部読んでおく)
+	virtual const std::vector<MapObject>& GetObjects() const = 0;
+};
+
+// メモリ上のマップから切り出す (CSV / TSV 用)
+class MapDataChunkSource : public TileChunkSource {
+public:
+	explicit MapDataChunkSource(MapData map) : map_(std::move(map)) {}
+
+	int32_t GetWidth() const override { return map_.width; }
+	int32_t GetHeight() const override { return map_.height; }
+	bool LoadChunk(int32_t chunkX, int32_t chunkY, uint8_t* tiles) override;
+	const std::vector<MapObject>& GetObjects() const override { return map_.objects; }
+
+private:
+	MapData map_;
+};
+
+// .mapbin から必要な行だけ読む (ファイルは開いたままにする)
+class MapBinChunkSource : public TileChunkSource {
+public:
+	// ヘッダーと表を読んで大きさを確かめる (壊れていたら false)
+	bool Open(const std::string& path);
+
+	int32_t GetWidth() const override { return header_.width; }
+	int32_t GetHeight() const override { return header_.height; }
+	bool LoadChunk(int32_t chunkX, int32_t chunkY, uint8_t* tiles) override;
+	const std::vector<MapObject>& GetObjects() const override { return objects_; }
+
+private:
+	std::ifstream file_;
+	MapBinHeader header_{};
+	std::vector<MapObject> objects_;
+};
+
+// 拡張子で読み込み元を選ぶ (.mapbin はファイルから少しずつ、それ以外は全体を解析してから切り出す)
+std::unique_ptr<TileChunkSource> OpenTileChunkSource(const std::string& path, std::string* errorMessage = nullptr);
+
+// マップ全体の座標での矩形 (両端を含む)
+struct TileRect {
+	int32_t x0;
+	int32_t mapY0;
+	int32_t x1;
+	int32_t mapY1;
+};
+
+// まだ通知していない書き換え (rect はどれも1つのチャンクに収まる)
+struct TileChange {
+	TileRect rect;
+	bool wallsChanged; // kTileWall になった・kTileWall でなくなったマスがある (kTileBlock の置き換えだけなら false)
+};
+
+// チャンクの読み込み・破棄・書き換えの通知 (描画データや当たり判定の補助データを作る側が受け取る)
+// tiles はそのチャンクの今のタイル (kChunkSize * kChunkSize、行優先)
+class TileChunkListener {
+public:
+	virtual ~TileChunkListener() = default;
+
+	virtual void OnChunkLoaded(int32_t chunkX, int32_t chunkY, const uint8_t* tiles) = 0;
+	virtual void OnChunkEvicted(int32_t chunkX, int32_t chunkY) = 0;
+	// dirtyRect はこのチャンクの中で書き換えのあった範囲をまとめたもの
+	// wallsChanged は壁 (kTileWall) の有無が変わったマスがあるか (壁のメッシュは false なら作り直さなくてよい)
+	virtual void OnChunkChanged(int32_t chunkX, int32_t chunkY, const TileRect& dirtyRect, bool wallsChanged, const uint8_t* tiles) = 0;
+};
+
+// 常駐チャンクの統計
+struct ChunkStreamStats {
+	size_t residentChunks = 0;
+	size_t residentBytes = 0;
+	size_t peakResidentBytes = 0;
+	size_t editedChunks = 0;   // 書き換えがあって捨てずに覚えているチャンク
+	uint64_t loadCount = 0;
+	uint64_t evictionCount = 0;
+	uint64_t demandLoadCount = 0; // Stream の範囲外を当たり判定で読んだ回数
+	uint64_t editCount = 0;        // 値が変わった Set の回数
+	uint64_t changedChunkCount = 0; // FlushChanges で通知したチャンクの延べ数
+	uint64_t wallChangedChunkCount = 0; // そのうち壁の有無が変わったチャンク
+};
+
+class ChunkedTileMap {
+public:
+	ChunkedTileMap() = default;
+	~ChunkedTileMap();
+	ChunkedTileMap(const ChunkedTileMap&) = delete;
+	const ChunkedTileMap& operator=(const ChunkedTileMap&) = delete;
+
+	// 読み込み元を差し替える (常駐チャンクと書き換えは全部捨てる)
+	// memoryBudget は常駐チャンクのバイト数の上限 (0 なら上限なし)
+	void Reset(std::unique_ptr<TileChunkSource> source, size_t memoryBudget = 0);
+
+	// 通知先 (登録した順に通知する)
+	void AddListener(TileChunkListener* listener);
+	void RemoveListener(TileChunkListener* listener);
+
+	int32_t GetWidth() const { return width_; }
+	int32_t GetHeight() const { return height_; }
+	int32_t GetChunkCountX() const { return chunkCountX_; }
+	int32_t GetChunkCountY() const { return chunkCountY_; }
+	const std::vector<MapObject>& GetObjects() const;
+
+	// (centerX, centerMapY) から各方向 radiusX / radiusY タイルにかかるチャンクを読み込み、
+	// 予算を超えていれば範囲外のチャンクを古い順に捨てる (毎フレーム1回呼ぶ)
+	// 範囲内のチャンクだけで予算を超えるときは範囲を優先する
+	void Stream(int32_t centerX, int32_t centerMapY, int32_t radiusX, int32_t radiusY);
+
+	bool Contains(int32_t x, int32_t mapY) const {
+		return static_cast<uint32_t>(x) < static_cast<uint32_t>(width_) && static_cast<uint32_t>(mapY) < static_cast<uint32_t>(height_);
+	}
+
+	// 以下は TileGrid と同じ (範囲外は -1 / 壁でない)
+	// 常駐していないチャンクはその場で読み込む
+	int32_t Get(int32_t x, int32_t mapY) const;
+	void Set(int32_t x, int32_t mapY, uint8_t type);
+	bool IsSolid(int32_t x, int32_t mapY) const;
+	bool IsSpanSolid(int32_t mapY, int32_t x0, int32_t x1) const;
+	bool IsColumnSolid(int32_t x, int32_t mapY0, int32_t mapY1) const;
+	bool IsRectSolid(int32_t x0, int32_t mapY0, int32_t x1, int32_t mapY1) const;
+
+	// 常駐しているチャンクか
+	bool IsResident(int32_t chunkX, int32_t chunkY) const;
+
+	// 壁の有無の粗い階層 (まだ読み込んでいないチャンクは壁があるものとして扱う)
+	const TileOccupancy& GetOccupancy() const { return occupancy_; }
+
+	// まだ通知していない書き換え (同じチャンクへの連続した書き換えは1つの矩形にまとまる)
+	const std::vector<TileChange>& GetPendingChanges() const { return changes_; }
+
+	// 書き換えのあった常駐チャンクごとに OnChunkChanged を1回ずつ送り、履歴を空にする (1フレームに1回呼ぶ)
+	// 通知前に捨てられたチャンクは、次に読み込んだときの OnChunkLoaded で今のタイルが渡る
+	void FlushChanges();
+
+	const ChunkStreamStats& GetStats() const { return stats_; }
+
+private:
+	struct Chunk {
+		int32_t chunkX = 0;
+		int32_t chunkY = 0;
+		TileGrid grid;
+		uint64_t lastUsedFrame = 0;
+		bool modified = false;
+	};
+
+	int32_t GetChunkIndex(int32_t chunkX, int32_t chunkY) const { return chunkY * chunkCountX_ + chunkX; }
+
+	// 範囲内のチャンク (常駐していなければ読み込む)
+	Chunk* AcquireChunk(int32_t chunkX, int32_t chunkY) const;
+	Chunk* LoadChunk(int32_t chunkX, int32_t chunkY) const;
+	void EvictChunk(int32_t index);
+	// incomingBytes を読み込んでも予算に収まるよう、このフレームに使っていないチャンクを捨てる
+	void EvictUnused(size_t incomingBytes);
+	// 常駐チャンクを全部解放する (notify なら通知も送る)
+	void ReleaseChunks(bool notify);
+
+	static int32_t Clamp(int32_t value, int32_t minValue, int32_t maxValue) {
+		return value < minValue ? minValue : (value > maxValue ? maxValue : value);
+	}
+
+private:
+	std::unique_ptr<TileChunkSource> source_;
+	std::vector<TileChunkListener*> listeners_;
+	int32_t width_ = 0;
+	int32_t height_ = 0;
+	int32_t chunkCountX_ = 0;
+	int32_t chunkCountY_ = 0;
+	size_t memoryBudget_ = 0;
+	size_t chunkBytes_ = 0;
+
+	// 当たり判定 (const) からも読み込むのでキャッシュ部分は mutable
+	// チャンクの表 (chunkY * chunkCountX + chunkX、常駐していなければ nullptr)
+	mutable std::vector<Chunk*> chunks_;
+	mutable std::vector<int32_t> residentIndices_;
+	// 書き換えのあったチャンクは捨てるときにタイルを覚えておき、次に読むときに戻す
+	mutable std::unordered_map<int32_t, std::vector<uint8_t>> editedTiles_;
+	mutable std::vector<uint8_t> loadBuffer_;
+	mutable TileOccupancy occupancy_;
+	mutable uint64_t frame_ = 0;
+	mutable ChunkStreamStats stats_;
+
+	// 変更履歴
+	std::vector<TileChange> changes_;
+	// FlushChanges の作業用 (チャンク番号 -> そのチャンクの範囲)
+	std::vector<std::pair<int32_t, TileChange>> changedChunks_;
+};
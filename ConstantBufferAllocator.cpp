@@ -0,0 +1,52 @@
+#include "ConstantBufferAllocator.h"
+#include "D3D12Util.h"
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <Windows.h> // OutputDebugStringA
+
+ConstantBufferAllocator* ConstantBufferAllocator::GetInstance() {
+	static ConstantBufferAllocator instance;
+	return &instance;
+}
+
+void ConstantBufferAllocator::Initialize(ID3D12Device* device, uint64_t sizeInBytes) {
+	// 端数は切り上げて256バイトの倍数にする
+	uint64_t capacity = (sizeInBytes + kAlignment - 1) & ~(kAlignment - 1);
+	resource_ = CreateBufferResource(device, static_cast<size_t>(capacity));
+	resource_->Map(0, nullptr, reinterpret_cast<void**>(&mappedData_));
+	gpuAddress_ = resource_->GetGPUVirtualAddress();
+	ring_.Initialize(capacity);
+}
+
+void ConstantBufferAllocator::Finalize() {
+	ring_.Reset();
+	mappedData_ = nullptr;
+	gpuAddress_ = 0;
+	resource_.Reset();
+}
+
+void ConstantBufferAllocator::BeginFrame(uint64_t completedFenceValue) {
+	ring_.ReleaseCompletedFrames(completedFenceValue);
+}
+
+void ConstantBufferAllocator::EndFrame(uint64_t fenceValue) {
+	ring_.FinishFrame(fenceValue);
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS ConstantBufferAllocator::Push(const void* data, size_t sizeInBytes) {
+	if (!mappedData_) {
+		return 0;
+	}
+
+	uint64_t offset = ring_.Allocate(sizeInBytes, kAlignment);
+	if (offset == RingAllocator::kInvalidOffset) {
+		std::string message = "[ConstantBufferAllocator] Out of memory: " + std::to_string(ring_.GetUsedSize()) + " / " + std::to_string(ring_.GetCapacity()) + " bytes in use\n";
+		OutputDebugStringA(message.c_str());
+		assert(false);
+		return 0;
+	}
+
+	std::memcpy(mappedData_ + offset, data, sizeInBytes);
+	return gpuAddress_ + offset;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "RingAllocator.h"
+#include <d3d12.h>
+#include <wrl.h>
+#include <cstdint>
+
+// 描画ごとの定数データを1本のアップロードバッファから切り出すクラス
+// 同じモデルを1フレームに何度描画しても、描画ごとに別の領域を参照できる
+class ConstantBufferAllocator {
+public:
+	// CBVのアドレスは256バイト境界に合わせる必要がある
+	static const uint64_t kAlignment = RingAllocator::kConstantBufferAlignment;
+
+	// シングルトンインスタンスの取得
+	static ConstantBufferAllocator* GetInstance();
+
+	// 初期化 (全フレーム分をまかなうバッファサイズを指定)
+	void Initialize(ID3D12Device* device, uint64_t sizeInBytes);
+
+	// 終了処理
+	void Finalize();
+
+	// フレームの開始 (GPUが完了したフレームの領域を再利用可能にする)
+	void BeginFrame(uint64_t completedFenceValue);
+
+	// フレームの終了 (このフレームの確保をフェンス値に紐づける)
+	void EndFrame(uint64_t fenceValue);
+
+	// データを書き込み、そのGPUアドレスを返す (確保できなければ0)
+	D3D12_GPU_VIRTUAL_ADDRESS Push(const void* data, size_t sizeInBytes);
+
+	template<typename T>
+	D3D12_GPU_VIRTUAL_ADDRESS Push(const T& data) { return Push(&data, sizeof(T)); }
+
+	const RingAllocator& GetRing() const { return ring_; }
+
+private:
+	ConstantBufferAllocator() = default;
+	~ConstantBufferAllocator() = default;
+	ConstantBufferAllocator(const ConstantBufferAllocator&) = delete;
+	const ConstantBufferAllocator& operator=(const ConstantBufferAllocator&) = delete;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource_;
+	uint8_t* mappedData_ = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress_ = 0;
+	RingAllocator ring_;
+};
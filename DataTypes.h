@@ -1,5 +1,6 @@
 #pragma once
 #include "MathTypes.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -10,6 +11,21 @@ struct VertexData {
 	Vector3 normal;
 };
 
+// 圧縮頂点データ (20バイト。Object3d.VS.hlsl の COMPACT_VERTEX と一致させる)
+// 位置の w は常に 1 なので持たない。UV は half、法線は八面体写像の 16bit SNORM
+struct CompactVertexData {
+	float position[3];   // R32G32B32_FLOAT
+	uint16_t texcoord[2]; // R16G16_FLOAT
+	int16_t normal[2];    // R16G16_SNORM
+};
+
+// メッシュの頂点形式
+enum VertexFormat {
+	kVertexFormatFull,    // VertexData (36バイト)
+	kVertexFormatCompact, // CompactVertexData (20バイト)
+	kCountOfVertexFormat, // カウント用
+};
+
 // マテリアル
 struct Material {
 	Vector4 color;
@@ -25,6 +41,12 @@ struct TransformationMatrix {
 	// ★修正点: カメラ座標をここから削除
 };
 
+// インスタンス描画用の1インスタンス分のデータ (Resources/Object3d.VS.hlsl の InstancingData と一致させる)
+struct InstancingData {
+	Matrix4x4 WVP;
+	Matrix4x4 World;
+};
+
 // ★修正点: カメラ専用の構造体を追加
 struct CameraForGpu {
 	Vector3 worldPosition;
@@ -46,4 +68,11 @@ struct MaterialData {
 struct ModelData {
 	std::vector<VertexData> vertices;
 	MaterialData material;
+};
+
+// インデックス付きのモデルデータ (同じ頂点は1つにまとめてある)
+struct IndexedModelData {
+	std::vector<VertexData> vertices;
+	std::vector<uint32_t> indices;
+	MaterialData material;
 };
\ No newline at end of file
@@ -32,6 +32,9 @@ public:
     ID3D12DescriptorHeap* GetRtvDescriptorHeap() const { return rtvDescriptorHeap_.Get(); }
     D3D12_RENDER_TARGET_VIEW_DESC GetRtvDesc() const { return rtvDesc_; }
     UINT GetBackBufferCount() const { return kBackBufferCount_; }
+    // 最後に PostDraw でシグナルしたフェンス値と、GPUが通過したフェンス値
+    UINT64 GetFenceValue() const { return fenceValue_; }
+    UINT64 GetCompletedFenceValue() const { return fence_->GetCompletedValue(); }
 
     // ★★★ main.cpp (テクスチャロード用) に追加 ★★★
     void ExecuteCommand();
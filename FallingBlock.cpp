@@ -1,18 +1,15 @@
 #include "FallingBlock.h"
+#include "StateHash.h"
 #include <cmath> // std::abs
-#include "DirectXCommon.h" 
 
-FallingBlock::~FallingBlock() {
-    delete model_;
-}
-
-void FallingBlock::Initialize(ID3D12Device* device, const Vector3& initialPos, BlockType type) {
-    model_ = Model::Create("Resources/Trap", "Trap.obj", device);
+void FallingBlock::Initialize(const Vector3& initialPos, BlockType type, int32_t objectId) {
     initialPos_ = initialPos;
     type_ = type;
-    model_->transform.scale = { MapChip::kBlockSize, MapChip::kBlockSize, MapChip::kBlockSize };
+    objectId_ = objectId;
+    transform_.scale = { GameMap::kBlockSize, GameMap::kBlockSize, GameMap::kBlockSize };
     state_ = BlockState::Idle;
-    model_->transform.translate = initialPos_;
+    transform_.translate = initialPos_;
+    previousTranslate_ = initialPos_;
     landedY_ = initialPos_.y;
     lastLandedGridX_ = -1;
     lastLandedGridMapY_ = -1;
@@ -20,20 +17,26 @@ void FallingBlock::Initialize(ID3D12Device* device, const Vector3& initialPos, B
     isCeiling_ = false;
 }
 
-void FallingBlock::Reset(MapChip* mapChip) {
+void FallingBlock::Reset(GameMap* map) {
     if (lastLandedGridX_ != -1 && lastLandedGridMapY_ != -1) {
-        mapChip->SetGridCell(lastLandedGridX_, lastLandedGridMapY_, 0);
+        map->SetGridCell(lastLandedGridX_, lastLandedGridMapY_, 0);
     }
-    model_->transform.translate = initialPos_;
+    transform_.translate = initialPos_;
+    previousTranslate_ = initialPos_;
     state_ = BlockState::Idle;
     landedY_ = initialPos_.y;
     lastLandedGridX_ = -1;
     lastLandedGridMapY_ = -1;
     moveDirX_ = 0.0f;
     isCeiling_ = false;
+    if (objectId_ >= 0) {
+        map->MoveObject(objectId_, initialPos_);
+    }
 }
 
-void FallingBlock::Update(Player* player, MapChip* mapChip) {
+void FallingBlock::Update(Player* player, GameMap* map) {
+    previousTranslate_ = transform_.translate;
+
     // プレイヤー生存時のみ接触判定（即死）を行う
     if (player->IsAlive() && CheckCollision(player)) {
         player->Die();
@@ -41,28 +44,28 @@ void FallingBlock::Update(Player* player, MapChip* mapChip) {
     }
 
     const Vector3& playerPos = player->GetPosition();
-    Vector3& blockPos = model_->transform.translate;
+    Vector3& blockPos = transform_.translate;
 
     float dx = std::abs(playerPos.x - blockPos.x);
     float dy = playerPos.y - blockPos.y;
     float distSq = (playerPos.x - blockPos.x) * (playerPos.x - blockPos.x) +
         (playerPos.y - blockPos.y) * (playerPos.y - blockPos.y);
 
-    float halfSize = MapChip::kBlockSize / 2.0f;
+    float halfSize = GameMap::kBlockSize / 2.0f;
 
     // マップの上端Y座標を計算 (rowCount * size)
     // マップチップの仕様上、一番下のブロックの中心Yは kBlockSize/2
     // 一番上のブロックの中心Yは (rowCount-1)*size + size/2
-    float mapTopY = static_cast<float>(mapChip->GetRowCount()) * MapChip::kBlockSize;
+    float mapTopY = static_cast<float>(map->GetRowCount()) * GameMap::kBlockSize;
 
     switch (state_) {
     case BlockState::Idle:
     {
         if (lastLandedGridX_ == -1 && type_ != BlockType::StaticHazard && !isCeiling_) {
             int gridX, gridMapY;
-            mapChip->GetGridCoordinates(blockPos, gridX, gridMapY);
+            map->GetGridCoordinates(blockPos, gridX, gridMapY);
             if (gridX != -1) {
-                mapChip->SetGridCell(gridX, gridMapY, 1);
+                map->SetGridCell(gridX, gridMapY, 1);
                 lastLandedGridX_ = gridX;
                 lastLandedGridMapY_ = gridMapY;
             }
@@ -73,7 +76,7 @@ void FallingBlock::Update(Player* player, MapChip* mapChip) {
 
         if (player->IsAlive()) {
             if (type_ == BlockType::FallOnly || type_ == BlockType::Spike) {
-                float kSearchRange = MapChip::kBlockSize * 5.0f;
+                float kSearchRange = GameMap::kBlockSize * 5.0f;
                 if (isAlignX && dy < 0 && dy > -kSearchRange) {
                     state_ = BlockState::Falling;
                     shouldAct = true;
@@ -84,7 +87,7 @@ void FallingBlock::Update(Player* player, MapChip* mapChip) {
                     shouldAct = true;
                 }
             } else if (type_ == BlockType::SideAttack) {
-                float kTriggerRadius = MapChip::kBlockSize * 6.0f;
+                float kTriggerRadius = GameMap::kBlockSize * 6.0f;
                 if (distSq < kTriggerRadius * kTriggerRadius) {
                     state_ = BlockState::MovingSide;
                     shouldAct = true;
@@ -105,7 +108,7 @@ void FallingBlock::Update(Player* player, MapChip* mapChip) {
         }
 
         if (shouldAct && lastLandedGridX_ != -1) {
-            mapChip->SetGridCell(lastLandedGridX_, lastLandedGridMapY_, 0);
+            map->SetGridCell(lastLandedGridX_, lastLandedGridMapY_, 0);
             lastLandedGridX_ = -1;
             lastLandedGridMapY_ = -1;
         }
@@ -114,26 +117,18 @@ void FallingBlock::Update(Player* player, MapChip* mapChip) {
 
     case BlockState::Falling:
     {
-        blockPos.y -= kFallSpeed_;
-        Vector3 footPos = { blockPos.x, blockPos.y - halfSize - 0.01f, 0.0f };
-        if (mapChip->CheckCollision(footPos)) {
-            int gx, gy;
-            mapChip->GetGridCoordinates(footPos, gx, gy);
-            int tileType = mapChip->GetGridValue(gx, gy);
-            // プレイヤー初期位置(2)はすり抜けるが、それ以外のブロック(1)なら着地
-            if (tileType == 2) {
-                // mapChip->SetGridCell(gx, gy, 0); // ここで消すとリスポーン地点が消える可能性があるので注意
-            } else {
-                state_ = BlockState::Landed;
-                blockPos.y = floor(footPos.y / MapChip::kBlockSize) * MapChip::kBlockSize + MapChip::kBlockSize + halfSize;
-                landedY_ = blockPos.y;
-                isCeiling_ = false;
-                if (gx != -1) {
-                    mapChip->SetGridCell(gx, gy, 1);
-                    lastLandedGridX_ = gx;
-                    lastLandedGridMapY_ = gy;
-                }
-            }
+        // 足元の壁まで落ちる (落下が速くても床を抜けない)
+        WorldRect box = { blockPos.x - halfSize, blockPos.y - halfSize, blockPos.x + halfSize, blockPos.y + halfSize };
+        TileSweepResult sweep = map->SweepAABB(box, { 0.0f, -kFallSpeed_ });
+        blockPos.y -= kFallSpeed_ * sweep.time;
+        if (sweep.hit) {
+            state_ = BlockState::Landed;
+            landedY_ = blockPos.y;
+            isCeiling_ = false;
+            // 乗った床のマスを覚える (地形の壁なら SetGridCell は書き換えない)
+            map->SetGridCell(sweep.tileX, sweep.tileMapY, 1);
+            lastLandedGridX_ = sweep.tileX;
+            lastLandedGridMapY_ = sweep.tileMapY;
         }
     }
     break;
@@ -142,9 +137,9 @@ void FallingBlock::Update(Player* player, MapChip* mapChip) {
     {
         if (lastLandedGridX_ == -1 && type_ != BlockType::StaticHazard && !isCeiling_) {
             int gridX, gridMapY;
-            mapChip->GetGridCoordinates(blockPos, gridX, gridMapY);
+            map->GetGridCoordinates(blockPos, gridX, gridMapY);
             if (gridX != -1) {
-                mapChip->SetGridCell(gridX, gridMapY, 1);
+                map->SetGridCell(gridX, gridMapY, 1);
                 lastLandedGridX_ = gridX;
                 lastLandedGridMapY_ = gridMapY;
             }
@@ -155,18 +150,18 @@ void FallingBlock::Update(Player* player, MapChip* mapChip) {
                 if (isAlignX && playerPos.y > blockPos.y) {
                     state_ = BlockState::Rising;
                     if (lastLandedGridX_ != -1) {
-                        mapChip->SetGridCell(lastLandedGridX_, lastLandedGridMapY_, 0);
+                        map->SetGridCell(lastLandedGridX_, lastLandedGridMapY_, 0);
                         lastLandedGridX_ = -1;
                         lastLandedGridMapY_ = -1;
                     }
                 }
             } else if (type_ == BlockType::RiseThenFall && isCeiling_) {
-                float kSearchRange = MapChip::kBlockSize * 10.0f;
+                float kSearchRange = GameMap::kBlockSize * 10.0f;
                 if (isAlignX && dy < 0 && dy > -kSearchRange) {
                     state_ = BlockState::Falling;
                     isCeiling_ = false;
                     if (lastLandedGridX_ != -1) {
-                        mapChip->SetGridCell(lastLandedGridX_, lastLandedGridMapY_, 0);
+                        map->SetGridCell(lastLandedGridX_, lastLandedGridMapY_, 0);
                         lastLandedGridX_ = -1;
                         lastLandedGridMapY_ = -1;
                     }
@@ -178,35 +173,19 @@ void FallingBlock::Update(Player* player, MapChip* mapChip) {
 
     case BlockState::Rising:
     {
-        blockPos.y += kRiseSpeed_;
+        // 頭上の壁まで上がる
+        WorldRect box = { blockPos.x - halfSize, blockPos.y - halfSize, blockPos.x + halfSize, blockPos.y + halfSize };
+        TileSweepResult sweep = map->SweepAABB(box, { 0.0f, kRiseSpeed_ });
+        blockPos.y += kRiseSpeed_ * sweep.time;
+        bool hitCeiling = sweep.hit;
 
         // ★修正点: マップ上端チェック
         // ブロックの上端がマップの最上部を超えたら強制停止させる
-        float blockTop = blockPos.y + halfSize;
-        bool hitCeiling = false;
-
-        // 1. マップ範囲外（上）に出たか？
-        if (blockTop >= mapTopY) {
+        if (blockPos.y + halfSize >= mapTopY) {
             hitCeiling = true;
             // 位置補正: マップ上端の内側に収める（天井に張り付く）
             blockPos.y = mapTopY - halfSize;
         }
-        // 2. 通常のブロック衝突判定
-        else {
-            Vector3 headPos = { blockPos.x, blockPos.y + halfSize + 0.01f, 0.0f };
-            if (mapChip->CheckCollision(headPos)) {
-                int gx, gy;
-                mapChip->GetGridCoordinates(headPos, gx, gy);
-                int tileType = mapChip->GetGridValue(gx, gy);
-                if (tileType == 2) {
-                    // mapChip->SetGridCell(gx, gy, 0); 
-                } else {
-                    hitCeiling = true;
-                    // 位置補正: 衝突したブロックの下側に収める
-                    blockPos.y = floor(headPos.y / MapChip::kBlockSize) * MapChip::kBlockSize - halfSize;
-                }
-            }
-        }
 
         // 天井にぶつかった（またはマップ端に達した）場合の処理
         if (hitCeiling) {
@@ -218,9 +197,9 @@ void FallingBlock::Update(Player* player, MapChip* mapChip) {
                 // 今回は「天井待機中」として扱い、マップデータは書き換えないか、
                 // あるいは書き換えるなら座標を再取得する。
                 int gx, gy;
-                mapChip->GetGridCoordinates(blockPos, gx, gy);
+                map->GetGridCoordinates(blockPos, gx, gy);
                 if (gx != -1) {
-                    mapChip->SetGridCell(gx, gy, 1);
+                    map->SetGridCell(gx, gy, 1);
                     lastLandedGridX_ = gx;
                     lastLandedGridMapY_ = gy;
                 }
@@ -235,11 +214,10 @@ void FallingBlock::Update(Player* player, MapChip* mapChip) {
     }
     break;
     }
-    model_->transform.translate = blockPos;
-}
-
-void FallingBlock::Draw(ID3D12GraphicsCommandList* commandList, const Matrix4x4& viewProjectionMatrix, D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress, D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandle) {
-    model_->Draw(commandList, viewProjectionMatrix, lightGpuAddress, textureSrvHandle);
+    transform_.translate = blockPos;
+    if (objectId_ >= 0) {
+        map->MoveObject(objectId_, blockPos);
+    }
 }
 
 bool FallingBlock::CheckCollision(Player* player) {
@@ -249,12 +227,21 @@ bool FallingBlock::CheckCollision(Player* player) {
     float pRight = pPos.x + pSize;
     float pTop = pPos.y + pSize;
     float pBottom = pPos.y - pSize;
-    Vector3 wPos = model_->transform.translate;
-    float halfSize = MapChip::kBlockSize / 2.0f;
+    Vector3 wPos = transform_.translate;
+    float halfSize = GameMap::kBlockSize / 2.0f;
     float wLeft = wPos.x - halfSize;
     float wRight = wPos.x + halfSize;
     float wTop = wPos.y + halfSize;
     float wBottom = wPos.y - halfSize;
     if (pLeft > wRight || pRight < wLeft || pTop < wBottom || pBottom > wTop) { return false; }
     return true;
+}
+
+void FallingBlock::AddState(StateHasher& hasher) const {
+    hasher.Add(static_cast<uint32_t>(state_) | static_cast<uint32_t>(isCeiling_) << 8);
+    hasher.Add(transform_.translate);
+    hasher.Add(landedY_);
+    hasher.Add(lastLandedGridX_);
+    hasher.Add(lastLandedGridMapY_);
+    hasher.Add(moveDirX_);
 }
\ No newline at end of file
@@ -1,9 +1,8 @@
 #pragma once
-#include "Model.h"
+#include "MathTypes.h"
 #include "Player.h"
-#include "MapChip.h"
-#include <d3d12.h>
-#include <wrl.h>
+#include "GameMap.h"
+#include "FixedTimestep.h"
 
 // ブロックの種類
 enum class BlockType {
@@ -27,25 +26,28 @@ enum class BlockState {
 
 class FallingBlock {
 public:
-    ~FallingBlock();
+    // objectId は GameMap の位置の索引での番号 (動いたら索引を書き換える。-1 なら登録しない)
+    void Initialize(const Vector3& initialPos, BlockType type, int32_t objectId);
+    void Update(Player* player, GameMap* map);
+    void Reset(GameMap* map);
 
-    void Initialize(ID3D12Device* device, const Vector3& initialPos, BlockType type);
-    void Update(Player* player, MapChip* mapChip);
-    void Draw(
-        ID3D12GraphicsCommandList* commandList,
-        const Matrix4x4& viewProjectionMatrix,
-        D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress,
-        D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandle);
-    void Reset(MapChip* mapChip);
+    const Vector3& GetPosition() const { return transform_.translate; }
+    // 描画用 (メッシュは描く側が持つ)
+    const Transform& GetTransform() const { return transform_; }
+    Transform GetRenderTransform(float alpha) const { return InterpolateTransform(previousTranslate_, transform_, alpha); }
+    // 状態・位置・着地したマス・横移動の向きをハッシュに足す
+    void AddState(StateHasher& hasher) const;
 
 private:
     bool CheckCollision(Player* player);
 
 private:
-    Model* model_ = nullptr;
+    Transform transform_{};
+    Vector3 previousTranslate_{}; // 前のティックの位置 (描画の補間用)
     Vector3 initialPos_{};
     BlockType type_ = BlockType::FallOnly;
     BlockState state_ = BlockState::Idle;
+    int32_t objectId_ = -1;
 
     // パラメータ
     const float kFallSpeed_ = 0.2f;
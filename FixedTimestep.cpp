@@ -0,0 +1,46 @@
+#include "FixedTimestep.h"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+// これより小さな差はティックの境目に届いたとみなす (秒)
+// kTickSeconds は float なので、60Hz の画面の 1/60 秒とわずかにずれ、放っておくと
+// ティックの境目の直前で止まり続けて、ときどきティックのないフレームが出る
+const double kBoundaryEpsilon = 1e-6;
+
+} // namespace
+
+FixedTimestep::FixedTimestep(double tickSeconds, int32_t maxTicksPerFrame)
+    : tickSeconds_(tickSeconds), maxTicksPerFrame_(maxTicksPerFrame) {
+    assert(tickSeconds > 0.0 && maxTicksPerFrame > 0);
+}
+
+void FixedTimestep::Reset() {
+    accumulator_ = 0.0;
+    tickCount_ = 0;
+    droppedTickCount_ = 0;
+}
+
+int32_t FixedTimestep::Advance(double elapsedSeconds) {
+    // 時計が戻ったときなどは進めない
+    if (!(elapsedSeconds > 0.0)) {
+        return 0;
+    }
+    accumulator_ += elapsedSeconds;
+
+    int32_t ticks = 0;
+    while (accumulator_ + kBoundaryEpsilon >= tickSeconds_ && ticks < maxTicksPerFrame_) {
+        accumulator_ -= tickSeconds_;
+        ++ticks;
+    }
+    // 上限まで進めても残っている分は追いつかず捨てる (1ティック未満の端数は次のフレームへ)
+    if (accumulator_ + kBoundaryEpsilon >= tickSeconds_) {
+        double dropped = static_cast<double>(static_cast<uint64_t>((accumulator_ + kBoundaryEpsilon) / tickSeconds_));
+        droppedTickCount_ += static_cast<uint64_t>(dropped);
+        accumulator_ -= dropped * tickSeconds_;
+    }
+    accumulator_ = std::max(accumulator_, 0.0);
+    tickCount_ += static_cast<uint64_t>(ticks);
+    return ticks;
+}
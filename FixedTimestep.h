@@ -0,0 +1,49 @@
+#pragma once
+#include "MathTypes.h"
+#include <cstdint>
+
+// シミュレーションの1ティックの長さ (秒)
+// 速度は「1ティックに進む量」、タイマーはこの値ずつ減らす。画面の更新間隔には使わない
+constexpr float kTickSeconds = 1.0f / 60.0f;
+
+// 描画のフレームの長さによらず、決まった間隔でティックを進めるための積算
+//
+// 毎フレーム経過時間を Advance に渡し、返った回数だけ Step する。
+// 144Hz の画面では何もしないフレームが、30Hz では2ティック進むフレームが混ざる。
+// 重いフレームの後に追いつこうとしてさらに重くなる (spiral of death) のを避けるため、
+// 1フレームに進めるティック数には上限があり、超えた分の時間は捨てる (ゲームがその分遅れる)。
+class FixedTimestep {
+public:
+    // maxTicksPerFrame: 1フレームに進める最大のティック数
+    explicit FixedTimestep(double tickSeconds = kTickSeconds, int32_t maxTicksPerFrame = 5);
+
+    void Reset();
+
+    // elapsedSeconds 進んだとして、このフレームで進めるティック数を返す
+    int32_t Advance(double elapsedSeconds);
+
+    // 最後のティックから次のティックまでのどこにいるか (0..1。描画の補間に使う)
+    float GetAlpha() const { return static_cast<float>(accumulator_ / tickSeconds_); }
+
+    double GetTickSeconds() const { return tickSeconds_; }
+    uint64_t GetTickCount() const { return tickCount_; }
+    // 上限を超えて捨てたティック数
+    uint64_t GetDroppedTickCount() const { return droppedTickCount_; }
+
+private:
+    double tickSeconds_;
+    int32_t maxTicksPerFrame_;
+    double accumulator_ = 0.0;
+    uint64_t tickCount_ = 0;
+    uint64_t droppedTickCount_ = 0;
+};
+
+// 前のティックと今のティックの間の描画用の姿勢
+// 補間するのは位置だけで、向き・大きさは今のティックのもの (向きの反転などを途中の角度で描かない)
+inline Transform InterpolateTransform(const Vector3& previousTranslate, const Transform& current, float alpha) {
+    Transform result = current;
+    result.translate.x = previousTranslate.x + (current.translate.x - previousTranslate.x) * alpha;
+    result.translate.y = previousTranslate.y + (current.translate.y - previousTranslate.y) * alpha;
+    result.translate.z = previousTranslate.z + (current.translate.z - previousTranslate.z) * alpha;
+    return result;
+}
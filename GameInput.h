@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+
+// ゲームの操作 (Windows / D3D12 に依存しない)
+//
+// シミュレーションはキーではなくボタンのビットで操作を受け取る。
+// 押されているボタンだけを渡し、「押した瞬間」は前のティックとの差から作るので、
+// キーボード・記録の再生・決まった手順で動かすボットのどれからでも同じ結果になる。
+
+// ボタン (キーボードでは A / D / Space / J / L)
+enum GameButton : uint8_t {
+    kButtonLeft = 1 << 0,
+    kButtonRight = 1 << 1,
+    kButtonJump = 1 << 2, // シーンの決定 (リトライなど) も兼ねる
+    kButtonShoot = 1 << 3,
+    kButtonRoll = 1 << 4,
+};
+
+// 1ティック分の操作
+struct InputFrame {
+    uint8_t down = 0;    // 押されているボタン
+    uint8_t pressed = 0; // このティックで押されたボタン (前のティックでは離されていた)
+
+    bool IsDown(GameButton button) const { return (down & button) != 0; }
+    bool IsPressed(GameButton button) const { return (pressed & button) != 0; }
+
+    // 前のティックで押されていたボタンから作る
+    static InputFrame FromButtons(uint8_t buttons, uint8_t previousButtons) {
+        InputFrame frame;
+        frame.down = buttons;
+        frame.pressed = static_cast<uint8_t>(buttons & ~previousButtons);
+        return frame;
+    }
+};
+
+// 操作の出どころ (1ティックに1回呼ばれる)
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+
+    // 次のティックで押されているボタン (GameButton のビット)
+    virtual uint8_t PollButtons() = 0;
+};
@@ -0,0 +1,156 @@
+#include "GameMap.h"
+#include "StateHash.h"
+#include <string>
+#include <cmath>
+
+const float GameMap::kBlockSize = 0.7f;
+
+bool GameMap::Load(const std::string& filePath, size_t memoryBudget, std::string* errorMessage) {
+    dynamicBlocks_.clear();
+    hasGoal_ = false;
+    gridEditHash_ = 0;
+
+    // CSV / TSV / .mapbin (拡張子で判定)
+    std::unique_ptr<TileChunkSource> source = OpenTileChunkSource(filePath, errorMessage);
+    bool loaded = source != nullptr;
+    tiles_.Reset(std::move(source), memoryBudget);
+    objects_.Reset(kObjectCellTiles * kBlockSize, (tiles_.GetWidth() + kObjectCellTiles - 1) / kObjectCellTiles,
+        (tiles_.GetHeight() + kObjectCellTiles - 1) / kObjectCellTiles);
+
+    // スタート・ゴール・動的ブロックは位置だけ覚える (グリッドは空き)
+    for (const MapObject& object : tiles_.GetObjects()) {
+        Vector3 pos = GetWorldPosFromGrid(object.x, object.mapY);
+        if (object.type == kTileStart) {
+            startPosition_ = pos;
+        } else if (object.type == kTileGoal) {
+            goalPos_ = pos;
+            hasGoal_ = true;
+        } else { // 動的ブロック (3,4,6,7,8,9,10)
+            DynamicBlockData d;
+            d.position = pos;
+            d.type = static_cast<int>(object.type);
+            d.objectId = AddObject(d.type, pos);
+            dynamicBlocks_.push_back(d);
+        }
+    }
+
+    // 最初はスタート地点の周りを読んでおく
+    UpdateStreaming(startPosition_);
+    return loaded;
+}
+
+void GameMap::UpdateStreaming(const Vector3& center) {
+    tiles_.Stream(WorldToGridX(center.x), WorldToMapY(center.y), kStreamRadiusX, kStreamRadiusY);
+}
+
+void GameMap::ApplyChanges() {
+    tiles_.FlushChanges();
+}
+
+bool GameMap::CheckCollision(const Vector3& worldPos) const {
+    CountSimulationSection(profile_, kSectionMapQueries);
+    return tiles_.IsSolid(WorldToGridX(worldPos.x), WorldToMapY(worldPos.y));
+}
+
+TileSweepResult GameMap::SweepAABB(const WorldRect& box, const Vector2& delta) const {
+    CountSimulationSection(profile_, kSectionMapQueries);
+    return SweepTileBox(tiles_, kBlockSize, box, delta);
+}
+
+TileRayHit GameMap::Raycast(const Vector2& origin, const Vector2& direction, float maxDistance) const {
+    CountSimulationSection(profile_, kSectionMapQueries);
+    return RaycastTiles(tiles_, kBlockSize, origin, direction, maxDistance);
+}
+
+bool GameMap::HasLineOfSight(const Vector3& from, const Vector3& to) const {
+    CountSimulationSection(profile_, kSectionMapQueries);
+    return HasTileLineOfSight(tiles_, kBlockSize, { from.x, from.y }, { to.x, to.y });
+}
+
+float GameMap::GetGroundDistance(const Vector3& worldPos, float maxDistance) const {
+    CountSimulationSection(profile_, kSectionMapQueries);
+    return GetTileGroundDistance(tiles_, kBlockSize, { worldPos.x, worldPos.y }, maxDistance);
+}
+
+bool GameMap::CheckGoalCollision(const Vector3& playerPos, float playerHalfSize) const {
+    CountSimulationSection(profile_, kSectionMapQueries);
+    if (!hasGoal_) return false;
+
+    float pLeft = playerPos.x - playerHalfSize;
+    float pRight = playerPos.x + playerHalfSize;
+    float pTop = playerPos.y + playerHalfSize;
+    float pBottom = playerPos.y - playerHalfSize;
+
+    float halfSize = kBlockSize / 2.0f;
+    float gLeft = goalPos_.x - halfSize;
+    float gRight = goalPos_.x + halfSize;
+    float gTop = goalPos_.y + halfSize;
+    float gBottom = goalPos_.y - halfSize;
+
+    if (pLeft > gRight || pRight < gLeft || pTop < gBottom || pBottom > gTop) {
+        return false;
+    }
+    return true;
+}
+
+void GameMap::GetGridCoordinates(const Vector3& worldPos, int& outX, int& outMapY) const {
+    outX = WorldToGridX(worldPos.x);
+    outMapY = WorldToMapY(worldPos.y);
+    if (!tiles_.Contains(outX, outMapY)) {
+        outX = -1; outMapY = -1;
+    }
+}
+
+void GameMap::SetGridCell(int x, int mapY, int value) {
+    // 落下ブロックは足元の壁のマスに書いてから 0 で戻すことがあるので、地形の壁は書き換えない
+    CountSimulationSection(profile_, kSectionMapEdits);
+    int32_t previous = tiles_.Get(x, mapY);
+    if (previous == kTileWall) {
+        return;
+    }
+    uint8_t type = value == kTileWall ? static_cast<uint8_t>(kTileBlock) : static_cast<uint8_t>(value);
+    if (previous >= 0 && previous != type) {
+        gridEditHash_ ^= HashGridCell(x, mapY, static_cast<uint8_t>(previous)) ^ HashGridCell(x, mapY, type);
+    }
+    tiles_.Set(x, mapY, type);
+}
+
+uint64_t GameMap::HashGridCell(int x, int mapY, uint8_t type) {
+    return StateHasher::Mix((static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(mapY) << 8 | type) + 1);
+}
+
+// ★追加実装: 指定タイプのブロック位置を検索
+bool GameMap::FindBlock(int type, int& outGridX, int& outMapY) const {
+    int32_t id = objects_.FindFirst(type);
+    if (id < 0) {
+        return false;
+    }
+    const Vector2& pos = objects_.GetPosition(id);
+    GetGridCoordinates({ pos.x, pos.y, 0.0f }, outGridX, outMapY);
+    return true;
+}
+
+int32_t GameMap::AddObject(int type, const Vector3& worldPos) {
+    CountSimulationSection(profile_, kSectionMapEdits);
+    return objects_.Add(type, { worldPos.x, worldPos.y });
+}
+
+void GameMap::MoveObject(int32_t id, const Vector3& worldPos) {
+    CountSimulationSection(profile_, kSectionMapEdits);
+    objects_.Move(id, { worldPos.x, worldPos.y });
+}
+
+size_t GameMap::FindObjectsInRadius(const Vector3& center, float radiusTiles, uint32_t typeMask, std::vector<int32_t>& outIds) const {
+    CountSimulationSection(profile_, kSectionMapQueries);
+    return objects_.FindInRadius({ center.x, center.y }, radiusTiles * kBlockSize, typeMask, outIds);
+}
+
+// ★追加実装: グリッド座標をワールド座標へ変換
+Vector3 GameMap::GetWorldPosFromGrid(int gridX, int gridMapY) const {
+    size_t rowCount = GetRowCount();
+    float worldX = gridX * kBlockSize + kBlockSize / 2.0f;
+    // 配列インデックス(gridMapY) から ワールドYへの変換
+    // worldY = (rowCount - 1 - index) * size + size/2
+    float worldY = (static_cast<float>(rowCount - 1) - static_cast<float>(gridMapY)) * kBlockSize + kBlockSize / 2.0f;
+    return { worldX, worldY, 0.0f };
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "MathTypes.h"
+#include "ChunkedTileMap.h"
+#include "ObjectGrid.h"
+#include "SimulationProfile.h"
+#include "TileRaycast.h"
+#include "TileSweep.h"
+#include <cmath>
+
+// 動的ブロック（罠や落下ブロック）の初期配置情報
+struct DynamicBlockData {
+    Vector3 position;
+    int type;
+    // GameMap の位置の索引での番号 (Load で登録する)
+    int32_t objectId = -1;
+};
+
+// ゲームのマップ (当たり判定・書き換え・動的ブロックの索引。Windows / D3D12 に依存しない)
+//
+// タイルはチャンクに分けて持ち、中心の周りだけを読み込む。
+// 壁の描画は MapChip がチャンクの読み込み・書き換えの通知を受けて行うので、ここはメッシュを持たない。
+// 座標はワールド座標 (タイル x は x*kBlockSize から右へ、mapY は上から数え、最下段が y = 0)。
+class GameMap {
+public:
+    static const float kBlockSize;
+    // 読み込んでおく範囲 (中心から左右・上下のタイル数。画面に映る範囲より少し広く取る)
+    static const int32_t kStreamRadiusX = 48;
+    static const int32_t kStreamRadiusY = 32;
+    // 動的ブロックと罠の位置の索引のセルの大きさ (タイル数)
+    static const int32_t kObjectCellTiles = 4;
+    // 索引での罠の種類 (動的ブロックは CSV の値 3..10 をそのまま使う)
+    static const int kTrapObjectType = 11;
+
+    // CSV / TSV は全体を読んでからチャンクに分け、.mapbin は必要なチャンクだけファイルから読む
+    // memoryBudget は常駐チャンクのバイト数の上限 (0 なら上限なし)
+    // 読めなければ false を返し、空のマップになる (errorMessage に理由)
+    bool Load(const std::string& filePath, size_t memoryBudget = 0, std::string* errorMessage = nullptr);
+
+    // center の周りのチャンクを読み込み、予算を超えた分を捨てる (毎ティック呼ぶ)
+    void UpdateStreaming(const Vector3& center);
+
+    // SetGridCell で書き換えたチャンクを通知する (1フレームに1回、描画の前に呼ぶ)
+    void ApplyChanges();
+
+    // チャンクの読み込み・破棄・書き換えの通知を受ける (描画用。Load の前に登録する)
+    void AddChunkListener(TileChunkListener* listener) { tiles_.AddListener(listener); }
+    void RemoveChunkListener(TileChunkListener* listener) { tiles_.RemoveListener(listener); }
+
+    // 問い合わせ (kSectionMapQueries) と書き換え (kSectionMapEdits) の回数を profile に足す (nullptr で数えない)
+    void SetProfile(SimulationProfile* profile) { profile_ = profile; }
+
+    bool CheckCollision(const Vector3& worldPos) const;
+    // box を delta だけ動かしたときに最初に当たる壁 (当たる割合・面の向き・タイル)
+    // 通り道にかかるタイルだけを調べ、速くても壁を飛び越さない。動く前から重なっている壁は無視する
+    TileSweepResult SweepAABB(const WorldRect& box, const Vector2& delta) const;
+    // origin から direction へ maxDistance までに最初に当たる壁 (origin のあるマスは調べない)
+    TileRayHit Raycast(const Vector2& origin, const Vector2& direction, float maxDistance) const;
+    // 2点の間に壁がないか (両端のマスは調べないので、ブロックやプレイヤーの中心どうしを結んでよい)
+    bool HasLineOfSight(const Vector3& from, const Vector3& to) const;
+    // worldPos の真下の床の面までの距離 (maxDistance までに床がなければ maxDistance)
+    float GetGroundDistance(const Vector3& worldPos, float maxDistance) const;
+
+    size_t GetRowCount() const { return static_cast<size_t>(tiles_.GetHeight()); }
+    size_t GetColCount() const { return static_cast<size_t>(tiles_.GetWidth()); }
+    const ChunkedTileMap& GetTiles() const { return tiles_; }
+
+    const Vector3& GetStartPosition() const { return startPosition_; }
+
+    const std::vector<DynamicBlockData>& GetDynamicBlocks() const { return dynamicBlocks_; }
+
+    bool CheckGoalCollision(const Vector3& playerPos, float playerHalfSize) const;
+
+    const Vector3& GetGoalPosition() const { return goalPos_; }
+    bool HasGoal() const { return hasGoal_; }
+
+    // ★追加: ゲーム中にゴールの位置を変更するための関数
+    void SetGoalPosition(const Vector3& newPos) { goalPos_ = newPos; }
+
+    void GetGridCoordinates(const Vector3& worldPos, int& outX, int& outMapY) const;
+
+    // 動的ブロックの占有を書き込む (1 は kTileBlock として置く。地形の壁のマスは書き換えない)
+    void SetGridCell(int x, int mapY, int value);
+
+    int GetGridValue(int x, int mapY) const { return tiles_.Get(x, mapY); }
+
+    // 読み込んでからのマスの書き換えのハッシュ (SetGridCell のたびに変わったマスの分だけ更新する)
+    // 各マスの (位置, 値) のハッシュの XOR を読み込んだときの値との差として持つので、同じ中身なら書き換えの順によらず同じ値になる
+    uint64_t GetGridEditHash() const { return gridEditHash_; }
+    // GetGridEditHash に混ぜる1マス分の値
+    static uint64_t HashGridCell(int x, int mapY, uint8_t type);
+
+    // ★追加: 指定したタイプのブロックが最初に見つかった場所を探す
+    // (マップに最初に置かれたものの今いるマス。索引から引くので数によらない)
+    bool FindBlock(int type, int& outGridX, int& outMapY) const;
+
+    // 動的ブロック・罠の位置の索引 (マップのブロックは Load で登録する。それ以外は AddObject で足す)
+    // 動いたら MoveObject で知らせる
+    int32_t AddObject(int type, const Vector3& worldPos);
+    void MoveObject(int32_t id, const Vector3& worldPos);
+    // center から radiusTiles タイル以内にいる typeMask の種類のもの (番号を outIds に足し、足した数を返す)
+    size_t FindObjectsInRadius(const Vector3& center, float radiusTiles, uint32_t typeMask, std::vector<int32_t>& outIds) const;
+    const ObjectGrid& GetObjectIndex() const { return objects_; }
+
+    // ★追加: グリッド座標からワールド座標を計算して返す
+    Vector3 GetWorldPosFromGrid(int gridX, int gridMapY) const;
+
+    // ワールド座標からグリッド座標へ (範囲外もそのまま返す)
+    int WorldToGridX(float worldX) const { return static_cast<int>(std::floor(worldX / kBlockSize)); }
+    int WorldToMapY(float worldY) const { return (tiles_.GetHeight() - 1) - static_cast<int>(std::floor(worldY / kBlockSize)); }
+
+private:
+    ChunkedTileMap tiles_;
+    Vector3 startPosition_ = { 0, 0, 0 };
+    Vector3 goalPos_ = { 0, 0, 0 };
+    bool hasGoal_ = false;
+    std::vector<DynamicBlockData> dynamicBlocks_;
+    ObjectGrid objects_;
+    SimulationProfile* profile_ = nullptr;
+    uint64_t gridEditHash_ = 0;
+};
@@ -0,0 +1,425 @@
+#include "GameSimulation.h"
+#include <algorithm>
+
+GameSimulation::~GameSimulation() {
+    Cleanup();
+}
+
+void GameSimulation::SetStartMap(const std::string& filePath) {
+    currentMapFilePath_ = filePath;
+    currentRespawnPos_ = GetMapEntryPosition(filePath);
+}
+
+void GameSimulation::SetProfile(SimulationProfile* profile) {
+    profile_ = profile;
+    map_.SetProfile(profile);
+}
+
+Vector3 GameSimulation::GetMapEntryPosition(const std::string& filePath) {
+    if (filePath == "Resources/map2.csv") {
+        size_t map2Height = 15;
+        float spawnY = (static_cast<float>(map2Height - 1) - 14.0f) * GameMap::kBlockSize + (GameMap::kBlockSize / 2.0f);
+        float spawnX = (GameMap::kBlockSize / 2.0f);
+        return { spawnX, spawnY, 0.0f };
+    }
+    if (filePath == "Resources/map3.csv") {
+        float spawnX = GameMap::kBlockSize * 3.5f;
+        float spawnY = GameMap::kBlockSize * 1.5f;
+        return { spawnX, spawnY, 0.0f };
+    }
+    return { 0.0f, 0.0f, 0.0f };
+}
+
+void GameSimulation::Step() {
+    Step(inputSource_ ? inputSource_->PollButtons() : 0);
+}
+
+void GameSimulation::Step(uint8_t buttons) {
+    InputFrame input = InputFrame::FromButtons(buttons, previousButtons_);
+    previousButtons_ = buttons;
+    ++tickCount_;
+
+    switch (scene_) {
+    case GameScene::Title:
+        if (input.IsPressed(kButtonJump)) {
+            if (currentMapFilePath_.empty()) {
+                currentMapFilePath_ = "Resources/map.csv";
+                currentRespawnPos_ = { 0.0f, 0.0f, 0.0f };
+            }
+            scene_ = GameScene::GamePlay;
+        }
+        break;
+
+    case GameScene::GamePlay:
+        if (!isGameInitialized_) {
+            ScopedSectionTimer timer(profile_, kSectionMapLoad);
+            StartGame();
+        }
+        if (!isLoadingNextMap_ && isGameInitialized_) {
+            UpdateGamePlay(input);
+        }
+        // このティックに書き換わったマスのチャンクを通知する (描画前に1回だけ)
+        if (!isLoadingNextMap_ && isGameInitialized_) {
+            ScopedSectionTimer timer(profile_, kSectionChunkFlush);
+            map_.ApplyChanges();
+        }
+        if (isLoadingNextMap_) {
+            ScopedSectionTimer timer(profile_, kSectionMapLoad);
+            LoadNextMap();
+        }
+        break;
+
+    case GameScene::GameOver:
+        if (input.IsPressed(kButtonJump)) {
+            Cleanup();
+            scene_ = GameScene::GamePlay;
+        }
+        break;
+
+    case GameScene::GameClear:
+        if (input.IsPressed(kButtonJump)) {
+            Cleanup();
+            scene_ = GameScene::Title;
+        }
+        break;
+    }
+}
+
+uint64_t GameSimulation::ComputeStateHash() const {
+    return ComputeStateDigest().Combine();
+}
+
+StateDigest GameSimulation::ComputeStateDigest() const {
+    StateDigest digest;
+    {
+        StateHasher hasher;
+        hasher.Add(tickCount_);
+        hasher.Add(static_cast<uint32_t>(scene_) | static_cast<uint32_t>(isGameInitialized_) << 8 |
+            static_cast<uint32_t>(isLoadingNextMap_) << 9);
+        hasher.Add(mapLoadCount_);
+        digest.fields[kStateFieldScene] = hasher.Get();
+    }
+    if (player_) {
+        StateHasher transform;
+        transform.Add(player_->GetTransform().translate);
+        transform.Add(player_->GetTransform().rotate);
+        digest.fields[kStateFieldPlayerTransform] = transform.Get();
+
+        StateHasher velocity;
+        velocity.Add(player_->GetVelocity());
+        digest.fields[kStateFieldPlayerVelocity] = velocity.Get();
+
+        StateHasher flags;
+        player_->AddFlagState(flags);
+        digest.fields[kStateFieldPlayerFlags] = flags.Get();
+
+        StateHasher bullets;
+        bullets.Add(player_->GetBullets().size());
+        for (const PlayerBullet* bullet : player_->GetBullets()) {
+            bullet->AddState(bullets);
+        }
+        digest.fields[kStateFieldBullets] = bullets.Get();
+    }
+    {
+        StateHasher hasher;
+        hasher.Add(traps_.size());
+        for (const Trap* trap : traps_) {
+            trap->AddState(hasher);
+        }
+        digest.fields[kStateFieldTraps] = hasher.Get();
+    }
+    {
+        StateHasher hasher;
+        hasher.Add(fallingBlocks_.size());
+        for (const FallingBlock* block : fallingBlocks_) {
+            block->AddState(hasher);
+        }
+        digest.fields[kStateFieldFallingBlocks] = hasher.Get();
+    }
+    digest.fields[kStateFieldGridEdits] = map_.GetGridEditHash();
+    {
+        StateHasher hasher;
+        hasher.Add(hasGoalFlag_);
+        hasher.Add(goalFlagPos_);
+        hasher.Add(map_.GetGoalPosition());
+        hasher.Add(static_cast<int32_t>(goalAnimPhase_));
+        digest.fields[kStateFieldGoal] = hasher.Get();
+    }
+    {
+        StateHasher hasher;
+        hasher.Add(map3EventTriggered_);
+        hasher.Add(map3Timer_);
+        digest.fields[kStateFieldGimmicks] = hasher.Get();
+    }
+    return digest;
+}
+
+StateDifference GameSimulation::FindStateDifference(const GameSimulation& a, const GameSimulation& b) {
+    StateDifference difference;
+    difference.field = a.ComputeStateDigest().FindFirstDifference(b.ComputeStateDigest());
+
+    // 並びの項目は、どの要素がずれたかまで調べる (数が違えば短いほうの次の要素)
+    auto findElement = [](const auto& left, const auto& right) {
+        size_t count = std::min(left.size(), right.size());
+        auto leftIt = left.begin();
+        auto rightIt = right.begin();
+        for (size_t i = 0; i < count; ++i, ++leftIt, ++rightIt) {
+            StateHasher leftHasher;
+            StateHasher rightHasher;
+            (*leftIt)->AddState(leftHasher);
+            (*rightIt)->AddState(rightHasher);
+            if (leftHasher.Get() != rightHasher.Get()) {
+                return static_cast<int32_t>(i);
+            }
+        }
+        return static_cast<int32_t>(count);
+    };
+    if (difference.field == kStateFieldBullets && a.player_ && b.player_) {
+        difference.index = findElement(a.player_->GetBullets(), b.player_->GetBullets());
+    } else if (difference.field == kStateFieldTraps) {
+        difference.index = findElement(a.traps_, b.traps_);
+    } else if (difference.field == kStateFieldFallingBlocks) {
+        difference.index = findElement(a.fallingBlocks_, b.fallingBlocks_);
+    }
+    return difference;
+}
+
+void GameSimulation::StartGame() {
+    player_ = new Player();
+    LoadMap(currentMapFilePath_);
+    player_->Initialize(&map_);
+
+    if (currentRespawnPos_.x != 0.0f || currentRespawnPos_.y != 0.0f) {
+        player_->SetPosition(currentRespawnPos_);
+    }
+
+    if (currentMapFilePath_ == "Resources/map.csv") {
+        size_t mapHeight = 15;
+        auto csvYToWorldY = [&](int csvY) { return (static_cast<float>(mapHeight - 1) - static_cast<float>(csvY)) * GameMap::kBlockSize + (GameMap::kBlockSize / 2.0f); };
+        float stopMarginNormal = GameMap::kBlockSize * 1.0f;
+        float stopMarginShort = GameMap::kBlockSize * 0.2f;
+
+        traps_.push_back(new Trap()); traps_.back()->Initialize(&map_, csvYToWorldY(4), Trap::AttackSide::FromLeft, stopMarginNormal);
+        traps_.push_back(new Trap()); traps_.back()->Initialize(&map_, csvYToWorldY(5), Trap::AttackSide::FromLeft, stopMarginNormal);
+        traps_.push_back(new Trap()); traps_.back()->Initialize(&map_, csvYToWorldY(6), Trap::AttackSide::FromLeft, stopMarginNormal);
+        traps_.push_back(new Trap()); traps_.back()->Initialize(&map_, csvYToWorldY(8), Trap::AttackSide::FromRight, stopMarginNormal);
+        traps_.push_back(new Trap()); traps_.back()->Initialize(&map_, csvYToWorldY(9), Trap::AttackSide::FromRight, stopMarginNormal);
+        traps_.push_back(new Trap()); traps_.back()->Initialize(&map_, csvYToWorldY(10), Trap::AttackSide::FromRight, stopMarginNormal);
+        traps_.push_back(new Trap()); traps_.back()->Initialize(&map_, csvYToWorldY(12), Trap::AttackSide::FromRight, stopMarginShort);
+        traps_.push_back(new Trap()); traps_.back()->Initialize(&map_, csvYToWorldY(13), Trap::AttackSide::FromRight, stopMarginShort);
+    }
+
+    isLoadingNextMap_ = false;
+    isGameInitialized_ = true;
+}
+
+void GameSimulation::LoadMap(const std::string& filePath) {
+    if (!map_.Load(filePath, 0, &lastError_)) {
+        lastError_ = "Cannot load map file: " + filePath + " (" + lastError_ + ")";
+    }
+    ++mapLoadCount_;
+
+    const auto& dynamicBlocks = map_.GetDynamicBlocks();
+    for (const auto& data : dynamicBlocks) {
+        FallingBlock* newBlock = new FallingBlock();
+        newBlock->Initialize(data.position, static_cast<BlockType>(data.type), data.objectId);
+        fallingBlocks_.push_back(newBlock);
+    }
+
+    // ★ Map3の初期設定 (初回ロード時・マップ遷移時のどちらでも必ず行う)
+    if (filePath == "Resources/map3.csv") {
+        map3Timer_ = 0.0f;
+        map3EventTriggered_ = false;
+        goalAnimPhase_ = 0;
+        int gx, gy;
+        if (map_.FindBlock(6, gx, gy)) {
+            block6Pos_ = map_.GetWorldPosFromGrid(gx, gy);
+        } else {
+            block6Pos_ = { 9999.0f, 0.0f, 0.0f };
+        }
+    }
+
+    hasGoalFlag_ = map_.HasGoal();
+    if (hasGoalFlag_) {
+        goalFlagPos_ = map_.GetGoalPosition();
+        goalFlagPos_.y -= GameMap::kBlockSize * 0.5f;
+        previousGoalFlagPos_ = goalFlagPos_;
+    }
+}
+
+void GameSimulation::UpdateGamePlay(const InputFrame& input) {
+    // マップの周りを読み込む (大きなマップでは範囲外のチャンクを捨てる)
+    {
+        ScopedSectionTimer timer(profile_, kSectionStreaming);
+        map_.UpdateStreaming(hasStreamingCenter_ ? streamingCenter_ : player_->GetPosition());
+    }
+
+    previousGoalFlagPos_ = goalFlagPos_;
+
+    {
+        ScopedSectionTimer timer(profile_, kSectionPlayer);
+
+        // 1. プレイヤーの更新
+        player_->Update(input);
+
+        // 2. 奈落（画面外）の死亡判定
+        if (player_->IsAlive() && player_->GetPosition().y < -5.0f) {
+            player_->Die();
+        }
+    }
+
+    // 3. ギミック・エネミーの更新 (死亡中も動かす)
+    {
+        ScopedSectionTimer timer(profile_, kSectionTraps);
+        for (Trap* trap : traps_) trap->Update(player_, &map_);
+    }
+    {
+        ScopedSectionTimer timer(profile_, kSectionFallingBlocks);
+        for (FallingBlock* block : fallingBlocks_) block->Update(player_, &map_);
+    }
+
+    ScopedSectionTimer gimmickTimer(profile_, kSectionGimmicks);
+
+    // ★ Map3専用ギミック
+    if (currentMapFilePath_ == "Resources/map3.csv" && !map3EventTriggered_) {
+        map3Timer_ += kTickSeconds;
+
+        // 時間制限: 10秒
+        bool timerCondition = (map3Timer_ >= 5.0f);
+
+        // ジャンプ条件: 6番ブロック + 4ブロック分右に進んだら発動
+        bool jumpCondition = (block6Pos_.x < 9000.0f && player_->GetPosition().x > block6Pos_.x + GameMap::kBlockSize * 4.0f);
+
+        if (timerCondition || jumpCondition) {
+            map3EventTriggered_ = true;
+
+            // ゴールの最終目的地を計算 (左側の x=3.5 あたりへ移動)
+            float goalX = GameMap::kBlockSize * 3.5f;
+            float goalY = GameMap::kBlockSize * 1.5f;
+            Vector3 newGoalPos = { goalX, goalY, 0.0f };
+
+            // モデル表示用の最終位置
+            goalTargetPosModel_ = newGoalPos;
+            goalTargetPosModel_.y -= GameMap::kBlockSize * 0.5f;
+
+            // ゴール移動アニメーション開始
+            if (hasGoalFlag_) {
+                goalAnimPhase_ = 1;
+            }
+
+            // ★壁生成位置: X=12 (1個分左) に変更
+            int midX = 12;
+            int rows = static_cast<int>(map_.GetRowCount());
+            for (int y = 0; y < rows; ++y) {
+                Vector3 spawnPos = map_.GetWorldPosFromGrid(midX, y);
+                FallingBlock* newWall = new FallingBlock();
+                newWall->Initialize(spawnPos, BlockType::StaticHazard, map_.AddObject(static_cast<int>(BlockType::StaticHazard), spawnPos));
+                fallingBlocks_.push_back(newWall);
+            }
+        }
+    }
+
+    // ★ ゴール移動アニメーション処理
+    if (map3EventTriggered_ && goalAnimPhase_ > 0 && hasGoalFlag_) {
+        float moveSpeed = 0.2f;
+        Vector3 currentPos = goalFlagPos_;
+
+        // マップ最上段のワールドY座標
+        float topY = (static_cast<float>(map_.GetRowCount() - 1)) * GameMap::kBlockSize + GameMap::kBlockSize * 0.5f;
+        topY -= GameMap::kBlockSize * 0.5f;
+
+        switch (goalAnimPhase_) {
+        case 1: // 上昇
+            currentPos.y += moveSpeed;
+            if (currentPos.y >= topY) {
+                currentPos.y = topY;
+                goalAnimPhase_ = 2;
+            }
+            break;
+        case 2: // 左へ移動 (天井伝い)
+            currentPos.x -= moveSpeed;
+            if (currentPos.x <= goalTargetPosModel_.x) {
+                currentPos.x = goalTargetPosModel_.x;
+                goalAnimPhase_ = 3;
+            }
+            break;
+        case 3: // 下降
+            currentPos.y -= moveSpeed;
+            if (currentPos.y <= goalTargetPosModel_.y) {
+                currentPos.y = goalTargetPosModel_.y;
+                goalAnimPhase_ = 0;
+
+                Vector3 finalColliderPos = goalTargetPosModel_;
+                finalColliderPos.y += GameMap::kBlockSize * 0.5f;
+                map_.SetGoalPosition(finalColliderPos);
+            }
+            break;
+        }
+
+        goalFlagPos_ = currentPos;
+
+        // 移動中も当たり判定を追従させる
+        Vector3 colliderPos = currentPos;
+        colliderPos.y += GameMap::kBlockSize * 0.5f;
+        map_.SetGoalPosition(colliderPos);
+    }
+
+    // 4. 死亡後のリトライ受付 (次のティックで最初から)
+    if (!player_->IsAlive()) {
+        if (input.IsPressed(kButtonJump)) {
+            Cleanup();
+            return;
+        }
+    }
+
+    // 5. マップ移動・クリア判定 (生存中のみ)
+    if (player_->IsAlive()) {
+        if (currentMapFilePath_ == "Resources/map.csv") {
+            if (player_->IsExiting()) {
+                isLoadingNextMap_ = true;
+                nextMapFilePath_ = "Resources/map2.csv";
+                nextRespawnPos_ = GetMapEntryPosition(nextMapFilePath_);
+            }
+        } else if (currentMapFilePath_ == "Resources/map2.csv") {
+            Vector3 pPos = player_->GetPosition();
+            float mapTopY = static_cast<float>(map_.GetRowCount()) * GameMap::kBlockSize;
+            if (pPos.x < GameMap::kBlockSize * 2.0f && pPos.y > mapTopY - (GameMap::kBlockSize * 2.0f)) {
+                isLoadingNextMap_ = true;
+                nextMapFilePath_ = "Resources/map3.csv";
+                nextRespawnPos_ = GetMapEntryPosition(nextMapFilePath_);
+            }
+        } else if (currentMapFilePath_ == "Resources/map3.csv") {
+            if (map_.HasGoal() && map_.CheckGoalCollision(player_->GetPosition(), player_->GetHalfSize())) {
+                scene_ = GameScene::GameClear;
+                currentMapFilePath_ = "Resources/map.csv";
+                currentRespawnPos_ = { 0.0f, 0.0f, 0.0f };
+            }
+        }
+    }
+}
+
+void GameSimulation::LoadNextMap() {
+    ReleaseGameObjects();
+
+    currentMapFilePath_ = nextMapFilePath_;
+    currentRespawnPos_ = nextRespawnPos_;
+    LoadMap(currentMapFilePath_);
+    player_->SetPosition(currentRespawnPos_);
+    isLoadingNextMap_ = false;
+}
+
+void GameSimulation::ReleaseGameObjects() {
+    for (Trap* trap : traps_) delete trap;
+    traps_.clear();
+    for (FallingBlock* block : fallingBlocks_) delete block;
+    fallingBlocks_.clear();
+    hasGoalFlag_ = false;
+}
+
+void GameSimulation::Cleanup() {
+    delete player_; player_ = nullptr;
+    ReleaseGameObjects();
+    isGameInitialized_ = false;
+    map3EventTriggered_ = false;
+    goalAnimPhase_ = 0;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include "FixedTimestep.h"
+#include "GameInput.h"
+#include "GameMap.h"
+#include "Player.h"
+#include "SimulationProfile.h"
+#include "StateHash.h"
+#include "Trap.h"
+#include "FallingBlock.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 2つのシミュレーションの状態の最初の違い
+struct StateDifference {
+    StateField field = kStateFieldCount; // 同じなら kStateFieldCount
+    int32_t index = -1;                  // 弾・罠・落下ブロックなら何番目か (それ以外は -1)
+};
+
+// シーン
+enum class GameScene {
+    Title,
+    GamePlay,
+    GameOver,
+    GameClear
+};
+
+// ゲームの進行 (シーンとマップの切り替え・プレイヤー・罠・落下ブロック。Windows / D3D12 に依存しない)
+//
+// Step 1回が1ティック (kTickSeconds)。操作は InputSource から1ティックに1回読む。
+// 画面の更新間隔とは切り離し、描く側が FixedTimestep で何ティック進めるかを決める。
+// 描画は持たないので、描く側は Get〜 で状態を読み、マップの壁は GameMap のチャンクの通知で作る。
+// ウィンドウのないところ (ベンチマークなど) で回しても、同じ操作なら同じ進み方をする。
+class GameSimulation {
+public:
+    ~GameSimulation();
+
+    // 操作の出どころ (持ち主は呼ぶ側。なければ何も押していない扱い)
+    void SetInputSource(InputSource* source) { inputSource_ = source; }
+
+    // マップを読み込む中心 (描く側はカメラの位置を渡す。渡さなければプレイヤーの位置)
+    void SetStreamingCenter(const Vector3& center) {
+        streamingCenter_ = center;
+        hasStreamingCenter_ = true;
+    }
+
+    // タイトルから始めるマップ (Resources/map2.csv など。途中のマップから遊ぶとき、Title のうちに呼ぶ)
+    // プレイヤーはそのマップへ移ってきたときの位置に置く
+    void SetStartMap(const std::string& filePath);
+
+    // 処理ごとの時間を profile に足す (持ち主は呼ぶ側。nullptr で測らない)
+    void SetProfile(SimulationProfile* profile);
+
+    // 1ティック進める (InputSource から操作を読む)
+    void Step();
+    // 押されているボタンを直接渡して1ティック進める
+    void Step(uint8_t buttons);
+
+    GameScene GetScene() const { return scene_; }
+    // プレイ中で、マップ・プレイヤーが揃っているか
+    bool IsPlaying() const { return scene_ == GameScene::GamePlay && isGameInitialized_; }
+    uint64_t GetTickCount() const { return tickCount_; }
+
+    // いまの状態のハッシュ (ComputeStateDigest の項目をまとめた値)
+    // 同じ操作で同じ状態なら同じ値になる。記録の再生でずれを見つけるのに使う
+    uint64_t ComputeStateHash() const;
+    // 項目ごとのハッシュ (プレイヤー・弾・罠・落下ブロック・マスの書き換え・ゴール・map3 の仕掛けなど)
+    // マスの書き換えは GameMap が書き換えのたびに更新した値を使うので、マップの広さによらない
+    StateDigest ComputeStateDigest() const;
+    // 2つの状態で最初に違う項目 (並びなら要素まで)。同じ操作で並べて回し、ずれたティックで呼ぶ
+    static StateDifference FindStateDifference(const GameSimulation& a, const GameSimulation& b);
+
+    GameMap& GetMap() { return map_; }
+    const GameMap& GetMap() const { return map_; }
+    // IsPlaying でなければ nullptr
+    const Player* GetPlayer() const { return player_; }
+    const std::vector<Trap*>& GetTraps() const { return traps_; }
+    const std::vector<FallingBlock*>& GetFallingBlocks() const { return fallingBlocks_; }
+    const std::string& GetMapFilePath() const { return currentMapFilePath_; }
+
+    // ゴールの旗の位置 (マップにゴールがあるときだけ。map3 では動く)
+    bool HasGoalFlag() const { return hasGoalFlag_; }
+    const Vector3& GetGoalFlagPosition() const { return goalFlagPos_; }
+    // 前のティックとの間を補間した旗の位置 (alpha は FixedTimestep::GetAlpha)
+    Vector3 GetGoalFlagRenderPosition(float alpha) const {
+        Transform current{};
+        current.translate = goalFlagPos_;
+        return InterpolateTransform(previousGoalFlagPos_, current, alpha).translate;
+    }
+
+    // マップを読んだ回数 (描く側が読み直しに気付くため)
+    uint32_t GetMapLoadCount() const { return mapLoadCount_; }
+    // 直近のマップの読み込みの失敗 (なければ空)
+    const std::string& GetLastError() const { return lastError_; }
+    void ClearLastError() { lastError_.clear(); }
+
+private:
+    void UpdateGamePlay(const InputFrame& input);
+    // マップを読んでプレイヤー・罠・ブロックを置く
+    void StartGame();
+    // player->IsExiting などで決まった次のマップへ移る
+    void LoadNextMap();
+    // マップを読み、落下ブロック・map3 の仕掛け・ゴールを置き直す
+    void LoadMap(const std::string& filePath);
+    void ReleaseGameObjects();
+    void Cleanup();
+    // 前のマップから移ってきたときのプレイヤーの位置 (0 ならプレイヤーの初期位置)
+    static Vector3 GetMapEntryPosition(const std::string& filePath);
+
+private:
+    InputSource* inputSource_ = nullptr;
+    uint8_t previousButtons_ = 0;
+    uint64_t tickCount_ = 0;
+    Vector3 streamingCenter_ = { 0.0f, 0.0f, 0.0f };
+    bool hasStreamingCenter_ = false;
+    SimulationProfile* profile_ = nullptr;
+
+    GameMap map_;
+    Player* player_ = nullptr;
+    std::vector<Trap*> traps_;
+    std::vector<FallingBlock*> fallingBlocks_;
+
+    // --- シーン管理用変数 ---
+    GameScene scene_ = GameScene::Title;
+    bool isGameInitialized_ = false;
+    bool isLoadingNextMap_ = false;
+
+    std::string currentMapFilePath_ = "Resources/map.csv";
+    Vector3 currentRespawnPos_ = { 0.0f, 0.0f, 0.0f };
+    std::string nextMapFilePath_ = "";
+    Vector3 nextRespawnPos_ = { 0.0f, 0.0f, 0.0f };
+
+    // ★ Map3用変数
+    float map3Timer_ = 0.0f;
+    bool map3EventTriggered_ = false;
+    Vector3 block6Pos_ = { 9999.0f, 0.0f, 0.0f }; // 6番ブロックの位置
+
+    // ★ ゴール移動アニメーション用変数
+    bool hasGoalFlag_ = false;
+    Vector3 goalFlagPos_ = { 0.0f, 0.0f, 0.0f };
+    Vector3 previousGoalFlagPos_ = { 0.0f, 0.0f, 0.0f };
+    int goalAnimPhase_ = 0; // 0:なし, 1:上昇, 2:左移動, 3:下降
+    Vector3 goalTargetPosModel_ = { 0.0f, 0.0f, 0.0f }; // ゴールモデルの最終到達位置
+
+    uint32_t mapLoadCount_ = 0;
+    std::string lastError_;
+};
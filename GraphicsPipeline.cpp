@@ -38,7 +38,7 @@ void GraphicsPipeline::Initialize(ID3D12Device* device) {
     descriptionRootSignature.pStaticSamplers = staticSamplers;
     descriptionRootSignature.NumStaticSamplers = _countof(staticSamplers);
 
-    D3D12_ROOT_PARAMETER rootParameters[5] = {};
+    D3D12_ROOT_PARAMETER rootParameters[6] = {};
 
     // Param [0]: Material (PS, b0)
     rootParameters[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
@@ -71,6 +71,11 @@ void GraphicsPipeline::Initialize(ID3D12Device* device) {
     rootParameters[4].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
     rootParameters[4].Descriptor.ShaderRegister = 2;
 
+    // Param [5]: InstancingData (VS, t1) インスタンス描画用の構造化バッファ
+    rootParameters[5].ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+    rootParameters[5].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+    rootParameters[5].Descriptor.ShaderRegister = 1;
+
     descriptionRootSignature.pParameters = rootParameters;
     descriptionRootSignature.NumParameters = _countof(rootParameters);
 
@@ -85,8 +90,16 @@ void GraphicsPipeline::Initialize(ID3D12Device* device) {
     assert(SUCCEEDED(hr));
 
     // --- PSOの作成 ---
-    Microsoft::WRL::ComPtr<IDxcBlob> vertexShaderBlob = CompileShader(L"Object3d.VS.hlsl", L"vs_6_0", dxcUtils.Get(), dxcCompiler.Get(), includeHandler.Get());
-    assert(vertexShaderBlob != nullptr);
+    // 頂点シェーダーは頂点形式ごとにコンパイルする (圧縮形式は COMPACT_VERTEX で展開する)
+    Microsoft::WRL::ComPtr<IDxcBlob> vertexShaderBlobs[kCountOfVertexFormat];
+    Microsoft::WRL::ComPtr<IDxcBlob> instancingVertexShaderBlobs[kCountOfVertexFormat];
+    const wchar_t* vertexFormatDefines[kCountOfVertexFormat] = { nullptr, L"COMPACT_VERTEX" };
+    for (int format = 0; format < kCountOfVertexFormat; ++format) {
+        vertexShaderBlobs[format] = CompileShader(L"Object3d.VS.hlsl", L"vs_6_0", dxcUtils.Get(), dxcCompiler.Get(), includeHandler.Get(), vertexFormatDefines[format]);
+        assert(vertexShaderBlobs[format] != nullptr);
+        instancingVertexShaderBlobs[format] = CompileShader(L"Resources/Object3d.VS.hlsl", L"vs_6_0", dxcUtils.Get(), dxcCompiler.Get(), includeHandler.Get(), vertexFormatDefines[format]);
+        assert(instancingVertexShaderBlobs[format] != nullptr);
+    }
     Microsoft::WRL::ComPtr<IDxcBlob> pixelShaderBlob = CompileShader(L"Object3d.PS.hlsl", L"ps_6_0", dxcUtils.Get(), dxcCompiler.Get(), includeHandler.Get());
     assert(pixelShaderBlob != nullptr);
 
@@ -103,9 +116,27 @@ void GraphicsPipeline::Initialize(ID3D12Device* device) {
     inputElementDescs[2].SemanticIndex = 0;
     inputElementDescs[2].Format = DXGI_FORMAT_R32G32B32_FLOAT;
     inputElementDescs[2].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
-    D3D12_INPUT_LAYOUT_DESC inputLayoutDesc{};
-    inputLayoutDesc.pInputElementDescs = inputElementDescs;
-    inputLayoutDesc.NumElements = _countof(inputElementDescs);
+
+    // 圧縮頂点 (CompactVertexData)
+    D3D12_INPUT_ELEMENT_DESC compactInputElementDescs[3] = {};
+    compactInputElementDescs[0].SemanticName = "POSITION";
+    compactInputElementDescs[0].SemanticIndex = 0;
+    compactInputElementDescs[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+    compactInputElementDescs[0].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+    compactInputElementDescs[1].SemanticName = "TEXCOORD";
+    compactInputElementDescs[1].SemanticIndex = 0;
+    compactInputElementDescs[1].Format = DXGI_FORMAT_R16G16_FLOAT;
+    compactInputElementDescs[1].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+    compactInputElementDescs[2].SemanticName = "NORMAL";
+    compactInputElementDescs[2].SemanticIndex = 0;
+    compactInputElementDescs[2].Format = DXGI_FORMAT_R16G16_SNORM;
+    compactInputElementDescs[2].AlignedByteOffset = D3D12_APPEND_ALIGNED_ELEMENT;
+
+    D3D12_INPUT_LAYOUT_DESC inputLayoutDescs[kCountOfVertexFormat] = {};
+    inputLayoutDescs[kVertexFormatFull].pInputElementDescs = inputElementDescs;
+    inputLayoutDescs[kVertexFormatFull].NumElements = _countof(inputElementDescs);
+    inputLayoutDescs[kVertexFormatCompact].pInputElementDescs = compactInputElementDescs;
+    inputLayoutDescs[kVertexFormatCompact].NumElements = _countof(compactInputElementDescs);
 
     D3D12_RASTERIZER_DESC rasterizerDesc{};
     rasterizerDesc.CullMode = D3D12_CULL_MODE_BACK;
@@ -166,8 +197,6 @@ void GraphicsPipeline::Initialize(ID3D12Device* device) {
 
         D3D12_GRAPHICS_PIPELINE_STATE_DESC graphicsPipelineStateDesc{};
         graphicsPipelineStateDesc.pRootSignature = rootSignature_.Get();
-        graphicsPipelineStateDesc.InputLayout = inputLayoutDesc;
-        graphicsPipelineStateDesc.VS = { vertexShaderBlob->GetBufferPointer(), vertexShaderBlob->GetBufferSize() };
         graphicsPipelineStateDesc.PS = { pixelShaderBlob->GetBufferPointer(), pixelShaderBlob->GetBufferSize() };
         graphicsPipelineStateDesc.BlendState = blendDesc;
         graphicsPipelineStateDesc.RasterizerState = rasterizerDesc;
@@ -179,8 +208,18 @@ void GraphicsPipeline::Initialize(ID3D12Device* device) {
         graphicsPipelineStateDesc.SampleDesc.Count = 1;
         graphicsPipelineStateDesc.SampleMask = D3D12_DEFAULT_SAMPLE_MASK;
 
-        hr = device->CreateGraphicsPipelineState(&graphicsPipelineStateDesc, IID_PPV_ARGS(&pipelineStates_[i]));
-        assert(SUCCEEDED(hr));
+        // 頂点形式ごとに入力レイアウトとVSを差し替える
+        for (int format = 0; format < kCountOfVertexFormat; ++format) {
+            graphicsPipelineStateDesc.InputLayout = inputLayoutDescs[format];
+            graphicsPipelineStateDesc.VS = { vertexShaderBlobs[format]->GetBufferPointer(), vertexShaderBlobs[format]->GetBufferSize() };
+            hr = device->CreateGraphicsPipelineState(&graphicsPipelineStateDesc, IID_PPV_ARGS(&pipelineStates_[format][i]));
+            assert(SUCCEEDED(hr));
+
+            // インスタンス描画用 (VSだけ差し替える)
+            graphicsPipelineStateDesc.VS = { instancingVertexShaderBlobs[format]->GetBufferPointer(), instancingVertexShaderBlobs[format]->GetBufferSize() };
+            hr = device->CreateGraphicsPipelineState(&graphicsPipelineStateDesc, IID_PPV_ARGS(&instancingPipelineStates_[format][i]));
+            assert(SUCCEEDED(hr));
+        }
     }
 }
 
@@ -189,9 +228,10 @@ Microsoft::WRL::ComPtr<IDxcBlob> GraphicsPipeline::CompileShader(
     const wchar_t* profile,
     IDxcUtils* dxcUtils,
     IDxcCompiler3* dxcCompiler,
-    IDxcIncludeHandler* includeHandler)
+    IDxcIncludeHandler* includeHandler,
+    const wchar_t* define)
 {
-    Log(logStream_, ConvertString(std::format(L"Begin CompileShader, path:{}, profile:{}\n", filePath, profile)));
+    Log(logStream_, ConvertString(std::format(L"Begin CompileShader, path:{}, profile:{}, define:{}\n", filePath, profile, define ? define : L"")));
     Microsoft::WRL::ComPtr<IDxcBlobEncoding> shaderSource = nullptr;
     HRESULT hr = dxcUtils->LoadFile(filePath.c_str(), nullptr, &shaderSource);
     assert(SUCCEEDED(hr));
@@ -205,11 +245,14 @@ Microsoft::WRL::ComPtr<IDxcBlob> GraphicsPipeline::CompileShader(
         L"-E", L"main",
         L"-T", profile,
         L"-Zi", L"-Qembed_debug",
-        L"-Od", L"-Zpr"
+        L"-Od", L"-Zpr",
+        L"-D", define
     };
+    // define がなければ最後の -D を渡さない
+    UINT argumentCount = define ? _countof(arguments) : _countof(arguments) - 2;
 
     Microsoft::WRL::ComPtr<IDxcResult> shaderResult = nullptr;
-    hr = dxcCompiler->Compile(&shaderSourceBuffer, arguments, _countof(arguments), includeHandler, IID_PPV_ARGS(&shaderResult));
+    hr = dxcCompiler->Compile(&shaderSourceBuffer, arguments, argumentCount, includeHandler, IID_PPV_ARGS(&shaderResult));
     assert(SUCCEEDED(hr));
 
     Microsoft::WRL::ComPtr<IDxcBlobUtf8> shaderError = nullptr;
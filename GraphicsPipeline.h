@@ -1,4 +1,5 @@
 #pragma once
+#include "DataTypes.h"
 #include <d3d12.h>
 #include <dxcapi.h>
 #include <wrl.h>
@@ -25,19 +26,27 @@ public:
 
     // ゲッター
     ID3D12RootSignature* GetRootSignature() const { return rootSignature_.Get(); }
-    ID3D12PipelineState* GetPipelineState(BlendMode blendMode) const { return pipelineStates_[blendMode].Get(); }
+    // vertexFormat は描画するメッシュの頂点形式に合わせる
+    ID3D12PipelineState* GetPipelineState(BlendMode blendMode, VertexFormat vertexFormat = kVertexFormatFull) const {
+        return pipelineStates_[vertexFormat][blendMode].Get();
+    }
+    ID3D12PipelineState* GetInstancingPipelineState(BlendMode blendMode, VertexFormat vertexFormat = kVertexFormatFull) const {
+        return instancingPipelineStates_[vertexFormat][blendMode].Get();
+    }
 
 private:
-    // シェーダーのコンパイル
+    // シェーダーのコンパイル (define を指定すると -D で渡す)
     Microsoft::WRL::ComPtr<IDxcBlob> CompileShader(
         const std::wstring& filePath,
         const wchar_t* profile,
         IDxcUtils* dxcUtils,
         IDxcCompiler3* dxcCompiler,
-        IDxcIncludeHandler* includeHandler);
+        IDxcIncludeHandler* includeHandler,
+        const wchar_t* define = nullptr);
 
 private:
     Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature_;
-    Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineStates_[kCountOfBlendMode]; // 全ブレンドモード分のPSO
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineStates_[kCountOfVertexFormat][kCountOfBlendMode]; // 全頂点形式・ブレンドモード分のPSO
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> instancingPipelineStates_[kCountOfVertexFormat][kCountOfBlendMode]; // インスタンス描画用PSO
     std::ofstream logStream_;
 };
\ No newline at end of file
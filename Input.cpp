@@ -17,6 +17,7 @@ void Input::Update() {
     // キーボード
     memcpy(prevKeys_, keys_, sizeof(keys_));
     GetKeyboardState(keys_);
+    pendingButtons_ |= GetButtons();
 
     // ゲームパッド
     prevJoyState_ = joyState_;
@@ -59,4 +60,20 @@ bool Input::GetJoyState(int stickNo, XINPUT_STATE& out) const {
         }
     }
     return false;
+}
+
+uint8_t Input::PollButtons() {
+    uint8_t buttons = static_cast<uint8_t>(pendingButtons_ | GetButtons());
+    pendingButtons_ = 0;
+    return buttons;
+}
+
+uint8_t Input::GetButtons() const {
+    uint8_t buttons = 0;
+    if (IsKeyDown('A')) buttons |= kButtonLeft;
+    if (IsKeyDown('D')) buttons |= kButtonRight;
+    if (IsKeyDown(VK_SPACE)) buttons |= kButtonJump;
+    if (IsKeyDown('J')) buttons |= kButtonShoot;
+    if (IsKeyDown('L')) buttons |= kButtonRoll;
+    return buttons;
 }
\ No newline at end of file
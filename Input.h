@@ -2,10 +2,11 @@
 #include <Windows.h>
 #include <XInput.h>
 #include <cstdint>
+#include "GameInput.h"
 
 #pragma comment(lib, "xinput.lib")
 
-class Input {
+class Input : public InputSource {
 public:
     // シングルトンインスタンスの取得
     static Input* GetInstance();
@@ -24,12 +25,19 @@ public:
     bool GetJoyState(XINPUT_STATE& out) const;
     bool GetJoyState(int stickNo, XINPUT_STATE& out) const; // 番号指定版
 
+    // ゲームのボタン (A / D / Space / J / L)
+    // ティックのないフレームに押して離したボタンも、次のティックで1回は押されている扱いにする
+    uint8_t PollButtons() override;
+
 private:
     Input() = default;
     ~Input() = default;
     Input(const Input&) = delete;
     const Input& operator=(const Input&) = delete;
 
+    // いま押されているゲームのボタン
+    uint8_t GetButtons() const;
+
 private:
     BYTE keys_[256] = {};
     BYTE prevKeys_[256] = {};
@@ -37,4 +45,7 @@ private:
     XINPUT_STATE joyState_{};
     XINPUT_STATE prevJoyState_{};
     bool isJoyValid_ = false;
+
+    // 前の PollButtons から押されたことのあるボタン
+    uint8_t pendingButtons_ = 0;
 };
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "InputReplay.h"
+#include "ObjLoader.h"
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+namespace {
+
+const char kReplayMagic[4] = { 'R', 'P', 'L', 'Y' };
+
+// 累積ハッシュを記録に足す (recording のティック数は足した後の数)
+void AppendHash(InputRecording& recording, uint64_t rollingHash) {
+    recording.hashBytes.push_back(static_cast<uint8_t>(rollingHash));
+    if (recording.hashBytes.size() % kReplayCheckpointTicks == 0) {
+        recording.checkpoints.push_back(rollingHash);
+    }
+    recording.finalHash = rollingHash;
+}
+
+void AppendVarint(std::string& buffer, uint32_t value) {
+    while (value >= 0x80) {
+        buffer += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buffer += static_cast<char>(value);
+}
+
+bool ReadVarint(std::string_view bytes, size_t& offset, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (offset >= bytes.size()) {
+            return false;
+        }
+        uint8_t byte = static_cast<uint8_t>(bytes[offset++]);
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Fail(std::string* errorMessage, const char* message) {
+    if (errorMessage) {
+        *errorMessage = message;
+    }
+    return false;
+}
+
+} // namespace
+
+uint64_t CombineReplayHash(uint64_t rollingHash, uint64_t stateHash) {
+    // 前の値を回してから混ぜ、splitmix64 の仕上げでビットを広げる (下位8ビットだけ見ても偏らないように)
+    uint64_t hash = ((rollingHash << 5) | (rollingHash >> 59)) ^ stateHash;
+    hash ^= hash >> 30;
+    hash *= 0xBF58476D1CE4E5B9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBull;
+    hash ^= hash >> 31;
+    return hash;
+}
+
+uint8_t InputRecorder::PollButtons() {
+    uint8_t buttons = source_ ? source_->PollButtons() : 0;
+    recording_.buttons.push_back(buttons);
+    return buttons;
+}
+
+void InputRecorder::RecordState(uint64_t stateHash) {
+    rollingHash_ = CombineReplayHash(rollingHash_, stateHash);
+    AppendHash(recording_, rollingHash_);
+}
+
+uint8_t InputReplayer::PollButtons() {
+    if (IsFinished()) {
+        return 0;
+    }
+    return recording_->buttons[tick_++];
+}
+
+bool InputReplayer::VerifyState(uint64_t stateHash) {
+    size_t tick = verified_++;
+    rollingHash_ = CombineReplayHash(rollingHash_, stateHash);
+    if (divergedTick_ >= 0) {
+        return false;
+    }
+    if (tick >= recording_->hashBytes.size()) {
+        // 記録より先は比べるものがない
+        return true;
+    }
+    bool matches = static_cast<uint8_t>(rollingHash_) == recording_->hashBytes[tick];
+    size_t tickCount = tick + 1;
+    if (matches && tickCount % kReplayCheckpointTicks == 0) {
+        matches = rollingHash_ == recording_->checkpoints[tickCount / kReplayCheckpointTicks - 1];
+    }
+    if (matches && tickCount == recording_->hashBytes.size()) {
+        matches = rollingHash_ == recording_->finalHash;
+    }
+    if (!matches) {
+        divergedTick_ = static_cast<int64_t>(tick);
+    }
+    return matches;
+}
+
+std::string SerializeInputRecording(const InputRecording& recording) {
+    // ボタンは同じ値が続いたティック数でまとめる (押しっぱなし・離しっぱなしが長いので小さくなる)
+    std::string runs;
+    uint32_t runCount = 0;
+    for (size_t i = 0; i < recording.buttons.size();) {
+        size_t end = i + 1;
+        while (end < recording.buttons.size() && recording.buttons[end] == recording.buttons[i]) {
+            ++end;
+        }
+        runs += static_cast<char>(recording.buttons[i]);
+        AppendVarint(runs, static_cast<uint32_t>(end - i));
+        ++runCount;
+        i = end;
+    }
+
+    ReplayHeader header{};
+    std::memcpy(header.magic, kReplayMagic, sizeof(header.magic));
+    header.version = kReplayVersion;
+    header.tickCount = static_cast<uint32_t>(recording.buttons.size());
+    header.runCount = runCount;
+    header.checkpointTicks = kReplayCheckpointTicks;
+    header.finalHash = recording.finalHash;
+
+    std::string buffer;
+    buffer.reserve(sizeof(header) + runs.size() + recording.hashBytes.size() + sizeof(uint64_t) * recording.checkpoints.size());
+    buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    buffer += runs;
+    buffer.append(reinterpret_cast<const char*>(recording.hashBytes.data()), recording.hashBytes.size());
+    buffer.append(reinterpret_cast<const char*>(recording.checkpoints.data()), sizeof(uint64_t) * recording.checkpoints.size());
+    return buffer;
+}
+
+bool ParseInputRecording(std::string_view bytes, InputRecording& recording, std::string* errorMessage) {
+    if (bytes.size() < sizeof(ReplayHeader)) {
+        return Fail(errorMessage, "file is too small");
+    }
+    ReplayHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, kReplayMagic, sizeof(header.magic)) != 0) {
+        return Fail(errorMessage, "not a replay file");
+    }
+    if (header.version != kReplayVersion || header.checkpointTicks != kReplayCheckpointTicks) {
+        return Fail(errorMessage, "unsupported replay version");
+    }
+
+    InputRecording result;
+    result.buttons.reserve(header.tickCount);
+    size_t offset = sizeof(ReplayHeader);
+    for (uint32_t run = 0; run < header.runCount; ++run) {
+        if (offset >= bytes.size()) {
+            return Fail(errorMessage, "button runs are truncated");
+        }
+        uint8_t buttons = static_cast<uint8_t>(bytes[offset++]);
+        uint32_t length = 0;
+        if (!ReadVarint(bytes, offset, length) || length == 0 || length > header.tickCount - result.buttons.size()) {
+            return Fail(errorMessage, "button run length is invalid");
+        }
+        result.buttons.insert(result.buttons.end(), length, buttons);
+    }
+    if (result.buttons.size() != header.tickCount) {
+        return Fail(errorMessage, "button runs do not cover every tick");
+    }
+
+    size_t checkpointCount = header.tickCount / kReplayCheckpointTicks;
+    if (bytes.size() - offset != header.tickCount + sizeof(uint64_t) * checkpointCount) {
+        return Fail(errorMessage, "hash section size does not match the tick count");
+    }
+    result.hashBytes.assign(reinterpret_cast<const uint8_t*>(bytes.data() + offset),
+        reinterpret_cast<const uint8_t*>(bytes.data() + offset) + header.tickCount);
+    offset += header.tickCount;
+    result.checkpoints.resize(checkpointCount);
+    std::memcpy(result.checkpoints.data(), bytes.data() + offset, sizeof(uint64_t) * checkpointCount);
+    result.finalHash = header.finalHash;
+
+    recording = std::move(result);
+    return true;
+}
+
+bool WriteInputRecording(const std::string& path, const InputRecording& recording) {
+    std::string buffer = SerializeInputRecording(recording);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(file);
+}
+
+bool ReadInputRecording(const std::string& path, InputRecording& recording, std::string* errorMessage) {
+    std::string bytes;
+    if (!ReadFileToString(path, bytes)) {
+        return Fail(errorMessage, "cannot open file");
+    }
+    return ParseInputRecording(bytes, recording, errorMessage);
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "GameInput.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 操作の記録と再生 (Windows / D3D12 に依存しない)
+//
+// 1ティックごとに、押されていたボタン (GameButton のビット) と、そのティックを進めた後の状態のハッシュを残す。
+// 再生では同じボタンをシミュレーションに渡し、状態のハッシュを毎ティック記録と比べて、ずれた最初のティックを見つける。
+// ハッシュは前のティックまでの値に混ぜていく累積なので、一度ずれたら最後までずれたままになる。
+
+// 記録した操作
+struct InputRecording {
+    std::vector<uint8_t> buttons;     // ティックごとのボタン
+    std::vector<uint8_t> hashBytes;   // ティックごとの累積ハッシュの下位8ビット
+    std::vector<uint64_t> checkpoints; // kReplayCheckpointTicks ティックごとの累積ハッシュ (checkpoints[i] は (i+1)*K ティック目の後)
+    uint64_t finalHash = 0;           // 最後のティックの後の累積ハッシュ
+
+    size_t GetTickCount() const { return buttons.size(); }
+};
+
+// 累積ハッシュの64ビット全体を残す間隔 (ティック)
+static const uint32_t kReplayCheckpointTicks = 600;
+
+// 累積ハッシュの始まりの値と、1ティック分の状態のハッシュを混ぜる
+static const uint64_t kReplayHashSeed = 14695981039346656037ull;
+uint64_t CombineReplayHash(uint64_t rollingHash, uint64_t stateHash);
+
+// 操作を記録する (source から読んだボタンをそのまま渡しつつ残す)
+class InputRecorder : public InputSource {
+public:
+    explicit InputRecorder(InputSource* source) : source_(source) {}
+
+    uint8_t PollButtons() override;
+    // Step の後に呼ぶ (そのティックの状態のハッシュ)
+    void RecordState(uint64_t stateHash);
+
+    const InputRecording& GetRecording() const { return recording_; }
+
+private:
+    InputSource* source_ = nullptr;
+    InputRecording recording_;
+    uint64_t rollingHash_ = kReplayHashSeed;
+};
+
+// 記録した操作を再生する (記録が尽きたら何も押さない)
+class InputReplayer : public InputSource {
+public:
+    explicit InputReplayer(const InputRecording* recording) : recording_(recording) {}
+
+    uint8_t PollButtons() override;
+    // Step の後に呼ぶ。記録とずれていたら false
+    // ハッシュの下位8ビットは 1/256 で偶然一致するが、累積なのでずれた次のティックでほぼ確実に見つかる
+    bool VerifyState(uint64_t stateHash);
+
+    bool IsFinished() const { return tick_ >= recording_->GetTickCount(); }
+    size_t GetTick() const { return tick_; }
+    // 記録とずれた最初のティック (0 から数える。ずれていなければ -1)
+    int64_t GetDivergedTick() const { return divergedTick_; }
+
+private:
+    const InputRecording* recording_ = nullptr;
+    size_t tick_ = 0;     // 次に PollButtons で渡すティック
+    size_t verified_ = 0; // 次に VerifyState で比べるティック
+    uint64_t rollingHash_ = kReplayHashSeed;
+    int64_t divergedTick_ = -1;
+};
+
+// .replay (リトルエンディアン)
+//   ReplayHeader
+//   ボタンの連続 [runCount]  (ボタン1バイト + 続いたティック数の LEB128 可変長整数)
+//   uint8_t  [tickCount]     累積ハッシュの下位8ビット
+//   uint64_t [tickCount / checkpointTicks] 累積ハッシュ
+struct ReplayHeader {
+    char magic[4]; // "RPLY"
+    uint32_t version;
+    uint32_t tickCount;
+    uint32_t runCount;
+    uint32_t checkpointTicks;
+    uint32_t reserved;
+    uint64_t finalHash;
+};
+
+// 形式を変えたら上げる
+static const uint32_t kReplayVersion = 2;
+
+// .replay の中身を作る・読む (壊れていたら false と理由)
+std::string SerializeInputRecording(const InputRecording& recording);
+bool ParseInputRecording(std::string_view bytes, InputRecording& recording, std::string* errorMessage = nullptr);
+
+bool WriteInputRecording(const std::string& path, const InputRecording& recording);
+bool ReadInputRecording(const std::string& path, InputRecording& recording, std::string* errorMessage = nullptr);
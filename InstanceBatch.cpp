@@ -0,0 +1,86 @@
+#include "InstanceBatch.h"
+#include "MathUtil.h"
+
+bool RecordingInstanceBackend::UploadInstances(const InstancingData* instances, uint32_t count) {
+	if (maxInstances != 0 && count > maxInstances) {
+		return false;
+	}
+	uploadedInstances.assign(instances, instances + count);
+	return true;
+}
+
+void RecordingInstanceBackend::DrawInstances(const InstanceDrawCommand& command) {
+	drawCommands.push_back(command);
+}
+
+void RecordingInstanceBackend::Clear() {
+	uploadedInstances.clear();
+	drawCommands.clear();
+}
+
+void InstanceBatch::Begin(const Matrix4x4& viewProjectionMatrix) {
+	viewProjectionMatrix_ = viewProjectionMatrix;
+	for (size_t i = 0; i < activeGroupCount_; ++i) {
+		groups_[i].instances.clear();
+	}
+	activeGroupCount_ = 0;
+	instanceCount_ = 0;
+}
+
+void InstanceBatch::Add(const Mesh* mesh, uint64_t textureHandle, const Transform& transform) {
+	if (!mesh) {
+		return;
+	}
+
+	// メッシュの種類は数個しかないので線形探索で十分
+	Group* group = nullptr;
+	for (size_t i = 0; i < activeGroupCount_; ++i) {
+		if (groups_[i].mesh == mesh && groups_[i].textureHandle == textureHandle) {
+			group = &groups_[i];
+			break;
+		}
+	}
+	if (!group) {
+		if (activeGroupCount_ == groups_.size()) {
+			groups_.emplace_back();
+		}
+		group = &groups_[activeGroupCount_++];
+		group->mesh = mesh;
+		group->textureHandle = textureHandle;
+	}
+
+	Matrix4x4 worldMatrix = MakeAffineMatrix(transform.scale, transform.rotate, transform.translate);
+	group->instances.push_back({ Multiply(worldMatrix, viewProjectionMatrix_), worldMatrix });
+	++instanceCount_;
+}
+
+uint32_t InstanceBatch::Submit(InstanceDrawBackend& backend) {
+	if (instanceCount_ == 0) {
+		return 0;
+	}
+
+	// メッシュごとに連続した範囲になるよう詰め直す
+	packed_.clear();
+	packed_.reserve(instanceCount_);
+	for (size_t i = 0; i < activeGroupCount_; ++i) {
+		packed_.insert(packed_.end(), groups_[i].instances.begin(), groups_[i].instances.end());
+	}
+	if (!backend.UploadInstances(packed_.data(), static_cast<uint32_t>(packed_.size()))) {
+		return 0;
+	}
+
+	uint32_t drawCount = 0;
+	uint32_t firstInstance = 0;
+	for (size_t i = 0; i < activeGroupCount_; ++i) {
+		const Group& group = groups_[i];
+		InstanceDrawCommand command;
+		command.mesh = group.mesh;
+		command.textureHandle = group.textureHandle;
+		command.firstInstance = firstInstance;
+		command.instanceCount = static_cast<uint32_t>(group.instances.size());
+		backend.DrawInstances(command);
+		firstInstance += command.instanceCount;
+		++drawCount;
+	}
+	return drawCount;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "DataTypes.h"
+#include <cstdint>
+#include <vector>
+
+class Mesh;
+
+// メッシュ1種類分の描画命令
+struct InstanceDrawCommand {
+	const Mesh* mesh = nullptr;
+	uint64_t textureHandle = 0; // D3D12_GPU_DESCRIPTOR_HANDLE::ptr
+	uint32_t firstInstance = 0;
+	uint32_t instanceCount = 0;
+};
+
+// インスタンス描画の送信先 (D3D12 / 記録用)
+class InstanceDrawBackend {
+public:
+	virtual ~InstanceDrawBackend() = default;
+
+	// そのフレームの全インスタンスデータを書き込む (失敗したら描画しない)
+	virtual bool UploadInstances(const InstancingData* instances, uint32_t count) = 0;
+
+	// メッシュ1種類分をまとめて描画する
+	virtual void DrawInstances(const InstanceDrawCommand& command) = 0;
+};
+
+// 描画命令を記録するだけのバックエンド (GPUなしで描画回数を確認する用)
+class RecordingInstanceBackend : public InstanceDrawBackend {
+public:
+	bool UploadInstances(const InstancingData* instances, uint32_t count) override;
+	void DrawInstances(const InstanceDrawCommand& command) override;
+
+	void Clear();
+
+public:
+	// これより多いインスタンスは受け付けない (InstancedRenderer の最大数の代わり。0 なら上限なし)
+	uint32_t maxInstances = 0;
+	std::vector<InstancingData> uploadedInstances;
+	std::vector<InstanceDrawCommand> drawCommands;
+};
+
+// 同じメッシュのインスタンスを集めて、メッシュごとに1回の描画にまとめる
+class InstanceBatch {
+public:
+	// フレームの開始 (前フレームの内容を破棄する)
+	void Begin(const Matrix4x4& viewProjectionMatrix);
+
+	// インスタンスを追加する
+	void Add(const Mesh* mesh, uint64_t textureHandle, const Transform& transform);
+
+	// まとめたインスタンスを送信する (戻り値は発行した描画回数)
+	uint32_t Submit(InstanceDrawBackend& backend);
+
+	uint32_t GetInstanceCount() const { return instanceCount_; }
+
+private:
+	struct Group {
+		const Mesh* mesh = nullptr;
+		uint64_t textureHandle = 0;
+		std::vector<InstancingData> instances;
+	};
+
+	Matrix4x4 viewProjectionMatrix_{};
+	// グループは最初に追加された順に並ぶ (フレーム間で容量を使い回す)
+	std::vector<Group> groups_;
+	size_t activeGroupCount_ = 0;
+	uint32_t instanceCount_ = 0;
+	std::vector<InstancingData> packed_;
+};
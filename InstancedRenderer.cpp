@@ -0,0 +1,68 @@
+#include "InstancedRenderer.h"
+#include "Mesh.h"
+#include "MathUtil.h"
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <Windows.h> // OutputDebugStringA
+
+void InstancedRenderer::Initialize(ID3D12Device* device, uint32_t maxInstances) {
+    maxInstances_ = maxInstances;
+
+    // 毎フレーム書き換える構造化バッファ (PostDraw でGPU完了を待つので1本で足りる)
+    instancingResource_ = CreateBufferResource(device, sizeof(InstancingData) * maxInstances_);
+    instancingResource_->Map(0, nullptr, reinterpret_cast<void**>(&instancingData_));
+
+    // インスタンス描画は共通のマテリアルを使う
+    materialBuffer_ = UploadBufferAllocator::GetInstance()->Allocate(sizeof(Material));
+    materialData_ = reinterpret_cast<Material*>(materialBuffer_.cpuAddress);
+    materialData_->color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    materialData_->enableLighting = true;
+    materialData_->uvTransform = MakeIdentity4x4();
+}
+
+InstancedRenderer::~InstancedRenderer() {
+    UploadBufferAllocator::GetInstance()->Free(materialBuffer_);
+}
+
+uint32_t InstancedRenderer::Draw(
+    ID3D12GraphicsCommandList* commandList,
+    InstanceBatch& batch,
+    D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress) {
+
+    commandList_ = commandList;
+    lightGpuAddress_ = lightGpuAddress;
+    uint32_t drawCount = batch.Submit(*this);
+    commandList_ = nullptr;
+    return drawCount;
+}
+
+bool InstancedRenderer::UploadInstances(const InstancingData* instances, uint32_t count) {
+    if (count > maxInstances_) {
+        std::string message = "[InstancedRenderer] Too many instances: " + std::to_string(count) + "\n";
+        OutputDebugStringA(message.c_str());
+        return false;
+    }
+    std::memcpy(instancingData_, instances, sizeof(InstancingData) * count);
+    return true;
+}
+
+void InstancedRenderer::DrawInstances(const InstanceDrawCommand& command) {
+    assert(commandList_ != nullptr);
+    if (command.mesh->IsEmpty()) {
+        return;
+    }
+
+    // SV_InstanceID は0から始まるので、グループの先頭をバッファの先頭としてバインドする
+    D3D12_GPU_VIRTUAL_ADDRESS instancesAddress =
+        instancingResource_->GetGPUVirtualAddress() + sizeof(InstancingData) * command.firstInstance;
+    D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandle{ command.textureHandle };
+
+    command.mesh->Bind(commandList_);
+    commandList_->SetGraphicsRootConstantBufferView(0, materialBuffer_.gpuAddress);
+    commandList_->SetGraphicsRootDescriptorTable(2, textureSrvHandle);
+    commandList_->SetGraphicsRootConstantBufferView(3, lightGpuAddress_);
+    commandList_->SetGraphicsRootShaderResourceView(5, instancesAddress);
+
+    commandList_->DrawIndexedInstanced(command.mesh->GetIndexCount(), command.instanceCount, 0, 0, 0);
+}
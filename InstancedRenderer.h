@@ -0,0 +1,34 @@
+#pragma once
+#include "D3D12Util.h"
+#include "DataTypes.h"
+#include "InstanceBatch.h"
+#include "UploadBufferAllocator.h"
+
+// InstanceBatch を構造化バッファ (t1) 経由で描画するクラス
+class InstancedRenderer : public InstanceDrawBackend {
+public:
+    // 初期化 (1フレームに描画できる最大インスタンス数を指定)
+    void Initialize(ID3D12Device* device, uint32_t maxInstances);
+
+    ~InstancedRenderer();
+
+    // まとめたインスタンスを描画する (インスタンシング用PSOをセットしてから呼ぶ)
+    uint32_t Draw(
+        ID3D12GraphicsCommandList* commandList,
+        InstanceBatch& batch,
+        D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress);
+
+    bool UploadInstances(const InstancingData* instances, uint32_t count) override;
+    void DrawInstances(const InstanceDrawCommand& command) override;
+
+private:
+    uint32_t maxInstances_ = 0;
+    Microsoft::WRL::ComPtr<ID3D12Resource> instancingResource_;
+    InstancingData* instancingData_ = nullptr;
+    UploadBuffer materialBuffer_;
+    Material* materialData_ = nullptr;
+
+    // Draw の間だけ有効
+    ID3D12GraphicsCommandList* commandList_ = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress_ = 0;
+};
@@ -1,70 +1,70 @@
 #pragma once
 #include <vector>
-#include <string>
-#include "Model.h"
+#include "Mesh.h"
+#include "InstanceBatch.h"
 #include "MathTypes.h"
+#include "GameMap.h"
+#include "TileMesher.h"
+#include "ViewCulling.h"
+#include <memory>
+#include <unordered_map>
 #include <d3d12.h> 
 
-// 動的ブロック（罠や落下ブロック）の初期配置情報
-struct DynamicBlockData {
-    Vector3 position;
-    int type;
+// 描画の間引きの結果 (見えた数 / 全体の数)
+struct ViewCullStats {
+    uint32_t visibleChunks = 0;
+    uint32_t totalChunks = 0;
+    size_t visibleWalls = 0;
+    size_t totalWalls = 0;
+    uint32_t visibleObjects = 0;
+    uint32_t totalObjects = 0;
 };
 
-class MapChip {
+// GameMap の壁を描く
+// 壁はチャンクごとに1つのメッシュにまとめる (見えない面を除き、並んだ面を大きな四角形にする)
+// チャンクの読み込み・破棄・書き換え (GameMap::ApplyChanges でまとめて届く) に合わせてメッシュを作り直す
+class MapChip : private TileChunkListener {
 public:
-    static const float kBlockSize;
-
     ~MapChip();
 
-    void Initialize();
-
-    void Load(const std::string& filePath, ID3D12Device* device);
-
-    void Draw(
-        ID3D12GraphicsCommandList* commandList,
-        const Matrix4x4& viewProjectionMatrix,
-        D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress,
-        D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandle);
-
-    bool CheckCollision(const Vector3& worldPos);
-
-    size_t GetRowCount() const { return data_.size(); }
-    size_t GetColCount() const { return data_.empty() ? 0 : data_[0].size(); }
+    // map のチャンクの通知を受け始める (map の Load より前に呼ぶ)
+    void Initialize(GameMap* map);
 
-    const Vector3& GetStartPosition() const { return startPosition_; }
+    // カメラに映るタイルの範囲を求める (毎フレーム描画の前に呼ぶ。統計もここで数え直す)
+    void UpdateVisibleRange(const Matrix4x4& viewProjectionMatrix);
 
-    const std::vector<DynamicBlockData>& GetDynamicBlocks() const { return dynamicBlocks_; }
+    // 見える範囲にかかる壁メッシュだけをインスタンス描画のバッチに積む (チャンクごとに1回の描画)
+    void Draw(InstanceBatch& batch, D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandle);
 
-    bool CheckGoalCollision(const Vector3& playerPos, float playerHalfSize) const;
+    // 動的ブロックなどが見える範囲にあるか (統計にも数える)
+    bool IsObjectVisible(const Vector3& worldPos);
 
-    const Vector3& GetGoalPosition() const { return goalPos_; }
-    bool HasGoal() const { return hasGoal_; }
+    const TileRect& GetVisibleRange() const { return visibleRange_; }
+    const ViewCullStats& GetCullStats() const { return cullStats_; }
+    // マップを読み直してから読み込んだチャンクの合計 (立方体を並べた場合との比較用)
+    const TileMeshStats& GetMeshStats() const { return meshStats_; }
+    void ResetMeshStats() { meshStats_ = {}; }
 
-    // ★追加: ゲーム中にゴールの位置を変更するための関数
-    void SetGoalPosition(const Vector3& newPos) { goalPos_ = newPos; }
-
-    void GetGridCoordinates(const Vector3& worldPos, int& outX, int& outMapY) const;
-
-    void SetGridCell(int x, int mapY, int value);
-
-    int GetGridValue(int x, int mapY) const {
-        if (x < 0 || mapY < 0 || mapY >= data_.size()) return -1;
-        if (x >= data_[mapY].size()) return -1;
-        return data_[mapY][x];
-    }
-
-    // ★追加: 指定したタイプのブロックが最初に見つかった場所を探す
-    bool FindBlock(int type, int& outGridX, int& outMapY) const;
+private:
+    // チャンクの読み込み・破棄・書き換えに合わせて壁のメッシュを作る・捨てる
+    // (メッシュにするのは kTileWall だけなので、落下ブロックが置いた kTileBlock は描かない)
+    void OnChunkLoaded(int32_t chunkX, int32_t chunkY, const uint8_t* tiles) override;
+    void OnChunkEvicted(int32_t chunkX, int32_t chunkY) override;
+    void OnChunkChanged(int32_t chunkX, int32_t chunkY, const TileRect& dirtyRect, bool wallsChanged, const uint8_t* tiles) override;
 
-    // ★追加: グリッド座標からワールド座標を計算して返す
-    Vector3 GetWorldPosFromGrid(int gridX, int gridMapY) const;
+    // チャンクのメッシュを作り直す (壁がなければ捨てる)
+    TileMeshStats BuildChunkMesh(int32_t chunkX, int32_t chunkY, const uint8_t* tiles);
 
 private:
-    std::vector<std::vector<int>> data_;
-    std::vector<Model*> models_;
-    Vector3 startPosition_ = { 0, 0, 0 };
-    Vector3 goalPos_ = { 0, 0, 0 };
-    bool hasGoal_ = false;
-    std::vector<DynamicBlockData> dynamicBlocks_;
+    GameMap* map_ = nullptr;
+    // チャンクの壁メッシュ (壁のないチャンクは持たない)
+    struct ChunkMesh {
+        std::shared_ptr<const Mesh> mesh;
+        size_t wallCount = 0;
+    };
+    std::unordered_map<int32_t, ChunkMesh> chunkMeshes_;
+    // 見えるタイルの範囲 (UpdateVisibleRange を呼ぶまではすべて)
+    TileRect visibleRange_ = kUnboundedTileRange;
+    ViewCullStats cullStats_;
+    TileMeshStats meshStats_;
 };
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "MapFile.h"
+#include "ObjLoader.h"
+#include <charconv>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char kMapBinMagic[4] = { 'M', 'A', 'P', 'B' };
+
+inline bool IsSpace(char c) { return c == ' ' || c == '\r'; }
+
+bool Fail(std::string* errorMessage, size_t lineNumber, const char* reason) {
+	if (errorMessage) {
+		*errorMessage = "line " + std::to_string(lineNumber) + ": " + reason;
+	}
+	return false;
+}
+
+// 最初の行に現れた区切り文字 (どちらもなければ1列のマップとして ,)
+char DetectDelimiter(std::string_view text) {
+	for (char c : text) {
+		if (c == ',' || c == '\t') {
+			return c;
+		}
+		if (c == '\n') {
+			break;
+		}
+	}
+	return ',';
+}
+
+} // namespace
+
+bool ParseMapText(std::string_view text, MapData& map, std::string* errorMessage) {
+	map = MapData();
+	// UTF-8 の BOM を飛ばす
+	if (text.size() >= 3 && std::memcmp(text.data(), "\xEF\xBB\xBF", 3) == 0) {
+		text.remove_prefix(3);
+	}
+	char delimiter = DetectDelimiter(text);
+
+	// 先に行数の見当をつけて確保しておく
+	map.tiles.reserve(text.size() / 2);
+
+	const char* p = text.data();
+	const char* end = p + text.size();
+	size_t lineNumber = 0;
+	while (p < end) {
+		++lineNumber;
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+		if (!lineEnd) {
+			lineEnd = end;
+		}
+
+		// 空行 (末尾の改行など) は飛ばす
+		const char* q = p;
+		while (q < lineEnd && IsSpace(*q)) {
+			++q;
+		}
+		if (q == lineEnd) {
+			p = lineEnd + 1;
+			continue;
+		}
+
+		int32_t column = 0;
+		while (q < lineEnd) {
+			while (q < lineEnd && IsSpace(*q)) {
+				++q;
+			}
+			if (q == lineEnd) {
+				break; // 行末の区切り文字の後ろの空白
+			}
+			uint32_t value = 0;
+			std::from_chars_result result = std::from_chars(q, lineEnd, value);
+			if (result.ec != std::errc() || value > 0xFF) {
+				return Fail(errorMessage, lineNumber, "invalid tile value");
+			}
+			q = result.ptr;
+			while (q < lineEnd && IsSpace(*q)) {
+				++q;
+			}
+			if (q < lineEnd) {
+				if (*q != delimiter) {
+					return Fail(errorMessage, lineNumber, "unexpected character");
+				}
+				++q; // 行末の区切り文字は許す
+			}
+
+			if (IsStaticTileType(value)) {
+				map.tiles.push_back(static_cast<uint8_t>(value));
+			} else {
+				map.tiles.push_back(kTileEmpty);
+				map.objects.push_back({ column, map.height, value });
+			}
+			++column;
+		}
+
+		if (map.height == 0) {
+			map.width = column;
+		} else if (column != map.width) {
+			return Fail(errorMessage, lineNumber, "row width differs from the first row");
+		}
+		++map.height;
+		p = lineEnd + 1;
+	}
+
+	if (map.height == 0) {
+		return Fail(errorMessage, lineNumber, "empty map");
+	}
+	return true;
+}
+
+std::string WriteMapText(const MapData& map, char delimiter) {
+	// オブジェクトをグリッドに戻してから書く
+	std::vector<uint32_t> cells(map.tiles.begin(), map.tiles.end());
+	for (const MapObject& object : map.objects) {
+		cells[static_cast<size_t>(object.mapY) * map.width + object.x] = object.type;
+	}
+
+	std::string text;
+	text.reserve(cells.size() * 2 + map.height);
+	char number[16];
+	for (int32_t y = 0; y < map.height; ++y) {
+		for (int32_t x = 0; x < map.width; ++x) {
+			if (x > 0) {
+				text += delimiter;
+			}
+			std::to_chars_result result = std::to_chars(number, number + sizeof(number), cells[static_cast<size_t>(y) * map.width + x]);
+			text.append(number, result.ptr);
+		}
+		text += '\n';
+	}
+	return text;
+}
+
+std::string SerializeMapBin(const MapData& map) {
+	MapBinHeader header{};
+	std::memcpy(header.magic, kMapBinMagic, sizeof(header.magic));
+	header.version = kMapBinVersion;
+	header.width = map.width;
+	header.height = map.height;
+	header.objectCount = static_cast<uint32_t>(map.objects.size());
+
+	std::string buffer;
+	buffer.reserve(sizeof(header) + map.tiles.size() + sizeof(MapObject) * map.objects.size());
+	buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+	buffer.append(reinterpret_cast<const char*>(map.tiles.data()), map.tiles.size());
+	buffer.append(reinterpret_cast<const char*>(map.objects.data()), sizeof(MapObject) * map.objects.size());
+	return buffer;
+}
+
+bool WriteMapBin(const std::string& path, const MapData& map) {
+	std::string buffer = SerializeMapBin(map);
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+	file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	return static_cast<bool>(file);
+}
+
+bool IsValidMapBinHeader(const MapBinHeader& header, uint64_t totalBytes) {
+	if (std::memcmp(header.magic, kMapBinMagic, sizeof(header.magic)) != 0 ||
+		header.version != kMapBinVersion ||
+		header.width < 0 || header.height < 0) {
+		return false;
+	}
+	uint64_t tileBytes = static_cast<uint64_t>(header.width) * static_cast<uint64_t>(header.height);
+	uint64_t objectBytes = sizeof(MapObject) * static_cast<uint64_t>(header.objectCount);
+	return totalBytes == sizeof(MapBinHeader) + tileBytes + objectBytes;
+}
+
+bool ParseMapBin(std::string_view bytes, MapData& map) {
+	if (bytes.size() < sizeof(MapBinHeader)) {
+		return false;
+	}
+	MapBinHeader header;
+	std::memcpy(&header, bytes.data(), sizeof(header));
+	if (!IsValidMapBinHeader(header, bytes.size())) {
+		return false;
+	}
+
+	size_t tileBytes = static_cast<size_t>(header.width) * static_cast<size_t>(header.height);
+	size_t objectBytes = sizeof(MapObject) * header.objectCount;
+	const char* cursor = bytes.data() + sizeof(MapBinHeader);
+	map.width = header.width;
+	map.height = header.height;
+	map.tiles.assign(reinterpret_cast<const uint8_t*>(cursor), reinterpret_cast<const uint8_t*>(cursor) + tileBytes);
+	cursor += tileBytes;
+	map.objects.resize(header.objectCount);
+	std::memcpy(map.objects.data(), cursor, objectBytes);
+
+	// 表の位置が範囲外なら壊れている
+	for (const MapObject& object : map.objects) {
+		if (object.x < 0 || object.x >= map.width || object.mapY < 0 || object.mapY >= map.height) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ReadMapBin(const std::string& path, MapData& map) {
+	std::string bytes;
+	return ReadFileToString(path, bytes) && ParseMapBin(bytes, map);
+}
+
+bool HasMapBinExtension(const std::string& path) {
+	const std::string kMapBinExtension = ".mapbin";
+	return path.size() >= kMapBinExtension.size() &&
+		path.compare(path.size() - kMapBinExtension.size(), kMapBinExtension.size(), kMapBinExtension) == 0;
+}
+
+bool LoadMapFile(const std::string& path, MapData& map, std::string* errorMessage) {
+	std::string bytes;
+	if (!ReadFileToString(path, bytes)) {
+		if (errorMessage) {
+			*errorMessage = "cannot open " + path;
+		}
+		return false;
+	}
+	if (HasMapBinExtension(path)) {
+		if (!ParseMapBin(bytes, map)) {
+			if (errorMessage) {
+				*errorMessage = "broken mapbin " + path;
+			}
+			return false;
+		}
+		return true;
+	}
+	return ParseMapText(bytes, map, errorMessage);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "TileGrid.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// マップファイル (CSV / TSV / .mapbin) の読み書き (Windows / D3D12 に依存しない)
+//
+// タイルは「動かないもの (空き・壁)」だけをグリッドに残し、
+// スタート・ゴール・罠などはマスの位置と種類の表に分けて持つ。
+
+// グリッド以外に置かれたもの (スタート・ゴール・動的ブロック)
+struct MapObject {
+	int32_t x;
+	int32_t mapY;
+	uint32_t type;
+};
+
+struct MapData {
+	int32_t width = 0;
+	int32_t height = 0;
+	std::vector<uint8_t> tiles;     // 行優先 (width * height)。kTileEmpty か kTileWall
+	std::vector<MapObject> objects; // 行優先で見つかった順
+};
+
+// グリッドに残す種類か (それ以外は MapObject になる)
+inline bool IsStaticTileType(uint32_t type) { return type == kTileEmpty || type == kTileWall; }
+
+// CSV / TSV のテキストを解析する
+// 区切り文字 (, か タブ) は最初の行から判定し、全行の列数が同じでなければ失敗する
+// 失敗したときは errorMessage に行番号付きの理由を入れる
+bool ParseMapText(std::string_view text, MapData& map, std::string* errorMessage = nullptr);
+
+// CSV / TSV のテキストにする (ParseMapText で読み戻すと同じ内容になる)
+std::string WriteMapText(const MapData& map, char delimiter = ',');
+
+// .mapbin (リトルエンディアン)
+//   MapBinHeader
+//   uint8_t   [width * height]  タイル
+//   MapObject [objectCount]
+struct MapBinHeader {
+	char magic[4]; // "MAPB"
+	uint32_t version;
+	int32_t width;
+	int32_t height;
+	uint32_t objectCount;
+	uint32_t reserved;
+};
+
+// 形式を変えたら上げる
+static const uint32_t kMapBinVersion = 1;
+
+// ヘッダーが正しく、ファイル全体が totalBytes バイトで中身と釣り合っているか
+bool IsValidMapBinHeader(const MapBinHeader& header, uint64_t totalBytes);
+
+// .mapbin の中身を作る・書き出す
+std::string SerializeMapBin(const MapData& map);
+bool WriteMapBin(const std::string& path, const MapData& map);
+// 読み込みは1回で済ませ、壊れていたら false
+bool ReadMapBin(const std::string& path, MapData& map);
+bool ParseMapBin(std::string_view bytes, MapData& map);
+
+// .mapbin の拡張子か
+bool HasMapBinExtension(const std::string& path);
+
+// 拡張子 (.mapbin かそれ以外) で形式を選んで読み込む
+bool LoadMapFile(const std::string& path, MapData& map, std::string* errorMessage = nullptr);
@@ -16,6 +16,10 @@ struct Matrix4x4 {
 	float m[4][4];
 };
 
+struct WorldRect {
+	float left, bottom, right, top;
+};
+
 struct Transform {
 	Vector3 scale;
 	Vector3 rotate;
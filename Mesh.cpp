@@ -0,0 +1,116 @@
+#include "Mesh.h"
+#include "MeshCache.h"
+#include "StaticBufferUploader.h"
+#include "VertexPacking.h"
+#include <cassert>
+#include <cstring>
+#include <vector>
+#include <Windows.h> // OutputDebugStringA のために追加
+
+std::shared_ptr<Mesh> Mesh::Create(
+	const std::string& directoryPath, const std::string& filename, ID3D12Device* device, VertexFormat vertexFormat) {
+	std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
+	mesh->Initialize(directoryPath, filename, device, vertexFormat);
+	return mesh;
+}
+
+std::shared_ptr<Mesh> Mesh::CreateFromData(const IndexedModelData& meshData, VertexFormat vertexFormat) {
+	std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
+	mesh->material_ = meshData.material;
+	mesh->Upload(meshData, vertexFormat);
+	return mesh;
+}
+
+void Mesh::Initialize(
+	const std::string& directoryPath, const std::string& filename, ID3D12Device* device, VertexFormat vertexFormat) {
+
+	// 焼き込み済みの .meshbin があれば解析せずに読む (OBJが変わっていたら焼き直す)
+	IndexedModelData indexedData;
+	MeshLoadResult loadResult = LoadMeshWithCache(directoryPath, filename, indexedData);
+	if (!loadResult.loaded) {
+		std::string message = "Error: Cannot load model file: " + directoryPath + "/" + filename + "\n";
+		OutputDebugStringA(message.c_str());
+		assert(false);
+		return; // 空のメッシュとして扱う
+	}
+
+	// 頂点データがなければ空のメッシュとして扱う
+	if (indexedData.indices.empty()) {
+		return;
+	}
+	weldStats_ = loadResult.weldStats;
+	material_ = indexedData.material;
+
+	const char* source = loadResult.fromCache ? " (meshbin)" : (loadResult.rebaked ? " (baked)" : "");
+	std::string message = "[Mesh] " + filename + source + ": " + std::to_string(weldStats_.sourceVertexCount) + " -> " + std::to_string(weldStats_.weldedVertexCount) +
+		" vertices, " + std::to_string(weldStats_.sourceBytes) + " -> " + std::to_string(weldStats_.weldedBytes) + " bytes";
+	if (loadResult.rebaked) {
+		message += ", ACMR " + std::to_string(loadResult.cacheBefore.acmr) + " -> " + std::to_string(loadResult.cacheAfter.acmr);
+	}
+	message += "\n";
+	OutputDebugStringA(message.c_str());
+
+	Upload(indexedData, vertexFormat);
+}
+
+void Mesh::Upload(const IndexedModelData& meshData, VertexFormat vertexFormat) {
+	// 頂点データがなければ空のメッシュとして扱う
+	if (meshData.indices.empty()) {
+		return;
+	}
+	vertexCount_ = UINT(meshData.vertices.size());
+	indexCount_ = UINT(meshData.indices.size());
+	vertexFormat_ = vertexFormat;
+
+	// 形状は生成後に変わらないので DEFAULT ヒープに置く (転送は次のフレームの先頭)
+	if (vertexFormat_ == kVertexFormatCompact) {
+		// 36 -> 20 バイト。展開は頂点シェーダーで行う
+		std::vector<CompactVertexData> compactVertices;
+		PackVertices(meshData.vertices, compactVertices);
+		size_t vertexBufferSize = sizeof(CompactVertexData) * vertexCount_;
+		vertexBufferView_.BufferLocation = CreateStaticBuffer(compactVertices.data(), vertexBufferSize, vertexBuffer_);
+		vertexBufferView_.SizeInBytes = UINT(vertexBufferSize);
+		vertexBufferView_.StrideInBytes = sizeof(CompactVertexData);
+	} else {
+		size_t vertexBufferSize = sizeof(VertexData) * vertexCount_;
+		vertexBufferView_.BufferLocation = CreateStaticBuffer(meshData.vertices.data(), vertexBufferSize, vertexBuffer_);
+		vertexBufferView_.SizeInBytes = UINT(vertexBufferSize);
+		vertexBufferView_.StrideInBytes = sizeof(VertexData);
+	}
+
+	// 頂点が65535個以下なら16bitインデックスにする
+	if (CanUse16BitIndices(vertexCount_)) {
+		std::vector<uint16_t> indices16(indexCount_);
+		for (UINT i = 0; i < indexCount_; ++i) {
+			indices16[i] = static_cast<uint16_t>(meshData.indices[i]);
+		}
+		indexBufferView_.BufferLocation = CreateStaticBuffer(indices16.data(), sizeof(uint16_t) * indexCount_, indexBuffer_);
+		indexBufferView_.SizeInBytes = UINT(sizeof(uint16_t) * indexCount_);
+		indexBufferView_.Format = DXGI_FORMAT_R16_UINT;
+	} else {
+		indexBufferView_.BufferLocation = CreateStaticBuffer(meshData.indices.data(), sizeof(uint32_t) * indexCount_, indexBuffer_);
+		indexBufferView_.SizeInBytes = UINT(sizeof(uint32_t) * indexCount_);
+		indexBufferView_.Format = DXGI_FORMAT_R32_UINT;
+	}
+}
+
+Mesh::~Mesh() {
+	UploadBufferAllocator::GetInstance()->Free(vertexBuffer_.fallback);
+	UploadBufferAllocator::GetInstance()->Free(indexBuffer_.fallback);
+}
+
+void Mesh::Bind(ID3D12GraphicsCommandList* commandList) const {
+	commandList->IASetVertexBuffers(0, 1, &vertexBufferView_);
+	commandList->IASetIndexBuffer(&indexBufferView_);
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS Mesh::CreateStaticBuffer(const void* data, size_t sizeInBytes, StaticBuffer& buffer) {
+	buffer.resource = StaticBufferUploader::GetInstance()->CreateStaticBuffer(data, sizeInBytes);
+	if (buffer.resource) {
+		return buffer.resource->GetGPUVirtualAddress();
+	}
+	// ステージングが足りないときはアップロードヒープから直接読む
+	buffer.fallback = UploadBufferAllocator::GetInstance()->Allocate(sizeInBytes);
+	std::memcpy(buffer.fallback.cpuAddress, data, sizeInBytes);
+	return buffer.fallback.gpuAddress;
+}
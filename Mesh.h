@@ -0,0 +1,59 @@
+#pragma once
+#include "D3D12Util.h"
+#include "DataTypes.h"
+#include "MeshProcessing.h"
+#include "UploadBufferAllocator.h"
+#include <memory>
+#include <string>
+
+// 読み込み済みの形状データ (複数のModelで共有する・生成後は変更しない)
+class Mesh {
+public:
+	// vertexFormat は描画に使うPSOの頂点形式と合わせる
+	static std::shared_ptr<Mesh> Create(
+		const std::string& directoryPath, const std::string& filename, ID3D12Device* device,
+		VertexFormat vertexFormat = kVertexFormatFull);
+
+	// 実行時に作った形状から作る (タイルをまとめたメッシュなど)
+	static std::shared_ptr<Mesh> CreateFromData(const IndexedModelData& meshData, VertexFormat vertexFormat = kVertexFormatFull);
+
+	~Mesh();
+
+	// 頂点バッファとインデックスバッファをセットする
+	void Bind(ID3D12GraphicsCommandList* commandList) const;
+
+	bool IsEmpty() const { return indexCount_ == 0; }
+	UINT GetVertexCount() const { return vertexCount_; }
+	UINT GetIndexCount() const { return indexCount_; }
+	VertexFormat GetVertexFormat() const { return vertexFormat_; }
+	const MaterialData& GetMaterial() const { return material_; }
+	// 読み込み時の頂点結合の結果
+	const WeldStats& GetWeldStats() const { return weldStats_; }
+
+private:
+	// DEFAULT ヒープ (作れなかったときはアップロードヒープ) に置いたバッファ
+	struct StaticBuffer {
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+		UploadBuffer fallback;
+	};
+
+	void Initialize(
+		const std::string& directoryPath, const std::string& filename, ID3D12Device* device, VertexFormat vertexFormat);
+
+	// 頂点とインデックスを転送する
+	void Upload(const IndexedModelData& meshData, VertexFormat vertexFormat);
+
+	// データを転送してGPUアドレスを返す
+	static D3D12_GPU_VIRTUAL_ADDRESS CreateStaticBuffer(const void* data, size_t sizeInBytes, StaticBuffer& buffer);
+
+private:
+	UINT vertexCount_ = 0;
+	UINT indexCount_ = 0;
+	VertexFormat vertexFormat_ = kVertexFormatFull;
+	MaterialData material_;
+	WeldStats weldStats_;
+	StaticBuffer vertexBuffer_;
+	StaticBuffer indexBuffer_;
+	D3D12_VERTEX_BUFFER_VIEW vertexBufferView_{};
+	D3D12_INDEX_BUFFER_VIEW indexBufferView_{};
+};
@@ -0,0 +1,282 @@
+#include "MeshCache.h"
+#include "ObjLoader.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+const char kMeshBinMagic[4] = { 'M', 'S', 'H', 'B' };
+
+// FNV-1a 64bit
+uint64_t HashBytes(std::string_view bytes, uint64_t hash) {
+	for (char c : bytes) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+template<typename T>
+void AppendBytes(std::string& buffer, const T* data, size_t count) {
+	buffer.append(reinterpret_cast<const char*>(data), sizeof(T) * count);
+}
+
+// ファイルの大きさと更新時刻 (無ければ false)
+bool GetFileStamp(const std::string& path, uint64_t& size, int64_t& writeTime) {
+	std::error_code error;
+	size = std::filesystem::file_size(path, error);
+	if (error) {
+		return false;
+	}
+	writeTime = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+	return !error;
+}
+
+// 長さ付きの文字列を読む (足りなければ false)
+bool ReadLengthPrefixedString(const std::string& buffer, size_t& offset, std::string* text) {
+	uint32_t length = 0;
+	if (buffer.size() < offset + sizeof(length)) {
+		return false;
+	}
+	std::memcpy(&length, buffer.data() + offset, sizeof(length));
+	offset += sizeof(length);
+	if (buffer.size() < offset + length) {
+		return false;
+	}
+	if (text) {
+		text->assign(buffer.data() + offset, length);
+	}
+	offset += length;
+	return true;
+}
+
+// .meshbin の見出しから統計を埋める
+void FillCachedResult(const MeshBinHeader& header, MeshLoadResult& result) {
+	result.loaded = true;
+	result.fromCache = true;
+	result.weldStats.sourceVertexCount = header.sourceVertexCount;
+	result.weldStats.weldedVertexCount = header.vertexCount;
+	result.weldStats.indexCount = header.indexCount;
+	result.weldStats.indexSize = CanUse16BitIndices(header.vertexCount) ? 2 : 4;
+	result.weldStats.sourceBytes = sizeof(VertexData) * header.sourceVertexCount;
+	result.weldStats.weldedBytes = sizeof(VertexData) * header.vertexCount + result.weldStats.indexSize * header.indexCount;
+}
+
+} // namespace
+
+uint64_t HashMeshSource(std::string_view objText, std::string_view mtlText) {
+	uint64_t hash = 14695981039346656037ull;
+	hash = HashBytes(objText, hash);
+	// OBJとMTLの境目がずれても同じにならないように長さも混ぜる
+	uint64_t objSize = objText.size();
+	hash = HashBytes(std::string_view(reinterpret_cast<const char*>(&objSize), sizeof(objSize)), hash);
+	hash = HashBytes(mtlText, hash);
+	return hash;
+}
+
+std::string FindMaterialLibrary(std::string_view objText) {
+	size_t position = 0;
+	while (position < objText.size()) {
+		size_t lineEnd = objText.find('\n', position);
+		if (lineEnd == std::string_view::npos) {
+			lineEnd = objText.size();
+		}
+		std::string_view line = objText.substr(position, lineEnd - position);
+		if (line.substr(0, 7) == "mtllib ") {
+			line.remove_prefix(7);
+			while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) {
+				line.remove_suffix(1);
+			}
+			while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) {
+				line.remove_prefix(1);
+			}
+			return std::string(line);
+		}
+		position = lineEnd + 1;
+	}
+	return std::string();
+}
+
+bool GetMeshSourceStamp(const std::string& objPath, const std::string& mtlPath, MeshSourceStamp& stamp) {
+	stamp = MeshSourceStamp{};
+	if (!GetFileStamp(objPath, stamp.objSize, stamp.objWriteTime)) {
+		return false;
+	}
+	// MTLが無いときは 0 のまま (あとから置かれたら違う値になる)
+	if (!mtlPath.empty() && !GetFileStamp(mtlPath, stamp.mtlSize, stamp.mtlWriteTime)) {
+		stamp.mtlSize = 0;
+		stamp.mtlWriteTime = 0;
+	}
+	return true;
+}
+
+bool WriteMeshBin(const std::string& path, const IndexedModelData& meshData, const MeshSource& source, size_t sourceVertexCount, uint32_t flags) {
+	MeshBinHeader header{};
+	std::memcpy(header.magic, kMeshBinMagic, sizeof(header.magic));
+	header.version = kMeshBinVersion;
+	header.sourceHash = source.hash;
+	header.sourceStamp = source.stamp;
+	header.vertexCount = static_cast<uint32_t>(meshData.vertices.size());
+	header.indexCount = static_cast<uint32_t>(meshData.indices.size());
+	header.vertexStride = sizeof(VertexData);
+	header.materialPathCount = meshData.material.textureFilePath.empty() ? 0 : 1;
+	header.sourceVertexCount = static_cast<uint32_t>(sourceVertexCount);
+	header.flags = flags;
+	for (int32_t axis = 0; axis < 3; ++axis) {
+		header.boundsMin[axis] = meshData.vertices.empty() ? 0.0f : FLT_MAX;
+		header.boundsMax[axis] = meshData.vertices.empty() ? 0.0f : -FLT_MAX;
+	}
+	for (const VertexData& vertex : meshData.vertices) {
+		const float position[3] = { vertex.position.x, vertex.position.y, vertex.position.z };
+		for (int32_t axis = 0; axis < 3; ++axis) {
+			header.boundsMin[axis] = std::min(header.boundsMin[axis], position[axis]);
+			header.boundsMax[axis] = std::max(header.boundsMax[axis], position[axis]);
+		}
+	}
+
+	// 1回の書き込みで済むようにまとめる
+	std::string buffer;
+	AppendBytes(buffer, &header, 1);
+	AppendBytes(buffer, meshData.vertices.data(), meshData.vertices.size());
+	AppendBytes(buffer, meshData.indices.data(), meshData.indices.size());
+	if (header.materialPathCount != 0) {
+		uint32_t length = static_cast<uint32_t>(meshData.material.textureFilePath.size());
+		AppendBytes(buffer, &length, 1);
+		buffer += meshData.material.textureFilePath;
+	}
+	uint32_t materialLibraryLength = static_cast<uint32_t>(source.materialLibrary.size());
+	AppendBytes(buffer, &materialLibraryLength, 1);
+	buffer += source.materialLibrary;
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+	file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	return static_cast<bool>(file);
+}
+
+bool ReadMeshBin(const std::string& path, IndexedModelData& meshData, MeshBinHeader& outHeader, std::string* materialLibrary) {
+	std::string buffer;
+	if (!ReadFileToString(path, buffer) || buffer.size() < sizeof(MeshBinHeader)) {
+		return false;
+	}
+
+	MeshBinHeader header;
+	std::memcpy(&header, buffer.data(), sizeof(header));
+	if (std::memcmp(header.magic, kMeshBinMagic, sizeof(header.magic)) != 0 ||
+		header.version != kMeshBinVersion ||
+		header.vertexStride != sizeof(VertexData)) {
+		return false;
+	}
+
+	size_t vertexBytes = sizeof(VertexData) * header.vertexCount;
+	size_t indexBytes = sizeof(uint32_t) * header.indexCount;
+	size_t offset = sizeof(MeshBinHeader);
+	if (buffer.size() < offset + vertexBytes + indexBytes) {
+		return false;
+	}
+	meshData.vertices.resize(header.vertexCount);
+	std::memcpy(meshData.vertices.data(), buffer.data() + offset, vertexBytes);
+	offset += vertexBytes;
+	meshData.indices.resize(header.indexCount);
+	std::memcpy(meshData.indices.data(), buffer.data() + offset, indexBytes);
+	offset += indexBytes;
+
+	meshData.material = MaterialData();
+	for (uint32_t i = 0; i < header.materialPathCount; ++i) {
+		// 今はテクスチャ1枚だけ
+		if (!ReadLengthPrefixedString(buffer, offset, i == 0 ? &meshData.material.textureFilePath : nullptr)) {
+			return false;
+		}
+	}
+	if (!ReadLengthPrefixedString(buffer, offset, materialLibrary)) {
+		return false;
+	}
+
+	outHeader = header;
+	return true;
+}
+
+std::string GetMeshBinPath(const std::string& directoryPath, const std::string& filename) {
+	return directoryPath + "/" + filename + ".meshbin";
+}
+
+void BakeMesh(const ModelData& modelData, const MeshBakeOptions& options, IndexedModelData& meshData,
+	WeldStats* weldStats, VertexCacheStats* before, VertexCacheStats* after) {
+	WeldVertices(modelData, meshData, weldStats);
+	if (!options.optimizeVertexCache) {
+		return;
+	}
+
+	if (before) {
+		*before = AnalyzeVertexCache(meshData.indices, meshData.vertices.size());
+	}
+	OptimizeVertexCache(meshData.indices, meshData.vertices.size());
+	OptimizeVertexFetch(meshData);
+	if (after) {
+		*after = AnalyzeVertexCache(meshData.indices, meshData.vertices.size());
+	}
+}
+
+MeshLoadResult LoadMeshWithCache(const std::string& directoryPath, const std::string& filename, IndexedModelData& meshData,
+	const MeshBakeOptions& options) {
+	MeshLoadResult result;
+
+	std::string objPath = directoryPath + "/" + filename;
+	std::string cachePath = GetMeshBinPath(directoryPath, filename);
+	uint32_t flags = options.optimizeVertexCache ? kMeshBinFlagVertexCacheOptimized : 0;
+	MeshBinHeader header;
+	std::string cachedMaterialLibrary;
+	bool cached = ReadMeshBin(cachePath, meshData, header, &cachedMaterialLibrary) && header.flags == flags;
+
+	// 元ファイルの大きさと更新時刻が焼いたときのままなら、読まずにそのまま使う
+	MeshSource source;
+	if (!GetMeshSourceStamp(objPath, cachedMaterialLibrary.empty() ? std::string() : directoryPath + "/" + cachedMaterialLibrary, source.stamp)) {
+		return result;
+	}
+	if (cached && source.stamp == header.sourceStamp) {
+		FillCachedResult(header, result);
+		return result;
+	}
+
+	std::string objText;
+	if (!ReadFileToString(objPath, objText)) {
+		return result;
+	}
+	std::string mtlText;
+	source.materialLibrary = FindMaterialLibrary(objText);
+	std::string mtlPath = source.materialLibrary.empty() ? std::string() : directoryPath + "/" + source.materialLibrary;
+	if (!mtlPath.empty()) {
+		ReadFileToString(mtlPath, mtlText);
+	}
+	source.hash = HashMeshSource(objText, mtlText);
+	GetMeshSourceStamp(objPath, mtlPath, source.stamp);
+	result.sourceRead = true;
+
+	// 時刻だけ変わって中身が同じなら、キャッシュを使って時刻を書き直す (次からは元ファイルを読まない)
+	if (cached && header.sourceHash == source.hash) {
+		FillCachedResult(header, result);
+		WriteMeshBin(cachePath, meshData, source, header.sourceVertexCount, flags);
+		return result;
+	}
+
+	// OBJを解析して作り直す
+	meshData = IndexedModelData();
+	ModelData modelData;
+	std::string parsedMaterialFilename;
+	if (!ParseObj(objText, modelData, &parsedMaterialFilename)) {
+		return result;
+	}
+	if (!mtlText.empty()) {
+		modelData.material = ParseMaterialTemplate(mtlText, directoryPath);
+	}
+	BakeMesh(modelData, options, meshData, &result.weldStats, &result.cacheBefore, &result.cacheAfter);
+	result.loaded = true;
+	// 書き込めなくても (読み取り専用の場所など) 読み込み自体は成功
+	result.rebaked = WriteMeshBin(cachePath, meshData, source, modelData.vertices.size(), flags);
+	return result;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "DataTypes.h"
+#include "MeshProcessing.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// 焼き込み済みメッシュ (.meshbin) の読み書き (Windows / D3D12 に依存しない)
+//
+// ファイル構成 (リトルエンディアン)
+//   MeshBinHeader
+//   VertexData  [vertexCount]
+//   uint32_t    [indexCount]
+//   マテリアルのパス表 [materialPathCount] (uint32_t 長さ + 文字列)
+//   元のMTLのファイル名 (uint32_t 長さ + 文字列、無ければ長さ 0)
+//
+// 元のOBJとMTLの大きさ・更新時刻と、内容のハッシュを持っている。
+// 大きさと更新時刻が同じなら元ファイルは読まない。違えば内容のハッシュを比べ、一致しなければ作り直す
+
+// 元ファイルの大きさと更新時刻 (ファイルが無ければ 0)
+struct MeshSourceStamp {
+	uint64_t objSize;
+	int64_t objWriteTime;
+	uint64_t mtlSize;
+	int64_t mtlWriteTime;
+
+	bool operator==(const MeshSourceStamp&) const = default;
+};
+
+struct MeshBinHeader {
+	char magic[4];               // "MSHB"
+	uint32_t version;
+	uint64_t sourceHash;         // OBJ + MTL の内容のハッシュ
+	MeshSourceStamp sourceStamp; // 焼いたときの元ファイルの大きさと更新時刻
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t vertexStride;       // sizeof(VertexData)
+	uint32_t materialPathCount;
+	uint32_t sourceVertexCount;  // 結合前の頂点数 (統計用)
+	uint32_t flags;              // kMeshBinFlag...
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+// 形式を変えたら上げる
+static const uint32_t kMeshBinVersion = 3;
+// 頂点キャッシュ・頂点フェッチの最適化済み
+static const uint32_t kMeshBinFlagVertexCacheOptimized = 1u << 0;
+
+// OBJとMTLの内容からキャッシュのキーを作る
+uint64_t HashMeshSource(std::string_view objText, std::string_view mtlText);
+
+// OBJのテキストから mtllib のファイル名だけを探す (解析はしない)
+std::string FindMaterialLibrary(std::string_view objText);
+
+// 元ファイルの大きさと更新時刻を調べる (OBJが無ければ false。mtlPath は空でもよい)
+bool GetMeshSourceStamp(const std::string& objPath, const std::string& mtlPath, MeshSourceStamp& stamp);
+
+// キャッシュと照らし合わせる元ファイルの情報
+struct MeshSource {
+	uint64_t hash = 0;
+	MeshSourceStamp stamp = {};
+	std::string materialLibrary; // OBJ の mtllib (無ければ空)
+};
+
+// 書き出し・読み込み (読み込みは壊れている・形式が違う場合に false。元ファイルとの照合は呼び出し側で行う)
+bool WriteMeshBin(const std::string& path, const IndexedModelData& meshData, const MeshSource& source, size_t sourceVertexCount, uint32_t flags = 0);
+bool ReadMeshBin(const std::string& path, IndexedModelData& meshData, MeshBinHeader& header, std::string* materialLibrary = nullptr);
+
+// 焼き込み時の加工
+struct MeshBakeOptions {
+	bool optimizeVertexCache = true;
+};
+
+// 焼き込み (OBJを解析した結果から .meshbin の中身を作る)
+// 最適化した場合は前後の頂点キャッシュ効率を返す
+void BakeMesh(const ModelData& modelData, const MeshBakeOptions& options, IndexedModelData& meshData,
+	WeldStats* weldStats = nullptr, VertexCacheStats* before = nullptr, VertexCacheStats* after = nullptr);
+
+// キャッシュを通して読み込む
+// 元ファイルの大きさと更新時刻が焼いたときのままなら、元ファイルを読まずにキャッシュを使う
+// キャッシュが古い・無い・加工の設定が違うときはOBJを解析して焼き直す
+struct MeshLoadResult {
+	bool loaded = false;
+	bool fromCache = false;
+	bool rebaked = false;
+	bool sourceRead = false; // 元ファイルを読んでハッシュを比べた (更新時刻だけ変わったときはキャッシュを使い、時刻を書き直す)
+	WeldStats weldStats;
+	// 焼き直したときだけ入る
+	VertexCacheStats cacheBefore;
+	VertexCacheStats cacheAfter;
+};
+MeshLoadResult LoadMeshWithCache(const std::string& directoryPath, const std::string& filename, IndexedModelData& meshData,
+	const MeshBakeOptions& options = MeshBakeOptions());
+
+// キャッシュファイルのパス (OBJと同じ場所に .meshbin を付けて置く)
+std::string GetMeshBinPath(const std::string& directoryPath, const std::string& filename);
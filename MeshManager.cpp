@@ -0,0 +1,39 @@
+#include "MeshManager.h"
+
+MeshManager* MeshManager::GetInstance() {
+	static MeshManager instance;
+	return &instance;
+}
+
+std::shared_ptr<const Mesh> MeshManager::Load(
+	const std::string& directoryPath, const std::string& filename, ID3D12Device* device) {
+
+	std::string key = directoryPath + "/" + filename;
+	auto it = meshes_.find(key);
+	if (it != meshes_.end()) {
+		++hitCount_;
+		return it->second;
+	}
+
+	// 初回のみOBJを解析してGPUへ転送する
+	++missCount_;
+	std::shared_ptr<Mesh> mesh = Mesh::Create(directoryPath, filename, device, vertexFormat_);
+	weldStats_.Accumulate(mesh->GetWeldStats());
+	meshes_.emplace(std::move(key), mesh);
+	return mesh;
+}
+
+void MeshManager::ReleaseUnused() {
+	for (auto it = meshes_.begin(); it != meshes_.end();) {
+		// マネージャ自身しか持っていなければ解放
+		if (it->second.use_count() == 1) {
+			it = meshes_.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void MeshManager::Finalize() {
+	meshes_.clear();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Mesh.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// メッシュ管理クラス (同じOBJはパスをキーに一度だけ読み込んで共有する)
+class MeshManager {
+public:
+	// シングルトンインスタンスの取得
+	static MeshManager* GetInstance();
+
+	// 読み込み (読み込み済みならキャッシュを返す)
+	std::shared_ptr<const Mesh> Load(
+		const std::string& directoryPath, const std::string& filename, ID3D12Device* device);
+
+	// これから読み込むメッシュの頂点形式 (描画に使うPSOと合わせる・読み込み済みのものは変わらない)
+	void SetVertexFormat(VertexFormat vertexFormat) { vertexFormat_ = vertexFormat; }
+	VertexFormat GetVertexFormat() const { return vertexFormat_; }
+
+	// どのModelからも参照されていないメッシュを解放する
+	void ReleaseUnused();
+
+	// 終了処理 (全メッシュを解放する)
+	void Finalize();
+
+	// 統計情報
+	uint32_t GetHitCount() const { return hitCount_; }
+	uint32_t GetMissCount() const { return missCount_; }
+	size_t GetMeshCount() const { return meshes_.size(); }
+	// これまでに読み込んだメッシュの頂点結合の合計
+	const WeldStats& GetWeldStats() const { return weldStats_; }
+
+private:
+	MeshManager() = default;
+	~MeshManager() = default;
+	MeshManager(const MeshManager&) = delete;
+	const MeshManager& operator=(const MeshManager&) = delete;
+
+private:
+	std::unordered_map<std::string, std::shared_ptr<Mesh>> meshes_;
+	uint32_t hitCount_ = 0;
+	uint32_t missCount_ = 0;
+	VertexFormat vertexFormat_ = kVertexFormatFull;
+	WeldStats weldStats_;
+};
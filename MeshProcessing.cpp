@@ -0,0 +1,259 @@
+#include "MeshProcessing.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+// VertexData をビット列として比較・ハッシュする (-0.0 と 0.0 は別扱い)
+struct VertexKey {
+	const VertexData* vertex;
+
+	bool operator==(const VertexKey& other) const {
+		return std::memcmp(vertex, other.vertex, sizeof(VertexData)) == 0;
+	}
+};
+
+struct VertexKeyHash {
+	size_t operator()(const VertexKey& key) const {
+		// FNV-1a (32bit単位)
+		uint32_t words[sizeof(VertexData) / sizeof(uint32_t)];
+		std::memcpy(words, key.vertex, sizeof(VertexData));
+		uint64_t hash = 14695981039346656037ull;
+		for (uint32_t word : words) {
+			hash ^= word;
+			hash *= 1099511628211ull;
+		}
+		return static_cast<size_t>(hash ^ (hash >> 32));
+	}
+};
+
+} // namespace
+
+void WeldStats::Accumulate(const WeldStats& other) {
+	sourceVertexCount += other.sourceVertexCount;
+	weldedVertexCount += other.weldedVertexCount;
+	indexCount += other.indexCount;
+	sourceBytes += other.sourceBytes;
+	weldedBytes += other.weldedBytes;
+}
+
+void WeldVertices(const ModelData& source, IndexedModelData& result, WeldStats* stats) {
+	static_assert(sizeof(VertexData) % sizeof(uint32_t) == 0, "VertexData must be made of 32bit words");
+
+	result.vertices.clear();
+	result.indices.clear();
+	result.material = source.material;
+	result.vertices.reserve(source.vertices.size());
+	result.indices.reserve(source.vertices.size());
+
+	// キーは入力側の頂点を指す (結合後の配列は伸びるとアドレスが変わるため)
+	std::unordered_map<VertexKey, uint32_t, VertexKeyHash> indexOfVertex;
+	indexOfVertex.reserve(source.vertices.size());
+	for (const VertexData& vertex : source.vertices) {
+		auto [it, inserted] = indexOfVertex.try_emplace(VertexKey{ &vertex }, static_cast<uint32_t>(result.vertices.size()));
+		if (inserted) {
+			result.vertices.push_back(vertex);
+		}
+		result.indices.push_back(it->second);
+	}
+	result.vertices.shrink_to_fit();
+
+	if (stats) {
+		stats->sourceVertexCount = source.vertices.size();
+		stats->weldedVertexCount = result.vertices.size();
+		stats->indexCount = result.indices.size();
+		stats->indexSize = CanUse16BitIndices(result.vertices.size()) ? 2 : 4;
+		stats->sourceBytes = sizeof(VertexData) * source.vertices.size();
+		stats->weldedBytes = sizeof(VertexData) * result.vertices.size() + stats->indexSize * result.indices.size();
+	}
+}
+
+VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+	VertexCacheStats stats;
+	if (indices.empty() || vertexCount == 0 || cacheSize == 0) {
+		return stats;
+	}
+
+	// 各頂点がキャッシュに入った時刻で FIFO を表す (時刻の差がキャッシュサイズ未満なら残っている)
+	std::vector<uint32_t> insertedAt(vertexCount, 0);
+	uint32_t time = cacheSize + 1;
+	size_t transformCount = 0;
+	for (uint32_t index : indices) {
+		if (time - insertedAt[index] > cacheSize) {
+			insertedAt[index] = time++;
+			++transformCount;
+		}
+	}
+
+	stats.acmr = static_cast<float>(transformCount) / static_cast<float>(indices.size() / 3);
+	stats.atvr = static_cast<float>(transformCount) / static_cast<float>(vertexCount);
+	return stats;
+}
+
+namespace {
+
+// Forsyth のスコア関数の定数 (元論文の値)
+const int32_t kForsythCacheSize = 32;
+const float kCacheDecayPower = 1.5f;
+const float kLastTriangleScore = 0.75f;
+const float kValenceBoostScale = 2.0f;
+const float kValenceBoostPower = 0.5f;
+
+float ScoreVertex(int32_t cachePosition, uint32_t remainingTriangles) {
+	if (remainingTriangles == 0) {
+		return -1.0f; // もう使われない
+	}
+
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			// 直前の三角形の頂点は、同じ辺の三角形ばかり続かないよう固定値にする
+			score = kLastTriangleScore;
+		} else {
+			float scaler = 1.0f / static_cast<float>(kForsythCacheSize - 3);
+			score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, kCacheDecayPower);
+		}
+	}
+	// 残りの三角形が少ない頂点を優先して片付ける
+	score += kValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -kValenceBoostPower);
+	return score;
+}
+
+} // namespace
+
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0 || vertexCount == 0) {
+		return;
+	}
+
+	// 頂点 → 三角形の隣接リスト
+	std::vector<uint32_t> remaining(vertexCount, 0);
+	for (uint32_t index : indices) {
+		++remaining[index];
+	}
+	std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+		adjacencyOffset[vertex + 1] = adjacencyOffset[vertex] + remaining[vertex];
+	}
+	std::vector<uint32_t> adjacency(indices.size());
+	{
+		std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+			for (size_t corner = 0; corner < 3; ++corner) {
+				uint32_t vertex = indices[triangle * 3 + corner];
+				adjacency[fill[vertex]++] = static_cast<uint32_t>(triangle);
+			}
+		}
+	}
+
+	std::vector<int32_t> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+		vertexScore[vertex] = ScoreVertex(-1, remaining[vertex]);
+	}
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+		triangleScore[triangle] = vertexScore[indices[triangle * 3]] + vertexScore[indices[triangle * 3 + 1]] + vertexScore[indices[triangle * 3 + 2]];
+	}
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	// 追加した三角形の3頂点を先頭に入れるので、一時的に +3 まで伸びる
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> nextCache;
+	cache.reserve(kForsythCacheSize + 3);
+	nextCache.reserve(kForsythCacheSize + 3);
+
+	// 最初の三角形は全体から選ぶ
+	size_t bestTriangle = 0;
+	for (size_t triangle = 1; triangle < triangleCount; ++triangle) {
+		if (triangleScore[triangle] > triangleScore[bestTriangle]) {
+			bestTriangle = triangle;
+		}
+	}
+	size_t scanCursor = 0;
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+		const uint32_t* corners = &indices[bestTriangle * 3];
+		result.insert(result.end(), corners, corners + 3);
+		emitted[bestTriangle] = 1;
+
+		// 各頂点の隣接リストからこの三角形を外す
+		for (size_t corner = 0; corner < 3; ++corner) {
+			uint32_t vertex = corners[corner];
+			uint32_t* begin = &adjacency[adjacencyOffset[vertex]];
+			uint32_t* end = begin + remaining[vertex];
+			uint32_t* found = std::find(begin, end, static_cast<uint32_t>(bestTriangle));
+			*found = *(end - 1);
+			--remaining[vertex];
+		}
+
+		// LRU キャッシュを更新 (この三角形の頂点を先頭へ)
+		nextCache.assign(corners, corners + 3);
+		for (uint32_t vertex : cache) {
+			if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+				nextCache.push_back(vertex);
+			}
+		}
+		cache.swap(nextCache);
+
+		// キャッシュ内の頂点と押し出された頂点のスコアを付け直す
+		for (size_t position = 0; position < cache.size(); ++position) {
+			uint32_t vertex = cache[position];
+			int32_t newPosition = (position < static_cast<size_t>(kForsythCacheSize)) ? static_cast<int32_t>(position) : -1;
+			cachePosition[vertex] = newPosition;
+			float newScore = ScoreVertex(newPosition, remaining[vertex]);
+			float delta = newScore - vertexScore[vertex];
+			vertexScore[vertex] = newScore;
+			for (uint32_t i = 0; i < remaining[vertex]; ++i) {
+				triangleScore[adjacency[adjacencyOffset[vertex] + i]] += delta;
+			}
+		}
+		if (cache.size() > static_cast<size_t>(kForsythCacheSize)) {
+			cache.resize(kForsythCacheSize);
+		}
+
+		// 次の三角形はキャッシュ内の頂点に接するものから選ぶ
+		float bestScore = -1.0f;
+		bool found = false;
+		for (uint32_t vertex : cache) {
+			for (uint32_t i = 0; i < remaining[vertex]; ++i) {
+				uint32_t triangle = adjacency[adjacencyOffset[vertex] + i];
+				if (triangleScore[triangle] > bestScore) {
+					bestScore = triangleScore[triangle];
+					bestTriangle = triangle;
+					found = true;
+				}
+			}
+		}
+		if (!found) {
+			// キャッシュが空振りしたら、まだ出していない三角形を先頭から探す
+			while (scanCursor < triangleCount && emitted[scanCursor]) {
+				++scanCursor;
+			}
+			bestTriangle = scanCursor;
+		}
+	}
+
+	indices.swap(result);
+}
+
+void OptimizeVertexFetch(IndexedModelData& meshData) {
+	const uint32_t kUnassigned = UINT32_MAX;
+	std::vector<uint32_t> remap(meshData.vertices.size(), kUnassigned);
+	std::vector<VertexData> vertices;
+	vertices.reserve(meshData.vertices.size());
+	for (uint32_t& index : meshData.indices) {
+		if (remap[index] == kUnassigned) {
+			remap[index] = static_cast<uint32_t>(vertices.size());
+			vertices.push_back(meshData.vertices[index]);
+		}
+		index = remap[index];
+	}
+	// どの三角形にも使われていない頂点はここで落ちる
+	meshData.vertices.swap(vertices);
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "DataTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// メッシュの加工 (Windows / D3D12 に依存しない)
+
+// 頂点の結合結果
+struct WeldStats {
+	size_t sourceVertexCount = 0; // 結合前 (面の角ごとの頂点)
+	size_t weldedVertexCount = 0; // 結合後
+	size_t indexCount = 0;
+	uint32_t indexSize = 0;       // 2 (16bit) か 4 (32bit)
+	size_t sourceBytes = 0;       // 結合前の頂点バッファ
+	size_t weldedBytes = 0;       // 結合後の頂点バッファ + インデックスバッファ
+
+	// 足し合わせ (複数メッシュの合計用)
+	void Accumulate(const WeldStats& other);
+};
+
+// 16bit インデックスで足りるか
+inline bool CanUse16BitIndices(size_t vertexCount) { return vertexCount <= 0xFFFF; }
+
+// 位置・UV・法線が完全に一致する頂点を1つにまとめ、インデックスを作る
+// 頂点は最初に現れた順に並ぶので、三角形の順序と巻き順は変わらない
+void WeldVertices(const ModelData& source, IndexedModelData& result, WeldStats* stats = nullptr);
+
+// 頂点キャッシュの効率
+struct VertexCacheStats {
+	float acmr = 0.0f; // 三角形あたりの頂点処理数 (0.5 に近いほど良い・最悪 3.0)
+	float atvr = 0.0f; // 頂点あたりの頂点処理数 (1.0 が理想)
+};
+
+// FIFO の頂点キャッシュを真似て ACMR / ATVR を求める
+VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+// 三角形の順序を頂点キャッシュに合わせて並べ替える (Forsyth の線形時間アルゴリズム)
+// 巻き順は変えない
+void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+// 頂点をインデックスで最初に使われる順に並べ替え、インデックスを付け直す (頂点フェッチの局所性)
+void OptimizeVertexFetch(IndexedModelData& meshData);
@@ -2,14 +2,18 @@
 #include "D3D12Util.h"
 #include "DataTypes.h"
 #include "MathUtil.h"
+#include "Mesh.h"
+#include "UploadBufferAllocator.h"
+#include <memory>
 #include <string>
-#include <vector>
 
 class Model {
 public:
     static Model* Create(
         const std::string& directoryPath, const std::string& filename, ID3D12Device* device);
 
+    ~Model();
+
     void Update();
 
     void Draw(
@@ -18,6 +22,8 @@ public:
         D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress,
         D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandle);
 
+    const Mesh* GetMesh() const { return mesh_.get(); }
+
 public:
     Transform transform;
     Material* materialData = nullptr;
@@ -27,10 +33,9 @@ private:
         const std::string& directoryPath, const std::string& filename, ID3D12Device* device);
 
 private:
-    std::vector<VertexData> vertices_;
-    Microsoft::WRL::ComPtr<ID3D12Resource> vertexResource_;
-    D3D12_VERTEX_BUFFER_VIEW vertexBufferView_{};
-    Microsoft::WRL::ComPtr<ID3D12Resource> materialResource_;
-    Microsoft::WRL::ComPtr<ID3D12Resource> wvpResource_;
-    TransformationMatrix* wvpData_ = nullptr;
-};
\ No newline at end of file
+    // 形状データは MeshManager 経由で共有する
+    std::shared_ptr<const Mesh> mesh_;
+    // 以下はインスタンスごとの状態
+    UploadBuffer materialBuffer_;
+    // WVPは描画ごとに ConstantBufferAllocator から確保する
+};
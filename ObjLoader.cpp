@@ -0,0 +1,279 @@
+#include "ObjLoader.h"
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+// 行単位で読み進める
+class LineReader {
+public:
+	explicit LineReader(std::string_view text) : cursor_(text.data()), end_(text.data() + text.size()) {}
+
+	bool Next(const char*& lineBegin, const char*& lineEnd) {
+		if (cursor_ >= end_) {
+			return false;
+		}
+		lineBegin = cursor_;
+		const char* newline = static_cast<const char*>(std::memchr(cursor_, '\n', end_ - cursor_));
+		lineEnd = newline ? newline : end_;
+		cursor_ = newline ? newline + 1 : end_;
+		// CRLF の \r を落とす
+		if (lineEnd > lineBegin && lineEnd[-1] == '\r') {
+			--lineEnd;
+		}
+		return true;
+	}
+
+private:
+	const char* cursor_;
+	const char* end_;
+};
+
+inline bool IsSpace(char c) { return c == ' ' || c == '\t'; }
+
+inline const char* SkipSpace(const char* p, const char* end) {
+	while (p < end && IsSpace(*p)) {
+		++p;
+	}
+	return p;
+}
+
+// 行頭のキーワードを読む (空白で区切られた最初の語)
+inline std::string_view ReadKeyword(const char*& p, const char* end) {
+	p = SkipSpace(p, end);
+	const char* begin = p;
+	while (p < end && !IsSpace(*p)) {
+		++p;
+	}
+	return std::string_view(begin, p - begin);
+}
+
+inline bool ReadFloat(const char*& p, const char* end, float& value) {
+	p = SkipSpace(p, end);
+	if (p < end && *p == '+') {
+		++p; // from_chars は先頭の + を受け付けない
+	}
+	std::from_chars_result result = std::from_chars(p, end, value);
+	if (result.ec != std::errc()) {
+		return false;
+	}
+	p = result.ptr;
+	return true;
+}
+
+// 行末の空白を除いた残り (ファイル名など)
+inline std::string_view ReadRest(const char* p, const char* end) {
+	p = SkipSpace(p, end);
+	while (end > p && IsSpace(end[-1])) {
+		--end;
+	}
+	return std::string_view(p, end - p);
+}
+
+// OBJのインデックス (1始まり・負数は末尾から) を0始まりに直す
+inline bool ResolveIndex(int32_t index, size_t count, size_t& resolved) {
+	if (index > 0 && static_cast<size_t>(index) <= count) {
+		resolved = static_cast<size_t>(index - 1);
+		return true;
+	}
+	if (index < 0 && static_cast<size_t>(-static_cast<int64_t>(index)) <= count) {
+		resolved = count - static_cast<size_t>(-static_cast<int64_t>(index));
+		return true;
+	}
+	return false;
+}
+
+} // namespace
+
+bool ReadFileToString(const std::string& path, std::string& text) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+	std::streamsize size = file.tellg();
+	file.seekg(0, std::ios::beg);
+	text.resize(static_cast<size_t>(size));
+	return size == 0 || static_cast<bool>(file.read(text.data(), size));
+}
+
+bool ParseObj(std::string_view text, ModelData& modelData, std::string* materialFilename, ObjParseStats* stats) {
+	// 1パス目: 要素数を数えて配列を確保しておく
+	size_t positionCount = 0;
+	size_t texcoordCount = 0;
+	size_t normalCount = 0;
+	size_t faceCount = 0;
+	{
+		LineReader reader(text);
+		const char* lineBegin = nullptr;
+		const char* lineEnd = nullptr;
+		while (reader.Next(lineBegin, lineEnd)) {
+			const char* p = SkipSpace(lineBegin, lineEnd);
+			if (lineEnd - p < 2) {
+				continue;
+			}
+			if (p[0] == 'v') {
+				if (IsSpace(p[1])) {
+					++positionCount;
+				} else if (p[1] == 't') {
+					++texcoordCount;
+				} else if (p[1] == 'n') {
+					++normalCount;
+				}
+			} else if (p[0] == 'f' && IsSpace(p[1])) {
+				++faceCount;
+			}
+		}
+	}
+
+	std::vector<Vector4> positions;
+	std::vector<Vector2> texcoords;
+	std::vector<Vector3> normals;
+	positions.reserve(positionCount);
+	texcoords.reserve(texcoordCount);
+	normals.reserve(normalCount);
+	// 三角形なら1面3頂点 (多角形が混ざれば追加で伸びる)
+	modelData.vertices.reserve(modelData.vertices.size() + faceCount * 3);
+
+	size_t triangleCount = 0;
+	LineReader reader(text);
+	const char* lineBegin = nullptr;
+	const char* lineEnd = nullptr;
+	while (reader.Next(lineBegin, lineEnd)) {
+		const char* p = lineBegin;
+		std::string_view keyword = ReadKeyword(p, lineEnd);
+
+		if (keyword == "v") {
+			Vector4 position{ 0.0f, 0.0f, 0.0f, 1.0f };
+			if (!ReadFloat(p, lineEnd, position.x) || !ReadFloat(p, lineEnd, position.y) || !ReadFloat(p, lineEnd, position.z)) {
+				return false;
+			}
+			position.x *= -1.0f;
+			positions.push_back(position);
+		} else if (keyword == "vt") {
+			Vector2 texcoord{};
+			if (!ReadFloat(p, lineEnd, texcoord.x) || !ReadFloat(p, lineEnd, texcoord.y)) {
+				return false;
+			}
+			texcoord.y = 1.0f - texcoord.y;
+			texcoords.push_back(texcoord);
+		} else if (keyword == "vn") {
+			Vector3 normal{};
+			if (!ReadFloat(p, lineEnd, normal.x) || !ReadFloat(p, lineEnd, normal.y) || !ReadFloat(p, lineEnd, normal.z)) {
+				return false;
+			}
+			normal.x *= -1.0f;
+			normals.push_back(normal);
+		} else if (keyword == "f") {
+			// 扇状に分割するので、最初の頂点と直前の頂点だけ覚えておけばよい
+			VertexData first{};
+			VertexData previous{};
+			uint32_t cornerCount = 0;
+			for (;;) {
+				p = SkipSpace(p, lineEnd);
+				if (p >= lineEnd) {
+					break;
+				}
+
+				// v, v/vt, v//vn, v/vt/vn
+				int32_t indices[3] = { 0, 0, 0 };
+				for (int32_t element = 0; element < 3; ++element) {
+					if (element > 0) {
+						if (p >= lineEnd || *p != '/') {
+							break;
+						}
+						++p;
+					}
+					if (p < lineEnd && (*p == '/' || IsSpace(*p))) {
+						continue; // 省略された要素
+					}
+					std::from_chars_result result = std::from_chars(p, lineEnd, indices[element]);
+					if (result.ec != std::errc()) {
+						return false;
+					}
+					p = result.ptr;
+				}
+
+				VertexData vertex{ { 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+				size_t resolved = 0;
+				if (!ResolveIndex(indices[0], positions.size(), resolved)) {
+					return false;
+				}
+				vertex.position = positions[resolved];
+				if (indices[1] != 0) {
+					if (!ResolveIndex(indices[1], texcoords.size(), resolved)) {
+						return false;
+					}
+					vertex.texcoord = texcoords[resolved];
+				}
+				if (indices[2] != 0) {
+					if (!ResolveIndex(indices[2], normals.size(), resolved)) {
+						return false;
+					}
+					vertex.normal = normals[resolved];
+				}
+
+				if (cornerCount == 0) {
+					first = vertex;
+				} else if (cornerCount >= 2) {
+					// 左手系に合わせて巻き順を反転して追加する
+					modelData.vertices.push_back(vertex);
+					modelData.vertices.push_back(previous);
+					modelData.vertices.push_back(first);
+					++triangleCount;
+				}
+				previous = vertex;
+				++cornerCount;
+			}
+		} else if (keyword == "mtllib") {
+			if (materialFilename) {
+				*materialFilename = std::string(ReadRest(p, lineEnd));
+			}
+		}
+	}
+
+	if (stats) {
+		stats->positionCount = positions.size();
+		stats->texcoordCount = texcoords.size();
+		stats->normalCount = normals.size();
+		stats->faceCount = faceCount;
+		stats->triangleCount = triangleCount;
+	}
+	return true;
+}
+
+MaterialData ParseMaterialTemplate(std::string_view text, const std::string& directoryPath) {
+	MaterialData materialData;
+	LineReader reader(text);
+	const char* lineBegin = nullptr;
+	const char* lineEnd = nullptr;
+	while (reader.Next(lineBegin, lineEnd)) {
+		const char* p = lineBegin;
+		if (ReadKeyword(p, lineEnd) == "map_Kd") {
+			materialData.textureFilePath = directoryPath + "/" + std::string(ReadRest(p, lineEnd));
+		}
+	}
+	return materialData;
+}
+
+bool LoadObjFile(const std::string& directoryPath, const std::string& filename, ModelData& modelData) {
+	std::string text;
+	if (!ReadFileToString(directoryPath + "/" + filename, text)) {
+		return false;
+	}
+
+	std::string materialFilename;
+	if (!ParseObj(text, modelData, &materialFilename)) {
+		return false;
+	}
+
+	if (!materialFilename.empty()) {
+		std::string materialText;
+		if (ReadFileToString(directoryPath + "/" + materialFilename, materialText)) {
+			modelData.material = ParseMaterialTemplate(materialText, directoryPath);
+		}
+	}
+	return true;
+}
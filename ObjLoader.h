@@ -0,0 +1,31 @@
+#pragma once
+#include "DataTypes.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// OBJ / MTL の読み込み (Windows / D3D12 に依存しない)
+// 行ごとの stringstream を作らず、読み込んだバッファを from_chars で直接解析する
+
+// 解析結果の統計
+struct ObjParseStats {
+	size_t positionCount = 0;
+	size_t texcoordCount = 0;
+	size_t normalCount = 0;
+	size_t faceCount = 0;
+	size_t triangleCount = 0;
+};
+
+// ファイルを丸ごと読み込む (開けなければ false)
+bool ReadFileToString(const std::string& path, std::string& text);
+
+// OBJのテキストを三角形リストに展開する
+// 四角形以上の面は扇状に分割し、負のインデックスは末尾からの相対指定として扱う
+// mtllib があれば materialFilename にファイル名を入れる
+bool ParseObj(std::string_view text, ModelData& modelData, std::string* materialFilename = nullptr, ObjParseStats* stats = nullptr);
+
+// MTLのテキストからテクスチャのファイル名 (map_Kd) を取り出す
+MaterialData ParseMaterialTemplate(std::string_view text, const std::string& directoryPath);
+
+// ファイルから読み込む (開けなかった・壊れていた場合は false)
+bool LoadObjFile(const std::string& directoryPath, const std::string& filename, ModelData& modelData);
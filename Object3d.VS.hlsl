@@ -13,17 +13,32 @@ ConstantBuffer<TransformationMatrix> gTransformationMatrix : register(b0);
 
 struct VertexSgaderInput
 {
+#ifdef COMPACT_VERTEX
+    // 圧縮頂点: 位置は w を省略、UV は half、法線は八面体写像 (R16G16_SNORM)
+    float32_t3 position : POSITION0;
+    float32_t2 texcoord : TEXCOORD0;
+    float32_t2 normal : NORMAL0;
+#else
     float32_t4 position : POSITION0;
     float32_t2 texcoord : TEXCOORD0;
     float32_t3 normal : NORMAL0;
+#endif
 };
 
 
 VertexShaderOutput main(VertexSgaderInput input)
 {
+#ifdef COMPACT_VERTEX
+    float32_t4 position = float32_t4(input.position, 1.0f);
+    float32_t3 normal = DecodeOctahedralNormal(input.normal);
+#else
+    float32_t4 position = input.position;
+    float32_t3 normal = input.normal;
+#endif
+
     VertexShaderOutput output;
-    output.position = mul(input.position, gTransformationMatrix.WVP);
+    output.position = mul(position, gTransformationMatrix.WVP);
     output.texcoord = input.texcoord;
-    output.normal = normalize(mul(input.normal, (float32_t3x3) gTransformationMatrix.World));
+    output.normal = normalize(mul(normal, (float32_t3x3) gTransformationMatrix.World));
     return output;
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "ObjectGrid.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+void ObjectGrid::Reset(float cellSize, int32_t columns, int32_t rows) {
+	assert(cellSize > 0.0f);
+	cellSize_ = cellSize;
+	inverseCellSize_ = 1.0f / cellSize;
+	columns_ = std::max(columns, 1);
+	rows_ = std::max(rows, 1);
+	count_ = 0;
+	objects_.clear();
+	cells_.clear();
+	cells_.resize(static_cast<size_t>(columns_) * rows_);
+	for (std::vector<int32_t>& ids : byType_) {
+		ids.clear();
+	}
+}
+
+int32_t ObjectGrid::GetCellIndex(const Vector2& position) const {
+	// 外や NaN は端のセルへ (float のまま丸めてから整数にする)
+	float fx = std::floor(position.x * inverseCellSize_);
+	float fy = std::floor(position.y * inverseCellSize_);
+	int32_t x = fx > 0.0f ? static_cast<int32_t>(std::min(fx, static_cast<float>(columns_ - 1))) : 0;
+	int32_t y = fy > 0.0f ? static_cast<int32_t>(std::min(fy, static_cast<float>(rows_ - 1))) : 0;
+	return y * columns_ + x;
+}
+
+void ObjectGrid::AddToCell(int32_t id, int32_t cell) {
+	std::vector<Entry>& entries = cells_[cell];
+	Object& object = objects_[id];
+	object.cell = cell;
+	object.slot = static_cast<int32_t>(entries.size());
+	entries.push_back({ object.position, id, object.type });
+}
+
+void ObjectGrid::RemoveFromCell(int32_t id) {
+	const Object& object = objects_[id];
+	std::vector<Entry>& entries = cells_[object.cell];
+	entries[object.slot] = entries.back();
+	objects_[entries[object.slot].id].slot = object.slot;
+	entries.pop_back();
+}
+
+int32_t ObjectGrid::Add(int32_t type, const Vector2& position) {
+	assert(type >= 0 && type < kMaxTypes && "ObjectGrid: type out of range");
+	assert(!cells_.empty() && "ObjectGrid: Reset has not been called");
+	int32_t id = static_cast<int32_t>(objects_.size());
+	Object object;
+	object.position = position;
+	object.type = type;
+	objects_.push_back(object);
+	AddToCell(id, GetCellIndex(position));
+	byType_[type].push_back(id);
+	++count_;
+	return id;
+}
+
+void ObjectGrid::Move(int32_t id, const Vector2& position) {
+	assert(IsAlive(id));
+	Object& object = objects_[id];
+	object.position = position;
+	int32_t cell = GetCellIndex(position);
+	if (cell != object.cell) {
+		RemoveFromCell(id);
+		AddToCell(id, cell);
+	} else {
+		cells_[cell][object.slot].position = position;
+	}
+}
+
+void ObjectGrid::Remove(int32_t id) {
+	if (!IsAlive(id)) {
+		return;
+	}
+	RemoveFromCell(id);
+	std::vector<int32_t>& ids = byType_[objects_[id].type];
+	ids.erase(std::find(ids.begin(), ids.end(), id));
+	objects_[id].type = -1;
+	--count_;
+}
+
+void ObjectGrid::GetCellRange(const WorldRect& rect, int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const {
+	int32_t low = GetCellIndex({ rect.left, rect.bottom });
+	int32_t high = GetCellIndex({ rect.right, rect.top });
+	x0 = low % columns_;
+	y0 = low / columns_;
+	x1 = high % columns_;
+	y1 = high / columns_;
+}
+
+size_t ObjectGrid::FindInRadius(const Vector2& center, float radius, uint32_t typeMask, std::vector<int32_t>& outIds) const {
+	if (cells_.empty() || !(radius >= 0.0f)) {
+		return 0;
+	}
+	int32_t x0, y0, x1, y1;
+	GetCellRange({ center.x - radius, center.y - radius, center.x + radius, center.y + radius }, x0, y0, x1, y1);
+	const float radiusSq = radius * radius;
+	size_t found = 0;
+	for (int32_t cellY = y0; cellY <= y1; ++cellY) {
+		for (int32_t cellX = x0; cellX <= x1; ++cellX) {
+			for (const Entry& entry : cells_[static_cast<size_t>(cellY) * columns_ + cellX]) {
+				float dx = entry.position.x - center.x;
+				float dy = entry.position.y - center.y;
+				if ((typeMask & GetTypeBit(entry.type)) != 0 && dx * dx + dy * dy <= radiusSq) {
+					outIds.push_back(entry.id);
+					++found;
+				}
+			}
+		}
+	}
+	return found;
+}
+
+size_t ObjectGrid::FindInRect(const WorldRect& rect, uint32_t typeMask, std::vector<int32_t>& outIds) const {
+	if (cells_.empty() || !(rect.left <= rect.right && rect.bottom <= rect.top)) {
+		return 0;
+	}
+	int32_t x0, y0, x1, y1;
+	GetCellRange(rect, x0, y0, x1, y1);
+	size_t found = 0;
+	for (int32_t cellY = y0; cellY <= y1; ++cellY) {
+		for (int32_t cellX = x0; cellX <= x1; ++cellX) {
+			for (const Entry& entry : cells_[static_cast<size_t>(cellY) * columns_ + cellX]) {
+				if ((typeMask & GetTypeBit(entry.type)) != 0 && entry.position.x >= rect.left && entry.position.x <= rect.right &&
+					entry.position.y >= rect.bottom && entry.position.y <= rect.top) {
+					outIds.push_back(entry.id);
+					++found;
+				}
+			}
+		}
+	}
+	return found;
+}
+
+int32_t ObjectGrid::FindFirst(int32_t type) const {
+	if (type < 0 || type >= kMaxTypes || byType_[type].empty()) {
+		return -1;
+	}
+	return byType_[type].front();
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "MathTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 動的ブロックや罠の位置の索引 (Windows / D3D12 に依存しない)
+//
+// ワールドを一辺 cellSize の正方形のセルに分け、セルごとに中にいるものの番号を持つ。
+// 範囲の問い合わせは範囲にかかるセルだけを見るので、マップ全体の数が増えても近くの数にしか比例しない。
+// 動かすときはセルが変わったときだけ付け替える。マップの外にいるものは一番端のセルに入れる
+// (問い合わせでは位置を確かめ直すので、答えは変わらない)。
+// 座標は MapChip のワールド座標 (x は右へ、y は最下段が 0 で上へ)。番号は追加した順で、消しても使い回さない。
+class ObjectGrid {
+public:
+	// 種類は 0..kMaxTypes-1 (問い合わせでは種類をビットの集まりで絞る)
+	static const int32_t kMaxTypes = 32;
+	static const uint32_t kAllTypes = ~0u;
+
+	static uint32_t GetTypeBit(int32_t type) { return uint32_t(1) << type; }
+
+	// 全部消して、[0, columns * cellSize) x [0, rows * cellSize) をセルに分ける
+	void Reset(float cellSize, int32_t columns, int32_t rows);
+
+	// 追加して番号を返す
+	int32_t Add(int32_t type, const Vector2& position);
+	// 位置を変える (セルが変わらなければ位置を書くだけ)
+	void Move(int32_t id, const Vector2& position);
+	void Remove(int32_t id);
+
+	bool IsAlive(int32_t id) const {
+		return static_cast<size_t>(id) < objects_.size() && objects_[id].type >= 0;
+	}
+	int32_t GetType(int32_t id) const { return objects_[id].type; }
+	const Vector2& GetPosition(int32_t id) const { return objects_[id].position; }
+	// 今いる数
+	size_t GetCount() const { return count_; }
+
+	// center から radius 以内 (境目を含む) にいる typeMask の種類のものを outIds に足し、足した数を返す
+	// 順番はセル順 (番号順ではない)
+	size_t FindInRadius(const Vector2& center, float radius, uint32_t typeMask, std::vector<int32_t>& outIds) const;
+	// rect の中 (境目を含む) にいるもの
+	size_t FindInRect(const WorldRect& rect, uint32_t typeMask, std::vector<int32_t>& outIds) const;
+	// その種類で一番先に追加され、まだいるもの (いなければ -1)
+	int32_t FindFirst(int32_t type) const;
+
+private:
+	struct Object {
+		Vector2 position;
+		int32_t type = -1; // 消したものは -1
+		int32_t cell = 0;
+		// セルの並びの中での位置 (消すときに末尾と入れ替える)
+		int32_t slot = 0;
+	};
+	// セルの中身 (問い合わせで objects_ を引かなくて済むように、位置と種類の写しも持つ)
+	struct Entry {
+		Vector2 position;
+		int32_t id;
+		int32_t type;
+	};
+
+	int32_t GetCellIndex(const Vector2& position) const;
+	void AddToCell(int32_t id, int32_t cell);
+	void RemoveFromCell(int32_t id);
+	// rect にかかるセルの範囲 (端のセルに丸める)
+	void GetCellRange(const WorldRect& rect, int32_t& x0, int32_t& y0, int32_t& x1, int32_t& y1) const;
+
+private:
+	float cellSize_ = 1.0f;
+	float inverseCellSize_ = 1.0f;
+	int32_t columns_ = 0;
+	int32_t rows_ = 0;
+	size_t count_ = 0;
+	std::vector<Object> objects_;
+	// cells_[cellY * columns_ + cellX] がセルの中身 (cellY は下から)
+	std::vector<std::vector<Entry>> cells_;
+	// 種類ごとの番号 (追加した順)
+	std::vector<int32_t> byType_[kMaxTypes];
+};
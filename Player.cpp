@@ -1,16 +1,14 @@
 #include "Player.h"
-#include "MathUtil.h"
+#include "StateHash.h"
 #include <cmath>
 #include <string>
-#include <Windows.h>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-void Player::Initialize(Model* model, MapChip* mapChip, ID3D12Device* device) {
-    model_ = model;
-    mapChip_ = mapChip;
+void Player::Initialize(GameMap* map) {
+    map_ = map;
     transform_.scale = { 0.4f, 0.4f, 0.4f };
     transform_.rotate = { 0.0f, 0.0f, 0.0f };
 
@@ -18,14 +16,9 @@ void Player::Initialize(Model* model, MapChip* mapChip, ID3D12Device* device) {
     SetPosition(initialPosition_);
     isAlive_ = true;
     jumpCount_ = 0; // ★追加: ジャンプ回数初期化
-
-    // 弾のモデル生成
-    bulletModel_ = Model::Create("Resources/cube", "cube.obj", device);
 }
 
-void Player::Update() {
-    Input* input = Input::GetInstance();
-
+void Player::Update(const InputFrame& input) {
     // --- パラメータ調整 ---
     const float kMoveSpeed = 0.1f;
     const float kGravity = 0.025f;
@@ -40,22 +33,23 @@ void Player::Update() {
     const float kRollDuration = 0.4f;     // ローリング時間(秒)
     const float kRollCooldownTime = 0.6f; // クールタイム(秒)
 
+    previousTranslate_ = transform_.translate;
+
     // ▼▼▼ 死亡時の演出処理 ▼▼▼
     if (!isAlive_) {
         velocity_.y -= kGravity;
         transform_.translate.y += velocity_.y;
         transform_.rotate.z += 0.1f;
         transform_.rotate.x += 0.05f;
-        model_->transform = transform_;
         return;
     }
 
     // --- タイマー更新 ---
-    if (rollCooldown_ > 0.0f) rollCooldown_ -= 1.0f / 60.0f;
-    if (wallJumpLockTimer_ > 0.0f) wallJumpLockTimer_ -= 1.0f / 60.0f;
+    if (rollCooldown_ > 0.0f) rollCooldown_ -= kTickSeconds;
+    if (wallJumpLockTimer_ > 0.0f) wallJumpLockTimer_ -= kTickSeconds;
 
     // ▼▼▼ ローリング開始処理 (Shiftキー) ▼▼▼
-    if (input->IsKeyPressed('L') && !isRolling_ && rollCooldown_ <= 0.0f) {
+    if (input.IsPressed(kButtonRoll) && !isRolling_ && rollCooldown_ <= 0.0f) {
         isRolling_ = true;
         rollTimer_ = kRollDuration;
         rollCooldown_ = kRollCooldownTime;
@@ -67,7 +61,7 @@ void Player::Update() {
 
     // ▼▼▼ ローリング中の更新 ▼▼▼
     if (isRolling_) {
-        rollTimer_ -= 1.0f / 60.0f;
+        rollTimer_ -= kTickSeconds;
 
         // ローリング中は速度固定
         velocity_.x = lrDirection_ * kRollSpeed;
@@ -92,11 +86,11 @@ void Player::Update() {
             velocity_.x = 0.0f;
             float moveX = 0.0f;
 
-            if (input->IsKeyDown('D')) {
+            if (input.IsDown(kButtonRight)) {
                 moveX = kMoveSpeed;
                 lrDirection_ = 1.0f;
             }
-            if (input->IsKeyDown('A')) {
+            if (input.IsDown(kButtonLeft)) {
                 moveX = -kMoveSpeed;
                 lrDirection_ = -1.0f;
             }
@@ -107,10 +101,10 @@ void Player::Update() {
         }
 
         // 射撃 (ローリング中は撃てない)
-        if (input->IsKeyPressed('J')) {
+        if (input.IsPressed(kButtonShoot)) {
             PlayerBullet* newBullet = new PlayerBullet();
             float bulletSpeed = 0.3f * lrDirection_;
-            newBullet->Initialize(bulletModel_, transform_.translate, bulletSpeed);
+            newBullet->Initialize(transform_.translate, bulletSpeed);
             bullets_.push_back(newBullet);
         }
 
@@ -126,7 +120,7 @@ void Player::Update() {
 
     // --- 弾の更新 ---
     bullets_.remove_if([this](PlayerBullet* bullet) {
-        if (bullet->Update(mapChip_)) {
+        if (bullet->Update(map_)) {
             delete bullet;
             return true;
         }
@@ -139,83 +133,44 @@ void Player::Update() {
     wallTouch_ = WallTouchSide::None;
 
     // ==========================================
-    // 物理挙動とコリジョン (Y軸)
+    // 物理挙動とコリジョン (Y軸 → X軸の順に、動く分だけ箱を掃引する)
     // ==========================================
     Vector3 position = transform_.translate;
-    position.y += velocity_.y;
-
-    float playerTop = position.y + kPlayerHalfSize;
-    float playerBottom = position.y - kPlayerHalfSize;
-    float playerLeft = transform_.translate.x - kPlayerHalfSize;
-    float playerRight = transform_.translate.x + kPlayerHalfSize;
-
-    // 床・天井判定
-    if (velocity_.y < 0) {
-        if (mapChip_->CheckCollision({ playerLeft, playerBottom, 0 }) || mapChip_->CheckCollision({ playerRight, playerBottom, 0 })) {
-            position.y = floor(playerBottom / MapChip::kBlockSize) * MapChip::kBlockSize + MapChip::kBlockSize + kPlayerHalfSize;
-            velocity_.y = 0;
-            onGround_ = true;
-            // 着地したら壁ジャンプロック解除
-            wallJumpLockTimer_ = 0.0f;
-        }
-    } else if (velocity_.y > 0) {
-        if (mapChip_->CheckCollision({ playerLeft, playerTop, 0 }) || mapChip_->CheckCollision({ playerRight, playerTop, 0 })) {
-            position.y = floor(playerTop / MapChip::kBlockSize) * MapChip::kBlockSize - kPlayerHalfSize;
+    auto makeBox = [&](const Vector3& center) {
+        return WorldRect{ center.x - kPlayerHalfSize, center.y - kPlayerHalfSize, center.x + kPlayerHalfSize, center.y + kPlayerHalfSize };
+    };
+
+    // 床・天井判定 (当たったら接するところで止まる)
+    if (velocity_.y != 0.0f) {
+        TileSweepResult sweep = map_->SweepAABB(makeBox(position), { 0.0f, velocity_.y });
+        position.y += velocity_.y * sweep.time;
+        if (sweep.hit) {
+            if (velocity_.y < 0) {
+                onGround_ = true;
+                // 着地したら壁ジャンプロック解除
+                wallJumpLockTimer_ = 0.0f;
+            }
             velocity_.y = 0;
         }
     }
 
-    // ==========================================
-    // 物理挙動とコリジョン
-    // ==========================================
-    position.x += velocity_.x;
-    playerLeft = position.x - kPlayerHalfSize;
-    playerRight = position.x + kPlayerHalfSize;
-    playerTop = position.y + kPlayerHalfSize;
-    playerBottom = position.y - kPlayerHalfSize;
-
-    
-    float checkY_Top = playerTop - 0.05f;
-    float checkY_Bottom = playerBottom + 0.05f;
-
-    if (velocity_.x < 0) { // 左移動
-        if (mapChip_->CheckCollision({ playerLeft, checkY_Top, 0 }) || mapChip_->CheckCollision({ playerLeft, checkY_Bottom, 0 })) {
-            position.x = floor(playerLeft / MapChip::kBlockSize) * MapChip::kBlockSize + MapChip::kBlockSize + kPlayerHalfSize + 0.001f;
-            if (!onGround_) wallTouch_ = WallTouchSide::Left;
+    // 壁判定 (ローリングや壁キックの速さでも薄い壁をすり抜けない)
+    if (velocity_.x != 0.0f) {
+        TileSweepResult sweep = map_->SweepAABB(makeBox(position), { velocity_.x, 0.0f });
+        position.x += velocity_.x * sweep.time;
+        if (sweep.hit) {
+            if (!onGround_) wallTouch_ = (velocity_.x < 0) ? WallTouchSide::Left : WallTouchSide::Right;
             velocity_.x = 0;
             // ローリング中に壁にぶつかったら止まる
             if (isRolling_) isRolling_ = false;
         }
-    } else if (velocity_.x > 0) { // 右移動
-        // マップ端判定含む
-        size_t colCount = 20;
-        if (mapChip_->GetColCount() > 0) colCount = mapChip_->GetColCount();
-        float mapWidth = static_cast<float>(colCount) * MapChip::kBlockSize;
-        float topExitY_Min = 7.7f;
-        float bottomExitY_Max = 0.7f;
-
-        bool mapChipHit = mapChip_->CheckCollision({ playerRight, checkY_Top, 0 }) || mapChip_->CheckCollision({ playerRight, checkY_Bottom, 0 });
-        bool mapEdgeHit = (playerRight > mapWidth && (transform_.translate.y > topExitY_Min || transform_.translate.y < bottomExitY_Max));
-
-        if (mapChipHit || (!mapEdgeHit && playerRight > mapWidth)) {
-            // 衝突した場合
-            if (mapChipHit || playerRight > mapWidth) {
-                // exit条件を満たしていないのに画面外に出ようとした、または壁に当たった
-                if (mapChipHit) {
-                    position.x = floor(playerRight / MapChip::kBlockSize) * MapChip::kBlockSize - kPlayerHalfSize - 0.001f;
-                    if (!onGround_) wallTouch_ = WallTouchSide::Right;
-                    velocity_.x = 0;
-                    if (isRolling_) isRolling_ = false;
-                }
-            }
-        }
     }
 
     transform_.translate = position;
 
     // ▼▼▼ ジャンプ処理 (先行入力あり) ▼▼▼
-    if (jumpBufferTimer_ > 0.0f) jumpBufferTimer_ -= 0.016f;
-    if (input->IsKeyPressed(VK_SPACE) && !isRolling_) jumpBufferTimer_ = 0.1f;
+    if (jumpBufferTimer_ > 0.0f) jumpBufferTimer_ -= kTickSeconds;
+    if (input.IsPressed(kButtonJump) && !isRolling_) jumpBufferTimer_ = 0.1f;
 
     if (jumpBufferTimer_ > 0.0f) {
         if (onGround_) {
@@ -266,8 +221,6 @@ void Player::Update() {
         // Z回転を戻す
         transform_.rotate.z = 0.0f;
     }
-
-    model_->transform = transform_;
 }
 
 void Player::Die() {
@@ -291,23 +244,9 @@ void Player::Reset() {
     jumpCount_ = 0;
 }
 
-void Player::Draw(ID3D12GraphicsCommandList* commandList, const Matrix4x4& viewProjectionMatrix, D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress, D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandle) {
-    model_->Draw(commandList, viewProjectionMatrix, lightGpuAddress, textureSrvHandle);
-    for (PlayerBullet* bullet : bullets_) bullet->Draw(commandList, viewProjectionMatrix, lightGpuAddress, textureSrvHandle);
-}
-
-void Player::ImGui_Draw() {
-    ImGui::Begin("Player");
-    ImGui::Text("isAlive: %s", isAlive_ ? "TRUE" : "FALSE");
-    ImGui::Text("Rolling: %s", isRolling_ ? "YES" : "NO");
-    ImGui::Text("Wall: %d", (int)wallTouch_);
-    ImGui::Text("Pos: %.2f, %.2f", transform_.translate.x, transform_.translate.y);
-    ImGui::End();
-}
-
 bool Player::IsExiting() const {
-    if (!mapChip_) return false;
-    float mapWidth = static_cast<float>(mapChip_->GetColCount()) * MapChip::kBlockSize;
+    if (!map_) return false;
+    float mapWidth = static_cast<float>(map_->GetColCount()) * GameMap::kBlockSize;
     if (transform_.translate.x > mapWidth) {
         if (transform_.translate.y > 7.7f || transform_.translate.y < 0.7f) return true;
     }
@@ -316,13 +255,13 @@ bool Player::IsExiting() const {
 
 void Player::SetPosition(const Vector3& pos) {
     transform_.translate = pos;
+    previousTranslate_ = pos;
     velocity_ = { 0.0f, 0.0f, 0.0f };
     onGround_ = false;
     wallTouch_ = WallTouchSide::None;
     jumpBufferTimer_ = 0.0f;
     wallJumpLockTimer_ = 0.0f;
     isRolling_ = false;
-    model_->transform = transform_;
     initialPosition_ = pos;
     for (PlayerBullet* bullet : bullets_) delete bullet;
     bullets_.clear();
@@ -337,7 +276,15 @@ void Player::UpdateClearAnimation() {
 
     // 少し手前に傾ける（楽しげに見えるように）
     transform_.rotate.z = 0.1f * std::sin(transform_.translate.y * 5.0f);
+}
 
-    // モデル行列更新
-    model_->transform = transform_;
+void Player::AddFlagState(StateHasher& hasher) const {
+    hasher.Add(static_cast<uint32_t>(isAlive_) | static_cast<uint32_t>(onGround_) << 1 | static_cast<uint32_t>(isRolling_) << 2 |
+        static_cast<uint32_t>(wallTouch_) << 3);
+    hasher.Add(jumpCount_);
+    hasher.Add(jumpBufferTimer_);
+    hasher.Add(wallJumpLockTimer_);
+    hasher.Add(rollTimer_);
+    hasher.Add(rollCooldown_);
+    hasher.Add(lrDirection_);
 }
\ No newline at end of file
@@ -1,22 +1,17 @@
 #pragma once
-#include "Model.h"
-#include "Input.h"
-#include "externals/imgui/imgui.h"
-#include "MapChip.h"
+#include "MathTypes.h"
+#include "GameInput.h"
+#include "GameMap.h"
+#include "FixedTimestep.h"
 #include "PlayerBullet.h" 
 #include <list>
 
 class Player {
 public:
-    void Initialize(Model* model, MapChip* mapChip, ID3D12Device* device);
+    void Initialize(GameMap* map);
 
-    void Update();
-    void Draw(
-        ID3D12GraphicsCommandList* commandList,
-        const Matrix4x4& viewProjectionMatrix,
-        D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress,
-        D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandle);
-    void ImGui_Draw();
+    // 1ティック進める (操作はキーボードでも記録の再生でもよい)
+    void Update(const InputFrame& input);
 
     void Die();
     void Reset();
@@ -28,8 +23,16 @@ public:
     bool IsInvincible() const { return isRolling_; }
 
     const Vector3& GetPosition() const { return transform_.translate; }
+    // 描画用 (モデル・弾のメッシュは描く側が持つ)
+    const Transform& GetTransform() const { return transform_; }
+    // 前のティックとの間を補間した描画用の姿勢 (alpha は FixedTimestep::GetAlpha)
+    Transform GetRenderTransform(float alpha) const { return InterpolateTransform(previousTranslate_, transform_, alpha); }
+    const std::list<PlayerBullet*>& GetBullets() const { return bullets_; }
     float GetHalfSize() const { return 0.2f; }
     bool IsOnGround() const { return onGround_; }
+    const Vector3& GetVelocity() const { return velocity_; }
+    // 位置と速度以外 (生死・接地・壁・ジャンプ回数・ローリング・向きとタイマー) をハッシュに足す
+    void AddFlagState(StateHasher& hasher) const;
 
     bool IsExiting() const;
     void SetPosition(const Vector3& pos);
@@ -42,9 +45,9 @@ private:
         Right
     };
 
-    Model* model_ = nullptr;
-    MapChip* mapChip_ = nullptr;
+    GameMap* map_ = nullptr;
     Transform transform_{};
+    Vector3 previousTranslate_{}; // 前のティックの位置 (描画の補間用)
     Vector3 velocity_{};
 
     bool onGround_ = false;
@@ -65,7 +68,6 @@ private:
     Vector3 initialPosition_{};
 
     // --- 弾関連 ---
-    Model* bulletModel_ = nullptr;
     std::list<PlayerBullet*> bullets_;
     float lrDirection_ = 1.0f; // 1.0:右, -1.0:左
 
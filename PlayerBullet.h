@@ -1,28 +1,30 @@
 #pragma once
-#include "Model.h"
-#include "MapChip.h"
+#include "MathTypes.h"
+#include "GameMap.h"
+#include "FixedTimestep.h"
+
+class StateHasher;
 
 class PlayerBullet {
 public:
-    // 初期化 (モデル、初期座標、移動速度X)
-    void Initialize(Model* model, const Vector3& position, float velocityX);
+    // 初期化 (初期座標、移動速度X)
+    void Initialize(const Vector3& position, float velocityX);
 
     // 更新 (寿命が尽きたり壁に当たったら true を返す)
-    bool Update(MapChip* mapChip);
+    bool Update(GameMap* map);
 
-    // 描画
-    void Draw(
-        ID3D12GraphicsCommandList* commandList,
-        const Matrix4x4& viewProjectionMatrix,
-        D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress,
-        D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandle);
+    // 描画用 (メッシュは描く側が持つ)
+    const Transform& GetTransform() const { return transform_; }
+    Transform GetRenderTransform(float alpha) const { return InterpolateTransform(previousTranslate_, transform_, alpha); }
+    // 位置・速さ・残りの寿命をハッシュに足す
+    void AddState(StateHasher& hasher) const;
 
 private:
-    Model* model_ = nullptr;
     Transform transform_{};
+    Vector3 previousTranslate_{}; // 前のティックの位置 (描画の補間用)
     float velocityX_ = 0.0f;
     float lifeTimer_ = 0.0f; // 生存時間
 
-    // 定数: 寿命は2秒 (60FPS想定)
+    // 定数: 寿命は2秒 (kTickSeconds ずつ減らす)
     const float kLifeTime = 2.0f;
 };
\ No newline at end of file
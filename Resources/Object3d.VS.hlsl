@@ -14,9 +14,16 @@ StructuredBuffer<InstancingData> gInstancingData : register(t1);
 
 struct VertexShaderInput
 {
+#ifdef COMPACT_VERTEX
+    // k_: ʒu w ȗAUV  halfA@͔ʑ̎ʑ (R16G16_SNORM)
+    float32_t3 position : POSITION0;
+    float32_t2 texcoord : TEXCOORD0;
+    float32_t2 normal : NORMAL0;
+#else
     float32_t4 position : POSITION0;
     float32_t2 texcoord : TEXCOORD0;
     float32_t3 normal : NORMAL0;
+#endif
 };
 
 
@@ -28,11 +35,19 @@ VertexShaderOutput main(VertexShaderInput input, uint instanceID : SV_InstanceID
     // CX^XIDgāA̒_ɑΉCX^X̃f[^擾
     InstancingData instancingData = gInstancingData[instanceID];
 
+#ifdef COMPACT_VERTEX
+    float32_t4 position = float32_t4(input.position, 1.0f);
+    float32_t3 normal = DecodeOctahedralNormal(input.normal);
+#else
+    float32_t4 position = input.position;
+    float32_t3 normal = input.normal;
+#endif
+
     // 擾CX^XŗL̍sgčWϊ
-    output.position = mul(input.position, instancingData.WVP);
+    output.position = mul(position, instancingData.WVP);
     output.texcoord = input.texcoord;
-    output.normal = normalize(mul(input.normal, (float32_t3x3) instancingData.World));
-    output.worldPosition = mul(input.position, instancingData.World).xyz; // worldPositionYꂸɌvZ
+    output.normal = normalize(mul(normal, (float32_t3x3) instancingData.World));
+    output.worldPosition = mul(position, instancingData.World).xyz; // worldPositionYꂸɌvZ
 
     return output;
 }
\ No newline at end of file
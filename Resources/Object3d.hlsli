@@ -26,4 +26,14 @@ struct DirectionalLight
     float32_t4 color;
     float32_t3 direction;
     float intensity;
-};
\ No newline at end of file
+};
+
+// k_ (C++ CompactVertexData) ̖@WJ (ʑ̎ʑEVertexPacking.cpp ƓvZ)
+float32_t3 DecodeOctahedralNormal(float32_t2 encoded)
+{
+    float32_t3 normal = float32_t3(encoded.x, encoded.y, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-normal.z);
+    normal.x += normal.x >= 0.0f ? -t : t;
+    normal.y += normal.y >= 0.0f ? -t : t;
+    return normalize(normal);
+}
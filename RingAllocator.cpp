@@ -0,0 +1,52 @@
+#include "RingAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+void RingAllocator::Initialize(uint64_t capacity) {
+	capacity_ = capacity;
+	Reset();
+}
+
+uint64_t RingAllocator::Allocate(uint64_t size, uint64_t alignment) {
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	if (size == 0 || size > capacity_) {
+		return kInvalidOffset;
+	}
+
+	uint64_t offset = head_ % capacity_;
+	uint64_t alignedOffset = (offset + alignment - 1) & ~(alignment - 1);
+	// 末尾に収まらなければ先頭まで読み飛ばす (途中で折り返す確保はしない)
+	if (alignedOffset + size > capacity_) {
+		alignedOffset = 0;
+	}
+	uint64_t padding = (alignedOffset >= offset) ? alignedOffset - offset : capacity_ - offset;
+	if (GetUsedSize() + padding + size > capacity_) {
+		// GPUがまだ読んでいる領域に追いついた
+		return kInvalidOffset;
+	}
+
+	head_ += padding + size;
+	peakUsedSize_ = std::max(peakUsedSize_, GetUsedSize());
+	++frameAllocationCount_;
+	return alignedOffset;
+}
+
+void RingAllocator::FinishFrame(uint64_t fenceValue) {
+	pendingFrames_.push_back({ fenceValue, head_ });
+	frameAllocationCount_ = 0;
+}
+
+void RingAllocator::ReleaseCompletedFrames(uint64_t completedFenceValue) {
+	while (!pendingFrames_.empty() && pendingFrames_.front().fenceValue <= completedFenceValue) {
+		tail_ = pendingFrames_.front().end;
+		pendingFrames_.pop_front();
+	}
+}
+
+void RingAllocator::Reset() {
+	head_ = 0;
+	tail_ = 0;
+	peakUsedSize_ = 0;
+	frameAllocationCount_ = 0;
+	pendingFrames_.clear();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// リングバッファ上の線形アロケータ (GPUに依存しない部分)
+// フレーム中は先頭から順に切り出し、フレームの終わりにフェンス値を記録する。
+// そのフェンスをGPUが通過したら、そのフレームで使った領域をまとめて返す。
+class RingAllocator {
+public:
+	static const uint64_t kInvalidOffset = UINT64_MAX;
+	// 定数バッファ (CBV) のアドレスに必要な境界
+	static const uint64_t kConstantBufferAlignment = 256;
+
+	// 初期化 (容量はアラインメントの倍数にしておく)
+	void Initialize(uint64_t capacity);
+
+	// 領域を確保してバッファ先頭からのオフセットを返す (空きがなければ kInvalidOffset)
+	uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+	// 現在のフレームの確保を締め切り、GPUがこのフレームを終えたときのフェンス値を記録する
+	void FinishFrame(uint64_t fenceValue);
+
+	// 完了したフェンス値までのフレームが使っていた領域を解放する
+	void ReleaseCompletedFrames(uint64_t completedFenceValue);
+
+	// 全フレーム分を破棄する
+	void Reset();
+
+	// 統計情報
+	uint64_t GetCapacity() const { return capacity_; }
+	uint64_t GetUsedSize() const { return head_ - tail_; }
+	uint64_t GetPeakUsedSize() const { return peakUsedSize_; }
+	uint32_t GetFrameAllocationCount() const { return frameAllocationCount_; }
+	size_t GetPendingFrameCount() const { return pendingFrames_.size(); }
+
+private:
+	struct FrameMarker {
+		uint64_t fenceValue = 0;
+		uint64_t end = 0; // このフレームの終端 (head_ と同じ通し番号)
+	};
+
+	uint64_t capacity_ = 0;
+	// head_ / tail_ は折り返しを含めた通しの位置 (実際のオフセットは capacity_ の剰余)
+	uint64_t head_ = 0;
+	uint64_t tail_ = 0;
+	uint64_t peakUsedSize_ = 0;
+	uint32_t frameAllocationCount_ = 0;
+	std::deque<FrameMarker> pendingFrames_;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// シミュレーションの処理ごとの時間と回数 (Windows / D3D12 に依存しない)
+//
+// GameSimulation::SetProfile で渡したときだけ測る (渡さなければ時計を読まない)。
+// 上の段 (Streaming..MapLoad) は1ティックの中で重ならず、足すと Step のほぼ全体になる。
+// MapQueries と MapEdits は上の段の中から呼ばれる GameMap の処理で、回数だけを数える
+// (1回が数十ナノ秒の処理なので、毎回時計を読むとその費用が上の段の時間の大半になってしまう)。
+enum SimulationSection {
+    kSectionStreaming,     // チャンクの読み込み・破棄 (UpdateStreaming)
+    kSectionPlayer,        // プレイヤーと弾
+    kSectionTraps,         // 横から来る罠
+    kSectionFallingBlocks, // 落下ブロック
+    kSectionGimmicks,      // map3 の仕掛け・ゴールの移動・リトライ・マップの移動とクリアの判定
+    kSectionChunkFlush,    // 書き換えたチャンクの通知 (ApplyChanges)
+    kSectionMapLoad,       // マップの読み込みと物の配置
+    kSectionMapQueries,    // (回数のみ) 当たり判定・スイープ・光線・位置の索引の問い合わせ
+    kSectionMapEdits,      // (回数のみ) マスの書き換え・位置の索引の更新
+    kSectionCount
+};
+
+// 時間も測る処理か (false なら回数だけ)
+inline bool IsSimulationSectionTimed(SimulationSection section) {
+    return section < kSectionMapQueries;
+}
+
+// 表示・JSON 用の名前
+inline const char* GetSimulationSectionName(SimulationSection section) {
+    static const char* const kNames[kSectionCount] = {
+        "streaming", "player", "traps", "falling_blocks", "gimmicks", "chunk_flush", "map_load", "map_queries", "map_edits",
+    };
+    return kNames[section];
+}
+
+struct SimulationProfile {
+    uint64_t nanoseconds[kSectionCount] = {};
+    uint64_t calls[kSectionCount] = {};
+
+    void Reset() { *this = SimulationProfile(); }
+};
+
+// 回数だけを profile に足す (profile が nullptr なら何もしない)
+inline void CountSimulationSection(SimulationProfile* profile, SimulationSection section) {
+    if (profile) {
+        ++profile->calls[section];
+    }
+}
+
+// スコープの間の時間を profile に足す (profile が nullptr なら何もしない)
+// 足した時間には時計を読む費用も1回分入る (細かく見るときは、空のスコープを測った値を回数分引く)
+class ScopedSectionTimer {
+public:
+    ScopedSectionTimer(SimulationProfile* profile, SimulationSection section) : profile_(profile), section_(section) {
+        if (profile_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~ScopedSectionTimer() {
+        if (profile_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            profile_->nanoseconds[section_] += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            ++profile_->calls[section_];
+        }
+    }
+    ScopedSectionTimer(const ScopedSectionTimer&) = delete;
+    ScopedSectionTimer& operator=(const ScopedSectionTimer&) = delete;
+
+private:
+    SimulationProfile* profile_;
+    SimulationSection section_;
+    std::chrono::steady_clock::time_point start_;
+};
@@ -0,0 +1,76 @@
+#include "SizeClassAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+SizeClassAllocator::Allocation SizeClassAllocator::Allocate(uint64_t size, uint64_t alignment) {
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+	assert(alignment <= kPageSize);
+
+	Allocation allocation;
+	if (size == 0) {
+		return allocation;
+	}
+	allocation.requestedSize = size;
+
+	// ページに収まらないものは専用リソース (64KiB単位で確保される)
+	if (size > kPageSize) {
+		allocation.page = kDedicatedPage;
+		allocation.reservedSize = (size + kPageSize - 1) / kPageSize * kPageSize;
+		dedicatedBytes_ += allocation.reservedSize;
+	} else {
+		// ブロックはサイズ境界に並ぶので、ブロックサイズ >= alignment なら配置も満たす
+		uint64_t needed = std::max(size, alignment);
+		uint32_t sizeClass = 0;
+		while (GetBlockSize(sizeClass) < needed) {
+			++sizeClass;
+		}
+
+		std::vector<FreeBlock>& freeList = freeBlocks_[sizeClass];
+		if (freeList.empty()) {
+			// 新しいページを丸ごとこのサイズクラスのブロックに分割する
+			uint32_t page = pageCount_++;
+			uint64_t blockSize = GetBlockSize(sizeClass);
+			for (uint64_t offset = kPageSize; offset > 0; offset -= blockSize) {
+				freeList.push_back({ page, offset - blockSize });
+			}
+		}
+
+		FreeBlock block = freeList.back();
+		freeList.pop_back();
+		allocation.page = block.page;
+		allocation.sizeClass = sizeClass;
+		allocation.offset = block.offset;
+		allocation.reservedSize = GetBlockSize(sizeClass);
+	}
+
+	requestedBytes_ += allocation.requestedSize;
+	reservedBytes_ += allocation.reservedSize;
+	++liveAllocationCount_;
+	return allocation;
+}
+
+void SizeClassAllocator::Free(const Allocation& allocation) {
+	if (!allocation.IsValid()) {
+		return;
+	}
+
+	if (allocation.IsDedicated()) {
+		dedicatedBytes_ -= allocation.reservedSize;
+	} else {
+		freeBlocks_[allocation.sizeClass].push_back({ allocation.page, allocation.offset });
+	}
+	requestedBytes_ -= allocation.requestedSize;
+	reservedBytes_ -= allocation.reservedSize;
+	--liveAllocationCount_;
+}
+
+void SizeClassAllocator::Reset() {
+	for (std::vector<FreeBlock>& freeList : freeBlocks_) {
+		freeList.clear();
+	}
+	pageCount_ = 0;
+	requestedBytes_ = 0;
+	reservedBytes_ = 0;
+	dedicatedBytes_ = 0;
+	liveAllocationCount_ = 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 小さなバッファを64KiBのページから切り出すための割り当て方針 (GPUに依存しない部分)
+// 256バイトから64KiBまでの2のべき乗のサイズクラスごとに空きブロックを管理する。
+// ページより大きい要求は専用リソースとして扱い、統計だけを記録する。
+class SizeClassAllocator {
+public:
+	// D3D12のバッファ1つあたりの配置単位
+	static const uint64_t kPageSize = 64 * 1024;
+	// CBVの配置単位に合わせた最小ブロック
+	static const uint64_t kMinBlockSize = 256;
+	static const uint32_t kSizeClassCount = 9; // 256, 512, ... , 64KiB
+	static const uint32_t kDedicatedPage = UINT32_MAX;
+
+	struct Allocation {
+		uint32_t page = kDedicatedPage;
+		uint32_t sizeClass = 0;
+		uint64_t offset = 0;        // ページ先頭からのオフセット
+		uint64_t requestedSize = 0; // 呼び出し側が要求したサイズ
+		uint64_t reservedSize = 0;  // 実際に確保したサイズ
+		bool IsDedicated() const { return page == kDedicatedPage; }
+		bool IsValid() const { return reservedSize != 0; }
+	};
+
+	// 確保 (alignment はページサイズ以下の2のべき乗)
+	Allocation Allocate(uint64_t size, uint64_t alignment);
+
+	// 解放 (ブロックはサイズクラスの空きリストに戻り、ページ自体は返さない)
+	void Free(const Allocation& allocation);
+
+	// 全て破棄する
+	void Reset();
+
+	// 統計情報
+	uint64_t GetRequestedBytes() const { return requestedBytes_; }
+	uint64_t GetReservedBytes() const { return reservedBytes_; }
+	// GPU側で実際に確保されているバイト数 (ページ + 専用リソース)
+	uint64_t GetCommittedBytes() const { return pageCount_ * kPageSize + dedicatedBytes_; }
+	uint32_t GetPageCount() const { return pageCount_; }
+	uint32_t GetLiveAllocationCount() const { return liveAllocationCount_; }
+
+	static uint64_t GetBlockSize(uint32_t sizeClass) { return kMinBlockSize << sizeClass; }
+
+private:
+	struct FreeBlock {
+		uint32_t page = 0;
+		uint64_t offset = 0;
+	};
+
+	std::vector<FreeBlock> freeBlocks_[kSizeClassCount];
+	uint32_t pageCount_ = 0;
+	uint64_t requestedBytes_ = 0;
+	uint64_t reservedBytes_ = 0;
+	uint64_t dedicatedBytes_ = 0;
+	uint32_t liveAllocationCount_ = 0;
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include "MathTypes.h"
+#include <cstdint>
+#include <cstring>
+
+// シミュレーションの状態のハッシュ (Windows / D3D12 に依存しない)
+//
+// 状態を 32 ビットの語に詰めて混ぜる。float はビット列をそのまま使う (0.0f と -0.0f も別の値)。
+// 語は順に4本の列へ振り分け、列ごとに独立に掛け算で混ぜるので、前の語の結果を待たずに進む
+// (1バイトずつ混ぜる FNV-1a より1語あたり数倍速い)。どの1語が変わっても結果は必ず変わる。
+class StateHasher {
+public:
+    void Add(uint32_t word) {
+        uint64_t& lane = lanes_[count_ & 3];
+        lane = (lane ^ word) * kPrime;
+        ++count_;
+    }
+    void Add(uint64_t value) {
+        Add(static_cast<uint32_t>(value));
+        Add(static_cast<uint32_t>(value >> 32));
+    }
+    void Add(int32_t value) { Add(static_cast<uint32_t>(value)); }
+    void Add(bool value) { Add(static_cast<uint32_t>(value)); }
+    void Add(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        Add(bits);
+    }
+    void Add(const Vector3& value) {
+        Add(value.x);
+        Add(value.y);
+        Add(value.z);
+    }
+
+    uint64_t Get() const {
+        // 列を順に混ぜ、語の数も入れる (末尾に 0 を足しただけの状態と区別するため)
+        uint64_t hash = count_;
+        for (uint64_t lane : lanes_) {
+            hash = Mix(hash ^ lane);
+        }
+        return hash;
+    }
+
+    // 64 ビットの値を広げる (splitmix64 の仕上げ)
+    static uint64_t Mix(uint64_t value) {
+        value ^= value >> 30;
+        value *= 0xBF58476D1CE4E5B9ull;
+        value ^= value >> 27;
+        value *= 0x94D049BB133111EBull;
+        value ^= value >> 31;
+        return value;
+    }
+
+private:
+    static const uint64_t kPrime = 0x100000001B3ull;
+    uint64_t lanes_[4] = { 0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0x27D4EB2F165667C5ull };
+    uint64_t count_ = 0;
+};
+
+// 状態の項目 (ずれたときにどこがずれたかを示す単位)
+enum StateField {
+    kStateFieldScene,           // シーン・ティック数・マップの読み込み
+    kStateFieldPlayerTransform, // プレイヤーの位置・回転
+    kStateFieldPlayerVelocity,  // プレイヤーの速度
+    kStateFieldPlayerFlags,     // 生死・接地・壁・ジャンプ回数・ローリングとそのタイマー
+    kStateFieldBullets,         // 弾
+    kStateFieldTraps,           // 罠
+    kStateFieldFallingBlocks,   // 落下ブロック
+    kStateFieldGridEdits,       // マップのマスの書き換え
+    kStateFieldGoal,            // ゴールの位置と移動
+    kStateFieldGimmicks,        // map3 の仕掛け
+    kStateFieldCount
+};
+
+// 表示用の名前
+inline const char* GetStateFieldName(StateField field) {
+    static const char* const kNames[kStateFieldCount] = {
+        "scene", "player.transform", "player.velocity", "player.flags", "bullets", "traps", "falling_blocks", "grid_edits", "goal",
+        "gimmicks",
+    };
+    return kNames[field];
+}
+
+// 項目ごとのハッシュ
+struct StateDigest {
+    uint64_t fields[kStateFieldCount] = {};
+
+    // 全体で1つの値 (記録の再生で比べる)
+    uint64_t Combine() const {
+        StateHasher hasher;
+        for (uint64_t field : fields) {
+            hasher.Add(field);
+        }
+        return hasher.Get();
+    }
+    // 違う最初の項目 (同じなら kStateFieldCount)
+    StateField FindFirstDifference(const StateDigest& other) const {
+        for (int field = 0; field < kStateFieldCount; ++field) {
+            if (fields[field] != other.fields[field]) {
+                return static_cast<StateField>(field);
+            }
+        }
+        return kStateFieldCount;
+    }
+};
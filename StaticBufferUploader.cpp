@@ -0,0 +1,100 @@
+#include "StaticBufferUploader.h"
+#include "D3D12Util.h"
+#include <cassert>
+#include <string>
+#include <vector>
+#include <Windows.h> // OutputDebugStringA
+
+StaticBufferUploader* StaticBufferUploader::GetInstance() {
+	static StaticBufferUploader instance;
+	return &instance;
+}
+
+void StaticBufferUploader::Initialize(ID3D12Device* device, uint64_t stagingSizeInBytes) {
+	device_ = device;
+	stagingResource_ = CreateBufferResource(device, static_cast<size_t>(stagingSizeInBytes));
+	uint8_t* stagingMemory = nullptr;
+	stagingResource_->Map(0, nullptr, reinterpret_cast<void**>(&stagingMemory));
+	scheduler_.Initialize(stagingMemory, stagingSizeInBytes);
+}
+
+void StaticBufferUploader::Finalize() {
+	scheduler_.Initialize(nullptr, 0);
+	stream_.Clear();
+	destinations_.clear();
+	stagingResource_.Reset();
+	device_ = nullptr;
+}
+
+Microsoft::WRL::ComPtr<ID3D12Resource> StaticBufferUploader::CreateStaticBuffer(const void* data, uint64_t sizeInBytes) {
+	assert(device_ != nullptr);
+
+	D3D12_HEAP_PROPERTIES heapProperties{};
+	heapProperties.Type = D3D12_HEAP_TYPE_DEFAULT;
+	D3D12_RESOURCE_DESC resourceDesc{};
+	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	resourceDesc.Width = sizeInBytes;
+	resourceDesc.Height = 1;
+	resourceDesc.DepthOrArraySize = 1;
+	resourceDesc.MipLevels = 1;
+	resourceDesc.SampleDesc.Count = 1;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	// COMMON で作っておけば、コピー時に COPY_DEST へ暗黙的に昇格する
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+	HRESULT hr = device_->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&resource));
+	if (FAILED(hr)) {
+		OutputDebugStringA("[StaticBufferUploader] CreateCommittedResource failed\n");
+		assert(false);
+		return nullptr;
+	}
+
+	uint32_t destination = nextDestinationId_++;
+	if (!scheduler_.Enqueue(destination, 0, data, sizeInBytes)) {
+		std::string message = "[StaticBufferUploader] Staging buffer is full (" + std::to_string(sizeInBytes) + " bytes requested)\n";
+		OutputDebugStringA(message.c_str());
+		return nullptr;
+	}
+	destinations_.emplace(destination, resource);
+	return resource;
+}
+
+void StaticBufferUploader::Flush(ID3D12GraphicsCommandList* commandList) {
+	if (!scheduler_.HasPendingCopies()) {
+		return;
+	}
+
+	stream_.Clear();
+	scheduler_.Flush(stream_);
+
+	for (const BufferCopyCommand& copy : stream_.copies) {
+		commandList->CopyBufferRegion(
+			destinations_[copy.destination].Get(), copy.destinationOffset,
+			stagingResource_.Get(), copy.stagingOffset, copy.size);
+	}
+
+	// コピーが終わったら頂点・インデックスバッファとして読める状態にする
+	std::vector<D3D12_RESOURCE_BARRIER> barriers(stream_.destinations.size());
+	for (size_t i = 0; i < stream_.destinations.size(); ++i) {
+		barriers[i].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+		barriers[i].Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+		barriers[i].Transition.pResource = destinations_[stream_.destinations[i]].Get();
+		barriers[i].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+		barriers[i].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+		barriers[i].Transition.StateAfter = D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER | D3D12_RESOURCE_STATE_INDEX_BUFFER;
+	}
+	commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+
+	// コピーの実行中は Mesh 側が参照を持っている (PostDraw でGPUの完了を待つ)
+	for (uint32_t destination : stream_.destinations) {
+		destinations_.erase(destination);
+	}
+}
+
+void StaticBufferUploader::BeginFrame(uint64_t completedFenceValue) {
+	scheduler_.BeginFrame(completedFenceValue);
+}
+
+void StaticBufferUploader::EndFrame(uint64_t fenceValue) {
+	scheduler_.EndFrame(fenceValue);
+}
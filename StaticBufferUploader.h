@@ -0,0 +1,47 @@
+#pragma once
+#include "UploadScheduler.h"
+#include <d3d12.h>
+#include <wrl.h>
+#include <cstdint>
+#include <unordered_map>
+
+// 生成後に書き換えない頂点・インデックスデータを DEFAULT ヒープに置くクラス
+// データはステージングバッファ経由で、次のフレームの先頭でまとめてコピーされる
+class StaticBufferUploader {
+public:
+	// シングルトンインスタンスの取得
+	static StaticBufferUploader* GetInstance();
+
+	// 初期化 (ステージングバッファのサイズを指定)
+	void Initialize(ID3D12Device* device, uint64_t stagingSizeInBytes);
+
+	// 終了処理
+	void Finalize();
+
+	// DEFAULT ヒープにバッファを作り、データの転送を予約する (失敗したら nullptr)
+	Microsoft::WRL::ComPtr<ID3D12Resource> CreateStaticBuffer(const void* data, uint64_t sizeInBytes);
+
+	// 予約済みのコピーをコマンドリストに積む (描画より前に呼ぶ)
+	void Flush(ID3D12GraphicsCommandList* commandList);
+
+	// フレームの開始・終了 (ステージングバッファの再利用をフェンスで管理する)
+	void BeginFrame(uint64_t completedFenceValue);
+	void EndFrame(uint64_t fenceValue);
+
+	const UploadScheduler& GetScheduler() const { return scheduler_; }
+
+private:
+	StaticBufferUploader() = default;
+	~StaticBufferUploader() = default;
+	StaticBufferUploader(const StaticBufferUploader&) = delete;
+	const StaticBufferUploader& operator=(const StaticBufferUploader&) = delete;
+
+private:
+	ID3D12Device* device_ = nullptr;
+	Microsoft::WRL::ComPtr<ID3D12Resource> stagingResource_;
+	UploadScheduler scheduler_;
+	CopyCommandStream stream_;
+	// コピーが済むまで転送先を保持しておく (ID → リソース)
+	std::unordered_map<uint32_t, Microsoft::WRL::ComPtr<ID3D12Resource>> destinations_;
+	uint32_t nextDestinationId_ = 0;
+};
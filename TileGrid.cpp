@@ -0,0 +1,90 @@
+#include "TileGrid.h"
+#include <algorithm>
+
+void TileGrid::Resize(int32_t width, int32_t height) {
+	width_ = std::max(width, 0);
+	height_ = std::max(height, 0);
+	tiles_.assign(static_cast<size_t>(width_) * height_, kTileEmpty);
+	wordsPerRow_ = (width_ + 2 + 63) / 64;
+	solidMask_.assign(static_cast<size_t>(wordsPerRow_) * (height_ + 2), 0);
+}
+
+void TileGrid::Assign(int32_t width, int32_t height, const uint8_t* tiles) {
+	Resize(width, height);
+	if (tiles_.empty()) {
+		return;
+	}
+	std::copy(tiles, tiles + tiles_.size(), tiles_.begin());
+	for (int32_t mapY = 0; mapY < height_; ++mapY) {
+		uint64_t* row = &solidMask_[static_cast<size_t>(mapY + 1) * wordsPerRow_];
+		const uint8_t* source = &tiles_[static_cast<size_t>(mapY) * width_];
+		for (int32_t x = 0; x < width_; ++x) {
+			int32_t column = x + 1;
+			row[column >> 6] |= uint64_t(IsSolidType(source[x])) << (column & 63);
+		}
+	}
+}
+
+void TileGrid::Set(int32_t x, int32_t mapY, uint8_t type) {
+	if (!Contains(x, mapY)) {
+		return;
+	}
+	tiles_[static_cast<size_t>(mapY) * width_ + x] = type;
+
+	int32_t column = x + 1;
+	uint64_t& word = solidMask_[static_cast<size_t>(mapY + 1) * wordsPerRow_ + (column >> 6)];
+	uint64_t bit = uint64_t(1) << (column & 63);
+	word = IsSolidType(type) ? (word | bit) : (word & ~bit);
+}
+
+bool TileGrid::IsSpanSolid(int32_t mapY, int32_t x0, int32_t x1) const {
+	if (x0 > x1) {
+		std::swap(x0, x1);
+	}
+	int32_t first = Clamp(x0, -1, width_) + 1;
+	int32_t last = Clamp(x1, -1, width_) + 1;
+	const uint64_t* row = GetMaskRow(mapY);
+
+	// 先頭と末尾の語だけ端を切り落として、間の語はそのまま見る
+	int32_t firstWord = first >> 6;
+	int32_t lastWord = last >> 6;
+	uint64_t firstMask = ~uint64_t(0) << (first & 63);
+	uint64_t lastMask = ~uint64_t(0) >> (63 - (last & 63));
+	if (firstWord == lastWord) {
+		return (row[firstWord] & firstMask & lastMask) != 0;
+	}
+	uint64_t bits = (row[firstWord] & firstMask) | (row[lastWord] & lastMask);
+	for (int32_t i = firstWord + 1; i < lastWord; ++i) {
+		bits |= row[i];
+	}
+	return bits != 0;
+}
+
+bool TileGrid::IsColumnSolid(int32_t x, int32_t mapY0, int32_t mapY1) const {
+	if (mapY0 > mapY1) {
+		std::swap(mapY0, mapY1);
+	}
+	int32_t column = Clamp(x, -1, width_) + 1;
+	int32_t first = Clamp(mapY0, -1, height_) + 1;
+	int32_t last = Clamp(mapY1, -1, height_) + 1;
+	const uint64_t* word = &solidMask_[static_cast<size_t>(first) * wordsPerRow_ + (column >> 6)];
+	uint64_t bits = 0;
+	for (int32_t row = first; row <= last; ++row, word += wordsPerRow_) {
+		bits |= *word;
+	}
+	return ((bits >> (column & 63)) & 1u) != 0;
+}
+
+bool TileGrid::IsRectSolid(int32_t x0, int32_t mapY0, int32_t x1, int32_t mapY1) const {
+	if (mapY0 > mapY1) {
+		std::swap(mapY0, mapY1);
+	}
+	int32_t first = Clamp(mapY0, -1, height_);
+	int32_t last = Clamp(mapY1, -1, height_);
+	for (int32_t mapY = first; mapY <= last; ++mapY) {
+		if (IsSpanSolid(mapY, x0, x1)) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// タイルの種類 (CSVの値そのまま)
+enum TileType : uint8_t {
+	kTileEmpty = 0,
+	kTileWall = 1,
+	kTileStart = 2,
+	kTileGoal = 5,
+	// 動くブロックが止まっているマス (壁として当たるが、地形としては描かない)
+	kTileBlock = 255,
+};
+
+// マップのタイル配列 (Windows / D3D12 に依存しない)
+//
+// 座標は CSV と同じ (x: 左から, mapY: 上から)。
+// 種類は行優先の uint8_t 配列に持ち、当たり判定用に「壁かどうか」だけのビットマスクを別に持つ。
+// ビットマスクは周囲1マスを空きで埋めてあり、範囲外の座標はその空きマスに丸めるので
+// 点や区間の判定に範囲チェックの分岐がいらない。
+class TileGrid {
+public:
+	TileGrid() { Resize(0, 0); }
+
+	// 大きさを変えて全部 kTileEmpty にする
+	void Resize(int32_t width, int32_t height);
+
+	int32_t GetWidth() const { return width_; }
+	int32_t GetHeight() const { return height_; }
+	bool IsEmpty() const { return width_ == 0 || height_ == 0; }
+
+	bool Contains(int32_t x, int32_t mapY) const {
+		return static_cast<uint32_t>(x) < static_cast<uint32_t>(width_) && static_cast<uint32_t>(mapY) < static_cast<uint32_t>(height_);
+	}
+
+	// タイルの種類 (範囲外は -1)
+	int32_t Get(int32_t x, int32_t mapY) const {
+		return Contains(x, mapY) ? tiles_[static_cast<size_t>(mapY) * width_ + x] : -1;
+	}
+
+	// 行優先のタイル配列 (width * height) で丸ごと置き換える
+	void Assign(int32_t width, int32_t height, const uint8_t* tiles);
+
+	// タイルを書き換える (範囲外は無視)
+	void Set(int32_t x, int32_t mapY, uint8_t type);
+
+	// 壁か (範囲外は壁でない)
+	bool IsSolid(int32_t x, int32_t mapY) const {
+		int32_t column = Clamp(x, -1, width_) + 1;
+		int32_t row = Clamp(mapY, -1, height_) + 1;
+		uint64_t word = solidMask_[static_cast<size_t>(row) * wordsPerRow_ + (column >> 6)];
+		return ((word >> (column & 63)) & 1u) != 0;
+	}
+
+	// 1行の [x0, x1] に壁があるか
+	bool IsSpanSolid(int32_t mapY, int32_t x0, int32_t x1) const;
+
+	// 1列の [mapY0, mapY1] に壁があるか
+	bool IsColumnSolid(int32_t x, int32_t mapY0, int32_t mapY1) const;
+
+	// 矩形 [x0, x1] x [mapY0, mapY1] に壁があるか
+	bool IsRectSolid(int32_t x0, int32_t mapY0, int32_t x1, int32_t mapY1) const;
+
+	// 壁になる種類か
+	static bool IsSolidType(uint8_t type) { return type == kTileWall || type == kTileBlock; }
+
+	// 行優先のタイル配列 (width * height)
+	const std::vector<uint8_t>& GetTiles() const { return tiles_; }
+
+	// タイル配列とビットマスクが確保しているバイト数
+	size_t GetMemoryBytes() const { return tiles_.capacity() + solidMask_.capacity() * sizeof(uint64_t); }
+
+private:
+	static int32_t Clamp(int32_t value, int32_t minValue, int32_t maxValue) {
+		return value < minValue ? minValue : (value > maxValue ? maxValue : value);
+	}
+
+	// 周囲の空きマスを含めた行の先頭
+	const uint64_t* GetMaskRow(int32_t mapY) const {
+		return &solidMask_[static_cast<size_t>(Clamp(mapY, -1, height_) + 1) * wordsPerRow_];
+	}
+
+private:
+	int32_t width_ = 0;
+	int32_t height_ = 0;
+	std::vector<uint8_t> tiles_;
+	// (width + 2) ビットを 64bit 単位で切り上げた行を (height + 2) 行並べる
+	int32_t wordsPerRow_ = 0;
+	std::vector<uint64_t> solidMask_;
+};
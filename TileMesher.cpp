@@ -0,0 +1,168 @@
+#include "TileMesher.h"
+#include "TileGrid.h"
+#include <vector>
+
+void TileMeshStats::Accumulate(const TileMeshStats& other) {
+	wallCount += other.wallCount;
+	cubeTriangleCount += other.cubeTriangleCount;
+	visibleFaceCount += other.visibleFaceCount;
+	triangleCount += other.triangleCount;
+	vertexCount += other.vertexCount;
+}
+
+namespace {
+
+Vector3 Add(const Vector3& a, const Vector3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+
+Vector3 Cross(const Vector3& a, const Vector3& b) {
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+float Dot(const Vector3& a, const Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+// 四角形を2つの三角形で追加する
+// corner が UV (0, 0) で、uEdge / vEdge の方向にそれぞれ uLength / vLength タイル分伸びる
+void AddQuad(IndexedModelData& mesh, const Vector3& corner, const Vector3& uEdge, const Vector3& vEdge,
+	float uLength, float vLength, const Vector3& normal) {
+	uint32_t base = static_cast<uint32_t>(mesh.vertices.size());
+	const Vector3 positions[4] = { corner, Add(corner, uEdge), Add(Add(corner, uEdge), vEdge), Add(corner, vEdge) };
+	const Vector2 texcoords[4] = { { 0.0f, 0.0f }, { uLength, 0.0f }, { uLength, vLength }, { 0.0f, vLength } };
+	for (int i = 0; i < 4; ++i) {
+		mesh.vertices.push_back({ { positions[i].x, positions[i].y, positions[i].z, 1.0f }, texcoords[i], normal });
+	}
+
+	// 法線の側から見て時計回り (左手系・FrontCounterClockwise = FALSE) になるように並べる
+	if (Dot(Cross(uEdge, vEdge), normal) > 0.0f) {
+		const uint32_t indices[6] = { 0, 1, 2, 0, 2, 3 };
+		for (uint32_t index : indices) {
+			mesh.indices.push_back(base + index);
+		}
+	} else {
+		const uint32_t indices[6] = { 0, 2, 1, 0, 3, 2 };
+		for (uint32_t index : indices) {
+			mesh.indices.push_back(base + index);
+		}
+	}
+}
+
+} // namespace
+
+TileMeshStats BuildTileMesh(
+	const uint8_t* tiles, int32_t width, int32_t height, const TileMeshOptions& options, IndexedModelData& mesh) {
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	TileMeshStats stats;
+	if (width <= 0 || height <= 0) {
+		return stats;
+	}
+
+	auto isSolid = [&](int32_t x, int32_t mapY) {
+		if (x < 0 || x >= width || mapY < 0 || mapY >= height) {
+			return false;
+		}
+		return tiles[static_cast<size_t>(mapY) * width + x] == kTileWall;
+	};
+
+	const float s = options.blockSize;
+	const float zFront = -s * 0.5f;
+	const float zBack = s * 0.5f;
+	auto left = [&](int32_t x) { return options.originX + static_cast<float>(x) * s; };
+	auto top = [&](int32_t mapY) { return options.originY - static_cast<float>(mapY) * s; };
+
+	// --- 手前・奥: 壁の長方形を貪欲に広げる (右へ伸ばしてから、同じ幅のまま下へ伸ばす) ---
+	std::vector<uint8_t> used(static_cast<size_t>(width) * height, 0);
+	auto isFree = [&](int32_t x, int32_t mapY) { return isSolid(x, mapY) && !used[static_cast<size_t>(mapY) * width + x]; };
+	for (int32_t mapY = 0; mapY < height; ++mapY) {
+		for (int32_t x = 0; x < width; ++x) {
+			if (!isSolid(x, mapY)) {
+				continue;
+			}
+			++stats.wallCount;
+			if (!isFree(x, mapY)) {
+				continue;
+			}
+			int32_t runWidth = 1;
+			int32_t runHeight = 1;
+			if (options.mergeFaces) {
+				while (isFree(x + runWidth, mapY)) {
+					++runWidth;
+				}
+				for (bool grow = true; grow && mapY + runHeight < height;) {
+					for (int32_t i = 0; i < runWidth; ++i) {
+						grow = grow && isFree(x + i, mapY + runHeight);
+					}
+					runHeight += grow ? 1 : 0;
+				}
+			}
+			for (int32_t dy = 0; dy < runHeight; ++dy) {
+				for (int32_t dx = 0; dx < runWidth; ++dx) {
+					used[static_cast<size_t>(mapY + dy) * width + x + dx] = 1;
+				}
+			}
+
+			float w = static_cast<float>(runWidth);
+			float h = static_cast<float>(runHeight);
+			AddQuad(mesh, { left(x), top(mapY), zFront }, { w * s, 0.0f, 0.0f }, { 0.0f, -h * s, 0.0f }, w, h, { 0.0f, 0.0f, -1.0f });
+			if (options.backFaces) {
+				// 奥から見て左右が反転しないよう右端から張る
+				AddQuad(mesh, { left(x + runWidth), top(mapY), zBack }, { -w * s, 0.0f, 0.0f }, { 0.0f, -h * s, 0.0f }, w, h, { 0.0f, 0.0f, 1.0f });
+			}
+		}
+	}
+	stats.visibleFaceCount += stats.wallCount * (options.backFaces ? 2 : 1);
+
+	// --- 上下: 行ごとに、上 (下) が空いている壁の連続をまとめる ---
+	for (int32_t mapY = 0; mapY < height; ++mapY) {
+		for (int32_t side = 0; side < 2; ++side) {
+			int32_t neighborY = side == 0 ? mapY - 1 : mapY + 1;
+			for (int32_t x = 0; x < width;) {
+				if (!isSolid(x, mapY) || isSolid(x, neighborY)) {
+					++x;
+					continue;
+				}
+				int32_t run = 1;
+				while (options.mergeFaces && isSolid(x + run, mapY) && !isSolid(x + run, neighborY)) {
+					++run;
+				}
+				stats.visibleFaceCount += run;
+				float w = static_cast<float>(run);
+				if (side == 0) {
+					AddQuad(mesh, { left(x), top(mapY), zBack }, { w * s, 0.0f, 0.0f }, { 0.0f, 0.0f, -s }, w, 1.0f, { 0.0f, 1.0f, 0.0f });
+				} else {
+					AddQuad(mesh, { left(x), top(mapY + 1), zFront }, { w * s, 0.0f, 0.0f }, { 0.0f, 0.0f, s }, w, 1.0f, { 0.0f, -1.0f, 0.0f });
+				}
+				x += run;
+			}
+		}
+	}
+
+	// --- 左右: 列ごとに、左 (右) が空いている壁の連続をまとめる ---
+	for (int32_t x = 0; x < width; ++x) {
+		for (int32_t side = 0; side < 2; ++side) {
+			int32_t neighborX = side == 0 ? x - 1 : x + 1;
+			for (int32_t mapY = 0; mapY < height;) {
+				if (!isSolid(x, mapY) || isSolid(neighborX, mapY)) {
+					++mapY;
+					continue;
+				}
+				int32_t run = 1;
+				while (options.mergeFaces && isSolid(x, mapY + run) && !isSolid(neighborX, mapY + run)) {
+					++run;
+				}
+				stats.visibleFaceCount += run;
+				float h = static_cast<float>(run);
+				if (side == 0) {
+					AddQuad(mesh, { left(x), top(mapY), zBack }, { 0.0f, 0.0f, -s }, { 0.0f, -h * s, 0.0f }, 1.0f, h, { -1.0f, 0.0f, 0.0f });
+				} else {
+					AddQuad(mesh, { left(x + 1), top(mapY), zFront }, { 0.0f, 0.0f, s }, { 0.0f, -h * s, 0.0f }, 1.0f, h, { 1.0f, 0.0f, 0.0f });
+				}
+				mapY += run;
+			}
+		}
+	}
+
+	stats.cubeTriangleCount = stats.wallCount * 12;
+	stats.triangleCount = mesh.indices.size() / 3;
+	stats.vertexCount = mesh.vertices.size();
+	return stats;
+}
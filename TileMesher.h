@@ -0,0 +1,41 @@
+#pragma once
+#include "DataTypes.h"
+#include <cstddef>
+#include <cstdint>
+
+// 壁タイルをまとめた1つのメッシュにする (Windows / D3D12 に依存しない)
+//
+// タイル1枚ごとに立方体を置く代わりに、
+//   1. 隣が壁の側面は作らない (見えない面の間引き)
+//   2. 同じ平面に並んだ面を、できるだけ大きな長方形にまとめる (greedy meshing)
+// をしてから四角形を並べる。UV はタイル単位 (1マスで 0..1) なので、まとめた面でもテクスチャは
+// マスごとに繰り返される (サンプラーは WRAP)。
+//
+// 座標は MapChip と同じで、タイル (x, mapY) は右へ +x、下へ -y に並び、z は -blockSize/2 .. +blockSize/2。
+// 配列の外は空きとして扱うので、チャンクの端の側面は隣のチャンクが壁でも残る (奥に隠れるので見た目は変わらない)。
+
+struct TileMeshOptions {
+	float blockSize = 1.0f;
+	// タイル (0, 0) の左上手前の角のワールド座標 (x, y)
+	float originX = 0.0f;
+	float originY = 0.0f;
+	// 奥 (+z) の面も作るか (カメラは常に -z 側から見るので既定では作らない)
+	bool backFaces = false;
+	// 面をまとめるか (false なら間引きだけ。比較用)
+	bool mergeFaces = true;
+};
+
+struct TileMeshStats {
+	size_t wallCount = 0;
+	size_t cubeTriangleCount = 0;   // 壁ごとに立方体 (12 三角形) を置いた場合
+	size_t visibleFaceCount = 0;    // 間引いたあとに残ったタイル単位の面
+	size_t triangleCount = 0;       // 実際に作った三角形
+	size_t vertexCount = 0;
+
+	void Accumulate(const TileMeshStats& other);
+};
+
+// 行優先 (width * height) のタイルから壁のメッシュを作る (mesh の中身は置き換える)
+// kTileWall だけを地形として扱う (kTileBlock は動くブロック側で描くので含めない)
+TileMeshStats BuildTileMesh(
+	const uint8_t* tiles, int32_t width, int32_t height, const TileMeshOptions& options, IndexedModelData& mesh);
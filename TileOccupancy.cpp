@@ -0,0 +1,129 @@
+#include "TileOccupancy.h"
+#include <algorithm>
+
+void TileOccupancy::Reset(int32_t width, int32_t height) {
+	width_ = std::max(width, 0);
+	height_ = std::max(height, 0);
+	levels_.clear();
+	if (width_ == 0 || height_ == 0) {
+		return;
+	}
+	const int32_t cellSize = 1 << kLevelShift;
+	int32_t levelWidth = width_;
+	int32_t levelHeight = height_;
+	while (true) {
+		Level level;
+		level.width = levelWidth;
+		level.height = levelHeight;
+		level.bits.assign((static_cast<size_t>(levelWidth) * levelHeight + 63) / 64, ~uint64_t(0));
+		levels_.push_back(std::move(level));
+		if (levelWidth == 1 && levelHeight == 1) {
+			break;
+		}
+		levelWidth = (levelWidth + cellSize - 1) >> kLevelShift;
+		levelHeight = (levelHeight + cellSize - 1) >> kLevelShift;
+	}
+}
+
+bool TileOccupancy::SetBit(Level& level, int32_t cellX, int32_t cellMapY, bool value) {
+	size_t index = static_cast<size_t>(cellMapY) * level.width + cellX;
+	uint64_t mask = uint64_t(1) << (index & 63);
+	uint64_t& word = level.bits[index >> 6];
+	uint64_t before = word;
+	word = value ? (word | mask) : (word & ~mask);
+	return word != before;
+}
+
+void TileOccupancy::UpdateRect(const TileGrid& grid, int32_t originX, int32_t originMapY, int32_t x0, int32_t mapY0, int32_t x1,
+	int32_t mapY1) {
+	x0 = std::max(x0, 0);
+	mapY0 = std::max(mapY0, 0);
+	x1 = std::min(x1, width_ - 1);
+	mapY1 = std::min(mapY1, height_ - 1);
+	if (levels_.empty() || x0 > x1 || mapY0 > mapY1) {
+		return;
+	}
+
+	// レベル 0 はタイルそのもの
+	const int32_t cellSize = 1 << kLevelShift;
+	int32_t cellX0 = x0;
+	int32_t cellX1 = x1;
+	int32_t cellY0 = mapY0;
+	int32_t cellY1 = mapY1;
+	bool changed = false;
+	for (int32_t mapY = mapY0; mapY <= mapY1; ++mapY) {
+		for (int32_t x = x0; x <= x1; ++x) {
+			changed = SetBit(levels_[0], x, mapY, grid.IsSolid(x - originX, mapY - originMapY)) || changed;
+		}
+	}
+
+	// 上のレベルは1つ下の 4x4 セルの OR (変わらなくなったらそこで止める)
+	for (size_t k = 1; k < levels_.size() && changed; ++k) {
+		const Level& child = levels_[k - 1];
+		Level& level = levels_[k];
+		cellX0 >>= kLevelShift;
+		cellX1 >>= kLevelShift;
+		cellY0 >>= kLevelShift;
+		cellY1 >>= kLevelShift;
+		changed = false;
+		for (int32_t cellY = cellY0; cellY <= cellY1; ++cellY) {
+			for (int32_t cellX = cellX0; cellX <= cellX1; ++cellX) {
+				bool solid = false;
+				int32_t childY1 = std::min((cellY << kLevelShift) + cellSize - 1, child.height - 1);
+				int32_t childX1 = std::min((cellX << kLevelShift) + cellSize - 1, child.width - 1);
+				for (int32_t childY = cellY << kLevelShift; childY <= childY1 && !solid; ++childY) {
+					for (int32_t childX = cellX << kLevelShift; childX <= childX1 && !solid; ++childX) {
+						solid = GetBit(child, childX, childY);
+					}
+				}
+				changed = SetBit(level, cellX, cellY, solid) || changed;
+			}
+		}
+	}
+}
+
+bool TileOccupancy::IsCellEmpty(int32_t level, int32_t cellX, int32_t cellMapY) const {
+	if (level < 0 || level >= GetLevelCount()) {
+		return false;
+	}
+	const Level& cells = levels_[level];
+	if (static_cast<uint32_t>(cellX) >= static_cast<uint32_t>(cells.width) ||
+		static_cast<uint32_t>(cellMapY) >= static_cast<uint32_t>(cells.height)) {
+		return false;
+	}
+	return !GetBit(cells, cellX, cellMapY);
+}
+
+bool TileOccupancy::IsRectEmpty(int32_t x0, int32_t mapY0, int32_t x1, int32_t mapY1) const {
+	x0 = std::max(x0, 0);
+	mapY0 = std::max(mapY0, 0);
+	x1 = std::min(x1, width_ - 1);
+	mapY1 = std::min(mapY1, height_ - 1);
+	if (levels_.empty() || x0 > x1 || mapY0 > mapY1) {
+		return true;
+	}
+	// 矩形が各方向2セル以内に収まるレベルで見る
+	int32_t span = std::max(x1 - x0, mapY1 - mapY0) + 1;
+	int32_t k = 0;
+	while (k + 1 < GetLevelCount() && (1 << (kLevelShift * k)) < span) {
+		++k;
+	}
+	const Level& level = levels_[k];
+	int32_t shift = kLevelShift * k;
+	for (int32_t cellY = mapY0 >> shift; cellY <= (mapY1 >> shift); ++cellY) {
+		for (int32_t cellX = x0 >> shift; cellX <= (x1 >> shift); ++cellX) {
+			if (GetBit(level, cellX, cellY)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+size_t TileOccupancy::GetMemoryBytes() const {
+	size_t bytes = 0;
+	for (const Level& level : levels_) {
+		bytes += level.bits.capacity() * sizeof(uint64_t);
+	}
+	return bytes;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "TileGrid.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 壁の有無を粗くまとめた階層 (Windows / D3D12 に依存しない)
+//
+// レベル 0 はタイル1つにつき1ビットの壁のマスク、レベル k のセルは 4^k 四方のタイルを表し、
+// その中に壁が1つでもあれば立つ (1つ下のレベルの 4x4 セルの OR)。
+// 光線や箱の掃引は、立っていないセルを1歩で飛び越せる。レベル 0 はチャンクを引かずに読めるので、
+// 1マスずつ進むときもビットが立っているマスだけ ChunkedTileMap に問い合わせればよい。
+// まだ数えていない場所 (読み込んでいないチャンク) は壁があるものとして扱うので、飛び越しすぎることはない。
+// 座標は ChunkedTileMap と同じ (x: 左から, mapY: 上から)。
+class TileOccupancy {
+public:
+	// 1レベル上がるごとに 4x4 のセルを1つにまとめる
+	static const int32_t kLevelShift = 2;
+
+	// 大きさを変えて、全部のセルを立てる (まだ数えていない)
+	void Reset(int32_t width, int32_t height);
+
+	// 矩形 [x0, x1] x [mapY0, mapY1] にかかるセルを数え直す (上のレベルへは変わったところだけ伝える)
+	// grid はマップの (originX, originMapY) に置かれたタイルで、矩形を含んでいること
+	// (チャンクの TileGrid とその中の矩形を渡す)
+	void UpdateRect(const TileGrid& grid, int32_t originX, int32_t originMapY, int32_t x0, int32_t mapY0, int32_t x1, int32_t mapY1);
+
+	// レベルの数 (レベル 0 から、全体が1セルになるレベルまで)
+	int32_t GetLevelCount() const { return static_cast<int32_t>(levels_.size()); }
+
+	// レベル level のセルが空か (範囲外は false)
+	bool IsCellEmpty(int32_t level, int32_t cellX, int32_t cellMapY) const;
+
+	// 光線などが1歩ごとに呼ぶものはヘッダーに置く
+
+	// (x, mapY) が壁かもしれないか (レベル 0 のビット。まだ読み込んでいない場所も true、マップの外は false)
+	bool MayBeSolid(int32_t x, int32_t mapY) const {
+		if (static_cast<uint32_t>(x) >= static_cast<uint32_t>(width_) || static_cast<uint32_t>(mapY) >= static_cast<uint32_t>(height_)) {
+			return false;
+		}
+		return GetBit(levels_[0], x, mapY);
+	}
+
+	// (x, mapY) を含む空のセルのうち一番上のレベル (レベル 1 のセルから空でなければ 0)
+	int32_t FindEmptyLevel(int32_t x, int32_t mapY) const {
+		if (static_cast<uint32_t>(x) >= static_cast<uint32_t>(width_) || static_cast<uint32_t>(mapY) >= static_cast<uint32_t>(height_)) {
+			return 0;
+		}
+		// 下のレベルが空でなければ上も空でない
+		int32_t found = 0;
+		for (int32_t k = 1; k < GetLevelCount(); ++k) {
+			int32_t shift = kLevelShift * k;
+			if (GetBit(levels_[k], x >> shift, mapY >> shift)) {
+				break;
+			}
+			found = k;
+		}
+		return found;
+	}
+
+	// 矩形に壁がないと言い切れるか (粗いセルで調べるので、false でも壁があるとは限らない。マップの外は空)
+	bool IsRectEmpty(int32_t x0, int32_t mapY0, int32_t x1, int32_t mapY1) const;
+
+	// セルのビットが使っているバイト数
+	size_t GetMemoryBytes() const;
+
+private:
+	struct Level {
+		int32_t width = 0;
+		int32_t height = 0;
+		std::vector<uint64_t> bits; // 行優先 (cellMapY * width + cellX)
+	};
+
+	static bool GetBit(const Level& level, int32_t cellX, int32_t cellMapY) {
+		size_t index = static_cast<size_t>(cellMapY) * level.width + cellX;
+		return ((level.bits[index >> 6] >> (index & 63)) & 1u) != 0;
+	}
+	// ビットを書き換え、変わったかを返す
+	static bool SetBit(Level& level, int32_t cellX, int32_t cellMapY, bool value);
+
+private:
+	int32_t width_ = 0;
+	int32_t height_ = 0;
+	// levels_[k] がレベル k
+	std::vector<Level> levels_;
+};
@@ -0,0 +1,198 @@
+#include "TileRaycast.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace {
+
+// 光線がまとめて飛び越すセルの最小のレベル (レベル 2 = 16x16 タイル)
+const int32_t kJumpLevel = 2;
+
+// 点の真下 (stepRow = -1) / 真上 (+1) の列をたどって、最初の壁の面までの距離 (タイル単位)
+float FindColumnDistance(const ChunkedTileMap& tiles, float inverseSize, const Vector2& point, int32_t stepRow, float maxTiles) {
+	const float u = point.x * inverseSize;
+	const float v = point.y * inverseSize;
+	const int32_t x = static_cast<int32_t>(std::floor(u));
+	const int32_t lastMapY = tiles.GetHeight() - 1;
+	if (static_cast<uint32_t>(x) >= static_cast<uint32_t>(tiles.GetWidth())) {
+		return maxTiles;
+	}
+	const TileOccupancy& occupancy = tiles.GetOccupancy();
+	int32_t row = static_cast<int32_t>(std::floor(v)) + stepRow;
+	while (true) {
+		// 次の行の、点に近い側の面までの距離
+		float distance = stepRow < 0 ? v - static_cast<float>(row + 1) : static_cast<float>(row) - v;
+		if (distance > maxTiles || (stepRow < 0 ? row < 0 : row > lastMapY)) {
+			return maxTiles;
+		}
+		if (row <= lastMapY && row >= 0) {
+			// 空のセルはまとめて飛ばす
+			int32_t level = occupancy.FindEmptyLevel(x, lastMapY - row);
+			if (level > 0) {
+				int32_t shift = TileOccupancy::kLevelShift * level;
+				int32_t cellMapY = ((lastMapY - row) >> shift) << shift;
+				row = stepRow < 0 ? lastMapY - cellMapY - (1 << shift) : lastMapY - cellMapY + 1;
+				continue;
+			}
+			if (occupancy.MayBeSolid(x, lastMapY - row) && tiles.IsSolid(x, lastMapY - row)) {
+				return distance;
+			}
+		}
+		row += stepRow;
+	}
+}
+
+} // namespace
+
+TileRayHit RaycastTiles(const ChunkedTileMap& tiles, float blockSize, const Vector2& origin, const Vector2& direction, float maxDistance) {
+	TileRayHit result;
+	result.distance = maxDistance > 0.0f ? maxDistance : 0.0f;
+	const float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	if (length <= 0.0f || maxDistance <= 0.0f) {
+		return result;
+	}
+	const float dirX = direction.x / length;
+	const float dirY = direction.y / length;
+	const float inverseSize = 1.0f / blockSize;
+	const float kInfinity = std::numeric_limits<float>::infinity();
+
+	// タイル単位で、行は下から数える
+	// 始点は double で割る (大きなマップで境目までの端数が丸められ、軸に近い光線で誤差が何倍にもなるのを防ぐ)
+	const double u = static_cast<double>(origin.x) / blockSize;
+	const double v = static_cast<double>(origin.y) / blockSize;
+	const float maxTiles = maxDistance * inverseSize;
+	const int32_t width = tiles.GetWidth();
+	const int32_t height = tiles.GetHeight();
+	const int32_t lastMapY = height - 1;
+	int32_t column = static_cast<int32_t>(std::floor(u));
+	int32_t row = static_cast<int32_t>(std::floor(v));
+	const int32_t stepX = dirX > 0.0f ? 1 : (dirX < 0.0f ? -1 : 0);
+	const int32_t stepY = dirY > 0.0f ? 1 : (dirY < 0.0f ? -1 : 0);
+
+	// (column, row) のタイルの、次の列・行の境目までの距離 (始点からの距離なので誤差がたまらない)
+	const double inverseDirX = stepX != 0 ? 1.0 / dirX : 0.0;
+	const double inverseDirY = stepY != 0 ? 1.0 / dirY : 0.0;
+	auto boundaryX = [&]() { return stepX != 0 ? static_cast<float>((column + (stepX > 0 ? 1 : 0) - u) * inverseDirX) : kInfinity; };
+	auto boundaryY = [&]() { return stepY != 0 ? static_cast<float>((row + (stepY > 0 ? 1 : 0) - v) * inverseDirY) : kInfinity; };
+	float nextX = boundaryX();
+	float nextY = boundaryY();
+	const float deltaX = stepX != 0 ? 1.0f / std::abs(dirX) : kInfinity;
+	const float deltaY = stepY != 0 ? 1.0f / std::abs(dirY) : kInfinity;
+	const TileOccupancy& occupancy = tiles.GetOccupancy();
+
+	float distance = 0.0f;
+	bool crossedColumn = false;
+	bool advance = true; // 始点のタイルは調べずに隣へ進む
+	// 最後に飛べるかを調べたセル (同じセルの中を進む間は調べ直さない)
+	int32_t checkedCellX = INT32_MIN;
+	int32_t checkedCellMapY = INT32_MIN;
+	while (true) {
+		if (advance) {
+			crossedColumn = nextX < nextY;
+			if (crossedColumn) {
+				distance = nextX;
+				column += stepX;
+				nextX += deltaX;
+			} else {
+				distance = nextY;
+				row += stepY;
+				nextY += deltaY;
+			}
+		}
+		advance = true;
+		if (distance > maxTiles) {
+			break;
+		}
+		// マップの外へ出ていく光線はもう壁に当たらない
+		if ((column < 0 && stepX <= 0) || (column >= width && stepX >= 0) || (row < 0 && stepY <= 0) || (row > lastMapY && stepY >= 0)) {
+			break;
+		}
+		// 空のセルにいるなら、そのセルを出るところまで一度に進む
+		// (小さなセルは飛ぶ計算の方が高くつくので、kJumpLevel より下はレベル 0 のビットを見ながら1マスずつ進む)
+		int32_t cellX = column >> (TileOccupancy::kLevelShift * kJumpLevel);
+		int32_t cellMapY = (lastMapY - row) >> (TileOccupancy::kLevelShift * kJumpLevel);
+		if (cellX != checkedCellX || cellMapY != checkedCellMapY) {
+			checkedCellX = cellX;
+			checkedCellMapY = cellMapY;
+			int32_t level = occupancy.FindEmptyLevel(column, lastMapY - row);
+			if (level >= kJumpLevel) {
+				int32_t shift = TileOccupancy::kLevelShift * level;
+				int32_t size = 1 << shift;
+				int32_t cellLeft = (column >> shift) << shift;
+				int32_t cellTop = lastMapY - (((lastMapY - row) >> shift) << shift); // セルの一番上の行
+				int32_t cellBottom = cellTop - size + 1;
+				double exitX = stepX != 0 ? ((stepX > 0 ? cellLeft + size : cellLeft) - u) * inverseDirX : kInfinity;
+				double exitY = stepY != 0 ? ((stepY > 0 ? cellTop + 1 : cellBottom) - v) * inverseDirY : kInfinity;
+				crossedColumn = exitX < exitY;
+				double exit = crossedColumn ? exitX : exitY;
+				distance = static_cast<float>(exit);
+				if (crossedColumn) {
+					column = stepX > 0 ? cellLeft + size : cellLeft - 1;
+					row = std::clamp(static_cast<int32_t>(std::floor(v + dirY * exit)), cellBottom, cellTop);
+				} else {
+					row = stepY > 0 ? cellTop + 1 : cellBottom - 1;
+					column = std::clamp(static_cast<int32_t>(std::floor(u + dirX * exit)), cellLeft, cellLeft + size - 1);
+				}
+				nextX = boundaryX();
+				nextY = boundaryY();
+				advance = false;
+				continue;
+			}
+		}
+		// ビットが立っているマス (壁か、まだ読み込んでいない) だけ本当に調べる
+		if (occupancy.MayBeSolid(column, lastMapY - row) && tiles.IsSolid(column, lastMapY - row)) {
+			result.hit = true;
+			result.distance = distance * blockSize;
+			result.point = { origin.x + dirX * result.distance, origin.y + dirY * result.distance };
+			result.normal = crossedColumn ? Vector2{ static_cast<float>(-stepX), 0.0f } : Vector2{ 0.0f, static_cast<float>(-stepY) };
+			result.tileX = column;
+			result.tileMapY = lastMapY - row;
+			return result;
+		}
+	}
+	return result;
+}
+
+bool HasTileLineOfSight(const ChunkedTileMap& tiles, float blockSize, const Vector2& from, const Vector2& to) {
+	Vector2 direction = { to.x - from.x, to.y - from.y };
+	float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	TileRayHit hit = RaycastTiles(tiles, blockSize, from, direction, length);
+	if (!hit.hit) {
+		return true;
+	}
+	// 終点のタイルに当たったのなら、そこまでは何もなかった
+	int32_t endX = static_cast<int32_t>(std::floor(static_cast<double>(to.x) / blockSize));
+	int32_t endMapY = (tiles.GetHeight() - 1) - static_cast<int32_t>(std::floor(static_cast<double>(to.y) / blockSize));
+	return hit.tileX == endX && hit.tileMapY == endMapY;
+}
+
+float GetTileGroundDistance(const ChunkedTileMap& tiles, float blockSize, const Vector2& point, float maxDistance) {
+	return FindColumnDistance(tiles, 1.0f / blockSize, point, -1, maxDistance / blockSize) * blockSize;
+}
+
+float GetTileCeilingDistance(const ChunkedTileMap& tiles, float blockSize, const Vector2& point, float maxDistance) {
+	return FindColumnDistance(tiles, 1.0f / blockSize, point, 1, maxDistance / blockSize) * blockSize;
+}
+
+void RaycastTilesBatch(const ChunkedTileMap& tiles, float blockSize, const TileRay* rays, size_t count, TileRayHit* outHits) {
+	for (size_t i = 0; i < count; ++i) {
+		outHits[i] = RaycastTiles(tiles, blockSize, rays[i].origin, rays[i].direction, rays[i].maxDistance);
+	}
+}
+
+void HasTileLineOfSightBatch(const ChunkedTileMap& tiles, float blockSize, const Vector2* from, const Vector2* to, size_t count,
+	bool* outVisible) {
+	for (size_t i = 0; i < count; ++i) {
+		outVisible[i] = HasTileLineOfSight(tiles, blockSize, from[i], to[i]);
+	}
+}
+
+void GetTileGroundDistanceBatch(const ChunkedTileMap& tiles, float blockSize, const Vector2* points, size_t count, float maxDistance,
+	float* outDistances) {
+	const float inverseSize = 1.0f / blockSize;
+	const float maxTiles = maxDistance * inverseSize;
+	for (size_t i = 0; i < count; ++i) {
+		outDistances[i] = FindColumnDistance(tiles, inverseSize, points[i], -1, maxTiles) * blockSize;
+	}
+}
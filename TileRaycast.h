@@ -0,0 +1,47 @@
+#pragma once
+#include "ChunkedTileMap.h"
+#include "MathTypes.h"
+#include <cstddef>
+#include <cstdint>
+
+// タイルの上を通る光線の問い合わせ (Windows / D3D12 に依存しない)
+//
+// 光線が通るタイルを順にたどり (グリッドの DDA)、最初の壁を返す。距離はワールド単位。
+// 始点のあるタイルは調べない (ブロックの中心から撃っても自分のマスに当たらない)。
+// 座標は MapChip と同じ (タイル x は x*blockSize から右へ、mapY は上から数え、最下段が y = 0)。
+
+struct TileRay {
+	Vector2 origin = { 0.0f, 0.0f };
+	// 向き (長さは問わない。0 なら何にも当たらない)
+	Vector2 direction = { 1.0f, 0.0f };
+	float maxDistance = 0.0f;
+};
+
+struct TileRayHit {
+	bool hit = false;
+	// 当たった面までの距離 (当たらなければ maxDistance)
+	float distance = 0.0f;
+	// 当たった面の上の点と、面の向き (光線を押し返す向き)
+	Vector2 point = { 0.0f, 0.0f };
+	Vector2 normal = { 0.0f, 0.0f };
+	// 当たったタイル (当たらなければ -1)
+	int32_t tileX = -1;
+	int32_t tileMapY = -1;
+};
+
+// origin から direction へ maxDistance までの間で最初に当たる壁
+TileRayHit RaycastTiles(const ChunkedTileMap& tiles, float blockSize, const Vector2& origin, const Vector2& direction, float maxDistance);
+
+// from と to の間に壁がないか (両端のタイルは調べない。物の中心どうしを結んでよい)
+bool HasTileLineOfSight(const ChunkedTileMap& tiles, float blockSize, const Vector2& from, const Vector2& to);
+
+// point の真下 / 真上で最初に当たる壁の面までの距離 (maxDistance までに壁がなければ maxDistance)
+float GetTileGroundDistance(const ChunkedTileMap& tiles, float blockSize, const Vector2& point, float maxDistance);
+float GetTileCeilingDistance(const ChunkedTileMap& tiles, float blockSize, const Vector2& point, float maxDistance);
+
+// まとめて問い合わせる版 (結果は入力と同じ順に outHits などへ書く)
+void RaycastTilesBatch(const ChunkedTileMap& tiles, float blockSize, const TileRay* rays, size_t count, TileRayHit* outHits);
+void HasTileLineOfSightBatch(const ChunkedTileMap& tiles, float blockSize, const Vector2* from, const Vector2* to, size_t count,
+	bool* outVisible);
+void GetTileGroundDistanceBatch(const ChunkedTileMap& tiles, float blockSize, const Vector2* points, size_t count, float maxDistance,
+	float* outDistances);
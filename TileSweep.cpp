@@ -0,0 +1,119 @@
+#include "TileSweep.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// 境目にぴったり接しているだけの辺は重なりに数えない (タイル単位)
+const float kTouchEpsilon = 1.0e-4f;
+
+// 区間 [low, high] (タイル単位) がかかるタイル番号の範囲
+// 動いている向きの端は、境目に着いたところで次のタイルも含める (ちょうど角を通る動きで取りこぼさないように)
+void GetCoveredRange(float low, float high, int32_t direction, int32_t& first, int32_t& last) {
+	first = static_cast<int32_t>(std::floor(direction < 0 ? low - kTouchEpsilon : low + kTouchEpsilon));
+	last = static_cast<int32_t>(std::ceil(direction > 0 ? high + kTouchEpsilon : high - kTouchEpsilon)) - 1;
+}
+
+} // namespace
+
+TileSweepResult SweepTileBox(const ChunkedTileMap& tiles, float blockSize, const WorldRect& box, const Vector2& delta) {
+	TileSweepResult result;
+	const float inverseSize = 1.0f / blockSize;
+	// タイル単位にする (行は下から数える)
+	const float left = box.left * inverseSize;
+	const float right = box.right * inverseSize;
+	const float bottom = box.bottom * inverseSize;
+	const float top = box.top * inverseSize;
+	const float du = delta.x * inverseSize;
+	const float dv = delta.y * inverseSize;
+	const int32_t stepX = du > 0.0f ? 1 : (du < 0.0f ? -1 : 0);
+	const int32_t stepY = dv > 0.0f ? 1 : (dv < 0.0f ? -1 : 0);
+	const int32_t lastMapY = tiles.GetHeight() - 1;
+	const float kInfinity = std::numeric_limits<float>::infinity();
+
+	// 通り道全体を囲む矩形に壁がなければ調べるまでもない (広い空間を長く動くときの近道)
+	{
+		int32_t first, last, rowFirst, rowLast;
+		GetCoveredRange(std::min(left, left + du), std::max(right, right + du), stepX, first, last);
+		GetCoveredRange(std::min(bottom, bottom + dv), std::max(top, top + dv), stepY, rowFirst, rowLast);
+		if (tiles.GetOccupancy().IsRectEmpty(first, lastMapY - rowLast, last, lastMapY - rowFirst)) {
+			return result;
+		}
+	}
+
+	// 次に入る列と、その境目に前の辺が着く時刻
+	int32_t column = 0;
+	float timeX = kInfinity;
+	if (stepX != 0) {
+		int32_t first, last;
+		GetCoveredRange(left, right, 0, first, last);
+		column = stepX > 0 ? last + 1 : first - 1;
+		timeX = ((stepX > 0 ? static_cast<float>(column) : static_cast<float>(column + 1)) - (stepX > 0 ? right : left)) / du;
+	}
+	int32_t row = 0;
+	float timeY = kInfinity;
+	if (stepY != 0) {
+		int32_t first, last;
+		GetCoveredRange(bottom, top, 0, first, last);
+		row = stepY > 0 ? last + 1 : first - 1;
+		timeY = ((stepY > 0 ? static_cast<float>(row) : static_cast<float>(row + 1)) - (stepY > 0 ? top : bottom)) / dv;
+	}
+	const float timeDeltaX = stepX != 0 ? 1.0f / std::abs(du) : kInfinity;
+	const float timeDeltaY = stepY != 0 ? 1.0f / std::abs(dv) : kInfinity;
+
+	while (true) {
+		bool enterColumn = timeX <= timeY;
+		float time = std::max(enterColumn ? timeX : timeY, 0.0f);
+		if (time > 1.0f) {
+			break;
+		}
+
+		if (enterColumn) {
+			// 新しく入る列のうち、その時刻に箱がかかる行
+			int32_t row0, row1;
+			GetCoveredRange(bottom + dv * time, top + dv * time, stepY, row0, row1);
+			if (row0 <= row1 && tiles.IsColumnSolid(column, lastMapY - row1, lastMapY - row0)) {
+				// 箱の中心に近い壁を当たったタイルにする
+				float center = (bottom + top) * 0.5f + dv * time;
+				float bestDistance = kInfinity;
+				for (int32_t r = row0; r <= row1; ++r) {
+					float distance = std::abs(static_cast<float>(r) + 0.5f - center);
+					if (tiles.IsSolid(column, lastMapY - r) && distance < bestDistance) {
+						bestDistance = distance;
+						result.tileX = column;
+						result.tileMapY = lastMapY - r;
+					}
+				}
+				result.hit = true;
+				result.time = time;
+				result.normal = { static_cast<float>(-stepX), 0.0f };
+				return result;
+			}
+			column += stepX;
+			timeX += timeDeltaX;
+		} else {
+			int32_t column0, column1;
+			GetCoveredRange(left + du * time, right + du * time, stepX, column0, column1);
+			if (column0 <= column1 && tiles.IsSpanSolid(lastMapY - row, column0, column1)) {
+				float center = (left + right) * 0.5f + du * time;
+				float bestDistance = kInfinity;
+				for (int32_t c = column0; c <= column1; ++c) {
+					float distance = std::abs(static_cast<float>(c) + 0.5f - center);
+					if (tiles.IsSolid(c, lastMapY - row) && distance < bestDistance) {
+						bestDistance = distance;
+						result.tileX = c;
+						result.tileMapY = lastMapY - row;
+					}
+				}
+				result.hit = true;
+				result.time = time;
+				result.normal = { 0.0f, static_cast<float>(-stepY) };
+				return result;
+			}
+			row += stepY;
+			timeY += timeDeltaY;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "ChunkedTileMap.h"
+#include "MathTypes.h"
+#include <cstdint>
+
+// 動く箱とタイルの連続的な当たり判定 (Windows / D3D12 に依存しない)
+//
+// 箱を delta だけ動かす間に新しくかかる列・行だけを順に調べ (グリッドの DDA)、最初に壁へ入る時刻を返す。
+// 1ステップで何マス進んでも途中の壁を飛び越さない。動き出す前から重なっている壁は無視する
+// (めり込んだ状態からは外へ出られる)。
+// 座標は MapChip と同じ (タイル x は x*blockSize から右へ、mapY は上から数え、最下段が y = 0)。
+
+struct TileSweepResult {
+	bool hit = false;
+	// 当たるまでに進める割合 (0..1。当たらなければ 1)
+	float time = 1.0f;
+	// 当たった面の向き (箱を押し返す向き。当たらなければ 0)
+	Vector2 normal = { 0.0f, 0.0f };
+	// 当たったタイル (当たらなければ -1)
+	int32_t tileX = -1;
+	int32_t tileMapY = -1;
+};
+
+TileSweepResult SweepTileBox(const ChunkedTileMap& tiles, float blockSize, const WorldRect& box, const Vector2& delta);
@@ -1,21 +1,18 @@
 #include "Trap.h"
+#include "StateHash.h"
 #include <cmath> // std::abs
 #include <cassert> // assert
 
-Trap::~Trap() {
-    delete wall_;
-}
-
-void Trap::Initialize(ID3D12Device* device, float triggerY, AttackSide side, float stopMargin) {
-    wall_ = Model::Create("Resources/cube", "cube.obj", device);
-    wallHalfSize_ = MapChip::kBlockSize / 2.0f;
-    wall_->transform.scale = { MapChip::kBlockSize, MapChip::kBlockSize, MapChip::kBlockSize };
+void Trap::Initialize(GameMap* map, float triggerY, AttackSide side, float stopMargin) {
+    wallHalfSize_ = GameMap::kBlockSize / 2.0f;
+    wallTransform_.scale = { GameMap::kBlockSize, GameMap::kBlockSize, GameMap::kBlockSize };
     trapY_ = triggerY;
     side_ = side;
     stopMargin_ = stopMargin;
-    mapWidth_ = 20.0f * MapChip::kBlockSize;
-    offscreenMargin_ = MapChip::kBlockSize * 3.0f;
+    mapWidth_ = 20.0f * GameMap::kBlockSize;
+    offscreenMargin_ = GameMap::kBlockSize * 3.0f;
     Reset();
+    objectId_ = map->AddObject(GameMap::kTrapObjectType, wallTransform_.translate);
 }
 
 void Trap::Reset() {
@@ -23,23 +20,24 @@ void Trap::Reset() {
     waitTimer_ = 0.0f;
     isPlayerInZone_ = false;
     if (side_ == AttackSide::FromLeft) {
-        wall_->transform.translate = { -offscreenMargin_, trapY_, 0.0f };
+        wallTransform_.translate = { -offscreenMargin_, trapY_, 0.0f };
     } else {
-        wall_->transform.translate = { mapWidth_ + offscreenMargin_, trapY_, 0.0f };
+        wallTransform_.translate = { mapWidth_ + offscreenMargin_, trapY_, 0.0f };
     }
+    previousTranslate_ = wallTransform_.translate;
 }
 
-void Trap::Update(Player* player) {
+void Trap::Update(Player* player, GameMap* map) {
+    previousTranslate_ = wallTransform_.translate;
     if (currentState_ == State::Finished) { return; }
 
     const Vector3& playerPos = player->GetPosition();
-    Vector3& wallPos = wall_->transform.translate;
-    const float kDeltaTime = 1.0f / 60.0f;
+    Vector3& wallPos = wallTransform_.translate;
 
     bool wasInZone = isPlayerInZone_;
     // ゾーン判定はプレイヤーが生きている時だけ行う
     if (player->IsAlive()) {
-        isPlayerInZone_ = (std::abs(playerPos.y - trapY_) < MapChip::kBlockSize * 0.5f);
+        isPlayerInZone_ = (std::abs(playerPos.y - trapY_) < GameMap::kBlockSize * 0.5f);
     }
 
     switch (currentState_) {
@@ -47,7 +45,7 @@ void Trap::Update(Player* player) {
     {
         if (player->IsAlive() && isPlayerInZone_ && !wasInZone) {
             currentState_ = State::Attacking;
-            bool isShortTrap = (stopMargin_ < (MapChip::kBlockSize * 0.8f));
+            bool isShortTrap = (stopMargin_ < (GameMap::kBlockSize * 0.8f));
             if (side_ == AttackSide::FromLeft) {
                 startX_ = -offscreenMargin_;
                 if (isShortTrap) {
@@ -95,7 +93,7 @@ void Trap::Update(Player* player) {
         break;
 
     case State::Waiting:
-        waitTimer_ -= kDeltaTime;
+        waitTimer_ -= kTickSeconds;
         if (waitTimer_ <= 0.0f) { currentState_ = State::Returning; }
 
         // ★修正点：待機中でも死亡させるだけにする（即座に帰らせない）
@@ -124,12 +122,7 @@ void Trap::Update(Player* player) {
     case State::Finished:
         break;
     }
-}
-
-void Trap::Draw(ID3D12GraphicsCommandList* commandList, const Matrix4x4& viewProjectionMatrix, D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress, D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandle) {
-    if (currentState_ != State::Idle && currentState_ != State::Finished) {
-        wall_->Draw(commandList, viewProjectionMatrix, lightGpuAddress, textureSrvHandle);
-    }
+    map->MoveObject(objectId_, wallPos);
 }
 
 bool Trap::CheckCollision(Player* player) {
@@ -139,11 +132,18 @@ bool Trap::CheckCollision(Player* player) {
     float pRight = pPos.x + pSize;
     float pTop = pPos.y + pSize;
     float pBottom = pPos.y - pSize;
-    Vector3 wPos = wall_->transform.translate;
+    Vector3 wPos = wallTransform_.translate;
     float wLeft = wPos.x - wallHalfSize_;
     float wRight = wPos.x + wallHalfSize_;
     float wTop = wPos.y + wallHalfSize_;
     float wBottom = wPos.y - wallHalfSize_;
     if (pLeft > wRight || pRight < wLeft || pTop < wBottom || pBottom > wTop) { return false; }
     return true;
+}
+
+void Trap::AddState(StateHasher& hasher) const {
+    hasher.Add(static_cast<uint32_t>(currentState_) | static_cast<uint32_t>(isPlayerInZone_) << 8);
+    hasher.Add(wallTransform_.translate);
+    hasher.Add(targetX_);
+    hasher.Add(waitTimer_);
 }
\ No newline at end of file
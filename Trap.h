@@ -1,7 +1,8 @@
 #pragma once
-#include "Model.h"
+#include "MathTypes.h"
 #include "Player.h" // Playerの情報を参照するため
-#include "MapChip.h"  // kBlockSize を参照するため
+#include "GameMap.h"  // kBlockSize を参照するため
+#include "FixedTimestep.h"
 
 class Trap {
 public:
@@ -11,24 +12,24 @@ public:
         FromRight
     };
 
-    ~Trap(); // デストラクタでモデルを解放
+    // 初期化 (作動Y座標, 攻撃方向, 停止マージン。map の位置の索引に登録する)
+    void Initialize(GameMap* map, float triggerY, AttackSide side, float stopMargin);
 
-    // 初期化 (作動Y座標, 攻撃方向, 停止マージン)
-    void Initialize(ID3D12Device* device, float triggerY, AttackSide side, float stopMargin);
+    // 更新 (動いたら索引を書き換える)
+    void Update(Player* player, GameMap* map);
 
-    // 更新
-    void Update(Player* player);
-
-    // 描画
-    void Draw(
-        ID3D12GraphicsCommandList* commandList,
-        const Matrix4x4& viewProjectionMatrix,
-        D3D12_GPU_VIRTUAL_ADDRESS lightGpuAddress,
-        D3D12_GPU_DESCRIPTOR_HANDLE textureSrvHandle); // main から cube.jpg のハンドルを受け取る
+    // 描画用 (待機中と完了後は画面外にいるので描かない。メッシュは描く側が持つ)
+    bool IsVisible() const { return currentState_ != State::Idle && currentState_ != State::Finished; }
+    const Transform& GetTransform() const { return wallTransform_; }
+    Transform GetRenderTransform(float alpha) const { return InterpolateTransform(previousTranslate_, wallTransform_, alpha); }
 
     // リセット
     void Reset();
 
+    const Vector3& GetPosition() const { return wallTransform_.translate; }
+    // 状態・位置・止まる位置・タイマーをハッシュに足す
+    void AddState(StateHasher& hasher) const;
+
 private:
     // AABB (軸並行境界ボックス) での当たり判定
     bool CheckCollision(Player* player);
@@ -46,10 +47,13 @@ private:
     // このトラップの攻撃方向 (Initializeで設定)
     AttackSide side_ = AttackSide::FromLeft;
 
-    // 落下してくる壁モデル (1つ)
-    Model* wall_ = nullptr;
+    // 落下してくる壁 (Transformだけ持つ)
+    Transform wallTransform_{};
+    Vector3 previousTranslate_{}; // 前のティックの位置 (描画の補間用)
+    // GameMap の位置の索引での番号
+    int32_t objectId_ = -1;
 
-    // 壁の当たり判定サイズ (MapChip::kBlockSize と同じ)
+    // 壁の当たり判定サイズ (GameMap::kBlockSize と同じ)
     float wallHalfSize_ = 0.0f;
 
     // --- 動作パラメータ ---
@@ -0,0 +1,110 @@
+#include "UploadBufferAllocator.h"
+#include "D3D12Util.h"
+#include <cassert>
+#include <string>
+#include <Windows.h> // OutputDebugStringA
+
+UploadBufferAllocator* UploadBufferAllocator::GetInstance() {
+	static UploadBufferAllocator instance;
+	return &instance;
+}
+
+void UploadBufferAllocator::Initialize(ID3D12Device* device) {
+	device_ = device;
+}
+
+void UploadBufferAllocator::Finalize() {
+	if (allocator_.GetLiveAllocationCount() != 0) {
+		std::string message = "[UploadBufferAllocator] " + std::to_string(allocator_.GetLiveAllocationCount()) + " buffers still allocated at shutdown\n";
+		OutputDebugStringA(message.c_str());
+	}
+	dedicatedResources_.clear();
+	pages_.clear();
+	heaps_.clear();
+	allocator_.Reset();
+	device_ = nullptr;
+}
+
+UploadBuffer UploadBufferAllocator::Allocate(uint64_t sizeInBytes, uint64_t alignment) {
+	assert(device_ != nullptr);
+	UploadBuffer buffer;
+	SizeClassAllocator::Allocation allocation = allocator_.Allocate(sizeInBytes, alignment);
+	if (!allocation.IsValid()) {
+		return buffer;
+	}
+
+	if (allocation.IsDedicated()) {
+		// ページに収まらない大きさは従来どおりコミットリソースにする
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource = CreateBufferResource(device_, static_cast<size_t>(sizeInBytes));
+		resource->Map(0, nullptr, reinterpret_cast<void**>(&buffer.cpuAddress));
+		buffer.resource = resource.Get();
+		buffer.gpuAddress = resource->GetGPUVirtualAddress();
+		dedicatedResources_.emplace(resource.Get(), resource);
+	} else {
+		if (allocation.page >= pages_.size() && !CreatePage(allocation.page)) {
+			allocator_.Free(allocation);
+			return buffer;
+		}
+		Page& page = pages_[allocation.page];
+		buffer.resource = page.resource.Get();
+		buffer.cpuAddress = page.cpuAddress + allocation.offset;
+		buffer.gpuAddress = page.resource->GetGPUVirtualAddress() + allocation.offset;
+	}
+	buffer.allocation = allocation;
+	return buffer;
+}
+
+void UploadBufferAllocator::Free(UploadBuffer& buffer) {
+	if (!buffer.IsValid()) {
+		return;
+	}
+	if (buffer.allocation.IsDedicated()) {
+		dedicatedResources_.erase(buffer.resource);
+	}
+	allocator_.Free(buffer.allocation);
+	buffer = UploadBuffer();
+}
+
+bool UploadBufferAllocator::CreatePage(uint32_t page) {
+	// ページは順番に作られるので、要求されたページは常に末尾
+	assert(page == pages_.size());
+
+	uint32_t pageInHeap = page % kPagesPerHeap;
+	if (pageInHeap == 0) {
+		D3D12_HEAP_DESC heapDesc{};
+		heapDesc.SizeInBytes = SizeClassAllocator::kPageSize * kPagesPerHeap;
+		heapDesc.Properties.Type = D3D12_HEAP_TYPE_UPLOAD;
+		heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+		Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+		HRESULT hr = device_->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap));
+		if (FAILED(hr)) {
+			OutputDebugStringA("[UploadBufferAllocator] CreateHeap failed\n");
+			assert(false);
+			return false;
+		}
+		heaps_.push_back(heap);
+	}
+
+	D3D12_RESOURCE_DESC resourceDesc{};
+	resourceDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	resourceDesc.Width = SizeClassAllocator::kPageSize;
+	resourceDesc.Height = 1;
+	resourceDesc.DepthOrArraySize = 1;
+	resourceDesc.MipLevels = 1;
+	resourceDesc.SampleDesc.Count = 1;
+	resourceDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	Page newPage;
+	HRESULT hr = device_->CreatePlacedResource(
+		heaps_.back().Get(), SizeClassAllocator::kPageSize * pageInHeap, &resourceDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&newPage.resource));
+	if (FAILED(hr)) {
+		OutputDebugStringA("[UploadBufferAllocator] CreatePlacedResource failed\n");
+		assert(false);
+		return false;
+	}
+	newPage.resource->Map(0, nullptr, reinterpret_cast<void**>(&newPage.cpuAddress));
+	pages_.push_back(newPage);
+	return true;
+}
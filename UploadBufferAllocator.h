@@ -0,0 +1,64 @@
+#pragma once
+#include "SizeClassAllocator.h"
+#include <d3d12.h>
+#include <wrl.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// UploadBufferAllocator から切り出したバッファ
+struct UploadBuffer {
+	ID3D12Resource* resource = nullptr; // ページ (または専用リソース)
+	uint8_t* cpuAddress = nullptr;      // 常にMapされている
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+	SizeClassAllocator::Allocation allocation;
+
+	bool IsValid() const { return resource != nullptr; }
+	uint64_t GetSize() const { return allocation.requestedSize; }
+};
+
+// 小さなアップロードバッファをまとめて確保するクラス
+// ヒープに64KiBのページを配置し、その中をサイズクラスごとに切り分けて返す
+class UploadBufferAllocator {
+public:
+	// 1つのヒープに置くページ数 (1MiB)
+	static const uint32_t kPagesPerHeap = 16;
+
+	// シングルトンインスタンスの取得
+	static UploadBufferAllocator* GetInstance();
+
+	// 初期化
+	void Initialize(ID3D12Device* device);
+
+	// 終了処理 (全てのヒープとページを解放する)
+	void Finalize();
+
+	// 確保 (アドレスは alignment の倍数になる。既定はCBVの256バイト)
+	UploadBuffer Allocate(uint64_t sizeInBytes, uint64_t alignment = 256);
+
+	// 解放 (GPUが使い終わってから呼ぶこと)
+	void Free(UploadBuffer& buffer);
+
+	const SizeClassAllocator& GetStats() const { return allocator_; }
+
+private:
+	UploadBufferAllocator() = default;
+	~UploadBufferAllocator() = default;
+	UploadBufferAllocator(const UploadBufferAllocator&) = delete;
+	const UploadBufferAllocator& operator=(const UploadBufferAllocator&) = delete;
+
+	// ページが足りなければヒープとページのリソースを作る
+	bool CreatePage(uint32_t page);
+
+private:
+	struct Page {
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+		uint8_t* cpuAddress = nullptr;
+	};
+
+	ID3D12Device* device_ = nullptr;
+	SizeClassAllocator allocator_;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> heaps_;
+	std::vector<Page> pages_;
+	std::unordered_map<ID3D12Resource*, Microsoft::WRL::ComPtr<ID3D12Resource>> dedicatedResources_;
+};
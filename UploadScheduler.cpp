@@ -0,0 +1,58 @@
+#include "UploadScheduler.h"
+#include <algorithm>
+#include <cstring>
+
+void UploadScheduler::Initialize(uint8_t* stagingMemory, uint64_t capacity) {
+	stagingMemory_ = stagingMemory;
+	ring_.Initialize(capacity);
+	pending_.clear();
+}
+
+bool UploadScheduler::Enqueue(uint32_t destination, uint64_t destinationOffset, const void* data, uint64_t size) {
+	if (!stagingMemory_ || size == 0) {
+		return false;
+	}
+
+	uint64_t stagingOffset = ring_.Allocate(size, kStagingAlignment);
+	if (stagingOffset == RingAllocator::kInvalidOffset) {
+		return false;
+	}
+	std::memcpy(stagingMemory_ + stagingOffset, data, static_cast<size_t>(size));
+
+	BufferCopyCommand command;
+	command.destination = destination;
+	command.destinationOffset = destinationOffset;
+	command.stagingOffset = stagingOffset;
+	command.size = size;
+	pending_.push_back(command);
+	return true;
+}
+
+void UploadScheduler::Flush(CopyCommandStream& stream) {
+	if (pending_.empty()) {
+		return;
+	}
+
+	for (const BufferCopyCommand& command : pending_) {
+		stream.copies.push_back(command);
+		if (std::find(stream.destinations.begin(), stream.destinations.end(), command.destination) == stream.destinations.end()) {
+			stream.destinations.push_back(command.destination);
+		}
+		totalUploadedBytes_ += command.size;
+	}
+	totalCopyCount_ += static_cast<uint32_t>(pending_.size());
+	++flushCount_;
+	pending_.clear();
+}
+
+void UploadScheduler::BeginFrame(uint64_t completedFenceValue) {
+	ring_.ReleaseCompletedFrames(completedFenceValue);
+}
+
+void UploadScheduler::EndFrame(uint64_t fenceValue) {
+	// まだ命令列に書き出していないコピーがあれば、その分も含めて次のフレームで締める
+	if (!pending_.empty()) {
+		return;
+	}
+	ring_.FinishFrame(fenceValue);
+}
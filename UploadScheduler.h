@@ -0,0 +1,62 @@
+#pragma once
+#include "RingAllocator.h"
+#include <cstdint>
+#include <vector>
+
+// ステージング領域から転送先バッファへの1回分のコピー
+struct BufferCopyCommand {
+	uint32_t destination = 0;       // 転送先バッファのID
+	uint64_t destinationOffset = 0;
+	uint64_t stagingOffset = 0;     // ステージング領域の先頭からのオフセット
+	uint64_t size = 0;
+};
+
+// まとめて発行するコピー命令の列 (D3D12 でも記録だけでも再生できる)
+struct CopyCommandStream {
+	std::vector<BufferCopyCommand> copies;
+	// コピー後に読み取り状態へ戻すバッファ (重複なし・最初に現れた順)
+	std::vector<uint32_t> destinations;
+
+	void Clear() {
+		copies.clear();
+		destinations.clear();
+	}
+};
+
+// 静的データの転送をまとめる (GPUに依存しない部分)
+// データはステージング領域のリングにコピーしておき、Flush でコピー命令の列として取り出す。
+// ステージング領域はそのフレームのフェンスをGPUが通過するまで再利用しない。
+class UploadScheduler {
+public:
+	// 初期化 (ステージング領域は呼び出し側が用意して、破棄までMapしたままにしておく)
+	void Initialize(uint8_t* stagingMemory, uint64_t capacity);
+
+	// 転送を予約する (ステージング領域が足りなければ false)
+	bool Enqueue(uint32_t destination, uint64_t destinationOffset, const void* data, uint64_t size);
+
+	// 予約済みのコピーを命令列に書き出す
+	void Flush(CopyCommandStream& stream);
+
+	// フレームの開始・終了 (ステージング領域の再利用をフェンスで管理する)
+	void BeginFrame(uint64_t completedFenceValue);
+	void EndFrame(uint64_t fenceValue);
+
+	bool HasPendingCopies() const { return !pending_.empty(); }
+
+	// 統計情報
+	uint64_t GetTotalUploadedBytes() const { return totalUploadedBytes_; }
+	uint32_t GetTotalCopyCount() const { return totalCopyCount_; }
+	uint32_t GetFlushCount() const { return flushCount_; }
+	const RingAllocator& GetStagingRing() const { return ring_; }
+
+private:
+	// コピー元の配置 (16バイトあれば十分)
+	static const uint64_t kStagingAlignment = 16;
+
+	uint8_t* stagingMemory_ = nullptr;
+	RingAllocator ring_;
+	std::vector<BufferCopyCommand> pending_;
+	uint64_t totalUploadedBytes_ = 0;
+	uint32_t totalCopyCount_ = 0;
+	uint32_t flushCount_ = 0;
+};
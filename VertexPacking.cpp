@@ -0,0 +1,204 @@
+#include "VertexPacking.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const double kRadiansToDegrees = 57.29577951308232;
+
+float SignNotZero(float value) { return value >= 0.0f ? 1.0f : -1.0f; }
+
+// [-1, 1] を SNORM16 に (D3D の規則: -32768 と -32767 はどちらも -1)
+float SnormToFloat(int16_t value) { return std::max(static_cast<float>(value) / 32767.0f, -1.0f); }
+
+float Length(const Vector3& v) { return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z); }
+
+// 2つのベクトルのなす角 (度)
+// acos だと float では 0.02 度より細かく測れないので、外積と内積の atan2 を double で求める
+float AngleDegrees(const Vector3& a, const Vector3& b) {
+	double crossX = static_cast<double>(a.y) * b.z - static_cast<double>(a.z) * b.y;
+	double crossY = static_cast<double>(a.z) * b.x - static_cast<double>(a.x) * b.z;
+	double crossZ = static_cast<double>(a.x) * b.y - static_cast<double>(a.y) * b.x;
+	double dot = static_cast<double>(a.x) * b.x + static_cast<double>(a.y) * b.y + static_cast<double>(a.z) * b.z;
+	double sine = std::sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ);
+	return static_cast<float>(std::atan2(sine, dot) * kRadiansToDegrees);
+}
+
+} // namespace
+
+uint16_t FloatToHalf(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000u;
+	uint32_t exponent = (bits >> 23) & 0xFFu;
+	uint32_t mantissa = bits & 0x7FFFFFu;
+
+	// NaN / 無限大
+	if (exponent == 0xFFu) {
+		return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+	}
+
+	int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+	if (halfExponent >= 0x1F) {
+		return static_cast<uint16_t>(sign | 0x7C00u);
+	}
+	if (halfExponent <= 0) {
+		// 非正規化数 (小さすぎるものは 0)
+		if (halfExponent < -10) {
+			return static_cast<uint16_t>(sign);
+		}
+		mantissa |= 0x800000u;
+		uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+		uint32_t halfMantissa = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1u);
+		uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (halfMantissa & 1u))) {
+			++halfMantissa;
+		}
+		return static_cast<uint16_t>(sign | halfMantissa);
+	}
+
+	uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+	uint32_t remainder = mantissa & 0x1FFFu;
+	// 繰り上がりで指数が1つ増えても (無限大になっても) そのまま正しい
+	if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+		++half;
+	}
+	return static_cast<uint16_t>(half);
+}
+
+float HalfToFloat(uint16_t value) {
+	uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+	uint32_t exponent = (value >> 10) & 0x1Fu;
+	uint32_t mantissa = value & 0x3FFu;
+
+	uint32_t bits;
+	if (exponent == 0x1Fu) {
+		bits = sign | 0x7F800000u | (mantissa << 13);
+	} else if (exponent != 0) {
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	} else if (mantissa == 0) {
+		bits = sign;
+	} else {
+		// 非正規化数を正規化する
+		int32_t shift = 0;
+		while ((mantissa & 0x400u) == 0) {
+			mantissa <<= 1;
+			++shift;
+		}
+		bits = sign | (static_cast<uint32_t>(127 - 15 + 1 - shift) << 23) | ((mantissa & 0x3FFu) << 13);
+	}
+	float result;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+void EncodeOctahedralNormal(const Vector3& normal, int16_t encoded[2]) {
+	float sum = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+	if (sum == 0.0f) {
+		// 長さ0の法線は +Z として扱う
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+	float u = normal.x / sum;
+	float v = normal.y / sum;
+	if (normal.z < 0.0f) {
+		// 下半球は対角線で折り返す
+		float foldedU = (1.0f - std::fabs(v)) * SignNotZero(u);
+		float foldedV = (1.0f - std::fabs(u)) * SignNotZero(v);
+		u = foldedU;
+		v = foldedV;
+	}
+
+	// 切り捨て・切り上げの組み合わせから一番近いものを選ぶ
+	float scaledU = std::clamp(u, -1.0f, 1.0f) * 32767.0f;
+	float scaledV = std::clamp(v, -1.0f, 1.0f) * 32767.0f;
+	encoded[0] = 0;
+	encoded[1] = 0;
+	float bestError = 2.0f;
+	for (int32_t i = 0; i < 4; ++i) {
+		float candidateU = (i & 1) ? std::ceil(scaledU) : std::floor(scaledU);
+		float candidateV = (i & 2) ? std::ceil(scaledV) : std::floor(scaledV);
+		int16_t candidate[2] = { static_cast<int16_t>(candidateU), static_cast<int16_t>(candidateV) };
+		Vector3 decoded = DecodeOctahedralNormal(candidate);
+		float error = 1.0f - (decoded.x * normal.x + decoded.y * normal.y + decoded.z * normal.z) / Length(normal);
+		if (error < bestError) {
+			bestError = error;
+			encoded[0] = candidate[0];
+			encoded[1] = candidate[1];
+		}
+	}
+}
+
+Vector3 DecodeOctahedralNormal(const int16_t encoded[2]) {
+	float u = SnormToFloat(encoded[0]);
+	float v = SnormToFloat(encoded[1]);
+	Vector3 normal = { u, v, 1.0f - std::fabs(u) - std::fabs(v) };
+	float t = std::max(-normal.z, 0.0f);
+	normal.x += normal.x >= 0.0f ? -t : t;
+	normal.y += normal.y >= 0.0f ? -t : t;
+	float length = Length(normal);
+	return { normal.x / length, normal.y / length, normal.z / length };
+}
+
+CompactVertexData PackVertex(const VertexData& vertex) {
+	CompactVertexData result;
+	result.position[0] = vertex.position.x;
+	result.position[1] = vertex.position.y;
+	result.position[2] = vertex.position.z;
+	result.texcoord[0] = FloatToHalf(vertex.texcoord.x);
+	result.texcoord[1] = FloatToHalf(vertex.texcoord.y);
+	EncodeOctahedralNormal(vertex.normal, result.normal);
+	return result;
+}
+
+VertexData UnpackVertex(const CompactVertexData& vertex) {
+	VertexData result;
+	result.position = { vertex.position[0], vertex.position[1], vertex.position[2], 1.0f };
+	result.texcoord = { HalfToFloat(vertex.texcoord[0]), HalfToFloat(vertex.texcoord[1]) };
+	result.normal = DecodeOctahedralNormal(vertex.normal);
+	return result;
+}
+
+void PackVertices(const std::vector<VertexData>& source, std::vector<CompactVertexData>& result) {
+	result.resize(source.size());
+	for (size_t i = 0; i < source.size(); ++i) {
+		result[i] = PackVertex(source[i]);
+	}
+}
+
+VertexPackingError MeasureVertexPackingError(const std::vector<VertexData>& vertices) {
+	VertexPackingError error;
+	error.vertexCount = vertices.size();
+	double normalErrorSum = 0.0;
+	for (const VertexData& vertex : vertices) {
+		VertexData decoded = UnpackVertex(PackVertex(vertex));
+
+		if (vertex.position.w != 1.0f) {
+			++error.nonUnitWCount;
+		}
+		float positionError = std::max({ std::fabs(decoded.position.x - vertex.position.x),
+			std::fabs(decoded.position.y - vertex.position.y), std::fabs(decoded.position.z - vertex.position.z) });
+		error.maxPositionError = std::max(error.maxPositionError, positionError);
+
+		const float source[2] = { vertex.texcoord.x, vertex.texcoord.y };
+		const float result[2] = { decoded.texcoord.x, decoded.texcoord.y };
+		for (int32_t i = 0; i < 2; ++i) {
+			float texcoordError = std::fabs(result[i] - source[i]);
+			error.maxTexcoordError = std::max(error.maxTexcoordError, texcoordError);
+			if (source[i] != 0.0f) {
+				error.maxTexcoordRelativeError = std::max(error.maxTexcoordRelativeError, texcoordError / std::fabs(source[i]));
+			}
+		}
+
+		float normalError = AngleDegrees(vertex.normal, decoded.normal);
+		error.maxNormalErrorDegrees = std::max(error.maxNormalErrorDegrees, normalError);
+		normalErrorSum += normalError;
+	}
+	if (!vertices.empty()) {
+		error.meanNormalErrorDegrees = static_cast<float>(normalErrorSum / static_cast<double>(vertices.size()));
+	}
+	return error;
+}
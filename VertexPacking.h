@@ -0,0 +1,37 @@
+#pragma once
+#include "DataTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 頂点の圧縮と展開 (Windows / D3D12 に依存しない)
+// 展開はシェーダー (Object3d.VS.hlsl) と同じ計算をする
+
+// half (IEEE 754 binary16) との変換 (最近接偶数丸め・範囲外は無限大)
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+
+// 単位ベクトルを八面体写像で 16bit SNORM 2つにする
+// 丸め方の4通りから展開後の誤差が最小のものを選ぶ
+void EncodeOctahedralNormal(const Vector3& normal, int16_t encoded[2]);
+Vector3 DecodeOctahedralNormal(const int16_t encoded[2]);
+
+// 1頂点の圧縮・展開
+CompactVertexData PackVertex(const VertexData& vertex);
+VertexData UnpackVertex(const CompactVertexData& vertex);
+
+void PackVertices(const std::vector<VertexData>& source, std::vector<CompactVertexData>& result);
+
+// 圧縮による誤差
+struct VertexPackingError {
+	size_t vertexCount = 0;
+	size_t nonUnitWCount = 0;         // 位置の w が 1 でない頂点 (圧縮すると失われる)
+	float maxPositionError = 0.0f;
+	float maxTexcoordError = 0.0f;    // 絶対誤差
+	float maxTexcoordRelativeError = 0.0f; // |uv| で割った誤差 (half の精度は値の大きさに比例する)
+	float maxNormalErrorDegrees = 0.0f;
+	float meanNormalErrorDegrees = 0.0f;
+};
+
+// 圧縮して展開し直したときの誤差を測る
+VertexPackingError MeasureVertexPackingError(const std::vector<VertexData>& vertices);
@@ -0,0 +1,70 @@
+#include "ViewCulling.h"
+#include "MathUtil.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// NDC の点をワールド座標に戻す
+bool Unproject(const Matrix4x4& inverse, float x, float y, float z, Vector3& out) {
+	float wx = x * inverse.m[0][0] + y * inverse.m[1][0] + z * inverse.m[2][0] + inverse.m[3][0];
+	float wy = x * inverse.m[0][1] + y * inverse.m[1][1] + z * inverse.m[2][1] + inverse.m[3][1];
+	float wz = x * inverse.m[0][2] + y * inverse.m[1][2] + z * inverse.m[2][2] + inverse.m[3][2];
+	float w = x * inverse.m[0][3] + y * inverse.m[1][3] + z * inverse.m[2][3] + inverse.m[3][3];
+	if (std::abs(w) < 1e-12f) {
+		return false;
+	}
+	out = { wx / w, wy / w, wz / w };
+	return true;
+}
+
+// float の座標をタイル番号に (大きすぎる値で int がはみ出さないように丸める)
+int32_t FloorToTile(float value, float blockSize) {
+	const float kLimit = 1.0e9f;
+	return static_cast<int32_t>(std::floor(std::clamp(value / blockSize, -kLimit, kLimit)));
+}
+
+} // namespace
+
+bool ComputeVisibleWorldRect(const Matrix4x4& viewProjectionMatrix, float planeZ, WorldRect& rect) {
+	Matrix4x4 inverse = Inverse(viewProjectionMatrix);
+	const float corners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { -1.0f, 1.0f }, { 1.0f, 1.0f } };
+	for (int i = 0; i < 4; ++i) {
+		Vector3 nearPoint;
+		Vector3 farPoint;
+		if (!Unproject(inverse, corners[i][0], corners[i][1], 0.0f, nearPoint) ||
+			!Unproject(inverse, corners[i][0], corners[i][1], 1.0f, farPoint)) {
+			return false;
+		}
+		float dz = farPoint.z - nearPoint.z;
+		if (std::abs(dz) < 1e-12f) {
+			return false;
+		}
+		// near から far までの間で平面と交わるか
+		float t = (planeZ - nearPoint.z) / dz;
+		if (!(t >= 0.0f && t <= 1.0f)) {
+			return false;
+		}
+		float x = nearPoint.x + (farPoint.x - nearPoint.x) * t;
+		float y = nearPoint.y + (farPoint.y - nearPoint.y) * t;
+		if (i == 0) {
+			rect = { x, y, x, y };
+		} else {
+			rect.left = std::min(rect.left, x);
+			rect.right = std::max(rect.right, x);
+			rect.bottom = std::min(rect.bottom, y);
+			rect.top = std::max(rect.top, y);
+		}
+	}
+	return true;
+}
+
+TileRect ComputeVisibleTileRange(const WorldRect& rect, float blockSize, int32_t mapHeight, int32_t margin) {
+	TileRect range;
+	range.x0 = FloorToTile(rect.left, blockSize) - margin;
+	range.x1 = FloorToTile(rect.right, blockSize) + margin;
+	// 上にあるほど mapY は小さい
+	range.mapY0 = (mapHeight - 1) - FloorToTile(rect.top, blockSize) - margin;
+	range.mapY1 = (mapHeight - 1) - FloorToTile(rect.bottom, blockSize) + margin;
+	return range;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "ChunkedTileMap.h"
+#include "MathTypes.h"
+#include <cstdint>
+
+// カメラに映る範囲をタイル単位で求める (Windows / D3D12 に依存しない)
+//
+// 行列は行ベクトル (v * M) で、NDC の z は 0..1 (MakePerspectiveFovMatrix と同じ)。
+// 画面の四隅を通る視線と平面 z = planeZ の交点を囲む矩形を、見えている範囲とする
+// (カメラが傾いていても四隅の交点の凸包が見える範囲なので、それを囲む矩形は取りこぼさない)。
+
+// 画面に映るタイルの範囲の外側に足す余白 (壁の奥行きと、マスからはみ出して動くブロックの分)
+const int32_t kTileCullMargin = 2;
+
+// 範囲を絞れないときの「すべて」(重なり判定で int がはみ出さない大きさ)
+const TileRect kUnboundedTileRange = { INT32_MIN / 2, INT32_MIN / 2, INT32_MAX / 2, INT32_MAX / 2 };
+
+// 視線が平面に届かない (平面がカメラの後ろ・near より手前・far より奥) なら false
+bool ComputeVisibleWorldRect(const Matrix4x4& viewProjectionMatrix, float planeZ, WorldRect& rect);
+
+// 矩形にかかるタイルの範囲を margin タイル分広げて返す
+// 座標は MapChip と同じ (タイル x は x*blockSize から右へ、mapY は上から数え、最下段が y = 0)
+// マップの外に出る分は切り詰めない (マップの外にいる動的ブロックも判定できるように)
+TileRect ComputeVisibleTileRange(const WorldRect& rect, float blockSize, int32_t mapHeight, int32_t margin);
+
+// 範囲が重なるか
+inline bool IsTileRectOverlapping(const TileRect& a, const TileRect& b) {
+	return a.x0 <= b.x1 && b.x0 <= a.x1 && a.mapY0 <= b.mapY1 && b.mapY0 <= a.mapY1;
+}
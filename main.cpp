@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdint>
 #include <filesystem>
+#include <format>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -34,14 +35,20 @@
 #include "GraphicsPipeline.h"
 #include "D3D12Util.h"
 #include "Model.h"
+#include "MeshManager.h"
+#include "ConstantBufferAllocator.h"
+#include "UploadBufferAllocator.h"
+#include "StaticBufferUploader.h"
+#include "InstanceBatch.h"
+#include "InstancedRenderer.h"
 #include "MathUtil.h"
 #include "DataTypes.h"
 #include "Input.h"
-#include "Player.h"
+#include "FixedTimestep.h"
+#include "GameSimulation.h"
+#include "InputReplay.h"
 #include "MapChip.h"
 #include "Camera.h"
-#include "Trap.h"
-#include "FallingBlock.h"
 
 // =========================================================================
 // ▼ ヘルパー関数群
@@ -178,18 +185,11 @@ void DeleteSave() {
     }
 }
 
-enum class GameScene {
-    Title,
-    GamePlay,
-    GameOver,
-    GameClear
-};
-
 // =========================================================================
 // ▼ メイン関数
 // =========================================================================
 
-int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
+int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR commandLine, int) {
     D3DResourceLeakChecker leakChecker;
     WinApp* winApp = WinApp::GetInstance();
     winApp->Initialize();
@@ -226,13 +226,64 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     graphicsPipeline->Initialize(device);
     ID3D12GraphicsCommandList* commandList = dxCommon->GetCommandList();
 
-    // --- ゲームプレイ用リソースポインタ ---
-    MapChip* mapChip = nullptr;
+    // --- 描画ごとの定数バッファ (1描画256バイト、1フレームで使い切ったら次のフレームで再利用) ---
+    const uint64_t kConstantBufferSize = 1024 * 1024;
+    ConstantBufferAllocator::GetInstance()->Initialize(device, kConstantBufferSize);
+    // 小さな常駐バッファ (マテリアル・ライトなど) は64KiBのページから切り出す
+    UploadBufferAllocator::GetInstance()->Initialize(device);
+    // 頂点データは DEFAULT ヒープへ、ステージングバッファ経由でまとめて転送する
+    const uint64_t kStagingBufferSize = 8 * 1024 * 1024;
+    StaticBufferUploader::GetInstance()->Initialize(device, kStagingBufferSize);
+    // 頂点形式 (kVertexFormatCompact で 36 -> 20 バイト。PSOもこれに合わせて選ぶ)
+    const VertexFormat kMeshVertexFormat = kVertexFormatFull;
+    MeshManager::GetInstance()->SetVertexFormat(kMeshVertexFormat);
+
+    // --- インスタンス描画 (ブロック・トラップ・弾をメッシュごとに1回で描く) ---
+    const uint32_t kMaxInstanceCount = 4096;
+    InstancedRenderer* instancedRenderer = new InstancedRenderer();
+    instancedRenderer->Initialize(device, kMaxInstanceCount);
+    InstanceBatch instanceBatch;
+
+    // --- ゲームの進行 (シーン・マップ・プレイヤー・罠。描画はここで状態を読んで行う) ---
+    GameSimulation* simulation = new GameSimulation();
+    simulation->SetInputSource(Input::GetInstance());
+    // 壁のメッシュはマップのチャンクの通知で作るので、マップを読む前に登録する
+    MapChip* mapChip = new MapChip();
+    mapChip->Initialize(&simulation->GetMap());
+
+    // --- 操作の記録・再生 (起動引数 --record path / --replay path) ---
+    // 記録はキーボードの操作をそのまま使いつつ残し、終了時に書き出す。
+    // 再生はキーボードの代わりに記録を渡し、毎ティック状態のハッシュを比べる
+    std::string recordPath;
+    std::string replayPath;
+    std::istringstream arguments(commandLine ? commandLine : "");
+    for (std::string argument; arguments >> argument;) {
+        if (argument == "--record") arguments >> recordPath;
+        else if (argument == "--replay") arguments >> replayPath;
+    }
+    InputRecording replayRecording;
+    InputRecorder* inputRecorder = nullptr;
+    InputReplayer* inputReplayer = nullptr;
+    bool isReplayReported = false;
+    if (!replayPath.empty()) {
+        std::string errorMessage;
+        if (ReadInputRecording(replayPath, replayRecording, &errorMessage)) {
+            inputReplayer = new InputReplayer(&replayRecording);
+            simulation->SetInputSource(inputReplayer);
+            Log(std::cout, std::format("[Replay] {} ({} ticks)", replayPath, replayRecording.GetTickCount()));
+        } else {
+            Log(std::cout, "[ERROR] Replay Load Failed: " + replayPath + " (" + errorMessage + ")");
+        }
+    } else if (!recordPath.empty()) {
+        inputRecorder = new InputRecorder(Input::GetInstance());
+        simulation->SetInputSource(inputRecorder);
+    }
+
+    // --- ゲームプレイ用リソースポインタ (プレイ開始時に作り、タイトルに戻ると解放) ---
     Model* playerModel = nullptr;
-    Player* player = nullptr;
     Model* goalModel_ = nullptr;
-    std::vector<Trap*> traps_;
-    std::vector<FallingBlock*> fallingBlocks_;
+    std::shared_ptr<const Mesh> cubeMesh;  // 罠の壁・弾
+    std::shared_ptr<const Mesh> trapMesh;  // 落下ブロック
 
     // --- シーン用モデルポインタ ---
     Model* titleModel = nullptr;
@@ -342,9 +393,8 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 
     // --- ライト・カメラ (常駐) ---
-    Microsoft::WRL::ComPtr<ID3D12Resource> directionalLightResource = CreateBufferResource(device, sizeof(DirectionalLight));
-    DirectionalLight* directionalLightData = nullptr;
-    directionalLightResource->Map(0, nullptr, reinterpret_cast<void**>(&directionalLightData));
+    UploadBuffer directionalLightBuffer = UploadBufferAllocator::GetInstance()->Allocate(sizeof(DirectionalLight));
+    DirectionalLight* directionalLightData = reinterpret_cast<DirectionalLight*>(directionalLightBuffer.cpuAddress);
     directionalLightData->color = { 1.0f, 1.0f, 1.0f, 1.0f };
     directionalLightData->direction = Normalize({ 0.0f, -1.0f, 0.0f });
     directionalLightData->intensity = 1.0f;
@@ -352,335 +402,120 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
     Camera* camera = new Camera();
     camera->Initialize();
 
-    Microsoft::WRL::ComPtr<ID3D12Resource> cameraForGpuResource = CreateBufferResource(device, sizeof(CameraForGpu));
-    CameraForGpu* cameraForGpuData = nullptr;
-    cameraForGpuResource->Map(0, nullptr, reinterpret_cast<void**>(&cameraForGpuData));
-
-    // --- シーン管理用変数 ---
-    GameScene currentScene = GameScene::Title;
-    bool isGameInitialized = false;
-    bool isLoadingNextMap = false;
-
-    std::string currentMapFilePath = "Resources/map.csv";
-    Vector3 currentRespawnPos = { 0.0f, 0.0f, 0.0f };
-    std::string nextMapFilePath = "";
-    Vector3 nextRespawnPos = { 0.0f, 0.0f, 0.0f };
-
-    // ★ Map3用変数
-    float map3Timer = 0.0f;
-    bool map3EventTriggered = false;
-    Vector3 block6Pos = { 9999.0f, 0.0f, 0.0f }; // 6番ブロックの位置
-
-    // ★ ゴール移動アニメーション用変数
-    int goalAnimPhase = 0; // 0:なし, 1:上昇, 2:左移動, 3:下降
-    Vector3 goalTargetPosModel = { 0.0f, 0.0f, 0.0f }; // ゴールモデルの最終到達位置
+    UploadBuffer cameraForGpuBuffer = UploadBufferAllocator::GetInstance()->Allocate(sizeof(CameraForGpu));
+    CameraForGpu* cameraForGpuData = reinterpret_cast<CameraForGpu*>(cameraForGpuBuffer.cpuAddress);
 
     float clearTimer = 0.0f; // ★追加: クリア演出の経過時間
+    uint32_t loggedMapLoadCount = 0;
 
     // --- ゲームリソース解放用ラムダ ---
     auto cleanupGameResources = [&]() {
-        delete mapChip; mapChip = nullptr;
-        delete player; player = nullptr;
         delete playerModel; playerModel = nullptr;
         delete goalModel_; goalModel_ = nullptr;
-        for (Trap* trap : traps_) delete trap; traps_.clear();
-        for (FallingBlock* block : fallingBlocks_) delete block; fallingBlocks_.clear();
-        isGameInitialized = false;
-        map3EventTriggered = false;
-        goalAnimPhase = 0;
+        cubeMesh.reset();
+        trapMesh.reset();
+        };
+
+    // --- メッシュ共有状況のログ出力 ---
+    auto logMeshStats = [&]() {
+        MeshManager* meshManager = MeshManager::GetInstance();
+        Log(std::cout, std::format("[MeshManager] hit:{} miss:{} meshes:{}",
+            meshManager->GetHitCount(), meshManager->GetMissCount(), meshManager->GetMeshCount()));
+        const WeldStats& weldStats = meshManager->GetWeldStats();
+        Log(std::cout, std::format("[MeshManager] vertices:{} -> {} bytes:{} -> {} (saved {})",
+            weldStats.sourceVertexCount, weldStats.weldedVertexCount, weldStats.sourceBytes, weldStats.weldedBytes,
+            static_cast<int64_t>(weldStats.sourceBytes) - static_cast<int64_t>(weldStats.weldedBytes)));
+        const SizeClassAllocator& bufferStats = UploadBufferAllocator::GetInstance()->GetStats();
+        Log(std::cout, std::format("[UploadBufferAllocator] buffers:{} requested:{}B reserved:{}B committed:{}B pages:{}",
+            bufferStats.GetLiveAllocationCount(), bufferStats.GetRequestedBytes(), bufferStats.GetReservedBytes(),
+            bufferStats.GetCommittedBytes(), bufferStats.GetPageCount()));
+        const UploadScheduler& uploadStats = StaticBufferUploader::GetInstance()->GetScheduler();
+        Log(std::cout, std::format("[StaticBufferUploader] copies:{} uploaded:{}B flushes:{} staging peak:{}B",
+            uploadStats.GetTotalCopyCount(), uploadStats.GetTotalUploadedBytes(), uploadStats.GetFlushCount(),
+            uploadStats.GetStagingRing().GetPeakUsedSize()));
         };
 
+    // 画面の更新間隔によらず、ゲームは kTickSeconds ごとに進める
+    FixedTimestep timestep;
+    std::chrono::steady_clock::time_point lastFrameTime = std::chrono::steady_clock::now();
+
     // ========== メインループ ==========
     while (!winApp->IsEndRequested()) {
         winApp->ProcessMessage();
         Input::GetInstance()->Update();
-        Input* input = Input::GetInstance();
-
-        // --- シーン処理 (ロジック更新のみ) ---
-        switch (currentScene) {
-        case GameScene::Title:
-            if (input->IsKeyPressed(VK_SPACE)) {
-                if (currentMapFilePath.empty()) {
-                    currentMapFilePath = "Resources/map.csv";
-                    currentRespawnPos = { 0.0f, 0.0f, 0.0f };
-                }
-                currentScene = GameScene::GamePlay;
-            }
-            break;
-
-        case GameScene::GamePlay:
-            if (!isGameInitialized) {
-                mapChip = new MapChip();
-                playerModel = Model::Create("Resources/player", "player.obj", device);
-                player = new Player();
-
-                mapChip->Load(currentMapFilePath, device);
-                player->Initialize(playerModel, mapChip, device);
 
-                if (currentRespawnPos.x != 0.0f || currentRespawnPos.y != 0.0f) {
-                    player->SetPosition(currentRespawnPos);
-                }
-
-                if (currentMapFilePath == "Resources/map.csv") {
-                    size_t mapHeight = 15;
-                    auto csvYToWorldY = [&](int csvY) { return (static_cast<float>(mapHeight - 1) - static_cast<float>(csvY)) * MapChip::kBlockSize + (MapChip::kBlockSize / 2.0f); };
-                    float stopMarginNormal = MapChip::kBlockSize * 1.0f;
-                    float stopMarginShort = MapChip::kBlockSize * 0.2f;
-
-                    traps_.push_back(new Trap()); traps_.back()->Initialize(device, csvYToWorldY(4), Trap::AttackSide::FromLeft, stopMarginNormal);
-                    traps_.push_back(new Trap()); traps_.back()->Initialize(device, csvYToWorldY(5), Trap::AttackSide::FromLeft, stopMarginNormal);
-                    traps_.push_back(new Trap()); traps_.back()->Initialize(device, csvYToWorldY(6), Trap::AttackSide::FromLeft, stopMarginNormal);
-                    traps_.push_back(new Trap()); traps_.back()->Initialize(device, csvYToWorldY(8), Trap::AttackSide::FromRight, stopMarginNormal);
-                    traps_.push_back(new Trap()); traps_.back()->Initialize(device, csvYToWorldY(9), Trap::AttackSide::FromRight, stopMarginNormal);
-                    traps_.push_back(new Trap()); traps_.back()->Initialize(device, csvYToWorldY(10), Trap::AttackSide::FromRight, stopMarginNormal);
-                    traps_.push_back(new Trap()); traps_.back()->Initialize(device, csvYToWorldY(12), Trap::AttackSide::FromRight, stopMarginShort);
-                    traps_.push_back(new Trap()); traps_.back()->Initialize(device, csvYToWorldY(13), Trap::AttackSide::FromRight, stopMarginShort);
-                }
-
-                const auto& dynamicBlocks = mapChip->GetDynamicBlocks();
-                for (const auto& data : dynamicBlocks) {
-                    FallingBlock* newBlock = new FallingBlock();
-                    newBlock->Initialize(device, data.position, static_cast<BlockType>(data.type));
-                    fallingBlocks_.push_back(newBlock);
-                }
+        // --- 更新 (前のフレームからの経過時間の分だけティックを進める) ---
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        double frameSeconds = std::chrono::duration<double>(now - lastFrameTime).count();
+        lastFrameTime = now;
 
-                // ★ Map3の初期設定 (初回ロード時)
-                if (currentMapFilePath == "Resources/map3.csv") {
-                    map3Timer = 0.0f;
-                    map3EventTriggered = false;
-                    goalAnimPhase = 0;
-                    int gx, gy;
-                    if (mapChip->FindBlock(6, gx, gy)) {
-                        block6Pos = mapChip->GetWorldPosFromGrid(gx, gy);
-                    } else {
-                        block6Pos = { 9999.0f, 0.0f, 0.0f };
-                    }
-                }
+        GameScene previousScene = simulation->GetScene();
+        int32_t tickCount = timestep.Advance(frameSeconds);
+        for (int32_t i = 0; i < tickCount; ++i) {
+            simulation->SetStreamingCenter(camera->GetTransform().translate);
+            simulation->Step();
 
-                if (mapChip->HasGoal()) {
-                    goalModel_ = Model::Create("Resources", "flag.obj", device);
-                    if (goalModel_) {
-                        goalModel_->transform.scale = { MapChip::kBlockSize, MapChip::kBlockSize, MapChip::kBlockSize };
-                        goalModel_->transform.rotate = { 0.0f, 0.0f, 0.0f };
-                        Vector3 goalPos = mapChip->GetGoalPosition();
-                        goalPos.y -= MapChip::kBlockSize * 0.5f;
-                        goalModel_->transform.translate = goalPos;
-                    }
-                }
-                isLoadingNextMap = false;
-                isGameInitialized = true;
+            if (inputRecorder) {
+                inputRecorder->RecordState(simulation->ComputeStateHash());
             }
-
-            if (!isLoadingNextMap && isGameInitialized) {
-                // 1. プレイヤーの更新
-                player->Update();
-
-                // 2. 奈落（画面外）の死亡判定
-                if (player->IsAlive() && player->GetPosition().y < -5.0f) {
-                    player->Die();
-                }
-
-                // 3. ギミック・エネミーの更新 (死亡中も動かす)
-                for (Trap* trap : traps_) trap->Update(player);
-                for (FallingBlock* block : fallingBlocks_) block->Update(player, mapChip);
-
-                // ★ Map3専用ギミック
-                if (currentMapFilePath == "Resources/map3.csv" && !map3EventTriggered) {
-                    map3Timer += 1.0f / 60.0f;
-
-                    // 時間制限: 10秒
-                    bool timerCondition = (map3Timer >= 5.0f);
-
-                    // ジャンプ条件: 6番ブロック + 4ブロック分右に進んだら発動
-                    bool jumpCondition = (block6Pos.x < 9000.0f && player->GetPosition().x > block6Pos.x + MapChip::kBlockSize * 4.0f);
-
-                    if (timerCondition || jumpCondition) {
-                        map3EventTriggered = true;
-
-                        // ゴールの最終目的地を計算 (左側の x=3.5 あたりへ移動)
-                        float goalX = MapChip::kBlockSize * 3.5f;
-                        float goalY = MapChip::kBlockSize * 1.5f;
-                        Vector3 newGoalPos = { goalX, goalY, 0.0f };
-
-                        // モデル表示用の最終位置
-                        goalTargetPosModel = newGoalPos;
-                        goalTargetPosModel.y -= MapChip::kBlockSize * 0.5f;
-
-                        // ゴール移動アニメーション開始
-                        if (goalModel_) {
-                            goalAnimPhase = 1;
-                        }
-
-                        // ★壁生成位置: X=12 (1個分左) に変更
-                        int midX = 12;
-                        size_t rows = mapChip->GetRowCount();
-                        for (int y = 0; y < rows; ++y) {
-                            Vector3 spawnPos = mapChip->GetWorldPosFromGrid(midX, y);
-                            FallingBlock* newWall = new FallingBlock();
-                            newWall->Initialize(device, spawnPos, BlockType::StaticHazard);
-                            fallingBlocks_.push_back(newWall);
-                        }
-                    }
-                }
-
-                // ★ ゴール移動アニメーション処理
-                if (map3EventTriggered && goalAnimPhase > 0 && goalModel_) {
-                    float moveSpeed = 0.2f;
-                    Vector3 currentPos = goalModel_->transform.translate;
-
-                    // マップ最上段のワールドY座標
-                    float topY = (static_cast<float>(mapChip->GetRowCount() - 1)) * MapChip::kBlockSize + MapChip::kBlockSize * 0.5f;
-                    topY -= MapChip::kBlockSize * 0.5f;
-
-                    switch (goalAnimPhase) {
-                    case 1: // 上昇
-                        currentPos.y += moveSpeed;
-                        if (currentPos.y >= topY) {
-                            currentPos.y = topY;
-                            goalAnimPhase = 2;
-                        }
-                        break;
-                    case 2: // 左へ移動 (天井伝い)
-                        currentPos.x -= moveSpeed;
-                        if (currentPos.x <= goalTargetPosModel.x) {
-                            currentPos.x = goalTargetPosModel.x;
-                            goalAnimPhase = 3;
-                        }
-                        break;
-                    case 3: // 下降
-                        currentPos.y -= moveSpeed;
-                        if (currentPos.y <= goalTargetPosModel.y) {
-                            currentPos.y = goalTargetPosModel.y;
-                            goalAnimPhase = 0;
-
-                            Vector3 finalColliderPos = goalTargetPosModel;
-                            finalColliderPos.y += MapChip::kBlockSize * 0.5f;
-                            mapChip->SetGoalPosition(finalColliderPos);
-                        }
-                        break;
-                    }
-
-                    goalModel_->transform.translate = currentPos;
-
-                    // 移動中も当たり判定を追従させる
-                    Vector3 colliderPos = currentPos;
-                    colliderPos.y += MapChip::kBlockSize * 0.5f;
-                    mapChip->SetGoalPosition(colliderPos);
-                }
-
-                // 4. 死亡後のリトライ受付
-                if (!player->IsAlive()) {
-                    if (input->IsKeyPressed(VK_SPACE)) {
-                        cleanupGameResources();
-                        goto end_of_update;
-                    }
-                }
-
-                // 5. マップ移動・クリア判定 (生存中のみ)
-                if (player->IsAlive()) {
-                    if (currentMapFilePath == "Resources/map.csv") {
-                        if (player->IsExiting()) {
-                            isLoadingNextMap = true;
-                            nextMapFilePath = "Resources/map2.csv";
-                            size_t map2Height = 15;
-                            float spawnY = (static_cast<float>(map2Height - 1) - 14.0f) * MapChip::kBlockSize + (MapChip::kBlockSize / 2.0f);
-                            float spawnX = (MapChip::kBlockSize / 2.0f);
-                            nextRespawnPos = { spawnX, spawnY, 0.0f };
-                        }
-                    } else if (currentMapFilePath == "Resources/map2.csv") {
-                        Vector3 pPos = player->GetPosition();
-                        float mapTopY = static_cast<float>(mapChip->GetRowCount()) * MapChip::kBlockSize;
-                        if (pPos.x < MapChip::kBlockSize * 2.0f && pPos.y > mapTopY - (MapChip::kBlockSize * 2.0f)) {
-                            isLoadingNextMap = true;
-                            nextMapFilePath = "Resources/map3.csv";
-                            float spawnX = MapChip::kBlockSize * 3.5f;
-                            float spawnY = MapChip::kBlockSize * 1.5f;
-                            nextRespawnPos = { spawnX, spawnY, 0.0f };
-                        }
-                    } else if (currentMapFilePath == "Resources/map3.csv") {
-                        if (mapChip->HasGoal() && mapChip->CheckGoalCollision(player->GetPosition(), player->GetHalfSize())) {
-                            currentScene = GameScene::GameClear;
-                            currentMapFilePath = "Resources/map.csv";
-                            currentRespawnPos = { 0.0f, 0.0f, 0.0f };
-                        }
-                    }
+            if (inputReplayer && !isReplayReported) {
+                if (!inputReplayer->VerifyState(simulation->ComputeStateHash())) {
+                    Log(std::cout, std::format("[Replay] diverged from the recording at tick {}", inputReplayer->GetDivergedTick()));
+                    isReplayReported = true;
+                } else if (inputReplayer->IsFinished()) {
+                    Log(std::cout, std::format("[Replay] finished {} ticks without divergence", inputReplayer->GetTick()));
+                    isReplayReported = true;
                 }
             }
+        }
+        // 描画は前のティックと今のティックの間を補間する
+        const float renderAlpha = timestep.GetAlpha();
+
+        if (!simulation->GetLastError().empty()) {
+            std::string message = "Error: " + simulation->GetLastError() + "\n";
+            OutputDebugStringA(message.c_str());
+            assert(false && "FAIL: map file could not be loaded.");
+            simulation->ClearLastError();
+        }
 
-            if (isLoadingNextMap) {
-                for (Trap* trap : traps_) delete trap; traps_.clear();
-                for (FallingBlock* block : fallingBlocks_) delete block; fallingBlocks_.clear();
-                delete goalModel_; goalModel_ = nullptr;
-
-                currentMapFilePath = nextMapFilePath;
-                currentRespawnPos = nextRespawnPos;
-                mapChip->Load(currentMapFilePath, device);
-                player->SetPosition(currentRespawnPos);
-
-                const auto& dynamicBlocks2 = mapChip->GetDynamicBlocks();
-                for (const auto& data : dynamicBlocks2) {
-                    FallingBlock* newBlock = new FallingBlock();
-                    newBlock->Initialize(device, data.position, static_cast<BlockType>(data.type));
-                    fallingBlocks_.push_back(newBlock);
-                }
-
-                // ★★★★ Map3の初期設定 (マップ遷移時にも必ず行う) ★★★★
-                if (currentMapFilePath == "Resources/map3.csv") {
-                    map3Timer = 0.0f;
-                    map3EventTriggered = false;
-                    goalAnimPhase = 0;
-                    int gx, gy;
-                    if (mapChip->FindBlock(6, gx, gy)) {
-                        block6Pos = mapChip->GetWorldPosFromGrid(gx, gy);
-                    } else {
-                        block6Pos = { 9999.0f, 0.0f, 0.0f };
-                    }
-                }
-                // ★★★★★★★★★★★★★★★★★★★★★★★★★★★★★
-
-                if (mapChip->HasGoal()) {
-                    goalModel_ = Model::Create("Resources", "flag.obj", device);
-                    if (goalModel_) {
-                        goalModel_->transform.scale = { MapChip::kBlockSize, MapChip::kBlockSize, MapChip::kBlockSize };
-                        goalModel_->transform.rotate = { 0.0f, 0.0f, 0.0f };
-                        Vector3 goalPos = mapChip->GetGoalPosition();
-                        goalPos.y -= MapChip::kBlockSize * 0.5f;
-                        goalModel_->transform.translate = goalPos;
-                    }
-                }
-                isLoadingNextMap = false;
-            }
-            break;
-
-        case GameScene::GameOver:
-            if (input->IsKeyPressed(VK_SPACE)) {
-                cleanupGameResources();
-                currentScene = GameScene::GamePlay;
-            }
-            break;
-
-        case GameScene::GameClear:
-            if (input->IsKeyPressed(VK_SPACE)) {
-                cleanupGameResources();
-                currentScene = GameScene::Title;
+        if (simulation->IsPlaying() && playerModel == nullptr) {
+            playerModel = Model::Create("Resources/player", "player.obj", device);
+            goalModel_ = Model::Create("Resources", "flag.obj", device);
+            if (goalModel_) {
+                goalModel_->transform.scale = { GameMap::kBlockSize, GameMap::kBlockSize, GameMap::kBlockSize };
+                goalModel_->transform.rotate = { 0.0f, 0.0f, 0.0f };
             }
-            break;
+            cubeMesh = MeshManager::GetInstance()->Load("Resources/cube", "cube.obj", device);
+            trapMesh = MeshManager::GetInstance()->Load("Resources/Trap", "Trap.obj", device);
+        }
+        if (simulation->GetMapLoadCount() != loggedMapLoadCount) {
+            loggedMapLoadCount = simulation->GetMapLoadCount();
+            logMeshStats();
+        }
+        if (previousScene == GameScene::GameClear && simulation->GetScene() == GameScene::Title) {
+            cleanupGameResources();
+            // タイトルでは使わないゲーム用メッシュを解放
+            MeshManager::GetInstance()->ReleaseUnused();
         }
-
-    end_of_update:
 
         // --- 描画開始 ---
+        // GPUが終えたフレームの定数・ステージング領域を再利用可能にする
+        const UINT64 completedFenceValue = dxCommon->GetCompletedFenceValue();
+        ConstantBufferAllocator::GetInstance()->BeginFrame(completedFenceValue);
+        StaticBufferUploader::GetInstance()->BeginFrame(completedFenceValue);
+        // 前のフレーム以降に作られた静的バッファへのコピーを、描画より先に積む
+        StaticBufferUploader::GetInstance()->Flush(commandList);
         dxCommon->PreDraw();
 
         commandList->SetGraphicsRootSignature(graphicsPipeline->GetRootSignature());
-        commandList->SetPipelineState(graphicsPipeline->GetPipelineState(kBlendModeNone));
+        commandList->SetPipelineState(graphicsPipeline->GetPipelineState(kBlendModeNone, kMeshVertexFormat));
         commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
         const Matrix4x4& viewProjectionMatrix = camera->GetViewProjectionMatrix();
         cameraForGpuData->worldPosition = camera->GetTransform().translate;
         directionalLightData->direction = Normalize(directionalLightData->direction);
-        commandList->SetGraphicsRootConstantBufferView(3, directionalLightResource->GetGPUVirtualAddress());
-        commandList->SetGraphicsRootConstantBufferView(4, cameraForGpuResource->GetGPUVirtualAddress());
+        commandList->SetGraphicsRootConstantBufferView(3, directionalLightBuffer.gpuAddress);
+        commandList->SetGraphicsRootConstantBufferView(4, cameraForGpuBuffer.gpuAddress);
 
         ID3D12DescriptorHeap* descriptorHeaps[] = { srvDescriptorHeap.Get() };
         commandList->SetDescriptorHeaps(1, descriptorHeaps);
@@ -688,52 +523,101 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
         // --- 描画コマンド発行 ---
 
         if (skydomeModel && skydomeTextureResource) {
-            skydomeModel->Draw(commandList, viewProjectionMatrix, directionalLightResource->GetGPUVirtualAddress(), skydomeTextureSrvHandleGPU);
+            skydomeModel->Draw(commandList, viewProjectionMatrix, directionalLightBuffer.gpuAddress, skydomeTextureSrvHandleGPU);
         }
 
+        GameScene currentScene = simulation->GetScene();
         if (currentScene == GameScene::Title) {
             if (titleModel && titleTextureResource) {
-                titleModel->Draw(commandList, viewProjectionMatrix, directionalLightResource->GetGPUVirtualAddress(), titleTextureSrvHandleGPU);
+                titleModel->Draw(commandList, viewProjectionMatrix, directionalLightBuffer.gpuAddress, titleTextureSrvHandleGPU);
             }
         } else if (currentScene == GameScene::GameClear) {
             if (gameClearModel && gameClearTextureResource) {
-                gameClearModel->Draw(commandList, viewProjectionMatrix, directionalLightResource->GetGPUVirtualAddress(), gameClearTextureSrvHandleGPU);
+                gameClearModel->Draw(commandList, viewProjectionMatrix, directionalLightBuffer.gpuAddress, gameClearTextureSrvHandleGPU);
+            }
+        } else if (simulation->IsPlaying() && playerModel != nullptr) {
+            const Player* player = simulation->GetPlayer();
+            playerModel->transform = player->GetRenderTransform(renderAlpha);
+            if (playerTextureResource) playerModel->Draw(commandList, viewProjectionMatrix, directionalLightBuffer.gpuAddress, playerTextureSrvHandleGPU);
+            if (cubeTextureResource) {
+                if (goalModel_ && simulation->HasGoalFlag()) {
+                    goalModel_->transform.translate = simulation->GetGoalFlagRenderPosition(renderAlpha);
+                    goalModel_->Draw(commandList, viewProjectionMatrix, directionalLightBuffer.gpuAddress, flagTextureSrvHandleGPU);
+                }
+            }
+
+            // 数の多いものはバッチに積んでまとめて描画
+            // カメラに映る範囲 (と少しの余白) の壁と動的ブロックだけを積む
+            instanceBatch.Begin(viewProjectionMatrix);
+            mapChip->UpdateVisibleRange(viewProjectionMatrix);
+            if (blockTextureResource) mapChip->Draw(instanceBatch, blockTextureSrvHandleGPU);
+            if (playerTextureResource) {
+                for (const PlayerBullet* bullet : player->GetBullets()) {
+                    instanceBatch.Add(cubeMesh.get(), playerTextureSrvHandleGPU.ptr, bullet->GetRenderTransform(renderAlpha));
+                }
             }
-        } else if (currentScene == GameScene::GamePlay && isGameInitialized && player != nullptr) {
-            // 背景を描画
-            if (blockTextureResource) mapChip->Draw(commandList, viewProjectionMatrix, directionalLightResource->GetGPUVirtualAddress(), blockTextureSrvHandleGPU);
-            if (playerTextureResource) player->Draw(commandList, viewProjectionMatrix, directionalLightResource->GetGPUVirtualAddress(), playerTextureSrvHandleGPU);
             if (cubeTextureResource) {
-                for (Trap* trap : traps_) trap->Draw(commandList, viewProjectionMatrix, directionalLightResource->GetGPUVirtualAddress(), cubeTextureSrvHandleGPU);
-                if (goalModel_) goalModel_->Draw(commandList, viewProjectionMatrix, directionalLightResource->GetGPUVirtualAddress(), flagTextureSrvHandleGPU);
+                for (const Trap* trap : simulation->GetTraps()) {
+                    if (trap->IsVisible() && mapChip->IsObjectVisible(trap->GetPosition())) {
+                        instanceBatch.Add(cubeMesh.get(), cubeTextureSrvHandleGPU.ptr, trap->GetRenderTransform(renderAlpha));
+                    }
+                }
             }
             if (trapTextureResource) {
-                for (FallingBlock* block : fallingBlocks_) {
-                    block->Draw(commandList, viewProjectionMatrix, directionalLightResource->GetGPUVirtualAddress(), trapTextureSrvHandleGPU);
+                for (const FallingBlock* block : simulation->GetFallingBlocks()) {
+                    if (mapChip->IsObjectVisible(block->GetPosition())) {
+                        instanceBatch.Add(trapMesh.get(), trapTextureSrvHandleGPU.ptr, block->GetRenderTransform(renderAlpha));
+                    }
                 }
             }
+            commandList->SetPipelineState(graphicsPipeline->GetInstancingPipelineState(kBlendModeNone, kMeshVertexFormat));
+            instancedRenderer->Draw(commandList, instanceBatch, directionalLightBuffer.gpuAddress);
+            commandList->SetPipelineState(graphicsPipeline->GetPipelineState(kBlendModeNone, kMeshVertexFormat));
 
             // ★ 死亡演出：GameOverを最前面に描画
             if (!player->IsAlive()) {
                 dxCommon->ClearDepthBuffer();
                 if (gameOverModel && gameOverTextureResource) {
-                    gameOverModel->Draw(commandList, viewProjectionMatrix, directionalLightResource->GetGPUVirtualAddress(), gameOverTextureSrvHandleGPU);
+                    gameOverModel->Draw(commandList, viewProjectionMatrix, directionalLightBuffer.gpuAddress, gameOverTextureSrvHandleGPU);
                 }
             }
         }
 
         dxCommon->PostDraw();
+        // このフレームの確保は、PostDraw でシグナルしたフェンスをGPUが通過するまで使い続ける
+        ConstantBufferAllocator::GetInstance()->EndFrame(dxCommon->GetFenceValue());
+        StaticBufferUploader::GetInstance()->EndFrame(dxCommon->GetFenceValue());
     }
 
     if (bgmSourceVoice) {
         bgmSourceVoice->DestroyVoice();
     }
 
-    if (isGameInitialized) cleanupGameResources();
+    if (inputRecorder) {
+        if (WriteInputRecording(recordPath, inputRecorder->GetRecording())) {
+            Log(std::cout, std::format("[Record] {} ({} ticks)", recordPath, inputRecorder->GetRecording().GetTickCount()));
+        } else {
+            Log(std::cout, "[ERROR] Record Write Failed: " + recordPath);
+        }
+    }
+    delete inputRecorder;
+    delete inputReplayer;
+
+    // MapChip はマップの通知の登録を外すので、マップを持つシミュレーションより先に消す
+    delete mapChip;
+    delete simulation;
+    cleanupGameResources();
 
     delete titleModel; delete gameOverModel; delete gameClearModel;
     delete skydomeModel;
+    delete instancedRenderer;
     delete graphicsPipeline; delete camera;
+    MeshManager::GetInstance()->Finalize();
+    ConstantBufferAllocator::GetInstance()->Finalize();
+    UploadBufferAllocator::GetInstance()->Free(directionalLightBuffer);
+    UploadBufferAllocator::GetInstance()->Free(cameraForGpuBuffer);
+    UploadBufferAllocator::GetInstance()->Finalize();
+    StaticBufferUploader::GetInstance()->Finalize();
 
     dxCommon->Finalize();
     CoUninitialize();